@@ -22,6 +22,7 @@
 #define  HYDRA_STATUS_DMA_DONE  BIT(3)
 #define  HYDRA_STATUS_BLIT_BUSY BIT(4)
 #define  HYDRA_STATUS_BLIT_DONE BIT(5)
+#define  HYDRA_STATUS_SCENE_DIRTY BIT(6)  /* a frame is owed in on-demand mode */
 
 #define HYDRA_REG_CAM_X         0x0020
 #define HYDRA_REG_CAM_Y         0x0024
@@ -32,7 +33,11 @@
 #define HYDRA_REG_CAM_PLANE_X   0x0038
 #define HYDRA_REG_CAM_PLANE_Y   0x003C
 
-#define HYDRA_REG_FLAGS         0x0040  /* [0]=smooth, [1]=curv, [2]=extra_light, [3]=diag_slice */
+#define HYDRA_REG_FLAGS         0x0040  /* [0]=smooth, [1]=curv, [2]=extra_light, [3]=diag_slice, [4]=render_on_demand, [5]=dda, [6]=perspective, [7]=memo, [8]=skip_empty, [9]=sdf, [10]=pipeline, [12:11]=tile_order, [13]=composite */
+#define  HYDRA_TILE_ORDER_RASTER 0
+#define  HYDRA_TILE_ORDER_ROWS   1  /* 8x8 tiles, row by row */
+#define  HYDRA_TILE_ORDER_MORTON 2
+#define  HYDRA_TILE_ORDER_HILBERT 3
 
 #define HYDRA_REG_SEL_ACTIVE    0x0044
 #define HYDRA_REG_SEL_X         0x0048
@@ -65,6 +70,17 @@
 #define HYDRA_REG_HDMI_FRAMES   0x00B4  /* RO: frame counter (sim) */
 #define HYDRA_REG_HDMI_LINE     0x00B8  /* RO: last line count (sim) */
 #define HYDRA_REG_HDMI_PIX      0x00BC  /* RO: last pixel-in-line (sim) */
+#define HYDRA_REG_SKIPPED_FRAMES 0x00C0 /* RO: frame_tick pulses with the auto-start held back (on-demand) */
+#define HYDRA_REG_SKIPPED_BRICKS 0x00C4 /* RO: empty bricks skipped by the last frame (skip_empty) */
+#define HYDRA_REG_FRAME_CYCLES  0x00C8 /* RO: clocks the last frame took */
+#define HYDRA_REG_CYCLES_PER_PIXEL 0x00CC /* RO: FRAME_CYCLES / pixels, unsigned Q24.8 */
+#define HYDRA_REG_CACHE_HITS    0x00D0 /* RO: voxel cache reads served by the last frame */
+#define HYDRA_REG_CACHE_MISSES  0x00D4 /* RO: voxel cache line fills of the last frame */
+#define HYDRA_REG_CACHE_EVICTIONS 0x00D8 /* RO: valid voxel cache lines replaced by the last frame */
+#define HYDRA_REG_FETCH_READS   0x00DC /* RO: trace reads of the last frame */
+#define HYDRA_REG_FETCH_REUSE   0x00E0 /* RO: of those, reads of a line in the fetch_stats tag table */
+#define HYDRA_REG_ALPHA_THRESHOLD 0x00E4 /* RW: [7:0] opacity (of 256) that ends a composite ray; loads like FLAGS, reset 243 */
+#define HYDRA_REG_ETS_SAVED     0x00E8 /* RO: voxels (not steps) early ray termination left unread in the last frame */
 
 /* 3D blitter stub (0x0100 region) */
 #define HYDRA_REG_BLIT_CTRL       0x0100  /* [0]=start, [1]=dir(readback), [2]=use_fifo */
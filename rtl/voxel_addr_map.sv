@@ -0,0 +1,46 @@
+// ============================================================================
+// voxel_addr_map.sv
+// - Maps a logical voxel address {x[5:0], y[5:0], z[5:0]} to the word index
+//   inside voxel_memory_64. Pure wiring, no logic levels.
+// - LAYOUT 0 (xyz):    unchanged, [17:12]=x, [11:6]=y, [5:0]=z.
+//   LAYOUT 1 (morton): bits interleaved, [3i+2]=x[i], [3i+1]=y[i], [3i]=z[i],
+//                      so every aligned 2^k cube is one contiguous run.
+//   LAYOUT 2 (brick):  {x[5:3], y[5:3], z[5:3], x[2:0], y[2:0], z[2:0]}: each
+//                      voxel_occupancy brick is 512 contiguous words.
+// - The build-wide default comes from +define+HYDRA_VOXEL_LAYOUT=N
+//   (sim/Makefile VOXEL_LAYOUT=); sim/scene/voxel_layout.h is the host copy.
+// ============================================================================
+
+`timescale 1ns/1ps
+
+`ifndef HYDRA_VOXEL_LAYOUT
+`define HYDRA_VOXEL_LAYOUT 0
+`endif
+
+module voxel_addr_map #(
+    parameter integer LAYOUT = `HYDRA_VOXEL_LAYOUT
+)(
+    input  wire [17:0] xyz,
+    output wire [17:0] index
+);
+
+    wire [5:0] x = xyz[17:12];
+    wire [5:0] y = xyz[11:6];
+    wire [5:0] z = xyz[5:0];
+
+    genvar i;
+    generate
+        if (LAYOUT == 1) begin : g_morton
+            for (i = 0; i < 6; i = i + 1) begin : g_bit
+                assign index[3*i+2] = x[i];
+                assign index[3*i+1] = y[i];
+                assign index[3*i]   = z[i];
+            end
+        end else if (LAYOUT == 2) begin : g_brick
+            assign index = {x[5:3], y[5:3], z[5:3], x[2:0], y[2:0], z[2:0]};
+        end else begin : g_xyz
+            assign index = xyz;
+        end
+    endgenerate
+
+endmodule
@@ -12,7 +12,7 @@ module voxel_axil_csr #(
     parameter [15:0]  VENDOR_ID  = 16'h1BAD,
     parameter [15:0]  DEVICE_ID  = 16'h2024,
     parameter [7:0]   REV_ID     = 8'h02,
-    parameter [7:0]   BUILD_ID   = 8'h01
+    parameter [7:0]   BUILD_ID   = 8'h0B
 )(
     input  wire                     clk,
     input  wire                     rst_n,
@@ -53,6 +53,16 @@ module voxel_axil_csr #(
     output reg                      flag_curvature,
     output reg                      flag_extra_light,
     output reg                      flag_diag_slice,
+    output reg                      flag_on_demand,
+    output reg                      flag_dda,
+    output reg                      flag_perspective,
+    output reg                      flag_memo,
+    output reg                      flag_skip_empty,
+    output reg                      flag_sdf,
+    output reg                      flag_pipeline,
+    output reg [1:0]                flag_tile_order,
+    output reg                      flag_composite,
+    output reg [7:0]                alpha_threshold,   // loads with the flags
 
     // Selection
     output reg                      sel_load_pulse,
@@ -69,6 +79,17 @@ module voxel_axil_csr #(
     // Core status inputs
     input  wire                     frame_done_pulse,
     input  wire                     core_busy,
+    input  wire                     scene_dirty_in,
+    input  wire [31:0]              skipped_frames_in,
+    input  wire [31:0]              skipped_bricks_in,
+    input  wire [31:0]              frame_cycles_in,
+    input  wire [31:0]              cycles_per_pixel_in,
+    input  wire [31:0]              cache_hits_in,
+    input  wire [31:0]              cache_misses_in,
+    input  wire [31:0]              cache_evictions_in,
+    input  wire [31:0]              fetch_reads_in,
+    input  wire [31:0]              fetch_reuses_in,
+    input  wire [31:0]              ets_saved_in,
 
     // Control pulses derived from CTRL register
     output reg                      soft_reset_pulse,
@@ -198,6 +219,17 @@ module voxel_axil_csr #(
     localparam integer W_HDMI_FR    = 8'h2D; // 0x00B4
     localparam integer W_HDMI_LINE  = 8'h2E; // 0x00B8
     localparam integer W_HDMI_PIX   = 8'h2F; // 0x00BC
+    localparam integer W_SKIPPED    = 8'h30; // 0x00C0
+    localparam integer W_SKIP_BRICKS= 8'h31; // 0x00C4
+    localparam integer W_FRAME_CYC  = 8'h32; // 0x00C8
+    localparam integer W_CYC_PIXEL  = 8'h33; // 0x00CC
+    localparam integer W_CACHE_HITS = 8'h34; // 0x00D0
+    localparam integer W_CACHE_MISS = 8'h35; // 0x00D4
+    localparam integer W_CACHE_EVICT= 8'h36; // 0x00D8
+    localparam integer W_FETCH_READS= 8'h37; // 0x00DC
+    localparam integer W_FETCH_REUSE= 8'h38; // 0x00E0
+    localparam integer W_ALPHA_THR  = 8'h39; // 0x00E4
+    localparam integer W_ETS_SAVED  = 8'h3A; // 0x00E8
 
     // 3D blitter stub (0x0100 region)
     localparam integer W_BLIT_CTRL      = 8'h40; // 0x0100
@@ -218,7 +250,7 @@ module voxel_axil_csr #(
 
     wire dma_done_pulse = dma_done_in & ~dma_done_d;
     wire status_read    = s_axil_arready && s_axil_arvalid && !s_axil_rvalid && (ar_word == W_STATUS);
-    wire [31:0] status_word = {26'd0, blit_done, blit_busy, dma_status[0], dma_status[1], frame_done_latched, core_busy};
+    wire [31:0] status_word = {25'd0, scene_dirty_in, blit_done, blit_busy, dma_status[0], dma_status[1], frame_done_latched, core_busy};
 
     integer pi;
     integer oi;
@@ -257,6 +289,16 @@ module voxel_axil_csr #(
             flag_curvature   <= 1'b1;
             flag_extra_light <= 1'b0;
             flag_diag_slice  <= 1'b0;
+            flag_on_demand   <= 1'b0;
+            flag_dda         <= 1'b0;
+            flag_perspective <= 1'b0;
+            flag_memo        <= 1'b0;
+            flag_skip_empty  <= 1'b0;
+            flag_sdf         <= 1'b0;
+            flag_pipeline    <= 1'b0;
+            flag_tile_order  <= 2'd0;
+            flag_composite   <= 1'b0;
+            alpha_threshold  <= 8'd243;
 
             sel_active <= 1'b0;
             sel_x <= 6'd0;
@@ -334,6 +376,16 @@ module voxel_axil_csr #(
                 flag_diag_slice    <= 1'b0;
                 flag_smooth        <= 1'b1;
                 flag_curvature     <= 1'b1;
+                flag_on_demand     <= 1'b0;
+                flag_dda           <= 1'b0;
+                flag_perspective   <= 1'b0;
+                flag_memo          <= 1'b0;
+                flag_skip_empty    <= 1'b0;
+                flag_sdf           <= 1'b0;
+                flag_pipeline      <= 1'b0;
+                flag_tile_order    <= 2'd0;
+                flag_composite     <= 1'b0;
+                alpha_threshold    <= 8'd243;
                 ctrl_shadow[3:2]   <= 2'b00;
                 blit_ctrl          <= 32'd0;
                 blit_status        <= 32'd0;
@@ -410,6 +462,15 @@ module voxel_axil_csr #(
                         flag_curvature   <= s_axil_wdata[1];
                         flag_extra_light <= s_axil_wdata[2];
                         flag_diag_slice  <= s_axil_wdata[3];
+                        flag_on_demand   <= s_axil_wdata[4];
+                        flag_dda         <= s_axil_wdata[5];
+                        flag_perspective <= s_axil_wdata[6];
+                        flag_memo        <= s_axil_wdata[7];
+                        flag_skip_empty  <= s_axil_wdata[8];
+                        flag_sdf         <= s_axil_wdata[9];
+                        flag_pipeline    <= s_axil_wdata[10];
+                        flag_tile_order  <= s_axil_wdata[12:11];
+                        flag_composite   <= s_axil_wdata[13];
                         flags_load_pulse <= 1'b1;
                         ctrl_shadow[3:2] <= s_axil_wdata[3:2];
                     end
@@ -417,6 +478,7 @@ module voxel_axil_csr #(
                     W_SEL_X:      begin sel_x      <= s_axil_wdata[5:0]; sel_load_pulse <= 1'b1; end
                     W_SEL_Y:      begin sel_y      <= s_axil_wdata[5:0]; sel_load_pulse <= 1'b1; end
                     W_SEL_Z:      begin sel_z      <= s_axil_wdata[5:0]; sel_load_pulse <= 1'b1; end
+                    W_ALPHA_THR:  begin alpha_threshold <= s_axil_wdata[7:0]; flags_load_pulse <= 1'b1; end
                     W_FB_BASE:    fb_base   <= merge_wstrb(fb_base,   s_axil_wdata, s_axil_wstrb);
                     W_FB_STRIDE:  fb_stride <= merge_wstrb(fb_stride, s_axil_wdata, s_axil_wstrb);
                     W_DMA_SRC:    dma_src   <= merge_wstrb(dma_src,   s_axil_wdata, s_axil_wstrb);
@@ -453,6 +515,7 @@ module voxel_axil_csr #(
                     W_DBG_CTRL: if (s_axil_wdata[0]) dbg_we_pulse <= 1'b1;
                     W_HDMI_CRC: ; // read-only
                     W_HDMI_FR:  ; // read-only
+                    W_SKIPPED:  ; // read-only
                     W_BLIT_CTRL: begin
                         blit_ctrl <= merge_wstrb(blit_ctrl, s_axil_wdata, s_axil_wstrb);
                         if (s_axil_wdata[0] && !blit_busy) begin
@@ -586,7 +649,7 @@ module voxel_axil_csr #(
                     W_CAM_DIR_Z: s_axil_rdata <= pack_s16(cam_dir_z);
                     W_CAM_PLANE_X: s_axil_rdata <= pack_s16(cam_plane_x);
                     W_CAM_PLANE_Y: s_axil_rdata <= pack_s16(cam_plane_y);
-                    W_FLAGS:   s_axil_rdata <= {28'd0, flag_diag_slice, flag_extra_light, flag_curvature, flag_smooth};
+                    W_FLAGS:   s_axil_rdata <= {18'd0, flag_composite, flag_tile_order, flag_pipeline, flag_sdf, flag_skip_empty, flag_memo, flag_perspective, flag_dda, flag_on_demand, flag_diag_slice, flag_extra_light, flag_curvature, flag_smooth};
                     W_SEL_ACTIVE: s_axil_rdata <= {31'd0, sel_active};
                     W_SEL_X:   s_axil_rdata <= {26'd0, sel_x};
                     W_SEL_Y:   s_axil_rdata <= {26'd0, sel_y};
@@ -608,6 +671,17 @@ module voxel_axil_csr #(
                     W_HDMI_FR:   s_axil_rdata <= hdmi_frames_in;
                     W_HDMI_LINE: s_axil_rdata <= {16'd0, hdmi_line_in};
                     W_HDMI_PIX:  s_axil_rdata <= {16'd0, hdmi_pix_in};
+                    W_SKIPPED:   s_axil_rdata <= skipped_frames_in;
+                    W_SKIP_BRICKS: s_axil_rdata <= skipped_bricks_in;
+                    W_FRAME_CYC:   s_axil_rdata <= frame_cycles_in;
+                    W_CYC_PIXEL:   s_axil_rdata <= cycles_per_pixel_in;
+                    W_CACHE_HITS:  s_axil_rdata <= cache_hits_in;
+                    W_CACHE_MISS:  s_axil_rdata <= cache_misses_in;
+                    W_CACHE_EVICT: s_axil_rdata <= cache_evictions_in;
+                    W_FETCH_READS: s_axil_rdata <= fetch_reads_in;
+                    W_FETCH_REUSE: s_axil_rdata <= fetch_reuses_in;
+                    W_ALPHA_THR:   s_axil_rdata <= {24'd0, alpha_threshold};
+                    W_ETS_SAVED:   s_axil_rdata <= ets_saved_in;
                     W_BLIT_CTRL:   s_axil_rdata <= blit_ctrl;
                     W_BLIT_STATUS: s_axil_rdata <= {28'd0, blit_status[3], blit_status[2], blit_status[1], blit_status[0]};
                     W_BLIT_SRC:    s_axil_rdata <= blit_src;
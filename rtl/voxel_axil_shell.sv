@@ -15,7 +15,9 @@ module voxel_axil_shell #(
     parameter integer SCREEN_HEIGHT   = 360,
     parameter integer VOXEL_GRID_SIZE = 64,
     parameter        TEST_FORCE_WORLD_READY = 0,
-    parameter        AUTO_START_FRAMES = 1
+    parameter        AUTO_START_FRAMES = 1,
+    parameter integer NUM_LANES       = 1,
+    parameter        VOXEL_CACHE      = 0
 )(
     input  wire clk,
     input  wire rst_n,
@@ -84,7 +86,10 @@ module voxel_axil_shell #(
 
     // Interrupt output
     output wire        irq_out,
-    output wire        msi_pulse
+    output wire        msi_pulse,
+
+    // Display refresh pulse (vsync) for SKIPPED_FRAMES; tie low without one
+    input  wire        frame_tick
 );
 
     // --------------------------------------------------------------------
@@ -105,6 +110,27 @@ module voxel_axil_shell #(
     wire         flag_curvature;
     wire         flag_extra_light;
     wire         flag_diag_slice;
+    wire         flag_on_demand;
+    wire         flag_dda;
+    wire         flag_perspective;
+    wire         flag_memo;
+    wire         flag_skip_empty;
+    wire         flag_sdf;
+    wire         flag_pipeline;
+    wire [1:0]   flag_tile_order;
+    wire         flag_composite;
+    wire [7:0]   alpha_threshold;
+    wire         scene_dirty;
+    wire [31:0]  skipped_frames;
+    wire [31:0]  skipped_bricks;
+    wire [31:0]  frame_cycles;
+    wire [31:0]  cycles_per_pixel;
+    wire [31:0]  cache_hits;
+    wire [31:0]  cache_misses;
+    wire [31:0]  cache_evictions;
+    wire [31:0]  fetch_reads;
+    wire [31:0]  fetch_reuses;
+    wire [31:0]  ets_saved;
 
     wire         sel_load_pulse;
     wire         sel_active;
@@ -174,6 +200,16 @@ module voxel_axil_shell #(
         .flag_curvature (flag_curvature),
         .flag_extra_light(flag_extra_light),
         .flag_diag_slice(flag_diag_slice),
+        .flag_on_demand (flag_on_demand),
+        .flag_dda       (flag_dda),
+        .flag_perspective(flag_perspective),
+        .flag_memo      (flag_memo),
+        .flag_skip_empty(flag_skip_empty),
+        .flag_sdf       (flag_sdf),
+        .flag_pipeline  (flag_pipeline),
+        .flag_tile_order(flag_tile_order),
+        .flag_composite (flag_composite),
+        .alpha_threshold(alpha_threshold),
 
         .sel_load_pulse (sel_load_pulse),
         .sel_active     (sel_active),
@@ -187,6 +223,17 @@ module voxel_axil_shell #(
 
         .frame_done_pulse(frame_done),
         .core_busy      (core_busy),
+        .scene_dirty_in (scene_dirty),
+        .skipped_frames_in(skipped_frames),
+        .skipped_bricks_in(skipped_bricks),
+        .frame_cycles_in(frame_cycles),
+        .cycles_per_pixel_in(cycles_per_pixel),
+        .cache_hits_in  (cache_hits),
+        .cache_misses_in(cache_misses),
+        .cache_evictions_in(cache_evictions),
+        .fetch_reads_in(fetch_reads),
+        .fetch_reuses_in(fetch_reuses),
+        .ets_saved_in   (ets_saved),
 
         .soft_reset_pulse(soft_reset_pulse),
         .start_frame_pulse(start_frame_pulse),
@@ -477,7 +524,9 @@ module voxel_axil_shell #(
         .SCREEN_HEIGHT  (SCREEN_HEIGHT),
         .VOXEL_GRID_SIZE(VOXEL_GRID_SIZE),
         .TEST_FORCE_WORLD_READY(TEST_FORCE_WORLD_READY),
-        .AUTO_START_FRAMES(AUTO_START_FRAMES)
+        .AUTO_START_FRAMES(AUTO_START_FRAMES),
+        .NUM_LANES      (NUM_LANES),
+        .VOXEL_CACHE    (VOXEL_CACHE)
     ) u_voxel (
         .clk            (clk),
         .rst_n          (rst_n),
@@ -488,6 +537,17 @@ module voxel_axil_shell #(
         .pixel_word2    (pixel_word2),
         .frame_done     (frame_done),
         .core_busy      (core_busy),
+        .scene_dirty_out(scene_dirty),
+        .skipped_frames (skipped_frames),
+        .skipped_bricks (skipped_bricks),
+        .frame_cycles_out(frame_cycles),
+        .cycles_per_pixel(cycles_per_pixel),
+        .cache_hits     (cache_hits),
+        .cache_misses   (cache_misses),
+        .cache_evictions(cache_evictions),
+        .fetch_reads    (fetch_reads),
+        .fetch_reuses   (fetch_reuses),
+        .ets_saved      (ets_saved),
         .cam_load       (cam_load_pulse),
         .cam_x_in       (cam_x),
         .cam_y_in       (cam_y),
@@ -502,6 +562,16 @@ module voxel_axil_shell #(
         .flag_curvature_in(flag_curvature),
         .flag_extra_light_in(flag_extra_light),
         .flag_diag_slice_in(flag_diag_slice),
+        .flag_on_demand_in(flag_on_demand),
+        .flag_dda_in      (flag_dda),
+        .flag_perspective_in(flag_perspective),
+        .flag_memo_in     (flag_memo),
+        .flag_skip_empty_in(flag_skip_empty),
+        .flag_sdf_in      (flag_sdf),
+        .flag_pipeline_in (flag_pipeline),
+        .flag_tile_order_in (flag_tile_order),
+        .flag_composite_in  (flag_composite),
+        .alpha_threshold_in (alpha_threshold),
         .sel_load       (sel_load_pulse),
         .sel_active_in  (sel_active),
         .sel_voxel_x_in (sel_x),
@@ -511,7 +581,8 @@ module voxel_axil_shell #(
         .dbg_ext_write_addr(ext_dbg_we ? ext_dbg_addr : dbg_addr),
         .dbg_ext_write_data(ext_dbg_we ? ext_dbg_data : dbg_wdata),
         .start_frame_ext (start_frame_pulse),
-        .soft_reset_ext  (soft_reset_pulse)
+        .soft_reset_ext  (soft_reset_pulse),
+        .frame_tick      (frame_tick)
     );
 
     localparam integer TOTAL_PIXELS = SCREEN_WIDTH * SCREEN_HEIGHT;
@@ -0,0 +1,369 @@
+// ============================================================================
+// voxel_cache.sv
+// - Set-associative read cache for a voxel volume held in external memory.
+//   It has the read ports of voxel_memory_64 (READ_PORTS trace ports and one
+//   payload port, registered, data one clock after the enable), so
+//   voxel_framebuffer_top puts it where geom_mem would be.
+// - SETS x WAYS lines of LINE_WORDS consecutive 64-bit words. Addresses are
+//   RAM word indices (after voxel_addr_map), so what a line holds depends on
+//   the layout: a run along z in xyz order, a 2^k cube in Morton order, part
+//   or all of an 8^3 brick in brick order (LINE_WORDS 512 is one brick).
+// - Each line is held as voxel_memory_64's two planes: a fill beat writes
+//   the 64-bit word to the payload plane and its trace byte to the trace
+//   plane. The trace ports read the 8-bit plane (one copy per port in
+//   synthesis), and only the payload port reads the wide one.
+// - Every port reports a hit for its address each clock, from the tags
+//   alone. A port that requests and misses queues its line in the miss
+//   queue (MISS_DEPTH lines, each at most once) and keeps requesting; the
+//   caller holds off read_en until the hit comes. Ports that miss on the
+//   same line share one fill.
+// - Fills leave the queue in order, one at a time, as AXI INCR bursts of up
+//   to 256 beats on the m_axi read channels (BASE_ADDR + index * 8). The
+//   victim is the first invalid way of the set, else the set's round-robin
+//   way; it is dropped when its fill starts. The write channels are unused.
+// - Writes to the volume (world_gen, debug port) go to the backing memory
+//   elsewhere. Here they drop the line they land in and spoil a fill of that
+//   line already under way; a read of the written word in the same clock
+//   returns the new word, as from voxel_memory_64.
+// - hits counts reads served, misses line fills queued and evictions valid
+//   lines replaced, since the last clear_stats.
+// ============================================================================
+
+`timescale 1ns/1ps
+
+module voxel_cache #(
+    parameter integer READ_PORTS     = 1,
+    parameter integer SETS           = 64,   // power of two, >= 2
+    parameter integer WAYS           = 4,    // 2..8: a lane may wait on two lines at once
+    parameter integer LINE_WORDS     = 8,    // power of two, 2..512
+    parameter integer MISS_DEPTH     = 4,    // power of two, >= 2
+    parameter integer AXI_ADDR_WIDTH = 21,
+    parameter integer AXI_ID_WIDTH   = 4,
+    parameter [AXI_ADDR_WIDTH-1:0] BASE_ADDR = {AXI_ADDR_WIDTH{1'b0}},
+    parameter [AXI_ID_WIDTH-1:0]   AXI_ID    = {AXI_ID_WIDTH{1'b0}}
+)(
+    input  wire                         clk,
+    input  wire                         rst_n,
+
+    // Trace read ports, port p at [p*18 +: 18] / [p*8 +: 8]
+    input  wire [READ_PORTS*18-1:0]     read_addr,
+    input  wire [READ_PORTS-1:0]        read_req,    // wants its word this clock
+    input  wire [READ_PORTS-1:0]        read_en,     // takes it (only on a hit)
+    output wire [READ_PORTS-1:0]        read_hit,
+    output reg  [READ_PORTS*8-1:0]      read_data,
+
+    // Payload read port
+    input  wire [17:0]                  payload_addr,
+    input  wire                         payload_req,
+    input  wire                         payload_en,
+    output wire                         payload_hit,
+    output reg  [63:0]                  payload_data,
+
+    // Writes to the backing volume
+    input  wire [17:0]                  write_addr,
+    input  wire                         write_en,
+    input  wire [63:0]                  write_data,
+
+    // Counters
+    input  wire                         clear_stats,
+    output reg  [31:0]                  hits,
+    output reg  [31:0]                  misses,
+    output reg  [31:0]                  evictions,
+
+    // AXI4 read master (line fills)
+    output wire [AXI_ID_WIDTH-1:0]      m_axi_arid,
+    output reg  [AXI_ADDR_WIDTH-1:0]    m_axi_araddr,
+    output wire [7:0]                   m_axi_arlen,
+    output wire [2:0]                   m_axi_arsize,
+    output wire [1:0]                   m_axi_arburst,
+    output reg                          m_axi_arvalid,
+    input  wire                         m_axi_arready,
+    input  wire [AXI_ID_WIDTH-1:0]      m_axi_rid,
+    input  wire [63:0]                  m_axi_rdata,
+    input  wire [1:0]                   m_axi_rresp,
+    input  wire                         m_axi_rlast,
+    input  wire                         m_axi_rvalid,
+    output wire                         m_axi_rready
+);
+
+    localparam integer OFF_BITS    = $clog2(LINE_WORDS);
+    localparam integer SET_BITS    = $clog2(SETS);
+    localparam integer WAY_BITS    = WAYS > 1 ? $clog2(WAYS) : 1;
+    localparam integer TAG_BITS    = 18 - OFF_BITS - SET_BITS;
+    localparam integer LINE_BITS   = 18 - OFF_BITS;
+    localparam integer SLOTS       = SETS * WAYS * LINE_WORDS;
+    localparam integer SLOT_BITS   = $clog2(SLOTS);
+    localparam integer MQ_BITS     = $clog2(MISS_DEPTH);
+    localparam integer BURST_WORDS = LINE_WORDS > 256 ? 256 : LINE_WORDS;
+    // The payload port is port READ_PORTS in the per-port arrays below.
+    localparam integer PORTS       = READ_PORTS + 1;
+
+    localparam [1:0] F_IDLE = 2'd0;
+    localparam [1:0] F_ADDR = 2'd1;
+    localparam [1:0] F_DATA = 2'd2;
+
+    function automatic [7:0] trace_byte;
+        input [63:0] word;
+        reg solid;
+    begin
+        solid      = word != 64'd0 && word[47:40] > 8'd10;
+        trace_byte = {solid, solid && (word[7:4] == 4'd2 || word[7:4] == 4'd5), 2'b00, word[3:0]};
+    end
+    endfunction
+
+    (* ram_style = "block" *)
+    reg [63:0]         payload   [0:SLOTS-1];
+    (* ram_style = "block" *)
+    reg [7:0]          trace     [0:SLOTS-1];
+    reg [TAG_BITS-1:0] tags      [0:SETS*WAYS-1];
+    reg [WAYS-1:0]     valid     [0:SETS-1];
+    reg [WAY_BITS-1:0] victim_rr [0:SETS-1];
+
+    function automatic [SLOT_BITS-1:0] slot;
+        input [SET_BITS-1:0] s;
+        input [WAY_BITS-1:0] way;
+        input [OFF_BITS-1:0] off;
+    begin
+        slot = (s * WAYS + way) * LINE_WORDS + off;
+    end
+    endfunction
+
+    // --------------------------------------------------------------------
+    // Tag lookups, one per port plus one for the write port (last)
+    // --------------------------------------------------------------------
+    wire [17:0]          port_addr [0:PORTS];
+    wire [PORTS-1:0]     port_req  = {payload_req, read_req};
+    wire [PORTS:0]       port_hit;
+    wire [WAY_BITS-1:0]  port_way  [0:PORTS];
+    wire [SLOT_BITS-1:0] port_slot [0:PORTS];
+
+    genvar port;
+    generate
+        for (port = 0; port < READ_PORTS; port = port + 1) begin : g_port
+            assign port_addr[port] = read_addr[port*18 +: 18];
+        end
+
+        // A block per port, so a port whose address depends on another
+        // port's hit (the lanes' payload arbiter) is no loop.
+        for (port = 0; port <= PORTS; port = port + 1) begin : g_lookup
+            wire [SET_BITS-1:0] s = port_addr[port][OFF_BITS +: SET_BITS];
+            reg                 hit;
+            reg [WAY_BITS-1:0]  way;
+
+            always @* begin : tag_match
+                integer w;
+                hit = 1'b0;
+                way = {WAY_BITS{1'b0}};
+                for (w = WAYS - 1; w >= 0; w = w - 1) begin
+                    if (valid[s][w] && tags[s*WAYS + w] == port_addr[port][17 -: TAG_BITS]) begin
+                        hit = 1'b1;
+                        way = w[WAY_BITS-1:0];
+                    end
+                end
+            end
+
+            assign port_hit[port]  = hit;
+            assign port_way[port]  = way;
+            assign port_slot[port] = slot(s, way, port_addr[port][OFF_BITS-1:0]);
+        end
+    endgenerate
+    assign port_addr[READ_PORTS] = payload_addr;
+    assign port_addr[PORTS]      = write_addr;
+
+    assign read_hit    = port_hit[READ_PORTS-1:0];
+    assign payload_hit = port_hit[READ_PORTS];
+
+    // --------------------------------------------------------------------
+    // Miss queue
+    // --------------------------------------------------------------------
+    reg [LINE_BITS-1:0] mq_line [0:MISS_DEPTH-1];
+    reg [MQ_BITS-1:0]   mq_head;
+    reg [MQ_BITS:0]     mq_count;
+
+    reg [1:0]           fill_state;
+    reg [LINE_BITS-1:0] fill_line;
+    reg [WAY_BITS-1:0]  fill_way;
+    reg [OFF_BITS-1:0]  fill_beat;
+    reg                 fill_spoiled;
+
+    // The first requesting port (lowest index) that misses on a line not
+    // yet queued or filling.
+    reg                 mq_push;
+    reg [LINE_BITS-1:0] mq_push_line;
+
+    always @* begin : miss_pick
+        integer p, e;
+        reg [LINE_BITS-1:0] line;
+        reg pending;
+        mq_push      = 1'b0;
+        mq_push_line = {LINE_BITS{1'b0}};
+        for (p = PORTS - 1; p >= 0; p = p - 1) begin
+            line    = port_addr[p][17:OFF_BITS];
+            pending = fill_state != F_IDLE && fill_line == line;
+            for (e = 0; e < MISS_DEPTH; e = e + 1)
+                if (e < mq_count && mq_line[(mq_head + e) % MISS_DEPTH] == line)
+                    pending = 1'b1;
+            if (port_req[p] && !port_hit[p] && !pending) begin
+                mq_push      = 1'b1;
+                mq_push_line = line;
+            end
+        end
+        if (mq_count == MISS_DEPTH)
+            mq_push = 1'b0;
+    end
+
+    // --------------------------------------------------------------------
+    // Fills
+    // --------------------------------------------------------------------
+    wire [SET_BITS-1:0]  fill_set   = fill_line[SET_BITS-1:0];
+    wire [LINE_BITS-1:0] next_line  = mq_line[mq_head];
+    wire [SET_BITS-1:0]  next_set   = next_line[SET_BITS-1:0];
+    wire                 fill_start = fill_state == F_IDLE && mq_count != 0;
+    wire                 fill_beat_in = fill_state == F_DATA && m_axi_rvalid;
+    wire                 fill_last  = fill_beat_in && m_axi_rlast &&
+                                      fill_beat == LINE_WORDS - 1;
+
+    reg [WAY_BITS-1:0]   victim;
+
+    always @* begin : victim_pick
+        integer w;
+        victim = victim_rr[next_set];
+        for (w = WAYS - 1; w >= 0; w = w - 1)
+            if (!valid[next_set][w])
+                victim = w[WAY_BITS-1:0];
+    end
+
+    // A write to the line being filled spoils it: the burst may already
+    // have read the old word.
+    wire              write_spoil = write_en && fill_state != F_IDLE &&
+                                    write_addr[17:OFF_BITS] == fill_line;
+
+    assign m_axi_arid    = AXI_ID;
+    assign m_axi_arlen   = BURST_WORDS - 1;
+    assign m_axi_arsize  = 3'd3;          // 8 bytes per beat
+    assign m_axi_arburst = 2'b01;         // INCR
+    assign m_axi_rready  = fill_state == F_DATA;
+
+    always @(posedge clk or negedge rst_n) begin : fill_ctl
+        integer s;
+        if (!rst_n) begin
+            mq_head       <= {MQ_BITS{1'b0}};
+            mq_count      <= {(MQ_BITS+1){1'b0}};
+            fill_state    <= F_IDLE;
+            fill_line     <= {LINE_BITS{1'b0}};
+            fill_way      <= {WAY_BITS{1'b0}};
+            fill_beat     <= {OFF_BITS{1'b0}};
+            fill_spoiled  <= 1'b0;
+            m_axi_arvalid <= 1'b0;
+            m_axi_araddr  <= {AXI_ADDR_WIDTH{1'b0}};
+            hits          <= 32'd0;
+            misses        <= 32'd0;
+            evictions     <= 32'd0;
+            for (s = 0; s < SETS; s = s + 1) begin
+                valid[s]     <= {WAYS{1'b0}};
+                victim_rr[s] <= {WAY_BITS{1'b0}};
+            end
+        end else begin
+            if (mq_push)
+                mq_line[(mq_head + mq_count) % MISS_DEPTH] <= mq_push_line;
+            mq_count <= mq_count + (mq_push ? 1 : 0) - (fill_start ? 1 : 0);
+
+            case (fill_state)
+                F_IDLE: begin
+                    if (fill_start) begin
+                        mq_head      <= mq_head + 1'b1;
+                        fill_line    <= next_line;
+                        fill_way     <= victim;
+                        fill_beat    <= {OFF_BITS{1'b0}};
+                        fill_spoiled <= 1'b0;
+                        valid[next_set][victim] <= 1'b0;
+                        if (victim == victim_rr[next_set])
+                            victim_rr[next_set] <= (victim + 1) % WAYS;
+                        m_axi_araddr  <= BASE_ADDR + {next_line, {OFF_BITS{1'b0}}, 3'b000};
+                        m_axi_arvalid <= 1'b1;
+                        fill_state    <= F_ADDR;
+                    end
+                end
+                F_ADDR: begin
+                    if (m_axi_arready) begin
+                        m_axi_arvalid <= 1'b0;
+                        fill_state    <= F_DATA;
+                    end
+                end
+                F_DATA: begin
+                    if (fill_beat_in) begin
+                        fill_beat <= fill_beat + 1'b1;
+                        if (fill_last) begin
+                            if (!fill_spoiled && !write_spoil) begin
+                                tags[fill_set*WAYS + fill_way] <= fill_line[LINE_BITS-1 -: TAG_BITS];
+                                valid[fill_set][fill_way]      <= 1'b1;
+                            end
+                            fill_state <= F_IDLE;
+                        end else if (m_axi_rlast) begin
+                            // Next burst of a line longer than 256 words.
+                            m_axi_araddr  <= m_axi_araddr + BURST_WORDS * 8;
+                            m_axi_arvalid <= 1'b1;
+                            fill_state    <= F_ADDR;
+                        end
+                    end
+                end
+                default: fill_state <= F_IDLE;
+            endcase
+
+            if (write_spoil)
+                fill_spoiled <= 1'b1;
+            if (write_en && port_hit[PORTS])
+                valid[write_addr[OFF_BITS +: SET_BITS]][port_way[PORTS]] <= 1'b0;
+
+            if (clear_stats) begin
+                hits      <= 32'd0;
+                misses    <= 32'd0;
+                evictions <= 32'd0;
+            end else begin
+                hits   <= hits + $countones(read_en) + (payload_en ? 32'd1 : 32'd0);
+                misses <= misses + (mq_push ? 32'd1 : 32'd0);
+                if (fill_start && valid[next_set][victim])
+                    evictions <= evictions + 32'd1;
+            end
+        end
+    end
+
+    // --------------------------------------------------------------------
+    // Data planes: one fill write each and a registered read per port.
+    // --------------------------------------------------------------------
+`ifndef SYNTHESIS
+    initial begin
+        read_data    = {READ_PORTS*8{1'b0}};
+        payload_data = 64'd0;
+    end
+`endif
+
+    wire [SLOT_BITS-1:0] fill_slot   = slot(fill_set, fill_way, fill_beat);
+    wire [7:0]           write_trace = trace_byte(write_data);
+
+    integer rp;
+
+    always @(posedge clk) begin
+        if (fill_beat_in) begin
+            payload[fill_slot] <= m_axi_rdata;
+            trace[fill_slot]   <= trace_byte(m_axi_rdata);
+        end
+
+        for (rp = 0; rp < READ_PORTS; rp = rp + 1) begin
+            if (read_en[rp]) begin
+                if (write_en && write_addr == port_addr[rp])
+                    read_data[rp*8 +: 8] <= write_trace;
+                else
+                    read_data[rp*8 +: 8] <= trace[port_slot[rp]];
+            end
+        end
+
+        if (payload_en) begin
+            if (write_en && write_addr == payload_addr)
+                payload_data <= write_data;
+            else
+                payload_data <= payload[port_slot[READ_PORTS]];
+        end
+    end
+
+endmodule
@@ -0,0 +1,78 @@
+// ============================================================================
+// voxel_fetch_stats.sv
+// - Locality counters for the trace reads of all lanes, independent of the
+//   voxel store behind them. A direct-mapped table of LINES line tags
+//   shadows the reads: a read whose line (LINE_WORDS consecutive RAM words,
+//   after voxel_addr_map) is the one last seen in its entry is a reuse, as
+//   it would be a hit in a direct-mapped cache of that size.
+// - Ports taken the same clock are seen in port order, so two lanes reading
+//   one line count one reuse. The table holds tags only, no data.
+// - reads counts trace reads taken and reuses those whose line was in the
+//   table, since the last clear_stats, which also empties the table.
+// ============================================================================
+
+`timescale 1ns/1ps
+
+module voxel_fetch_stats #(
+    parameter integer READ_PORTS = 1,
+    parameter integer LINES      = 64,   // power of two, >= 2
+    parameter integer LINE_WORDS = 8     // power of two, 2..512
+)(
+    input  wire                     clk,
+    input  wire                     rst_n,
+
+    // Trace read ports as voxel_memory_64 sees them
+    input  wire [READ_PORTS*18-1:0] read_addr,
+    input  wire [READ_PORTS-1:0]    read_en,
+
+    input  wire                     clear_stats,
+    output reg  [31:0]              reads,
+    output reg  [31:0]              reuses
+);
+
+    localparam integer OFF_BITS  = $clog2(LINE_WORDS);
+    localparam integer SET_BITS  = $clog2(LINES);
+    localparam integer LINE_BITS = 18 - OFF_BITS;
+
+    reg [LINE_BITS-1:0] tags  [0:LINES-1];
+    reg [LINES-1:0]     valid;
+
+    always @(posedge clk or negedge rst_n) begin : fetch_count
+        integer p, q;
+        reg [LINE_BITS-1:0] line, prev;
+        reg [SET_BITS-1:0]  s;
+        reg                 seen;
+        reg [31:0]          found;
+        if (!rst_n) begin
+            valid  <= {LINES{1'b0}};
+            reads  <= 32'd0;
+            reuses <= 32'd0;
+        end else if (clear_stats) begin
+            valid  <= {LINES{1'b0}};
+            reads  <= 32'd0;
+            reuses <= 32'd0;
+        end else begin
+            found = 32'd0;
+            for (p = 0; p < READ_PORTS; p = p + 1) begin
+                if (read_en[p]) begin
+                    line = read_addr[p*18 + OFF_BITS +: LINE_BITS];
+                    s    = line[SET_BITS-1:0];
+                    // The entry as the earlier ports of this clock left it.
+                    seen = valid[s] && tags[s] == line;
+                    for (q = 0; q < p; q = q + 1) begin
+                        prev = read_addr[q*18 + OFF_BITS +: LINE_BITS];
+                        if (read_en[q] && prev[SET_BITS-1:0] == s)
+                            seen = prev == line;
+                    end
+                    if (seen)
+                        found = found + 32'd1;
+                    tags[s]  <= line;
+                    valid[s] <= 1'b1;
+                end
+            end
+            reads  <= reads + $countones(read_en);
+            reuses <= reuses + found;
+        end
+    end
+
+endmodule
@@ -2,6 +2,10 @@
 // voxel_framebuffer_top.sv
 // - Top-level integration for Verilator + SDL demo.
 // - Builds world, then runs raycaster frame loop.
+// - NUM_LANES raycaster cores render interleaved scanlines against one voxel
+//   store (see "Lanes" below); 1 is the single core, wired straight through.
+// - The voxel store is on-chip geom_mem, or with VOXEL_CACHE an AXI memory
+//   read through voxel_cache (see "Voxel store" below).
 // ============================================================================
 
 `timescale 1ns/1ps
@@ -15,7 +19,15 @@ module voxel_framebuffer_top #(
     // Test-only: force world_ready to 1 after reset for benches
     parameter TEST_FORCE_WORLD_READY = 0,
     // Allow benches to disable auto-run and require host start pulses.
-    parameter AUTO_START_FRAMES = 1
+    parameter AUTO_START_FRAMES = 1,
+    // Raycaster lanes; lane k renders rows k, k + NUM_LANES, ...
+    parameter NUM_LANES = 1,
+    // Volume in external memory behind a voxel_cache of CACHE_SETS x
+    // CACHE_WAYS lines of CACHE_LINE_WORDS words
+    parameter VOXEL_CACHE      = 0,
+    parameter CACHE_SETS       = 64,
+    parameter CACHE_WAYS       = 4,
+    parameter CACHE_LINE_WORDS = 8
 )(
     input  wire         clk,
     input  wire         rst_n,
@@ -31,6 +43,31 @@ module voxel_framebuffer_top #(
     output wire         frame_done,
     output wire         core_busy,
 
+    // Render-on-demand status (see frame control below)
+    output wire         scene_dirty_out,
+    output wire [31:0]  skipped_frames,
+
+    // Empty bricks the last frame's rays skipped (render_config[5])
+    output wire [31:0]  skipped_bricks,
+
+    // Length of the last frame, total and per pixel (Q24.8)
+    output wire [31:0]  frame_cycles_out,
+    output wire [31:0]  cycles_per_pixel,
+
+    // Voxel cache activity over the last frame (0 without VOXEL_CACHE)
+    output wire [31:0]  cache_hits,
+    output wire [31:0]  cache_misses,
+    output wire [31:0]  cache_evictions,
+
+    // Trace reads of the last frame and how many reused a recent line
+    // (voxel_fetch_stats, any voxel store)
+    output wire [31:0]  fetch_reads,
+    output wire [31:0]  fetch_reuses,
+
+    // Voxels early ray termination left unread in the last frame
+    // (render_config[10])
+    output wire [31:0]  ets_saved,
+
     // Optional external control (AXI-Lite shell / host)
     input  wire         cam_load,
     input  wire signed [15:0] cam_x_in,
@@ -47,6 +84,16 @@ module voxel_framebuffer_top #(
     input  wire         flag_curvature_in,
     input  wire         flag_extra_light_in,
     input  wire         flag_diag_slice_in,
+    input  wire         flag_on_demand_in,
+    input  wire         flag_dda_in,
+    input  wire         flag_perspective_in,
+    input  wire         flag_memo_in,
+    input  wire         flag_skip_empty_in,
+    input  wire         flag_sdf_in,
+    input  wire         flag_pipeline_in,
+    input  wire [1:0]   flag_tile_order_in,
+    input  wire         flag_composite_in,
+    input  wire [7:0]   alpha_threshold_in,   // taken with flags_load
 
     input  wire         sel_load,
     input  wire         sel_active_in,
@@ -59,7 +106,11 @@ module voxel_framebuffer_top #(
     input  wire [63:0]  dbg_ext_write_data,
 
     input  wire         start_frame_ext,
-    input  wire         soft_reset_ext
+    input  wire         soft_reset_ext,
+
+    // One pulse per display refresh (the scan-out's vsync); SKIPPED_FRAMES
+    // counts the ones render-on-demand let pass without a frame.
+    input  wire         frame_tick
 );
 
     // Camera registers (host-writeable)
@@ -77,6 +128,16 @@ module voxel_framebuffer_top #(
     reg cfg_curvature;
     reg cfg_extra_light;
     reg cfg_diag_slice;
+    reg cfg_render_on_demand;
+    reg cfg_dda;
+    reg cfg_perspective;
+    reg cfg_memo;
+    reg cfg_skip_empty;
+    reg cfg_sdf;
+    reg cfg_pipeline;
+    reg [1:0] cfg_tile_order;
+    reg cfg_composite;
+    reg [7:0] cfg_alpha_threshold;
 
     // Selection controls
     reg       sel_active;
@@ -96,10 +157,26 @@ module voxel_framebuffer_top #(
     wire        world_wen;
     wire [63:0] world_wdata;
 
-    // Memory <-> core
-    wire [17:0] geom_addr;
-    wire        geom_rd_en;
-    wire [63:0] geom_data;
+    // Memory <-> lanes: a trace byte per step on each lane's own port
+    // (lane k at [k*18 +: 18] / [k*8 +: 8]), a payload word per hit from
+    // the one shared port
+    wire [NUM_LANES*18-1:0] geom_addr;
+    wire [NUM_LANES-1:0]    geom_rd_en;
+    wire [NUM_LANES*8-1:0]  geom_trace;
+    wire [17:0] geom_payload_addr;
+    wire        geom_payload_en;
+    wire [63:0] geom_payload;
+    // Whether each port's word is ready this clock (always, on chip), and
+    // whether the payload port has a request (geom_payload_en is the read
+    // actually taken)
+    wire [NUM_LANES-1:0] geom_rd_hit;
+    wire        geom_payload_hit;
+    wire        geom_payload_req;
+    wire [31:0] cache_hit_count;
+    wire [31:0] cache_miss_count;
+    wire [31:0] cache_evict_count;
+    wire [31:0] fetch_read_count;
+    wire [31:0] fetch_reuse_count;
 
     // Core control
     reg         start;
@@ -113,7 +190,39 @@ module voxel_framebuffer_top #(
     wire [5:0]  cursor_voxel_z;
     wire [7:0]  cursor_material_id;
     wire [63:0] cursor_voxel_data;
-    wire [31:0] core_dbg_hit_count;
+    reg  [31:0] core_dbg_hit_count;
+    reg  [31:0] core_dbg_skip_count;
+    reg  [31:0] core_dbg_ets_count;
+    wire [NUM_LANES*9-1:0] brick_addr;
+    wire [NUM_LANES-1:0]   brick_occupied;
+
+    // Per-lane core ports
+    wire [NUM_LANES-1:0] lane_start;
+    wire [NUM_LANES-1:0] lane_stall;
+    wire [NUM_LANES-1:0] lane_busy;
+    wire [NUM_LANES-1:0] lane_done;
+    wire [NUM_LANES-1:0] lane_pixel_en;
+    wire [31:0]          lane_pixel_addr  [0:NUM_LANES-1];
+    wire [31:0]          lane_pixel_word0 [0:NUM_LANES-1];
+    wire [31:0]          lane_pixel_word1 [0:NUM_LANES-1];
+    wire [31:0]          lane_pixel_word2 [0:NUM_LANES-1];
+    wire [17:0]          lane_payload_addr [0:NUM_LANES-1];
+    wire [NUM_LANES-1:0] lane_payload_en;
+    wire [63:0]          lane_payload     [0:NUM_LANES-1];
+    wire [NUM_LANES-1:0] lane_cursor_hit_valid;
+    wire [5:0]           lane_cursor_x    [0:NUM_LANES-1];
+    wire [5:0]           lane_cursor_y    [0:NUM_LANES-1];
+    wire [5:0]           lane_cursor_z    [0:NUM_LANES-1];
+    wire [7:0]           lane_cursor_material [0:NUM_LANES-1];
+    wire [63:0]          lane_cursor_data [0:NUM_LANES-1];
+    wire [31:0]          lane_hit_count   [0:NUM_LANES-1];
+    wire [31:0]          lane_skip_count  [0:NUM_LANES-1];
+    wire [31:0]          lane_ets_count   [0:NUM_LANES-1];
+    // Why a stalled lane is waiting: the payload port went to another lane,
+    // its pixel hold is still full, or its word is not in the voxel cache.
+    wire [NUM_LANES-1:0] lane_payload_stall;
+    wire [NUM_LANES-1:0] lane_pixel_stall;
+    wire [NUM_LANES-1:0] lane_miss_stall;
 
     // Expose cursor/regs to Verilator (they are regs/wires in this scope)
     // (No extra ports needed; Verilator can access internal regs/wires.)
@@ -133,6 +242,12 @@ module voxel_framebuffer_top #(
         cfg_curvature       <= 1'b1;
         cfg_extra_light     <= 1'b0;
         cfg_diag_slice      <= 1'b0;
+        cfg_render_on_demand <= 1'b0;
+        cfg_dda             <= 1'b0;
+        cfg_perspective     <= 1'b0;
+        cfg_memo            <= 1'b0;
+        cfg_skip_empty      <= 1'b0;
+        cfg_sdf             <= 1'b0;
 
         sel_active   <= 1'b0;
         sel_voxel_x  <= 6'd0;
@@ -170,79 +285,661 @@ module voxel_framebuffer_top #(
     wire        mem_write_en   = dbg_write_en_mux | world_wen;
     wire [63:0] mem_write_data = dbg_write_en_mux ? dbg_write_data_mux : world_wdata;
 
-    voxel_memory_64 geom_mem (
-        .clk        (clk),
-        .read_addr  (geom_addr),
-        .read_en    (geom_rd_en),
-        .read_data  (geom_data),
-        .write_addr (mem_write_addr),
-        .write_en   (mem_write_en),
-        .write_data (mem_write_data)
+    // The core, world_gen and the debug port all address voxels as
+    // {x,y,z}; only geom_mem sees the RAM layout (HYDRA_VOXEL_LAYOUT).
+    wire [NUM_LANES*18-1:0] geom_read_index;
+    wire [17:0] geom_payload_index;
+    wire [17:0] geom_write_index;
+
+    // A stalled lane's trace read waits with the rest of the lane.
+    wire [NUM_LANES-1:0] geom_rd_fire = geom_rd_en & ~lane_stall;
+
+    voxel_addr_map payload_map (
+        .xyz   (geom_payload_addr),
+        .index (geom_payload_index)
     );
 
-    // Core config word
-    wire [31:0] render_config = {30'd0, cfg_diag_slice, cfg_extra_light};
-
-    voxel_raycaster_core_pipelined #(
-        .SCREEN_WIDTH    (SCREEN_WIDTH),
-        .SCREEN_HEIGHT   (SCREEN_HEIGHT),
-        .VOXEL_GRID_SIZE (VOXEL_GRID_SIZE),
-        .COORD_WIDTH     (COORD_WIDTH),
-        .FRAC_BITS       (FRAC_BITS)
-    ) core (
-        .clk                (clk),
-        .rst_n              (rst_n),
-        .start              (start),
-
-        .cam_x              (cam_x),
-        .cam_y              (cam_y),
-        .cam_z              (cam_z),
-        .cam_dir_x          (cam_dir_x),
-        .cam_dir_y          (cam_dir_y),
-        .cam_dir_z          (cam_dir_z),
-        .cam_plane_x        (cam_plane_x),
-        .cam_plane_y        (cam_plane_y),
-
-        .render_config      (render_config),
-        .enable_smooth_surfaces(cfg_smooth_surfaces),
-        .enable_curvature   (cfg_curvature),
-
-        .sel_active         (sel_active),
-        .sel_voxel_x        (sel_voxel_x),
-        .sel_voxel_y        (sel_voxel_y),
-        .sel_voxel_z        (sel_voxel_z),
-
-        .voxel_addr         (geom_addr),
-        .voxel_data         (geom_data),
-        .voxel_read_en      (geom_rd_en),
-
-        .pixel_word0        (pixel_word0),
-        .pixel_word1        (pixel_word1),
-        .pixel_word2        (pixel_word2),
-        .pixel_addr         (pixel_addr),
-        .pixel_write_en     (pixel_write_en),
-
-        .busy               (busy),
-        .done               (done),
-
-        .cursor_hit_valid   (cursor_hit_valid),
-        .cursor_voxel_x     (cursor_voxel_x),
-        .cursor_voxel_y     (cursor_voxel_y),
-        .cursor_voxel_z     (cursor_voxel_z),
-        .cursor_material_id (cursor_material_id),
-        .cursor_voxel_data  (cursor_voxel_data),
-        .dbg_hit_count      (core_dbg_hit_count)
+    voxel_addr_map write_map (
+        .xyz   (mem_write_addr),
+        .index (geom_write_index)
     );
 
+    // --------------------------------------------------------------------
+    // Voxel store. By default geom_mem holds the volume on chip and every
+    // read is ready the next clock. With VOXEL_CACHE the volume lives in
+    // vram, an axi_sdram_stub standing in for DDR (word index * 8), and
+    // voxel_cache serves the same ports from its lines, filling misses with
+    // bursts through xbar. A lane whose word is not cached stalls until the
+    // line arrives. world_gen and debug writes reach vram through its debug
+    // port, as a host upload would, and drop the cached line.
+    // --------------------------------------------------------------------
+    generate
+        if (VOXEL_CACHE == 0) begin : g_bram
+            voxel_memory_64 #(
+                .READ_PORTS   (NUM_LANES)
+            ) geom_mem (
+                .clk          (clk),
+                .read_addr    (geom_read_index),
+                .read_en      (geom_rd_fire),
+                .read_data    (geom_trace),
+                .payload_addr (geom_payload_index),
+                .payload_en   (geom_payload_en),
+                .payload_data (geom_payload),
+                .write_addr   (geom_write_index),
+                .write_en     (mem_write_en),
+                .write_data   (mem_write_data)
+            );
+
+            assign geom_rd_hit       = {NUM_LANES{1'b1}};
+            assign geom_payload_hit  = 1'b1;
+            assign cache_hit_count   = 32'd0;
+            assign cache_miss_count  = 32'd0;
+            assign cache_evict_count = 32'd0;
+        end else begin : g_cached
+            localparam integer VRAM_ADDR_WIDTH = 21;   // 2^18 words of 8 bytes
+
+            // Fill master (cache) and the SDRAM slave; the crossbar's
+            // second master and BRAM slave are unused.
+            wire [3:0]                 c_arid,    v_arid;
+            wire [VRAM_ADDR_WIDTH-1:0] c_araddr,  v_araddr;
+            wire [7:0]                 c_arlen,   v_arlen;
+            wire [2:0]                 c_arsize,  v_arsize;
+            wire [1:0]                 c_arburst, v_arburst;
+            wire                       c_arvalid, v_arvalid;
+            wire                       c_arready, v_arready;
+            wire [3:0]                 c_rid,     v_rid;
+            wire [63:0]                c_rdata,   v_rdata;
+            wire [1:0]                 c_rresp,   v_rresp;
+            wire                       c_rlast,   v_rlast;
+            wire                       c_rvalid,  v_rvalid;
+            wire                       c_rready,  v_rready;
+            wire [3:0]                 v_awid;
+            wire [VRAM_ADDR_WIDTH-1:0] v_awaddr;
+            wire [7:0]                 v_awlen;
+            wire [2:0]                 v_awsize;
+            wire [1:0]                 v_awburst;
+            wire                       v_awvalid, v_awready;
+            wire [63:0]                v_wdata;
+            wire [7:0]                 v_wstrb;
+            wire                       v_wlast, v_wvalid, v_wready;
+            wire [3:0]                 v_bid;
+            wire [1:0]                 v_bresp;
+            wire                       v_bvalid, v_bready;
+            wire [63:0]                vram_dbg_rdata;
+
+            voxel_cache #(
+                .READ_PORTS     (NUM_LANES),
+                .SETS           (CACHE_SETS),
+                .WAYS           (CACHE_WAYS),
+                .LINE_WORDS     (CACHE_LINE_WORDS),
+                .AXI_ADDR_WIDTH (VRAM_ADDR_WIDTH)
+            ) cache (
+                .clk           (clk),
+                .rst_n         (rst_n),
+                .read_addr     (geom_read_index),
+                .read_req      (geom_rd_en),
+                .read_en       (geom_rd_fire),
+                .read_hit      (geom_rd_hit),
+                .read_data     (geom_trace),
+                .payload_addr  (geom_payload_index),
+                .payload_req   (geom_payload_req),
+                .payload_en    (geom_payload_en),
+                .payload_hit   (geom_payload_hit),
+                .payload_data  (geom_payload),
+                .write_addr    (geom_write_index),
+                .write_en      (mem_write_en),
+                .write_data    (mem_write_data),
+                .clear_stats   (start && !busy),
+                .hits          (cache_hit_count),
+                .misses        (cache_miss_count),
+                .evictions     (cache_evict_count),
+                .m_axi_arid    (c_arid),
+                .m_axi_araddr  (c_araddr),
+                .m_axi_arlen   (c_arlen),
+                .m_axi_arsize  (c_arsize),
+                .m_axi_arburst (c_arburst),
+                .m_axi_arvalid (c_arvalid),
+                .m_axi_arready (c_arready),
+                .m_axi_rid     (c_rid),
+                .m_axi_rdata   (c_rdata),
+                .m_axi_rresp   (c_rresp),
+                .m_axi_rlast   (c_rlast),
+                .m_axi_rvalid  (c_rvalid),
+                .m_axi_rready  (c_rready)
+            );
+
+            // No BRAM window here: every address decodes to s1.
+            axi_crossbar_stub #(
+                .ADDR_WIDTH (VRAM_ADDR_WIDTH),
+                .S0_BASE    (21'h000001),
+                .S0_MASK    (21'h000000)
+            ) xbar (
+                .clk        (clk),
+                .rst_n      (rst_n),
+
+                .m0_awid    (4'd0),
+                .m0_awaddr  ({VRAM_ADDR_WIDTH{1'b0}}),
+                .m0_awlen   (8'd0),
+                .m0_awsize  (3'd0),
+                .m0_awburst (2'd0),
+                .m0_awvalid (1'b0),
+                .m0_awready (),
+                .m0_wdata   (64'd0),
+                .m0_wstrb   (8'd0),
+                .m0_wlast   (1'b0),
+                .m0_wvalid  (1'b0),
+                .m0_wready  (),
+                .m0_bid     (),
+                .m0_bresp   (),
+                .m0_bvalid  (),
+                .m0_bready  (1'b1),
+                .m0_arid    (c_arid),
+                .m0_araddr  (c_araddr),
+                .m0_arlen   (c_arlen),
+                .m0_arsize  (c_arsize),
+                .m0_arburst (c_arburst),
+                .m0_arvalid (c_arvalid),
+                .m0_arready (c_arready),
+                .m0_rid     (c_rid),
+                .m0_rdata   (c_rdata),
+                .m0_rresp   (c_rresp),
+                .m0_rlast   (c_rlast),
+                .m0_rvalid  (c_rvalid),
+                .m0_rready  (c_rready),
+
+                .m1_awid    (4'd0),
+                .m1_awaddr  ({VRAM_ADDR_WIDTH{1'b0}}),
+                .m1_awlen   (8'd0),
+                .m1_awsize  (3'd0),
+                .m1_awburst (2'd0),
+                .m1_awvalid (1'b0),
+                .m1_awready (),
+                .m1_wdata   (64'd0),
+                .m1_wstrb   (8'd0),
+                .m1_wlast   (1'b0),
+                .m1_wvalid  (1'b0),
+                .m1_wready  (),
+                .m1_bid     (),
+                .m1_bresp   (),
+                .m1_bvalid  (),
+                .m1_bready  (1'b1),
+                .m1_arid    (4'd0),
+                .m1_araddr  ({VRAM_ADDR_WIDTH{1'b0}}),
+                .m1_arlen   (8'd0),
+                .m1_arsize  (3'd0),
+                .m1_arburst (2'd0),
+                .m1_arvalid (1'b0),
+                .m1_arready (),
+                .m1_rid     (),
+                .m1_rdata   (),
+                .m1_rresp   (),
+                .m1_rlast   (),
+                .m1_rvalid  (),
+                .m1_rready  (1'b1),
+
+                .s0_awid    (),
+                .s0_awaddr  (),
+                .s0_awlen   (),
+                .s0_awsize  (),
+                .s0_awburst (),
+                .s0_awvalid (),
+                .s0_awready (1'b0),
+                .s0_wdata   (),
+                .s0_wstrb   (),
+                .s0_wlast   (),
+                .s0_wvalid  (),
+                .s0_wready  (1'b0),
+                .s0_bid     (4'd0),
+                .s0_bresp   (2'd0),
+                .s0_bvalid  (1'b0),
+                .s0_bready  (),
+                .s0_arid    (),
+                .s0_araddr  (),
+                .s0_arlen   (),
+                .s0_arsize  (),
+                .s0_arburst (),
+                .s0_arvalid (),
+                .s0_arready (1'b0),
+                .s0_rid     (4'd0),
+                .s0_rdata   (64'd0),
+                .s0_rresp   (2'd0),
+                .s0_rlast   (1'b0),
+                .s0_rvalid  (1'b0),
+                .s0_rready  (),
+
+                .s1_awid    (v_awid),
+                .s1_awaddr  (v_awaddr),
+                .s1_awlen   (v_awlen),
+                .s1_awsize  (v_awsize),
+                .s1_awburst (v_awburst),
+                .s1_awvalid (v_awvalid),
+                .s1_awready (v_awready),
+                .s1_wdata   (v_wdata),
+                .s1_wstrb   (v_wstrb),
+                .s1_wlast   (v_wlast),
+                .s1_wvalid  (v_wvalid),
+                .s1_wready  (v_wready),
+                .s1_bid     (v_bid),
+                .s1_bresp   (v_bresp),
+                .s1_bvalid  (v_bvalid),
+                .s1_bready  (v_bready),
+                .s1_arid    (v_arid),
+                .s1_araddr  (v_araddr),
+                .s1_arlen   (v_arlen),
+                .s1_arsize  (v_arsize),
+                .s1_arburst (v_arburst),
+                .s1_arvalid (v_arvalid),
+                .s1_arready (v_arready),
+                .s1_rid     (v_rid),
+                .s1_rdata   (v_rdata),
+                .s1_rresp   (v_rresp),
+                .s1_rlast   (v_rlast),
+                .s1_rvalid  (v_rvalid),
+                .s1_rready  (v_rready)
+            );
+
+            axi_sdram_stub #(
+                .ADDR_WIDTH (VRAM_ADDR_WIDTH),
+                .MEM_WORDS  (1 << 18)
+            ) vram (
+                .clk           (clk),
+                .rst_n         (rst_n),
+                .s_axi_awid    (v_awid),
+                .s_axi_awaddr  (v_awaddr),
+                .s_axi_awlen   (v_awlen),
+                .s_axi_awsize  (v_awsize),
+                .s_axi_awburst (v_awburst),
+                .s_axi_awvalid (v_awvalid),
+                .s_axi_awready (v_awready),
+                .s_axi_wdata   (v_wdata),
+                .s_axi_wstrb   (v_wstrb),
+                .s_axi_wlast   (v_wlast),
+                .s_axi_wvalid  (v_wvalid),
+                .s_axi_wready  (v_wready),
+                .s_axi_bid     (v_bid),
+                .s_axi_bresp   (v_bresp),
+                .s_axi_bvalid  (v_bvalid),
+                .s_axi_bready  (v_bready),
+                .s_axi_arid    (v_arid),
+                .s_axi_araddr  (v_araddr),
+                .s_axi_arlen   (v_arlen),
+                .s_axi_arsize  (v_arsize),
+                .s_axi_arburst (v_arburst),
+                .s_axi_arvalid (v_arvalid),
+                .s_axi_arready (v_arready),
+                .s_axi_rid     (v_rid),
+                .s_axi_rdata   (v_rdata),
+                .s_axi_rresp   (v_rresp),
+                .s_axi_rlast   (v_rlast),
+                .s_axi_rvalid  (v_rvalid),
+                .s_axi_rready  (v_rready),
+                .dbg_we        (mem_write_en),
+                .dbg_addr      ({geom_write_index, 3'b000}),
+                .dbg_wdata     (mem_write_data),
+                .dbg_re        (1'b0),
+                .dbg_rdata     (vram_dbg_rdata)
+            );
+        end
+    endgenerate
+
+    // Fetch locality of the pixel order (render_config[9:8]) and layout:
+    // trace reads against a direct-mapped tag table as large as the cache,
+    // whichever store serves them.
+    voxel_fetch_stats #(
+        .READ_PORTS  (NUM_LANES),
+        .LINES       (CACHE_SETS * CACHE_WAYS),
+        .LINE_WORDS  (CACHE_LINE_WORDS)
+    ) fetch_stats (
+        .clk         (clk),
+        .rst_n       (rst_n),
+        .read_addr   (geom_read_index),
+        .read_en     (geom_rd_fire),
+        .clear_stats (start && !busy),
+        .reads       (fetch_read_count),
+        .reuses      (fetch_reuse_count)
+    );
+
+    // Brick occupancy, kept in step with every write to the volume.
+    voxel_occupancy #(
+        .LOOKUP_PORTS   (NUM_LANES)
+    ) occ (
+        .clk            (clk),
+        .write_addr     (mem_write_addr),
+        .write_en       (mem_write_en),
+        .write_data     (mem_write_data),
+        .brick_addr     (brick_addr),
+        .brick_occupied (brick_occupied)
+    );
+
+    // Core config word
+    wire [31:0] render_config = {8'd0, cfg_alpha_threshold, 5'd0, cfg_composite,
+                                 cfg_tile_order, cfg_pipeline, cfg_sdf, cfg_skip_empty,
+                                 cfg_memo, cfg_perspective, cfg_dda, cfg_diag_slice,
+                                 cfg_extra_light};
+
+    // --------------------------------------------------------------------
+    // Lanes. Each lane is one raycaster core rendering every NUM_LANES-th
+    // row, with its own trace read port (geom_mem keeps a copy of the trace
+    // plane per port) and brick lookup, so traversal never waits on another
+    // lane. The payload port is shared: a round-robin arbiter grants one
+    // address per clock, and every lane asking for that same address is
+    // served by the same read. Pixels go through a one-entry hold per lane
+    // and leave on the pixel port one per clock, round robin, so
+    // pixel_write_en/pixel_addr/pixel_word* behave as for a single core
+    // (each pixel once, any order between rows). A lane whose payload read
+    // is not granted, or whose pixel finds its hold full, stalls whole for
+    // that clock and retries; a stalled lane makes no memory access, so it
+    // renders exactly what it would alone. The frame is done once every
+    // lane is done and the holds are empty.
+    // --------------------------------------------------------------------
+    genvar lane;
+    generate
+        for (lane = 0; lane < NUM_LANES; lane = lane + 1) begin : g_lane
+            voxel_addr_map read_map (
+                .xyz   (geom_addr[lane*18 +: 18]),
+                .index (geom_read_index[lane*18 +: 18])
+            );
+
+            voxel_raycaster_core_pipelined #(
+                .SCREEN_WIDTH    (SCREEN_WIDTH),
+                .SCREEN_HEIGHT   (SCREEN_HEIGHT),
+                .VOXEL_GRID_SIZE (VOXEL_GRID_SIZE),
+                .COORD_WIDTH     (COORD_WIDTH),
+                .FRAC_BITS       (FRAC_BITS),
+                .LANE            (lane),
+                .NUM_LANES       (NUM_LANES)
+            ) core (
+                .clk                (clk),
+                .rst_n              (rst_n),
+                .start              (lane_start[lane]),
+                .stall              (lane_stall[lane]),
+
+                .cam_x              (cam_x),
+                .cam_y              (cam_y),
+                .cam_z              (cam_z),
+                .cam_dir_x          (cam_dir_x),
+                .cam_dir_y          (cam_dir_y),
+                .cam_dir_z          (cam_dir_z),
+                .cam_plane_x        (cam_plane_x),
+                .cam_plane_y        (cam_plane_y),
+
+                .render_config      (render_config),
+                .enable_smooth_surfaces(cfg_smooth_surfaces),
+                .enable_curvature   (cfg_curvature),
+
+                .sel_active         (sel_active),
+                .sel_voxel_x        (sel_voxel_x),
+                .sel_voxel_y        (sel_voxel_y),
+                .sel_voxel_z        (sel_voxel_z),
+
+                .voxel_addr         (geom_addr[lane*18 +: 18]),
+                .voxel_trace        (geom_trace[lane*8 +: 8]),
+                .voxel_read_en      (geom_rd_en[lane]),
+                .payload_addr       (lane_payload_addr[lane]),
+                .payload_read_en    (lane_payload_en[lane]),
+                .payload_data       (lane_payload[lane]),
+
+                .pixel_word0        (lane_pixel_word0[lane]),
+                .pixel_word1        (lane_pixel_word1[lane]),
+                .pixel_word2        (lane_pixel_word2[lane]),
+                .pixel_addr         (lane_pixel_addr[lane]),
+                .pixel_write_en     (lane_pixel_en[lane]),
+
+                .busy               (lane_busy[lane]),
+                .done               (lane_done[lane]),
+
+                .cursor_hit_valid   (lane_cursor_hit_valid[lane]),
+                .cursor_voxel_x     (lane_cursor_x[lane]),
+                .cursor_voxel_y     (lane_cursor_y[lane]),
+                .cursor_voxel_z     (lane_cursor_z[lane]),
+                .cursor_material_id (lane_cursor_material[lane]),
+                .cursor_voxel_data  (lane_cursor_data[lane]),
+                .dbg_hit_count      (lane_hit_count[lane]),
+
+                .brick_addr         (brick_addr[lane*9 +: 9]),
+                .brick_occupied     (brick_occupied[lane]),
+                .dbg_skip_count     (lane_skip_count[lane]),
+                .dbg_ets_count      (lane_ets_count[lane])
+            );
+        end
+
+        if (NUM_LANES == 1) begin : g_single
+            assign lane_start         = start;
+            assign lane_miss_stall    = (geom_rd_en & ~geom_rd_hit) |
+                                        (lane_payload_en & ~geom_payload_hit);
+            assign lane_stall         = lane_miss_stall;
+            assign lane_payload_stall = 1'b0;
+            assign lane_pixel_stall   = 1'b0;
+            assign geom_payload_addr  = lane_payload_addr[0];
+            assign geom_payload_req   = lane_payload_en[0];
+            assign geom_payload_en    = lane_payload_en[0] & ~lane_stall[0];
+            assign lane_payload[0]    = geom_payload;
+            assign pixel_write_en     = lane_pixel_en[0];
+            assign pixel_addr         = lane_pixel_addr[0];
+            assign pixel_word0        = lane_pixel_word0[0];
+            assign pixel_word1        = lane_pixel_word1[0];
+            assign pixel_word2        = lane_pixel_word2[0];
+            assign busy               = lane_busy[0];
+            assign done               = lane_done[0];
+        end else begin : g_array
+            localparam integer LANE_BITS = $clog2(NUM_LANES);
+
+            reg [LANE_BITS-1:0] pay_rr;        // first lane in payload priority
+            reg [LANE_BITS-1:0] pix_rr;        // first hold in pixel-port priority
+            reg [NUM_LANES-1:0] pay_fresh;     // granted last clock: word is on the port
+            reg [63:0]          pay_hold  [0:NUM_LANES-1];
+            reg [NUM_LANES-1:0] hold_valid;
+            reg [31:0]          hold_addr  [0:NUM_LANES-1];
+            reg [31:0]          hold_word0 [0:NUM_LANES-1];
+            reg [31:0]          hold_word1 [0:NUM_LANES-1];
+            reg [31:0]          hold_word2 [0:NUM_LANES-1];
+            reg [NUM_LANES-1:0] lane_finished;
+            reg                 frame_active;
+            reg                 frame_done_r;
+
+            reg                 pix_any, pay_any;
+            reg [LANE_BITS-1:0] pix_pick, pay_pick;
+            reg [NUM_LANES-1:0] pix_ok, pay_grant;
+            reg [NUM_LANES-1:0] trace_miss, pay_ok;
+
+            always @* begin : lane_arbiter
+                integer k;
+                reg [LANE_BITS-1:0] idx;
+                // Pixel port: first full hold from pix_rr.
+                pix_any  = 1'b0;
+                pix_pick = pix_rr;
+                for (k = NUM_LANES-1; k >= 0; k = k - 1) begin
+                    idx = (pix_rr + k) % NUM_LANES;
+                    if (hold_valid[idx]) begin
+                        pix_any  = 1'b1;
+                        pix_pick = idx;
+                    end
+                end
+                // A lane can hand over its pixel if its hold is free or
+                // drains this clock. Only lanes that can run ask for the
+                // payload port, so a grant is never wasted on a stall.
+                for (k = 0; k < NUM_LANES; k = k + 1) begin
+                    pix_ok[k]     = !lane_pixel_en[k] || !hold_valid[k] ||
+                                    (pix_any && pix_pick == k);
+                    trace_miss[k] = geom_rd_en[k] && !geom_rd_hit[k];
+                end
+                pay_ok   = pix_ok & ~trace_miss;
+                pay_any  = 1'b0;
+                pay_pick = pay_rr;
+                for (k = NUM_LANES-1; k >= 0; k = k - 1) begin
+                    idx = (pay_rr + k) % NUM_LANES;
+                    if (lane_payload_en[idx] && pay_ok[idx]) begin
+                        pay_any  = 1'b1;
+                        pay_pick = idx;
+                    end
+                end
+                for (k = 0; k < NUM_LANES; k = k + 1)
+                    pay_grant[k] = pay_any && lane_payload_en[k] && pay_ok[k] &&
+                                   lane_payload_addr[k] == lane_payload_addr[pay_pick];
+            end
+
+            // A granted payload read is only taken once its word is cached.
+            wire [NUM_LANES-1:0] pay_take = pay_grant & {NUM_LANES{geom_payload_hit}};
+
+            assign lane_start         = {NUM_LANES{start && !frame_active}};
+            assign lane_pixel_stall   = ~pix_ok;
+            assign lane_miss_stall    = pix_ok & (trace_miss | (pay_grant & ~pay_take));
+            assign lane_payload_stall = pay_ok & lane_payload_en & ~pay_grant;
+            assign lane_stall         = lane_pixel_stall | lane_miss_stall | lane_payload_stall;
+            assign geom_payload_addr  = lane_payload_addr[pay_pick];
+            assign geom_payload_req   = pay_any;
+            assign geom_payload_en    = pay_any & geom_payload_hit;
+            assign pixel_write_en     = pix_any;
+            assign pixel_addr         = hold_addr[pix_pick];
+            assign pixel_word0        = hold_word0[pix_pick];
+            assign pixel_word1        = hold_word1[pix_pick];
+            assign pixel_word2        = hold_word2[pix_pick];
+            assign busy               = frame_active;
+            assign done               = frame_done_r;
+
+            genvar view;
+            for (view = 0; view < NUM_LANES; view = view + 1) begin : g_view
+                // The shared port holds the last lane's word; each lane sees
+                // its own last word, as from a port of its own.
+                assign lane_payload[view] = pay_fresh[view] ? geom_payload : pay_hold[view];
+            end
+
+            always @(posedge clk or negedge rst_n) begin : lane_merge
+                integer k;
+                if (!rst_n) begin
+                    pay_rr        <= {LANE_BITS{1'b0}};
+                    pix_rr        <= {LANE_BITS{1'b0}};
+                    pay_fresh     <= {NUM_LANES{1'b0}};
+                    hold_valid    <= {NUM_LANES{1'b0}};
+                    lane_finished <= {NUM_LANES{1'b0}};
+                    frame_active  <= 1'b0;
+                    frame_done_r  <= 1'b0;
+                    for (k = 0; k < NUM_LANES; k = k + 1)
+                        pay_hold[k] <= 64'd0;
+                end else begin
+                    pay_fresh    <= pay_take;
+                    frame_done_r <= 1'b0;
+                    for (k = 0; k < NUM_LANES; k = k + 1)
+                        if (pay_fresh[k])
+                            pay_hold[k] <= geom_payload;
+                    if (geom_payload_en)
+                        pay_rr <= (pay_pick + 1) % NUM_LANES;
+
+                    if (pix_any) begin
+                        hold_valid[pix_pick] <= 1'b0;
+                        pix_rr               <= (pix_pick + 1) % NUM_LANES;
+                    end
+                    for (k = 0; k < NUM_LANES; k = k + 1) begin
+                        if (lane_pixel_en[k] && !lane_stall[k]) begin
+                            hold_valid[k] <= 1'b1;
+                            hold_addr[k]  <= lane_pixel_addr[k];
+                            hold_word0[k] <= lane_pixel_word0[k];
+                            hold_word1[k] <= lane_pixel_word1[k];
+                            hold_word2[k] <= lane_pixel_word2[k];
+                        end
+                    end
+
+                    if (start && !frame_active) begin
+                        frame_active  <= 1'b1;
+                        lane_finished <= {NUM_LANES{1'b0}};
+                    end else begin
+                        lane_finished <= lane_finished | lane_done;
+                        if (frame_active && &lane_finished && !(|hold_valid)) begin
+                            frame_active <= 1'b0;
+                            frame_done_r <= 1'b1;
+                        end
+                    end
+                end
+            end
+        end
+    endgenerate
+
+    // The cursor pixel's row belongs to one lane; counts are summed.
+    localparam integer CURSOR_LANE = (SCREEN_HEIGHT >> 1) % NUM_LANES;
+    assign cursor_hit_valid   = lane_cursor_hit_valid[CURSOR_LANE];
+    assign cursor_voxel_x     = lane_cursor_x[CURSOR_LANE];
+    assign cursor_voxel_y     = lane_cursor_y[CURSOR_LANE];
+    assign cursor_voxel_z     = lane_cursor_z[CURSOR_LANE];
+    assign cursor_material_id = lane_cursor_material[CURSOR_LANE];
+    assign cursor_voxel_data  = lane_cursor_data[CURSOR_LANE];
+
+    always @* begin : lane_totals
+        integer k;
+        core_dbg_hit_count  = 32'd0;
+        core_dbg_skip_count = 32'd0;
+        core_dbg_ets_count  = 32'd0;
+        for (k = 0; k < NUM_LANES; k = k + 1) begin
+            core_dbg_hit_count  = core_dbg_hit_count  + lane_hit_count[k];
+            core_dbg_skip_count = core_dbg_skip_count + lane_skip_count[k];
+            core_dbg_ets_count  = core_dbg_ets_count  + lane_ets_count[k];
+        end
+    end
+
     assign frame_done = done;
     assign core_busy  = busy;
 
+`ifdef HYDRA_DPI_PIXELS
+    // Verilator harness: push pixels into the host ring buffer from inside
+    // eval instead of having the harness poll pixel_write_en every cycle.
+    // Sampled at the edge, so each call lands one cycle after the port
+    // showed the pixel; ordering against hydra_frame_done is preserved.
+    import "DPI-C" function void hydra_pixel_push(input int addr,
+                                                  input int w0,
+                                                  input int w1,
+                                                  input int w2);
+    import "DPI-C" function void hydra_frame_done();
+
+    always @(posedge clk) begin
+        if (rst_n) begin
+            if (pixel_write_en)
+                hydra_pixel_push(pixel_addr, pixel_word0, pixel_word1, pixel_word2);
+            if (done)
+                hydra_frame_done();
+        end
+    end
+`endif
+
     // Simple control: run world_gen once, then repeatedly start frames
     reg world_started;
     reg world_ready;
     reg busy_d;
     reg pending_start;
 
+    // Render-on-demand: with cfg_render_on_demand set, auto-start only runs
+    // while scene_dirty is set. Any camera/flag/selection load or voxel write
+    // sets it; starting a frame clears it, so a change that lands mid-frame
+    // triggers exactly one more frame. A frame_tick that finds the core idle
+    // with nothing owed is a frame free-running would have started there.
+    reg        scene_dirty;
+    reg [31:0] frame_cycles;      // length of the last rendered frame
+    reg [31:0] frame_cycle_cnt;
+    reg [31:0] skipped_frames_r;  // frame ticks with the auto-start held back
+    reg [31:0] skipped_bricks_r;  // dbg_skip_count at the last done
+    reg [31:0] cycles_per_pixel_r;
+    reg [31:0] cache_hits_r;      // voxel_cache counters at the last done
+    reg [31:0] cache_misses_r;
+    reg [31:0] cache_evictions_r;
+    reg [31:0] fetch_reads_r;     // voxel_fetch_stats counters at the last done
+    reg [31:0] fetch_reuses_r;
+    reg [31:0] ets_saved_r;       // dbg_ets_count at the last done
+
+    // CYCLES_PER_PIXEL: FRAME_CYCLES (Q.8) / pixel count by restoring
+    // division, one quotient bit per clock, so it settles 40 cycles after
+    // done instead of putting a 40-bit divider on a single cycle.
+    localparam integer CPP_BITS = 40;
+    localparam [31:0]  CPP_DIVISOR = SCREEN_WIDTH * SCREEN_HEIGHT;
+    reg [CPP_BITS-1:0] cpp_num;     // dividend, shifted out MSB first
+    reg [CPP_BITS-1:0] cpp_quo;
+    reg [32:0]         cpp_rem;
+    reg [5:0]          cpp_cnt;     // bits still to go; 0 = idle
+    wire [32:0] cpp_shift = {cpp_rem[31:0], cpp_num[CPP_BITS-1]};
+    wire        cpp_fits  = cpp_shift >= {1'b0, CPP_DIVISOR};
+
+    wire scene_change = cam_load | flags_load | sel_load | dbg_write_en_mux | world_done;
+    wire auto_run     = AUTO_START_FRAMES && (!cfg_render_on_demand || scene_dirty);
+    wire idle_clean   = AUTO_START_FRAMES && cfg_render_on_demand && world_ready && !busy &&
+                        !scene_dirty && !pending_start;
+
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             world_started <= 1'b0;
@@ -251,6 +948,22 @@ module voxel_framebuffer_top #(
             start         <= 1'b0;
             busy_d        <= 1'b0;
             pending_start <= 1'b0;
+            scene_dirty      <= 1'b1;
+            frame_cycles     <= 32'd0;
+            frame_cycle_cnt  <= 32'd0;
+            skipped_frames_r <= 32'd0;
+            skipped_bricks_r <= 32'd0;
+            cycles_per_pixel_r <= 32'd0;
+            cpp_num           <= {CPP_BITS{1'b0}};
+            cpp_quo           <= {CPP_BITS{1'b0}};
+            cpp_rem           <= 33'd0;
+            cpp_cnt           <= 6'd0;
+            cache_hits_r      <= 32'd0;
+            cache_misses_r    <= 32'd0;
+            cache_evictions_r <= 32'd0;
+            fetch_reads_r     <= 32'd0;
+            fetch_reuses_r    <= 32'd0;
+            ets_saved_r       <= 32'd0;
         end else begin
             busy_d      <= busy;
             world_start <= 1'b0;
@@ -260,6 +973,8 @@ module voxel_framebuffer_top #(
                 world_started <= 1'b0;
                 world_ready   <= TEST_FORCE_WORLD_READY ? 1'b1 : 1'b0;
                 pending_start <= 1'b0;
+                scene_dirty      <= 1'b1;
+                skipped_frames_r <= 32'd0;
             end else begin
                 if (!world_started) begin
                     world_start   <= 1'b1;
@@ -273,17 +988,106 @@ module voxel_framebuffer_top #(
                     pending_start <= 1'b1;
 
                 // Kick frames when idle:
-                // - If AUTO_START_FRAMES, free-run once world is ready.
+                // - If AUTO_START_FRAMES, free-run once world is ready
+                //   (only while the scene is dirty in render-on-demand mode).
                 // - Otherwise require a pending_start from host.
-                if (world_ready && AUTO_START_FRAMES && !busy)
-                    start <= 1'b1;
-                else if (world_ready && AUTO_START_FRAMES && busy_d && !busy)
-                    start <= 1'b1;
+                if (world_ready && auto_run && !busy) begin
+                    start       <= 1'b1;
+                    scene_dirty <= 1'b0;
+                end else if (world_ready && auto_run && busy_d && !busy) begin
+                    start       <= 1'b1;
+                    scene_dirty <= 1'b0;
+                end
 
                 if (world_ready && pending_start) begin
                     start         <= 1'b1;
                     pending_start <= 1'b0;
                 end
+
+                if (scene_change)
+                    scene_dirty <= 1'b1;
+
+                if (frame_tick && idle_clean)
+                    skipped_frames_r <= skipped_frames_r + 32'd1;
+
+                // Frame length.
+                if (busy)
+                    frame_cycle_cnt <= frame_cycle_cnt + 32'd1;
+                if (done) begin
+                    frame_cycles     <= frame_cycle_cnt + 32'd1;
+                    frame_cycle_cnt  <= 32'd0;
+                    skipped_bricks_r <= core_dbg_skip_count;
+                    cpp_num           <= {frame_cycle_cnt + 32'd1, 8'd0};
+                    cpp_quo           <= {CPP_BITS{1'b0}};
+                    cpp_rem           <= 33'd0;
+                    cpp_cnt           <= CPP_BITS[5:0];
+                    cache_hits_r      <= cache_hit_count;
+                    cache_misses_r    <= cache_miss_count;
+                    cache_evictions_r <= cache_evict_count;
+                    fetch_reads_r     <= fetch_read_count;
+                    fetch_reuses_r    <= fetch_reuse_count;
+                    ets_saved_r       <= core_dbg_ets_count;
+                end
+
+                if (!done && cpp_cnt != 6'd0) begin
+                    cpp_num <= {cpp_num[CPP_BITS-2:0], 1'b0};
+                    cpp_rem <= cpp_fits ? cpp_shift - {1'b0, CPP_DIVISOR} : cpp_shift;
+                    cpp_quo <= {cpp_quo[CPP_BITS-2:0], cpp_fits};
+                    cpp_cnt <= cpp_cnt - 6'd1;
+                    if (cpp_cnt == 6'd1)
+                        cycles_per_pixel_r <= {cpp_quo[30:0], cpp_fits};
+                end
+            end
+        end
+    end
+
+    assign scene_dirty_out = scene_dirty;
+    assign skipped_frames  = skipped_frames_r;
+    assign skipped_bricks  = skipped_bricks_r;
+    assign frame_cycles_out = frame_cycles;
+    assign cycles_per_pixel = cycles_per_pixel_r;
+    assign cache_hits       = cache_hits_r;
+    assign cache_misses     = cache_misses_r;
+    assign cache_evictions  = cache_evictions_r;
+    assign fetch_reads      = fetch_reads_r;
+    assign fetch_reuses     = fetch_reuses_r;
+    assign ets_saved        = ets_saved_r;
+
+    // Per-lane utilisation for the harness: clocks each lane worked, and
+    // clocks it stalled on the shared payload port, its pixel hold or a
+    // voxel cache miss, from the frame's start pulse. A lane that finishes
+    // early stops counting.
+    reg [31:0] lane_active_cycles  [0:NUM_LANES-1];
+    reg [31:0] lane_payload_stalls [0:NUM_LANES-1];
+    reg [31:0] lane_pixel_stalls   [0:NUM_LANES-1];
+    reg [31:0] lane_miss_stalls    [0:NUM_LANES-1];
+
+    always @(posedge clk or negedge rst_n) begin : lane_stats
+        integer k;
+        if (!rst_n) begin
+            for (k = 0; k < NUM_LANES; k = k + 1) begin
+                lane_active_cycles[k]  <= 32'd0;
+                lane_payload_stalls[k] <= 32'd0;
+                lane_pixel_stalls[k]   <= 32'd0;
+                lane_miss_stalls[k]    <= 32'd0;
+            end
+        end else begin
+            for (k = 0; k < NUM_LANES; k = k + 1) begin
+                if (start && !busy) begin
+                    lane_active_cycles[k]  <= 32'd0;
+                    lane_payload_stalls[k] <= 32'd0;
+                    lane_pixel_stalls[k]   <= 32'd0;
+                    lane_miss_stalls[k]    <= 32'd0;
+                end else if (lane_busy[k]) begin
+                    if (lane_payload_stall[k])
+                        lane_payload_stalls[k] <= lane_payload_stalls[k] + 32'd1;
+                    else if (lane_pixel_stall[k])
+                        lane_pixel_stalls[k] <= lane_pixel_stalls[k] + 32'd1;
+                    else if (lane_miss_stall[k])
+                        lane_miss_stalls[k] <= lane_miss_stalls[k] + 32'd1;
+                    else
+                        lane_active_cycles[k] <= lane_active_cycles[k] + 32'd1;
+                end
             end
         end
     end
@@ -304,6 +1108,16 @@ module voxel_framebuffer_top #(
             cfg_curvature       <= 1'b1;
             cfg_extra_light     <= 1'b0;
             cfg_diag_slice      <= 1'b0;
+            cfg_render_on_demand <= 1'b0;
+            cfg_dda             <= 1'b0;
+            cfg_perspective     <= 1'b0;
+            cfg_memo            <= 1'b0;
+            cfg_skip_empty      <= 1'b0;
+            cfg_sdf             <= 1'b0;
+            cfg_pipeline        <= 1'b0;
+            cfg_tile_order      <= 2'd0;
+            cfg_composite       <= 1'b0;
+            cfg_alpha_threshold <= 8'd243;   // ~95% opaque
 
             sel_active   <= 1'b0;
             sel_voxel_x  <= 6'd0;
@@ -328,10 +1142,20 @@ module voxel_framebuffer_top #(
             end
 
             if (flags_load) begin
-                cfg_smooth_surfaces <= flag_smooth_in;
-                cfg_curvature       <= flag_curvature_in;
-                cfg_extra_light     <= flag_extra_light_in;
-                cfg_diag_slice      <= flag_diag_slice_in;
+                cfg_smooth_surfaces  <= flag_smooth_in;
+                cfg_curvature        <= flag_curvature_in;
+                cfg_extra_light      <= flag_extra_light_in;
+                cfg_diag_slice       <= flag_diag_slice_in;
+                cfg_render_on_demand <= flag_on_demand_in;
+                cfg_dda              <= flag_dda_in;
+                cfg_perspective      <= flag_perspective_in;
+                cfg_memo             <= flag_memo_in;
+                cfg_skip_empty       <= flag_skip_empty_in;
+                cfg_sdf              <= flag_sdf_in;
+                cfg_pipeline         <= flag_pipeline_in;
+                cfg_tile_order       <= flag_tile_order_in;
+                cfg_composite        <= flag_composite_in;
+                cfg_alpha_threshold  <= alpha_threshold_in;
             end
 
             if (sel_load) begin
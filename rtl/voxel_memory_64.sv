@@ -1,8 +1,24 @@
 // ============================================================================
 // voxel_memory_64.sv
-// - Simple 1R1W block-RAM-friendly memory for 64^3 voxels.
-// - Address mapping: {x[5:0], y[5:0], z[5:0]} -> [17:12]=x, [11:6]=y, [5:0]=z.
-// - Write-first behavior on read-after-write to the same address.
+// - Block-RAM-friendly memory for 64^3 voxels, stored as two planes behind
+//   one write port:
+//   * trace:   8 bits per voxel, {solid, translucent, 2'b0, word[3:0]}.
+//              solid is word != 0 && alpha > 10 (the core's hit test);
+//              translucent is a solid glass or water voxel (material type
+//              2 or 5, which composite mode blends); [3:0] is the
+//              distance-field nibble. The core reads this every step.
+//   * payload: the full 64-bit word, read only when the core has found
+//              its hit (read_data comes back solid).
+//   A ray therefore moves 1 byte per voxel it crosses instead of 8, plus
+//   one 8-byte payload fetch per hit.
+// - Addresses are word indices. voxel_framebuffer_top maps {x,y,z} to them
+//   through voxel_addr_map (xyz, Morton or 8^3-brick order), so an
+//   INIT_FILE must be in the same order.
+// - READ_PORTS trace read ports (one per voxel_framebuffer_top lane), all
+//   on the one trace array: synthesis gives each port its own copy of the
+//   plane, written together. The payload plane keeps a single port.
+// - Write-first behavior on read-after-write to the same address, on every
+//   port. Each read register holds its value while its enable is low.
 // ============================================================================
 
 `timescale 1ns/1ps
@@ -11,16 +27,22 @@ module voxel_memory_64 #(
     parameter integer DATA_WIDTH = 64,
     parameter integer GRID_SIZE  = 64,
     parameter integer ADDR_WIDTH = 18,
+    parameter integer READ_PORTS = 1,
     // Simulation-only zero/init helper; synthesis will ignore the for loop.
     parameter integer INIT_ZERO  = 1'b0,
     parameter INIT_FILE          = ""
 )(
     input  wire                   clk,
 
-    // Read port
-    input  wire [ADDR_WIDTH-1:0]  read_addr,
-    input  wire                   read_en,
-    output reg  [DATA_WIDTH-1:0]  read_data,
+    // Trace read ports (every ray step), port p at [p*ADDR_WIDTH +: ADDR_WIDTH]
+    input  wire [READ_PORTS*ADDR_WIDTH-1:0] read_addr,
+    input  wire [READ_PORTS-1:0]            read_en,
+    output reg  [READ_PORTS*8-1:0]          read_data,
+
+    // Payload read port (once per hit)
+    input  wire [ADDR_WIDTH-1:0]  payload_addr,
+    input  wire                   payload_en,
+    output reg  [DATA_WIDTH-1:0]  payload_data,
 
     // Write port
     input  wire [ADDR_WIDTH-1:0]  write_addr,
@@ -30,32 +52,64 @@ module voxel_memory_64 #(
 
     localparam integer DEPTH = GRID_SIZE * GRID_SIZE * GRID_SIZE; // 262,144
 
+    function automatic [7:0] trace_byte;
+        input [DATA_WIDTH-1:0] word;
+        reg solid;
+    begin
+        solid      = word != {DATA_WIDTH{1'b0}} && word[47:40] > 8'd10;
+        trace_byte = {solid, solid && (word[7:4] == 4'd2 || word[7:4] == 4'd5), 2'b00, word[3:0]};
+    end
+    endfunction
+
     (* ram_style = "block", ram_decomp = "power" *)
     reg [DATA_WIDTH-1:0] vox [0:DEPTH-1];
 
+    (* ram_style = "block" *)
+    reg [7:0] trace [0:DEPTH-1];
+
+    wire [7:0] write_trace = trace_byte(write_data);
+
 `ifndef SYNTHESIS
     integer i;
     initial begin
         if (INIT_FILE != "") begin
             $readmemh(INIT_FILE, vox);
-        end else if (INIT_ZERO) begin
             for (i = 0; i < DEPTH; i = i + 1)
-                vox[i] = {DATA_WIDTH{1'b0}};
+                trace[i] = trace_byte(vox[i]);
+        end else if (INIT_ZERO) begin
+            for (i = 0; i < DEPTH; i = i + 1) begin
+                vox[i]   = {DATA_WIDTH{1'b0}};
+                trace[i] = 8'd0;
+            end
         end
-        read_data = {DATA_WIDTH{1'b0}};
+        read_data    = {READ_PORTS*8{1'b0}};
+        payload_data = {DATA_WIDTH{1'b0}};
     end
 `endif
 
+    integer p;
+
     always @(posedge clk) begin
         // Write-first behavior if read/write collide
-        if (write_en)
-            vox[write_addr] <= write_data;
+        if (write_en) begin
+            vox[write_addr]   <= write_data;
+            trace[write_addr] <= write_trace;
+        end
+
+        for (p = 0; p < READ_PORTS; p = p + 1) begin
+            if (read_en[p]) begin
+                if (write_en && (write_addr == read_addr[p*ADDR_WIDTH +: ADDR_WIDTH]))
+                    read_data[p*8 +: 8] <= write_trace;
+                else
+                    read_data[p*8 +: 8] <= trace[read_addr[p*ADDR_WIDTH +: ADDR_WIDTH]];
+            end
+        end
 
-        if (read_en) begin
-            if (write_en && (write_addr == read_addr))
-                read_data <= write_data;
+        if (payload_en) begin
+            if (write_en && (write_addr == payload_addr))
+                payload_data <= write_data;
             else
-                read_data <= vox[read_addr];
+                payload_data <= vox[payload_addr];
         end
     end
 
@@ -0,0 +1,93 @@
+// ============================================================================
+// voxel_occupancy.sv
+// - Coarse occupancy of the 64^3 volume: one bit per 8^3 brick (512 bricks),
+//   set while the brick holds at least one voxel the core would hit
+//   (word != 0 and alpha > 10).
+// - Snoops the voxel_memory_64 write port, so world_gen and debug writes
+//   keep it current: a shadow bit per voxel gives the old occupancy, and a
+//   per-brick count of occupied voxels goes up or down by one. A brick bit
+//   follows its write two cycles later.
+// - Brick index mapping: {x[5:3], y[5:3], z[5:3]}, like the voxel address.
+// - LOOKUP_PORTS independent lookups of the bitmap, one per core lane.
+// - Nothing is reset: the counts only stay right relative to the shadow
+//   bits, which start at zero and track every write, so the structure is
+//   exact once every voxel has been written (world_gen's clear pass does).
+//   Harnesses that preload the volume must preload this too.
+// ============================================================================
+
+`timescale 1ns/1ps
+
+module voxel_occupancy #(
+    parameter integer GRID_SIZE  = 64,
+    parameter integer ADDR_WIDTH = 18,
+    parameter integer LOOKUP_PORTS = 1
+)(
+    input  wire                   clk,
+
+    // Mirror of the voxel_memory_64 write port
+    input  wire [ADDR_WIDTH-1:0]  write_addr,
+    input  wire                   write_en,
+    input  wire [63:0]            write_data,
+
+    // Brick lookups (combinational), port p at [p*9 +: 9]
+    input  wire [LOOKUP_PORTS*9-1:0] brick_addr,
+    output wire [LOOKUP_PORTS-1:0]   brick_occupied
+);
+
+    localparam integer DEPTH      = GRID_SIZE * GRID_SIZE * GRID_SIZE;
+    localparam integer NUM_BRICKS = 512;
+
+    (* ram_style = "block" *)
+    reg       solid_bits  [0:DEPTH-1];
+    (* ram_style = "distributed" *)
+    reg [9:0] brick_count [0:NUM_BRICKS-1];
+    reg [NUM_BRICKS-1:0] brick_occ;
+
+    // Stage 1: the write, its brick and the voxel's previous occupancy.
+    reg       upd_en;
+    reg [8:0] upd_brick;
+    reg       upd_old;
+    reg       upd_new;
+
+    wire write_solid = (write_data != 64'd0) && (write_data[47:40] > 8'd10);
+
+`ifndef SYNTHESIS
+    integer i;
+    initial begin
+        for (i = 0; i < DEPTH; i = i + 1)
+            solid_bits[i] = 1'b0;
+        for (i = 0; i < NUM_BRICKS; i = i + 1)
+            brick_count[i] = 10'd0;
+        brick_occ = {NUM_BRICKS{1'b0}};
+        upd_en    = 1'b0;
+    end
+`endif
+
+    always @(posedge clk) begin
+        upd_en <= write_en;
+        if (write_en) begin
+            upd_old   <= solid_bits[write_addr];
+            upd_new   <= write_solid;
+            upd_brick <= {write_addr[17:15], write_addr[11:9], write_addr[5:3]};
+            solid_bits[write_addr] <= write_solid;
+        end
+
+        if (upd_en && upd_old != upd_new) begin
+            if (upd_new) begin
+                brick_count[upd_brick] <= brick_count[upd_brick] + 10'd1;
+                brick_occ[upd_brick]   <= 1'b1;
+            end else begin
+                brick_count[upd_brick] <= brick_count[upd_brick] - 10'd1;
+                brick_occ[upd_brick]   <= brick_count[upd_brick] != 10'd1;
+            end
+        end
+    end
+
+    genvar port;
+    generate
+        for (port = 0; port < LOOKUP_PORTS; port = port + 1) begin : g_lookup
+            assign brick_occupied[port] = brick_occ[brick_addr[port*9 +: 9]];
+        end
+    endgenerate
+
+endmodule
@@ -1,12 +1,50 @@
 // ============================================================================
 // voxel_raycaster_core_pipelined.sv
-// - Very simple per-pixel ray marcher through 64^3 voxel volume.
-// - Outputs extended 96-bit pixel as 3x32-bit words.
+// - One raycaster lane over a 64^3 voxel volume: for each of its pixels it
+//   casts a ray, walks it with the legacy half-voxel march or a 3D-DDA
+//   (orthographic or from the camera), shades the first opaque voxel or the
+//   sky, and writes the extended 96-bit pixel as 3x32-bit words.
+// - The DDA can cross empty space without reads (occupancy bricks, distance
+//   field), reuse rays across a screen bucket (ray memo), keep several rays
+//   in flight (pipelined DDA), walk pixels in tile orders, and blend
+//   translucent voxels on the way (composite). One 15-state FSM runs it
+//   all; the pipelined DDA keeps its PIPE_SLOTS rays in slots of their own
+//   while the FSM sits in S_PIPE.
 // - Supports:
 //   * render_config[0] = "extra light" mode
 //   * render_config[1] = diagnostic slice mode (orthographic Y/Z slices)
+//   * render_config[2] = 3D-DDA traversal (Amanatides-Woo): each voxel the
+//     ray crosses is read exactly once, and the occupancy test waits for
+//     the registered read instead of using the previous sample's word
+//   * render_config[3] = perspective rays from the cam_* inputs, walked with
+//     the same DDA (see "Perspective rays" below)
+//   * render_config[4] = ray memo: each orthographic ray is traced once per
+//     frame and copied to the other pixels of its (map_y, map_z) bucket
+//   * render_config[5] = empty-space skipping: rays cross 8^3 bricks that
+//     the occupancy bitmap (voxel_occupancy) marks empty in one cycle,
+//     without reading them
+//   * render_config[6] = distance-field jumps: DDA and perspective rays
+//     cross the empty cube that a host-baked distance (voxel word [3:0])
+//     guarantees around them in one cycle
+//   * render_config[7] = pipelined DDA: with render_config[2], orthographic
+//     rays run PIPE_SLOTS at a time, one trace read per clock, and retire
+//     in pixel order (see "Pipelined DDA" below)
+//   * render_config[9:8] = pixel order: 0 raster, else 8x8 tiles of this
+//     lane's rows in tile-row (1), Morton (2) or Hilbert (3) order (see
+//     "Tile order" below)
+//   * render_config[10] = composite: DDA and perspective rays blend the
+//     translucent voxels they cross front to back and end early once the
+//     opacity would reach render_config[23:16] (see "Composite" below)
 //   * cursor ray info for center pixel
 //   * selection highlight (sel_*)
+// - Traversal only reads the 8-bit trace plane of voxel_memory_64 (solid
+//   bit + distance nibble); the 64-bit payload word is fetched once per hit,
+//   in the cycle the hit is found, and is back before the pixel shades, so
+//   pixels and cycle counts are those of a single 64-bit read port.
+// - One lane of NUM_LANES (voxel_framebuffer_top): this core renders rows
+//   LANE, LANE + NUM_LANES, ... and nothing else. stall is a clock enable
+//   for the whole core; the top raises it while one of the lane's memory or
+//   pixel requests cannot be served, and the core retries it next clock.
 // ============================================================================
 
 `timescale 1ns/1ps
@@ -16,11 +54,14 @@ module voxel_raycaster_core_pipelined #(
     parameter SCREEN_HEIGHT   = 360,
     parameter VOXEL_GRID_SIZE = 64,
     parameter COORD_WIDTH     = 16,
-    parameter FRAC_BITS       = 8
+    parameter FRAC_BITS       = 8,
+    parameter LANE            = 0,
+    parameter NUM_LANES       = 1
 )(
     input  wire clk,
     input  wire rst_n,
     input  wire start,
+    input  wire stall,
 
     // Camera parameters (fixed-point)
     input  wire signed [15:0] cam_x,
@@ -43,10 +84,15 @@ module voxel_raycaster_core_pipelined #(
     input  wire [5:0]  sel_voxel_y,
     input  wire [5:0]  sel_voxel_z,
 
-    // Voxel memory
+    // Voxel memory: the trace byte {solid, translucent, 2'b0, dist[3:0]}
+    // every step, the 64-bit payload word only for the voxel a ray hits
+    // (or blends)
     output reg  [17:0] voxel_addr,
-    input  wire [63:0] voxel_data,
+    input  wire [7:0]  voxel_trace,
     output reg         voxel_read_en,
+    output wire [17:0] payload_addr,
+    output wire        payload_read_en,
+    input  wire [63:0] payload_data,
 
     // Extended framebuffer: 3 words = 96 bits
     output reg [31:0]  pixel_word0, // reflection/refraction/attenuation/emission
@@ -65,7 +111,14 @@ module voxel_raycaster_core_pipelined #(
     output reg [5:0]   cursor_voxel_z,
     output reg [7:0]   cursor_material_id,
     output reg [63:0]  cursor_voxel_data,
-    output reg [31:0]  dbg_hit_count
+    output reg [31:0]  dbg_hit_count,
+
+    // Brick occupancy lookup for the voxel the ray is about to read
+    output wire [8:0]  brick_addr,
+    input  wire        brick_occupied,
+    output reg [31:0]  dbg_skip_count,
+    // Voxels early ray termination left unread (composite)
+    output reg [31:0]  dbg_ets_count
 );
 
     // State machine
@@ -76,24 +129,61 @@ module voxel_raycaster_core_pipelined #(
     localparam S_SHADE       = 4'd4;
     localparam S_WRITE       = 4'd5;
     localparam S_NEXT_PIXEL  = 4'd6;
+    localparam S_RAY_DIV     = 4'd7;
+    localparam S_RAY_CLIP    = 4'd8;
+    localparam S_RAY_ENTER   = 4'd9;
+    localparam S_RAY_TMAX    = 4'd10;
+    localparam S_PIPE        = 4'd11;
+    localparam S_PIPE_END    = 4'd12;
+    localparam S_NEXT_TILE   = 4'd13;
+    localparam S_BLEND       = 4'd14;
 
     reg [3:0]  state;
 
+    // This lane's first and last rows.
+    localparam [10:0] FIRST_ROW = LANE;
+    localparam [10:0] LAST_ROW  = SCREEN_HEIGHT - 1 - (SCREEN_HEIGHT - 1 - LANE) % NUM_LANES;
+
     reg [10:0] pixel_x, pixel_y;
     reg        cursor_sample;
 
+    // Tile order. Pixels are walked in 8x8 tiles of the lane's own rows
+    // (tile row k covers rows FIRST_ROW + (8k .. 8k+7) * NUM_LANES), raster
+    // inside a tile, so consecutive rays stay within a few voxel columns of
+    // each other. Tiles are visited in the order's sequence of cells over a
+    // 2^TILE_BITS square; S_NEXT_TILE tests one cell per clock and skips the
+    // ones outside the screen, so a frame takes TILE_CELLS clocks more than
+    // in raster order. Pixels are those of the same walk in raster order
+    // except where the carry registers chain one pixel to the next (the
+    // march's first sample); the ray memo needs raster order and is off.
+    // Perspective directions are rebuilt at each tile's corner from the
+    // frame's base direction and then stepped as in raster order.
+    wire [1:0] tile_order = render_config[9:8];
+    wire       tile_mode  = tile_order != 2'd0;
+    localparam integer LANE_ROWS  = (LAST_ROW - FIRST_ROW) / NUM_LANES + 1;
+    localparam integer TILES_X    = (SCREEN_WIDTH + 7) / 8;
+    localparam integer TILES_Y    = (LANE_ROWS + 7) / 8;
+    localparam integer TILE_SPAN  = (TILES_X > TILES_Y) ? TILES_X : TILES_Y;
+    localparam integer TILE_BITS  = (TILE_SPAN > 1) ? $clog2(TILE_SPAN) : 1;
+    localparam integer TILE_CELLS = 1 << (2 * TILE_BITS);
+    reg [2*TILE_BITS-1:0] tile_d;                   // next cell to test
+    reg [10:0]            tile_x0, tile_x1, tile_y1; // this tile's left/right x, last row
+
     // Current ray voxel position
     reg [5:0]  voxel_x, voxel_y, voxel_z;
     reg [7:0]  ray_steps;
     reg        hit;
 
-    // Latched voxel fields
-    reg [7:0]  voxel_material_props;
-    reg [7:0]  voxel_emissive;
-    reg [7:0]  voxel_alpha;
-    reg [7:0]  voxel_light;
-    reg [23:0] voxel_color;
-    reg [3:0]  voxel_material_type;
+    // The payload port only reads on a hit and holds its word otherwise, so
+    // payload_data is the latched hit word; shading decodes it.
+    wire [3:0]  voxel_material_type  = payload_data[7:4];
+
+    // Address of the word voxel_trace belongs to: the last read issued.
+    reg  [17:0] trace_addr;
+    wire        trace_solid = voxel_trace[7];
+    wire        trace_glass = voxel_trace[6];   // solid type 2 or 5
+    // The cursor pixel hit: copy its payload word once it lands.
+    reg         cursor_fetch;
 
     // Pixel components
     reg [7:0]  pixel_reflection;
@@ -115,9 +205,221 @@ module voxel_raycaster_core_pipelined #(
     localparam [5:0] SLICE_STEP    = 6'd8;
     reg [2:0] slice_idx;
     reg       best_hit;
-    reg [7:0] best_emissive;
     wire diag_slice_mode = render_config[1];
 
+    // 3D-DDA state. dda_* is the next voxel to visit (7-bit signed so a step
+    // off the grid is visible); voxel_x/y/z keep the voxel whose read is in
+    // flight. t values are Q16.8 ray parameter, T_INF for an axis the ray
+    // never crosses.
+    localparam integer T_WIDTH       = 24;
+    localparam [T_WIDTH-1:0] T_INF   = {T_WIDTH{1'b1}};
+    localparam [7:0]  DDA_MAX_STEPS  = 8'd192;  // 3 * 64 bounds any ray
+    reg signed [6:0]  dda_x, dda_y, dda_z;
+    reg               dda_neg_x, dda_neg_y, dda_neg_z;
+    reg [T_WIDTH-1:0] dda_tmax_x, dda_tmax_y, dda_tmax_z;
+    reg [T_WIDTH-1:0] dda_tdelta_x, dda_tdelta_y, dda_tdelta_z;
+    reg               dda_pending;   // a read was issued and not yet tested
+    reg               dda_out;       // dda_* left the grid
+
+    // Perspective rays. cam_* are Q8.8 in camera axes with z up; the volume's
+    // up axis is y, so camera (x, y, z) is voxel (x, z, y). The ray through
+    // pixel (px, py) is dir + plane * (2px - W) / W + up * (H - 2py) / W,
+    // with up = dir x plane (as long as plane, perpendicular to both).
+    // Directions are Q8.24 and only ever added to: one plane step per pixel,
+    // one up step per row. The rest of the per-pixel setup is not add-only,
+    // and takes this hardware per ray:
+    //   divider     three 26-bit radix-4 dividers for 2^24 / |d| (13 cycles)
+    //   S_RAY_CLIP  six 17x24 multiplies for the slab entry and exit t
+    //   S_RAY_ENTER three 24x25 multiplies for the entry voxel
+    //   S_RAY_TMAX  three 17x24 multiplies for the first boundary t
+    // Neither 1/|d| nor the t products are linear in the pixel, so they are
+    // not stepped across the scanline. The divider runs on its own: once
+    // S_RAY_CLIP has taken a ray's quotients it starts on the next pixel's
+    // direction (the next one in the row, or the first of the lane's next
+    // row), so that divide overlaps the current ray's walk. S_RAY_DIV only
+    // waits for whatever is left of it, and a ray costs 3 + max(0, 12 - n)
+    // setup cycles, n being the previous ray's cycles from S_RAY_ENTER to
+    // S_NEXT_PIXEL. The first pixel of a frame or tile pays all 16.
+    wire persp_mode = render_config[3];
+    wire dda_walk   = render_config[2] | render_config[3];
+
+    // Composite. The DDA and perspective walks test each trace byte as
+    // usual, but a translucent one (glass or water) goes to S_BLEND with
+    // its payload word instead of ending the ray. There its alpha takes
+    // contrib = t * alpha / 256 of the transmittance t (256 = clear) and
+    // adds contrib * colour / 256 to the accumulated colour, and the walk
+    // carries on. A voxel that would take the opacity 256 - t to
+    // comp_threshold or more ends the ray instead: it is shaded as the
+    // surface, with the transmittance in front of it, and the voxels
+    // between it and the face the ray would have left through are added to
+    // dbg_ets_count (all the ray had left when orthographic; a lower bound
+    // for perspective rays). These are voxels, not steps: with skip_empty or
+    // sdf the walk would have crossed most of them in far fewer. The pixel
+    // is the accumulated colour plus t of the surface's (or the sky's).
+    // Each blend costs S_BLEND and, unless it
+    // ends the ray, the S_STEP that found it. Opaque voxels hit as before,
+    // so a scene without translucent voxels renders as without composite.
+    // The pipelined DDA and the ray memo are off.
+    wire       comp_mode      = render_config[10] & dda_walk & ~diag_slice_mode;
+    wire [7:0] comp_threshold = render_config[23:16];
+    reg  [8:0] comp_t;
+    reg  [7:0] comp_r, comp_g, comp_b;
+
+    // Pipelined orthographic DDA; see "Pipelined DDA" below.
+    wire pipe_mode  = render_config[7] & render_config[2] & ~persp_mode & ~diag_slice_mode &
+                      ~comp_mode;
+    localparam integer RECIP_CYCLES = 13;   // 26 quotient bits of 2^24 / |d|
+    localparam signed [17:0] GRID_END = VOXEL_GRID_SIZE << FRAC_BITS;
+    reg signed [31:0] ray_base_x, ray_base_y, ray_base_z; // direction at (0, FIRST_ROW)
+    reg signed [31:0] ray_row_x, ray_row_y, ray_row_z;   // direction at (0 or tile_x0, pixel_y)
+    reg signed [31:0] ray_dir_x, ray_dir_y, ray_dir_z;   // direction at (pixel_x, pixel_y)
+    reg signed [31:0] ray_dx_x,  ray_dx_y,  ray_dx_z;    // + per pixel
+    reg signed [31:0] ray_du_x,  ray_du_y,  ray_du_z;    // - per row of this lane
+    reg signed [15:0] org_x, org_y, org_z;               // camera position, voxel axes
+    reg signed [23:0] ray_d_x, ray_d_y, ray_d_z;         // this pixel's direction, Q8.16
+    reg [23:0]        div_mag_x, div_mag_y, div_mag_z;
+    reg [25:0]        div_rem_x, div_rem_y, div_rem_z;
+    reg [25:0]        div_q_x,   div_q_y,   div_q_z;
+    reg [3:0]         div_cnt;
+    reg               div_run;    // a divide is in flight
+    reg               div_next;   // ... or done, for the next pixel
+    reg [T_WIDTH-1:0] clip_t_enter;
+
+    // Ray memo. In the orthographic modes every pixel of a (map_y, map_z)
+    // bucket traces the same ray, about 7.5 x 5.6 pixels each. The first
+    // pixel of each bucket stores its words in a line buffer indexed by
+    // map_z; the buffer is emptied whenever map_y changes, so it only ever
+    // holds the current row bucket. Later pixels copy the entry in
+    // S_RENDER_PIXEL and go straight to S_WRITE without touching the read,
+    // hit or normal registers. Sky entries (material 0xFF) take their own
+    // row's gradient. The cursor pixel always traces so cursor_* stay live.
+    wire memo_mode = render_config[4] & (diag_slice_mode | ~persp_mode) & ~pipe_mode & ~tile_mode &
+                     ~comp_mode;
+    reg [95:0]                memo_words [0:VOXEL_GRID_SIZE-1];
+    reg [VOXEL_GRID_SIZE-1:0] memo_valid;
+    reg [5:0]                 memo_row;
+
+    // Pipelined DDA: orthographic DDA (render_config[7] with [2]; not with
+    // perspective or diag_slice). The frame runs in S_PIPE with up to
+    // PIPE_SLOTS rays in flight. Each slot is one pixel: slots are filled
+    // in pixel order at the tail (one per clock), and every clock the
+    // oldest slot that is ready takes one DDA step: a brick skip, a
+    // distance-field jump or one trace read. A read's word comes back two
+    // clocks later and is tested then, so a slot steps at most every third
+    // clock and the trace port is kept busy by the others. A solid word
+    // fetches its payload word into the slot. Slots finish out of order;
+    // the head slot is shaded and written when done, one pixel per clock,
+    // so pixel writes, normals/curvature carry-over, hit counts and the
+    // cursor follow pixel order. Pixels are those of the sequential DDA.
+    // At the end, S_PIPE_END re-reads the last word of the last pixel in
+    // order (trace and payload) so the next frame starts from the same
+    // carried words. The ray memo is off in this mode. In tile order the
+    // launch side walks the tiles (pipe_seek while it looks for the next
+    // cell) and each slot keeps its pixel's coordinates for the write.
+    localparam integer PIPE_SLOTS = 16;
+    localparam integer PIPE_BITS  = 4;
+    localparam [2:0] P_FREE    = 3'd0;   // no pixel
+    localparam [2:0] P_TRACE   = 3'd1;   // ready to step
+    localparam [2:0] P_WAIT    = 3'd2;   // trace read in flight
+    localparam [2:0] P_PAYLOAD = 3'd3;   // hit; payload read in flight
+    localparam [2:0] P_DONE    = 3'd4;   // waiting to be written
+
+    reg [2:0]        slot_state [0:PIPE_SLOTS-1];
+    reg signed [6:0] slot_x     [0:PIPE_SLOTS-1];   // next voxel, -X
+    reg [5:0]        slot_y     [0:PIPE_SLOTS-1];
+    reg [5:0]        slot_z     [0:PIPE_SLOTS-1];
+    reg [7:0]        slot_steps [0:PIPE_SLOTS-1];
+    reg              slot_pend  [0:PIPE_SLOTS-1];   // last step was a non-solid read
+    reg [3:0]        slot_dist  [0:PIPE_SLOTS-1];   // ... with this distance
+    reg              slot_out   [0:PIPE_SLOTS-1];   // read in flight is x = 0
+    reg              slot_hit   [0:PIPE_SLOTS-1];
+    reg [5:0]        slot_hx    [0:PIPE_SLOTS-1];
+    reg [63:0]       slot_word  [0:PIPE_SLOTS-1];
+    reg              slot_read  [0:PIPE_SLOTS-1];   // made at least one read
+    reg [5:0]        slot_lastx [0:PIPE_SLOTS-1];
+    reg [10:0]       slot_px    [0:PIPE_SLOTS-1];
+    reg [10:0]       slot_py    [0:PIPE_SLOTS-1];
+    reg [PIPE_BITS-1:0] pipe_head, pipe_tail;
+    reg [10:0]       pipe_lx, pipe_ly;              // next pixel to launch
+    reg              pipe_launched;
+    reg              pipe_seek;                     // tile order: between tiles
+    reg              iss_valid, ret_valid, pay_valid;
+    reg [PIPE_BITS-1:0] iss_slot, ret_slot, pay_slot;
+    reg [5:0]        iss_x, ret_x;
+    reg [17:0]       last_read_addr, last_hit_addr;
+    reg              last_read_valid, last_hit_valid;
+
+    // Orthographic screen mapping: pixel (x, y) looks down voxel column
+    // (pix_map_y, pix_map_z). One divider pair serves the march, DDA, memo
+    // and pipeline paths; S_PIPE maps the pixel it launches, every other
+    // state the current pixel.
+    wire [10:0] map_px    = (state == S_PIPE) ? pipe_lx : pixel_x;
+    wire [10:0] map_py    = (state == S_PIPE) ? pipe_ly : pixel_y;
+    wire [17:0] pix_map_y = ((SCREEN_HEIGHT-1 - map_py) * (VOXEL_GRID_SIZE-1)) / (SCREEN_HEIGHT-1);
+    wire [17:0] pix_map_z = (map_px * (VOXEL_GRID_SIZE-1)) / (SCREEN_WIDTH-1);
+
+    integer pipe_k;
+
+    // Oldest slot ready to step.
+    reg                 pipe_pick_valid;
+    reg [PIPE_BITS-1:0] pipe_pick;
+    always @* begin : pipe_select
+        integer k;
+        reg [PIPE_BITS-1:0] idx;
+        pipe_pick_valid = 1'b0;
+        pipe_pick       = pipe_head;
+        for (k = PIPE_SLOTS-1; k >= 0; k = k - 1) begin
+            idx = pipe_head + k[PIPE_BITS-1:0];
+            if (slot_state[idx] == P_TRACE) begin
+                pipe_pick_valid = 1'b1;
+                pipe_pick       = idx;
+            end
+        end
+    end
+
+    // Empty-space skipping. Before a read, S_STEP looks up the brick of the
+    // voxel it is about to read. If the brick is empty, the ray goes to the
+    // brick's far side in one cycle and ray_steps counts what it passed, so
+    // pixels are unchanged and only reads and cycles drop.
+    //  * March: only while the word under test (the previous read) is not
+    //    solid, since that test is what the skipped S_FETCH would have done.
+    //    The ray jumps to the first half-voxel sample past the brick.
+    //  * DDA and perspective: the pending read is tested first, then the
+    //    whole brick is crossed in DDA order: the first boundary crossing
+    //    that leaves the brick (ties X, Y, Z, as in S_FETCH) and every
+    //    crossing on the other axes that comes before it.
+    // diag_slice never skips.
+    wire skip_mode = render_config[5] & ~diag_slice_mode;
+    assign brick_addr = (state == S_PIPE)
+        ? {slot_x[pipe_pick][5:3], slot_y[pipe_pick][5:3], slot_z[pipe_pick][5:3]}
+        : dda_walk
+        ? {dda_x[5:3], dda_y[5:3], dda_z[5:3]}
+        : {ray_pos_x[FRAC_BITS+5:FRAC_BITS+3], ray_pos_y[FRAC_BITS+5:FRAC_BITS+3],
+           ray_pos_z[FRAC_BITS+5:FRAC_BITS+3]};
+
+    // Distance-field jumps. The host stores, in the reserved low nibble of
+    // every non-solid voxel, its Chebyshev distance to the nearest solid one
+    // (0 = unknown, saturating at 15; see sim/scene/distance_field.h). A
+    // distance d clears the cube of radius d-1 around that voxel. When the
+    // pending read comes back non-solid with d >= 2, the ray (one voxel on
+    // from it by then) crosses the cube of radius min(d-2, 7) around its
+    // current voxel, clipped to the grid, in one cycle and in DDA order,
+    // like a brick skip. DDA and perspective only: the march tests a word
+    // one sample late, so it never knows where its last read was.
+    wire sdf_mode = render_config[6] & ~diag_slice_mode;
+    wire [3:0] sdf_reach = voxel_trace[3:0] > 4'd9 ? 4'd7 : voxel_trace[3:0] - 4'd2;
+
+    // Payload fetch, issued in the cycle a hit is detected: the word the
+    // solid trace byte came from is on payload_data when the pixel shades
+    // (S_SHADE for DDA, the next S_STEP for the march and diag-slice, the
+    // next clock for a pipeline slot). S_PIPE_END re-reads the last hit.
+    assign payload_addr    = (state == S_PIPE_END) ? last_hit_addr : trace_addr;
+    assign payload_read_en = (state == S_PIPE_END) ? last_hit_valid : trace_solid &&
+        ((state == S_STEP  && !diag_slice_mode && dda_walk && dda_pending) ||
+         (state == S_FETCH && diag_slice_mode && !best_hit) ||
+         (state == S_FETCH && !diag_slice_mode && !dda_walk && !hit) ||
+         (state == S_PIPE  && ret_valid));
+
     // Simple hard-coded lighting/shadow references for the demo scene.
     localparam [5:0] FLOOR_MIN_Y    = 6'd8;
     localparam [5:0] FLOOR_MAX_Y    = 6'd16;
@@ -162,10 +464,345 @@ module voxel_raycaster_core_pipelined #(
     end
     endfunction
 
+    // --------------------------------------------------------------------
+    // 3D-DDA setup helpers. dir is Q8.8; frac is the origin's offset inside
+    // its voxel (Q0.8).
+    // --------------------------------------------------------------------
+    // |1/dir| in Q16.8, clamped to 16 bits; T_INF when the axis is never crossed.
+    function automatic [T_WIDTH-1:0] dda_tdelta;
+        input signed [15:0] dir;
+        reg [15:0] mag;
+        reg [16:0] q;
+    begin
+        mag = dir[15] ? -dir : dir;
+        if (mag == 16'd0) begin
+            dda_tdelta = T_INF;
+        end else begin
+            q = 17'h10000 / mag;
+            dda_tdelta = (q > 17'h0FFFF) ? 24'h00FFFF : {7'd0, q};
+        end
+    end
+    endfunction
+
+    // Ray parameter at the first boundary crossing on this axis.
+    function automatic [T_WIDTH-1:0] dda_tmax0;
+        input signed [15:0] dir;
+        input        [7:0]  frac;
+        input [T_WIDTH-1:0] tdelta;
+        reg   [8:0]  dist;
+    begin
+        if (tdelta == T_INF)
+            dda_tmax0 = T_INF;
+        else begin
+            dist = dir[15] ? {1'b0, frac} : (9'd256 - frac);
+            dda_tmax0 = (tdelta * dist) >> 8;
+        end
+    end
+    endfunction
+
+    // tmax + tdelta, saturating at T_INF.
+    function automatic [T_WIDTH-1:0] t_add;
+        input [T_WIDTH-1:0] a;
+        input [T_WIDTH-1:0] b;
+        reg   [T_WIDTH:0]   sum;
+    begin
+        sum   = {1'b0, a} + {1'b0, b};
+        t_add = sum[T_WIDTH] ? T_INF : sum[T_WIDTH-1:0];
+    end
+    endfunction
+
+    function automatic [T_WIDTH-1:0] t_sat;
+        input [47:0] v;
+    begin
+        t_sat = (v >= {24'd0, T_INF}) ? T_INF : v[T_WIDTH-1:0];
+    end
+    endfunction
+
+    // tmax + n * tdelta, saturating at T_INF (n crossings on from tmax).
+    function automatic [T_WIDTH-1:0] t_after;
+        input [T_WIDTH-1:0] tmax;
+        input [T_WIDTH-1:0] tdelta;
+        input [3:0]         n;
+    begin
+        t_after = t_sat({24'd0, tmax} + n * tdelta);
+    end
+    endfunction
+
+    // Voxels left before the grid edge in the direction of travel.
+    function automatic [5:0] grid_left;
+        input signed [6:0] pos;
+        input              neg;
+    begin
+        grid_left = neg ? pos[5:0] : 6'd63 - pos[5:0];
+    end
+    endfunction
+
+    // grid_left capped at reach (<= 7).
+    function automatic [2:0] box_reach;
+        input signed [6:0] pos;
+        input              neg;
+        input [3:0]        reach;
+        reg   [5:0]        left;
+    begin
+        left      = grid_left(pos, neg);
+        box_reach = ({2'd0, reach} < left) ? reach[2:0] : left[2:0];
+    end
+    endfunction
+
+    // Crossings on one axis that the DDA takes before the brick-exit
+    // crossing at t_exit; ties go first only for an axis ahead of the exit
+    // axis in X, Y, Z order.
+    function automatic [3:0] brick_steps;
+        input [T_WIDTH-1:0] tmax;
+        input [T_WIDTH-1:0] tdelta;
+        input [T_WIDTH-1:0] t_exit;
+        input               tie_first;
+        reg   [T_WIDTH-1:0] t;
+        integer             c;
+    begin
+        brick_steps = 4'd0;
+        for (c = 0; c < 8; c = c + 1) begin
+            t = t_after(tmax, tdelta, c[3:0]);
+            if (t < t_exit || (tie_first && t == t_exit))
+                brick_steps = brick_steps + 4'd1;
+        end
+    end
+    endfunction
+
+    // --------------------------------------------------------------------
+    // Perspective ray setup helpers (all per axis).
+    // --------------------------------------------------------------------
+    // Two restoring-division steps of 2^24 / mag; returns {rem, q}.
+    function automatic [51:0] recip_step;
+        input [25:0] rem_in;
+        input [25:0] q_in;
+        input [23:0] mag;
+        input [3:0]  cnt;
+        reg   [25:0] rem;
+        reg   [25:0] q;
+        reg   [5:0]  idx;
+        integer      k;
+    begin
+        rem = rem_in;
+        q   = q_in;
+        for (k = 0; k < 2; k = k + 1) begin
+            idx = 6'd25 - {1'b0, cnt, 1'b0} - k[5:0];
+            rem = {rem[24:0], idx == 6'd24};
+            if (rem >= {2'b00, mag}) begin
+                rem = rem - {2'b00, mag};
+                q   = {q[24:0], 1'b1};
+            end else begin
+                q   = {q[24:0], 1'b0};
+            end
+        end
+        recip_step = {rem, q};
+    end
+    endfunction
+
+    // tdelta from the divider: T_INF when the axis is (nearly) never crossed.
+    function automatic [T_WIDTH-1:0] recip_tdelta;
+        input [23:0] mag;
+        input [25:0] q;
+    begin
+        recip_tdelta = (mag == 24'd0 || q >= {2'b00, T_INF}) ? T_INF : q[T_WIDTH-1:0];
+    end
+    endfunction
+
+    // Slab test against [0, 64): {miss, t_near, t_far}.
+    function automatic [2*T_WIDTH:0] clip_axis;
+        input signed [15:0] org;
+        input               neg;
+        input [T_WIDTH-1:0] inv;
+        reg signed [17:0]   dn;
+        reg signed [17:0]   df;
+        reg [47:0]          prod;
+        reg [T_WIDTH-1:0]   t_near;
+        reg [T_WIDTH-1:0]   t_far;
+    begin
+        if (inv == T_INF) begin
+            clip_axis = {(org < 0) || (org >= GRID_END), {T_WIDTH{1'b0}}, T_INF};
+        end else begin
+            dn = neg ? org - GRID_END : 18'sd0 - org;
+            df = neg ? org            : GRID_END - org;
+            prod   = dn[16:0] * inv;
+            t_near = (dn <= 0) ? {T_WIDTH{1'b0}} : t_sat(prod >> 8);
+            prod   = df[16:0] * inv;
+            t_far  = (df <= 0) ? {T_WIDTH{1'b0}} : t_sat(prod >> 8);
+            clip_axis = {df <= 0, t_near, t_far};
+        end
+    end
+    endfunction
+
+    // Voxel holding org + d * t, clamped to the grid.
+    function automatic signed [6:0] enter_voxel;
+        input signed [15:0] org;
+        input signed [23:0] d;
+        input [T_WIDTH-1:0] t;
+        reg signed [48:0]   step;
+        reg signed [49:0]   p;
+    begin
+        step = d * $signed({1'b0, t});
+        p    = org + (step >>> 16);
+        if (p < 0)
+            enter_voxel = 7'sd0;
+        else if (p >= GRID_END)
+            enter_voxel = 7'sd63;
+        else
+            enter_voxel = {1'b0, p[13:8]};
+    end
+    endfunction
+
+    // Ray parameter where it leaves voxel v on this axis.
+    function automatic [T_WIDTH-1:0] first_tmax;
+        input signed [15:0] org;
+        input               neg;
+        input [T_WIDTH-1:0] inv;
+        input [5:0]         v;
+        reg   [6:0]         edge_v;
+        reg signed [17:0]   bound;
+        reg signed [17:0]   dist;
+        reg [47:0]          prod;
+    begin
+        edge_v = {1'b0, v} + (neg ? 7'd0 : 7'd1);
+        bound  = $signed({3'd0, edge_v, 8'd0});
+        dist   = neg ? org - bound : bound - org;
+        prod   = dist[16:0] * inv;
+        if (inv == T_INF)
+            first_tmax = T_INF;
+        else if (dist <= 0)
+            first_tmax = {T_WIDTH{1'b0}};
+        else
+            first_tmax = t_sat(prod >> 8);
+    end
+    endfunction
+
+    // --------------------------------------------------------------------
+    // Tile order helpers. A cell is {ty, tx}; tile (tx, ty) covers pixels
+    // x = 8tx .. 8tx+7 of lane rows 8ty .. 8ty+7, clipped to the screen.
+    // --------------------------------------------------------------------
+    // Cell d of the order: tile rows (1), Morton (2) or Hilbert (3).
+    function automatic [2*TILE_BITS-1:0] tile_cell;
+        input [1:0]             order;
+        input [2*TILE_BITS-1:0] d;
+        reg   [TILE_BITS-1:0]   tx, ty, tmp, mask;
+        reg   [2*TILE_BITS-1:0] t;
+        reg                     rx, ry;
+        integer                 b;
+    begin
+        tx = {TILE_BITS{1'b0}};
+        ty = {TILE_BITS{1'b0}};
+        case (order)
+            2'd2: begin
+                for (b = 0; b < TILE_BITS; b = b + 1) begin
+                    tx[b] = d[2*b];
+                    ty[b] = d[2*b+1];
+                end
+            end
+            2'd3: begin
+                // d2xy: quadrant by quadrant from the finest, rotating the
+                // part already placed.
+                t = d;
+                for (b = 0; b < TILE_BITS; b = b + 1) begin
+                    mask = (1 << b) - 1;
+                    rx   = t[1];
+                    ry   = t[0] ^ t[1];
+                    if (!ry) begin
+                        if (rx) begin
+                            tx = mask - tx;
+                            ty = mask - ty;
+                        end
+                        tmp = tx;
+                        tx  = ty;
+                        ty  = tmp;
+                    end
+                    tx[b] = rx;
+                    ty[b] = ry;
+                    t = t >> 2;
+                end
+            end
+            default: begin
+                tx = d[TILE_BITS-1:0];
+                ty = d[2*TILE_BITS-1:TILE_BITS];
+            end
+        endcase
+        tile_cell = {ty, tx};
+    end
+    endfunction
+
+    function automatic tile_on_screen;
+        input [2*TILE_BITS-1:0] cell;
+    begin
+        tile_on_screen = cell[TILE_BITS-1:0] < TILES_X &&
+                         cell[2*TILE_BITS-1:TILE_BITS] < TILES_Y;
+    end
+    endfunction
+
+    // Lane row index of the tile's first row (8ty).
+    function automatic [10:0] tile_row0;
+        input [2*TILE_BITS-1:0] cell;
+    begin
+        tile_row0 = {cell[2*TILE_BITS-1:TILE_BITS], 3'd0};
+    end
+    endfunction
+
+    function automatic [10:0] tile_left;
+        input [2*TILE_BITS-1:0] cell;
+    begin
+        tile_left = {cell[TILE_BITS-1:0], 3'd0};
+    end
+    endfunction
+
+    function automatic [10:0] tile_right;
+        input [2*TILE_BITS-1:0] cell;
+        reg   [11:0]            x;
+    begin
+        x = tile_left(cell) + 12'd7;
+        tile_right = (x < SCREEN_WIDTH) ? x[10:0] : SCREEN_WIDTH - 1;
+    end
+    endfunction
+
+    function automatic [10:0] tile_top;
+        input [2*TILE_BITS-1:0] cell;
+    begin
+        tile_top = FIRST_ROW + tile_row0(cell) * NUM_LANES;
+    end
+    endfunction
+
+    function automatic [10:0] tile_bottom;
+        input [2*TILE_BITS-1:0] cell;
+        reg   [11:0]            y;
+    begin
+        y = tile_top(cell) + 7 * NUM_LANES;
+        tile_bottom = (y < LAST_ROW) ? y[10:0] : LAST_ROW;
+    end
+    endfunction
+
+    // A channel of the surface seen through what S_BLEND accumulated.
+    function automatic [7:0] comp_over;
+        input [7:0] acc;
+        input [7:0] c;
+        input [8:0] t;
+        reg   [16:0] seen;
+    begin
+        seen      = t * c;
+        comp_over = acc + seen[15:8];
+    end
+    endfunction
+
     // --------------------------------------------------------------------
     // Compute pixel from voxel fields + selection
     // --------------------------------------------------------------------
     task automatic compute_pixel_data;
+        input [63:0] word;
+        input [5:0]  vx;
+        input [5:0]  vy;
+        input [5:0]  vz;
+        input [7:0]  steps;
+        reg [7:0]  voxel_material_props;
+        reg [7:0]  voxel_emissive;
+        reg [7:0]  voxel_light;
+        reg [23:0] voxel_color;
+        reg [3:0]  voxel_material_type;
         reg [8:0] tmp;
         reg [7:0] out_r, out_g, out_b;
         reg [7:0] out_reflection, out_refraction, out_attenuation, out_emission;
@@ -175,6 +812,12 @@ module voxel_raycaster_core_pipelined #(
         reg [7:0] shadow_scale;
         reg [15:0] scaled;
     begin
+        voxel_material_props = word[63:56];
+        voxel_emissive       = word[55:48];
+        voxel_light          = word[39:32];
+        voxel_color          = word[31:8];
+        voxel_material_type  = word[7:4];
+
         // Base lighting
         out_r = (voxel_color[23:16] * voxel_light) >> 8;
         out_g = (voxel_color[15:8]  * voxel_light) >> 8;
@@ -204,7 +847,7 @@ module voxel_raycaster_core_pipelined #(
         else if (voxel_material_type == 4'd2) out_refraction = 8'd85;
         else                                  out_refraction = 8'd0;
 
-        out_attenuation = ray_steps;
+        out_attenuation = steps;
         out_emission    = (voxel_material_type == 4'd1) ? voxel_emissive : 8'd0;
 
         // Normals/curvature are stubbed: up vector unless smooth surfaces enabled
@@ -225,8 +868,8 @@ module voxel_raycaster_core_pipelined #(
         // Simple top-down shadow from the main blob onto the floor plane.
         shadow_hit   = 1'b0;
         shadow_scale = 8'd255;
-        if (voxel_y >= FLOOR_MIN_Y && voxel_y <= FLOOR_MAX_Y) begin
-            shadow_hit   = is_shadowed_floor(voxel_x, voxel_z);
+        if (vy >= FLOOR_MIN_Y && vy <= FLOOR_MAX_Y) begin
+            shadow_hit   = is_shadowed_floor(vx, vz);
             shadow_scale = shadow_hit ? 8'd80 : (8'd180 + (LIGHT_PLANE_Y >> 1)); // brighter with overhead light
 
             scaled = out_r * shadow_scale; out_r = scaled[15:8];
@@ -243,14 +886,20 @@ module voxel_raycaster_core_pipelined #(
 
         // Selection highlight
         if (sel_active &&
-            voxel_x == sel_voxel_x &&
-            voxel_y == sel_voxel_y &&
-            voxel_z == sel_voxel_z) begin
+            vx == sel_voxel_x &&
+            vy == sel_voxel_y &&
+            vz == sel_voxel_z) begin
             tmp = out_r + 9'd96; out_r = (tmp > 9'd255) ? 8'd255 : tmp[7:0];
             tmp = out_g + 9'd16; out_g = (tmp > 9'd255) ? 8'd255 : tmp[7:0];
             tmp = out_b + 9'd96; out_b = (tmp > 9'd255) ? 8'd255 : tmp[7:0];
         end
 
+        if (comp_mode) begin
+            out_r = comp_over(comp_r, out_r, comp_t);
+            out_g = comp_over(comp_g, out_g, comp_t);
+            out_b = comp_over(comp_b, out_b, comp_t);
+        end
+
         // Commit results with non-blocking assignments to keep sequential logic consistent
         pixel_reflection  <= out_reflection;
         pixel_refraction  <= out_refraction;
@@ -275,6 +924,37 @@ module voxel_raycaster_core_pipelined #(
     end
     endtask
 
+    // Sky pixel (dark blue) with slight vertical gradient
+    task automatic sky_pixel;
+        input [10:0] py;
+        reg   [7:0]  sky_r, sky_g, sky_b;
+    begin
+        sky_r = 8'd10 + (py[7:0] >> 3);
+        sky_g = 8'd40 + (py[7:0] >> 3);
+        sky_b = 8'd90 + (py[7:0] >> 2);
+        if (comp_mode) begin
+            sky_r = comp_over(comp_r, sky_r, comp_t);
+            sky_g = comp_over(comp_g, sky_g, comp_t);
+            sky_b = comp_over(comp_b, sky_b, comp_t);
+        end
+        pixel_word0      <= {8'd0, 8'd0, 8'd255, 8'd0};
+        pixel_word1      <= {sky_r, sky_g, sky_b, 8'hFF};
+        pixel_word2      <= {8'd0, 8'd0, 8'd127, 8'd0};
+        pixel_reflection <= 8'd0;
+        pixel_refraction <= 8'd0;
+        pixel_attenuation<= 8'd255;
+        pixel_emission   <= 8'd0;
+        pixel_r          <= sky_r;
+        pixel_g          <= sky_g;
+        pixel_b          <= sky_b;
+        pixel_material_id<= 8'hFF;
+        pixel_normal_x   <= 8'd0;
+        pixel_normal_y   <= 8'd0;
+        pixel_normal_z   <= 8'd127;
+        pixel_curvature  <= 8'd0;
+    end
+    endtask
+
     // --------------------------------------------------------------------
     // Main FSM
     // --------------------------------------------------------------------
@@ -289,6 +969,8 @@ module voxel_raycaster_core_pipelined #(
             pixel_write_en   <= 1'b0;
             voxel_addr       <= 18'd0;
             voxel_read_en    <= 1'b0;
+            trace_addr       <= 18'd0;
+            cursor_fetch     <= 1'b0;
             cursor_hit_valid <= 1'b0;
             cursor_voxel_x   <= 6'd0;
             cursor_voxel_y   <= 6'd0;
@@ -296,24 +978,124 @@ module voxel_raycaster_core_pipelined #(
             cursor_material_id <= 8'd0;
             cursor_voxel_data  <= 64'd0;
             dbg_hit_count    <= 32'd0;
+            dbg_skip_count   <= 32'd0;
+            dbg_ets_count    <= 32'd0;
             slice_idx        <= 2'd0;
             best_hit         <= 1'b0;
-            best_emissive    <= 8'd0;
-        end else begin
+            dda_pending      <= 1'b0;
+            dda_out          <= 1'b0;
+            memo_valid       <= {VOXEL_GRID_SIZE{1'b0}};
+            memo_row         <= 6'd0;
+            pipe_head        <= {PIPE_BITS{1'b0}};
+            pipe_tail        <= {PIPE_BITS{1'b0}};
+            pipe_launched    <= 1'b0;
+            pipe_seek        <= 1'b0;
+            tile_d           <= {2*TILE_BITS{1'b0}};
+            iss_valid        <= 1'b0;
+            ret_valid        <= 1'b0;
+            pay_valid        <= 1'b0;
+            last_read_valid  <= 1'b0;
+            last_hit_valid   <= 1'b0;
+            div_run          <= 1'b0;
+            div_next         <= 1'b0;
+            for (pipe_k = 0; pipe_k < PIPE_SLOTS; pipe_k = pipe_k + 1)
+                slot_state[pipe_k] <= P_FREE;
+        end else if (!stall) begin
             pixel_write_en <= 1'b0;
             voxel_read_en  <= 1'b0;
             done           <= 1'b0;
+            cursor_fetch   <= 1'b0;
+            if (voxel_read_en)
+                trace_addr <= voxel_addr;
+            if (cursor_fetch)
+                cursor_voxel_data <= payload_data;
+            iss_valid      <= 1'b0;
+            ret_valid      <= iss_valid;
+            ret_slot       <= iss_slot;
+            ret_x          <= iss_x;
+            pay_valid      <= 1'b0;
+
+            // 1/|d| per axis, two quotient bits per cycle, whatever the
+            // state; S_RENDER_PIXEL and S_RAY_CLIP load it.
+            if (div_run) begin
+                {div_rem_x, div_q_x} <= recip_step(div_rem_x, div_q_x, div_mag_x, div_cnt);
+                {div_rem_y, div_q_y} <= recip_step(div_rem_y, div_q_y, div_mag_y, div_cnt);
+                {div_rem_z, div_q_z} <= recip_step(div_rem_z, div_q_z, div_mag_z, div_cnt);
+                div_cnt <= div_cnt + 1'b1;
+                if (div_cnt == RECIP_CYCLES - 1)
+                    div_run <= 1'b0;
+            end
 
             case (state)
                 S_IDLE: begin
                     if (start) begin
                         busy             <= 1'b1;
                         pixel_x          <= 11'd0;
-                        pixel_y          <= 11'd0;
+                        pixel_y          <= FIRST_ROW;
                         cursor_hit_valid <= 1'b0;
                         cursor_voxel_data<= 64'd0;
                         dbg_hit_count    <= 32'd0;
-                        state            <= S_RENDER_PIXEL;
+                        dbg_skip_count   <= 32'd0;
+                        dbg_ets_count    <= 32'd0;
+                        memo_valid       <= {VOXEL_GRID_SIZE{1'b0}};
+                        tile_d           <= {2*TILE_BITS{1'b0}};
+                        div_run          <= 1'b0;
+                        div_next         <= 1'b0;
+                        state            <= tile_mode ? S_NEXT_TILE : S_RENDER_PIXEL;
+
+                        // Perspective basis for the frame, in voxel axes.
+                        begin : cam_setup
+                            reg signed [31:0] fx, fy, fz, ux, uy, uz;
+                            reg signed [31:0] rdx, rdz, udx, udy, udz;
+                            reg signed [31:0] row_x, row_y, row_z;
+                            reg signed [47:0] wide;
+                            fx = cam_dir_x;
+                            fy = cam_dir_z;
+                            fz = cam_dir_y;
+                            ux = (32'sd0 - cam_plane_y * cam_dir_z) >>> 8;
+                            uz = (cam_plane_x * cam_dir_z) >>> 8;
+                            uy = (cam_plane_y * cam_dir_x - cam_plane_x * cam_dir_y) >>> 8;
+                            wide = cam_plane_x; wide = (wide <<< 17) / SCREEN_WIDTH; rdx = wide[31:0];
+                            wide = cam_plane_y; wide = (wide <<< 17) / SCREEN_WIDTH; rdz = wide[31:0];
+                            wide = ux;          wide = (wide <<< 17) / SCREEN_WIDTH; udx = wide[31:0];
+                            wide = uy;          wide = (wide <<< 17) / SCREEN_WIDTH; udy = wide[31:0];
+                            wide = uz;          wide = (wide <<< 17) / SCREEN_WIDTH; udz = wide[31:0];
+                            row_x = (fx <<< 16) - (SCREEN_WIDTH/2) * rdx + (SCREEN_HEIGHT/2 - LANE) * udx;
+                            row_y = (fy <<< 16)                         + (SCREEN_HEIGHT/2 - LANE) * udy;
+                            row_z = (fz <<< 16) - (SCREEN_WIDTH/2) * rdz + (SCREEN_HEIGHT/2 - LANE) * udz;
+                            ray_dx_x  <= rdx;
+                            ray_dx_y  <= 32'sd0;
+                            ray_dx_z  <= rdz;
+                            ray_du_x  <= udx * NUM_LANES;
+                            ray_du_y  <= udy * NUM_LANES;
+                            ray_du_z  <= udz * NUM_LANES;
+                            ray_base_x <= row_x;
+                            ray_base_y <= row_y;
+                            ray_base_z <= row_z;
+                            ray_row_x <= row_x;
+                            ray_row_y <= row_y;
+                            ray_row_z <= row_z;
+                            ray_dir_x <= row_x;
+                            ray_dir_y <= row_y;
+                            ray_dir_z <= row_z;
+                            org_x <= cam_x;
+                            org_y <= cam_z;
+                            org_z <= cam_y;
+                        end
+
+                        if (pipe_mode) begin
+                            pipe_head       <= {PIPE_BITS{1'b0}};
+                            pipe_tail       <= {PIPE_BITS{1'b0}};
+                            pipe_lx         <= 11'd0;
+                            pipe_ly         <= FIRST_ROW;
+                            pipe_launched   <= 1'b0;
+                            pipe_seek       <= tile_mode;
+                            last_read_valid <= 1'b0;
+                            last_hit_valid  <= 1'b0;
+                            for (pipe_k = 0; pipe_k < PIPE_SLOTS; pipe_k = pipe_k + 1)
+                                slot_state[pipe_k] <= P_FREE;
+                            state <= S_PIPE;
+                        end
                     end
                 end
 
@@ -323,25 +1105,172 @@ module voxel_raycaster_core_pipelined #(
                     hit         <= 1'b0;
                     slice_idx   <= 2'd0;
                     best_hit    <= 1'b0;
-                    best_emissive <= 8'd0;
+                    comp_t      <= 9'd256;
+                    comp_r      <= 8'd0;
+                    comp_g      <= 8'd0;
+                    comp_b      <= 8'd0;
 
                     // Deterministic orthographic scan: map screen to Y/Z, march along -X
-                    begin : dir_calc
-                        reg [17:0] map_y;
-                        reg [17:0] map_z;
-                        map_y = ((SCREEN_HEIGHT-1 - pixel_y) * (VOXEL_GRID_SIZE-1)) / (SCREEN_HEIGHT-1);
-                        map_z = (pixel_x * (VOXEL_GRID_SIZE-1)) / (SCREEN_WIDTH-1);
-
-                        ray_pos_x <= (VOXEL_GRID_SIZE-1) <<< FRAC_BITS;
-                        ray_pos_y <= map_y <<< FRAC_BITS;
-                        ray_pos_z <= map_z <<< FRAC_BITS;
-                        map_voxel_y <= map_y[5:0];
-                        map_voxel_z <= map_z[5:0];
+                    ray_pos_x <= (VOXEL_GRID_SIZE-1) <<< FRAC_BITS;
+                    ray_pos_y <= pix_map_y <<< FRAC_BITS;
+                    ray_pos_z <= pix_map_z <<< FRAC_BITS;
+                    map_voxel_y <= pix_map_y[5:0];
+                    map_voxel_z <= pix_map_z[5:0];
+
+                    // DDA: same orthographic ray, from the centre of voxel
+                    // (63, map_y, map_z) along -X. The stepping below works
+                    // for any direction.
+                    begin : dda_setup
+                        reg signed [15:0] dir_x, dir_y, dir_z;
+                        reg [T_WIDTH-1:0] td_x, td_y, td_z;
+                        dir_x = -16'sd256;
+                        dir_y = 16'sd0;
+                        dir_z = 16'sd0;
+                        td_x  = dda_tdelta(dir_x);
+                        td_y  = dda_tdelta(dir_y);
+                        td_z  = dda_tdelta(dir_z);
+                        dda_x        <= 7'sd63;
+                        dda_y        <= {1'b0, pix_map_y[5:0]};
+                        dda_z        <= {1'b0, pix_map_z[5:0]};
+                        dda_neg_x    <= dir_x[15];
+                        dda_neg_y    <= dir_y[15];
+                        dda_neg_z    <= dir_z[15];
+                        dda_tdelta_x <= td_x;
+                        dda_tdelta_y <= td_y;
+                        dda_tdelta_z <= td_z;
+                        dda_tmax_x   <= dda_tmax0(dir_x, 8'd128, td_x);
+                        dda_tmax_y   <= dda_tmax0(dir_y, 8'd128, td_y);
+                        dda_tmax_z   <= dda_tmax0(dir_z, 8'd128, td_z);
+                        dda_pending  <= 1'b0;
+                        dda_out      <= 1'b0;
                     end
 
                     cursor_sample <= (pixel_x == (SCREEN_WIDTH  >> 1)) &&
                                      (pixel_y == (SCREEN_HEIGHT >> 1));
 
+                    if (persp_mode && !diag_slice_mode) begin
+                        ray_d_x   <= ray_dir_x[31:8];
+                        ray_d_y   <= ray_dir_y[31:8];
+                        ray_d_z   <= ray_dir_z[31:8];
+                        dda_neg_x <= ray_dir_x[31];
+                        dda_neg_y <= ray_dir_y[31];
+                        dda_neg_z <= ray_dir_z[31];
+                        if (div_next) begin
+                            // Started for this direction during the last ray.
+                            div_next <= 1'b0;
+                            state    <= (!div_run || div_cnt == RECIP_CYCLES - 1) ? S_RAY_CLIP
+                                                                                 : S_RAY_DIV;
+                        end else begin
+                            div_mag_x <= ray_dir_x[31] ? -ray_dir_x[31:8] : ray_dir_x[31:8];
+                            div_mag_y <= ray_dir_y[31] ? -ray_dir_y[31:8] : ray_dir_y[31:8];
+                            div_mag_z <= ray_dir_z[31] ? -ray_dir_z[31:8] : ray_dir_z[31:8];
+                            div_rem_x <= 26'd0; div_rem_y <= 26'd0; div_rem_z <= 26'd0;
+                            div_q_x   <= 26'd0; div_q_y   <= 26'd0; div_q_z   <= 26'd0;
+                            div_cnt   <= 4'd0;
+                            div_run   <= 1'b1;
+                            state     <= S_RAY_DIV;
+                        end
+                    end else begin
+                        state <= S_STEP;
+                    end
+
+                    begin : memo_lookup
+                        reg [95:0] words;
+                        reg        new_row;
+                        reg [7:0]  sky_r, sky_g, sky_b;
+                        words   = memo_words[pix_map_z[5:0]];
+                        new_row = pix_map_y[5:0] != memo_row;
+                        sky_r   = 8'd10 + (pixel_y[7:0] >> 3);
+                        sky_g   = 8'd40 + (pixel_y[7:0] >> 3);
+                        sky_b   = 8'd90 + (pixel_y[7:0] >> 2);
+                        if (new_row) begin
+                            memo_valid <= {VOXEL_GRID_SIZE{1'b0}};
+                            memo_row   <= pix_map_y[5:0];
+                        end
+                        if (memo_mode && !new_row && memo_valid[pix_map_z[5:0]] &&
+                            !((pixel_x == (SCREEN_WIDTH >> 1)) && (pixel_y == (SCREEN_HEIGHT >> 1)))) begin
+                            pixel_word0 <= words[95:64];
+                            pixel_word2 <= words[31:0];
+                            if (words[39:32] == 8'hFF) begin
+                                pixel_word1 <= {sky_r, sky_g, sky_b, 8'hFF};
+                            end else begin
+                                pixel_word1   <= words[63:32];
+                                dbg_hit_count <= dbg_hit_count + 1'b1;
+                            end
+                            state <= S_WRITE;
+                        end
+                    end
+                end
+
+                // Wait for the divider's last step.
+                S_RAY_DIV: begin
+                    if (div_cnt == RECIP_CYCLES - 1)
+                        state <= S_RAY_CLIP;
+                end
+
+                // Clip against the grid: a miss goes straight to sky without
+                // a single read.
+                S_RAY_CLIP: begin
+                    begin : ray_clip
+                        reg [T_WIDTH-1:0] ix, iy, iz;
+                        reg [2*T_WIDTH:0] cx, cy, cz;
+                        reg [T_WIDTH-1:0] t_in, t_out;
+                        ix = recip_tdelta(div_mag_x, div_q_x);
+                        iy = recip_tdelta(div_mag_y, div_q_y);
+                        iz = recip_tdelta(div_mag_z, div_q_z);
+                        cx = clip_axis(org_x, dda_neg_x, ix);
+                        cy = clip_axis(org_y, dda_neg_y, iy);
+                        cz = clip_axis(org_z, dda_neg_z, iz);
+                        t_in  = cx[2*T_WIDTH-1:T_WIDTH];
+                        if (cy[2*T_WIDTH-1:T_WIDTH] > t_in) t_in = cy[2*T_WIDTH-1:T_WIDTH];
+                        if (cz[2*T_WIDTH-1:T_WIDTH] > t_in) t_in = cz[2*T_WIDTH-1:T_WIDTH];
+                        t_out = cx[T_WIDTH-1:0];
+                        if (cy[T_WIDTH-1:0] < t_out) t_out = cy[T_WIDTH-1:0];
+                        if (cz[T_WIDTH-1:0] < t_out) t_out = cz[T_WIDTH-1:0];
+                        dda_tdelta_x <= ix;
+                        dda_tdelta_y <= iy;
+                        dda_tdelta_z <= iz;
+                        clip_t_enter <= t_in;
+                        dda_out      <= cx[2*T_WIDTH] | cy[2*T_WIDTH] | cz[2*T_WIDTH] | (t_in >= t_out);
+                    end
+
+                    // The quotients are taken: start on the direction
+                    // S_NEXT_PIXEL will step to, unless it leaves the tile
+                    // or ends the frame.
+                    begin : div_prefetch
+                        reg               in_row, more;
+                        reg signed [31:0] nx, ny, nz;
+                        in_row = tile_mode ? pixel_x != tile_x1 : pixel_x != SCREEN_WIDTH-1;
+                        more   = tile_mode ? in_row || pixel_y != tile_y1
+                                           : in_row || pixel_y != LAST_ROW;
+                        nx = in_row ? ray_dir_x + ray_dx_x : ray_row_x - ray_du_x;
+                        ny = in_row ? ray_dir_y + ray_dx_y : ray_row_y - ray_du_y;
+                        nz = in_row ? ray_dir_z + ray_dx_z : ray_row_z - ray_du_z;
+                        if (more) begin
+                            div_mag_x <= nx[31] ? -nx[31:8] : nx[31:8];
+                            div_mag_y <= ny[31] ? -ny[31:8] : ny[31:8];
+                            div_mag_z <= nz[31] ? -nz[31:8] : nz[31:8];
+                            div_rem_x <= 26'd0; div_rem_y <= 26'd0; div_rem_z <= 26'd0;
+                            div_q_x   <= 26'd0; div_q_y   <= 26'd0; div_q_z   <= 26'd0;
+                            div_cnt   <= 4'd0;
+                            div_run   <= 1'b1;
+                            div_next  <= 1'b1;
+                        end
+                    end
+                    state <= S_RAY_ENTER;
+                end
+
+                S_RAY_ENTER: begin
+                    dda_x <= enter_voxel(org_x, ray_d_x, clip_t_enter);
+                    dda_y <= enter_voxel(org_y, ray_d_y, clip_t_enter);
+                    dda_z <= enter_voxel(org_z, ray_d_z, clip_t_enter);
+                    state <= S_RAY_TMAX;
+                end
+
+                S_RAY_TMAX: begin
+                    dda_tmax_x <= first_tmax(org_x, dda_neg_x, dda_tdelta_x, dda_x[5:0]);
+                    dda_tmax_y <= first_tmax(org_y, dda_neg_y, dda_tdelta_y, dda_y[5:0]);
+                    dda_tmax_z <= first_tmax(org_z, dda_neg_z, dda_tdelta_z, dda_z[5:0]);
                     state <= S_STEP;
                 end
 
@@ -350,30 +1279,11 @@ module voxel_raycaster_core_pipelined #(
                     if (diag_slice_mode) begin
                         if (slice_idx >= NUM_SLICES[2:0]) begin
                             if (!best_hit) begin
-                                // sky pixel (dark blue) with slight vertical gradient
-                                reg [7:0] sky_r, sky_g, sky_b;
-                                sky_r = 8'd10 + (pixel_y[7:0] >> 3);
-                                sky_g = 8'd40 + (pixel_y[7:0] >> 3);
-                                sky_b = 8'd90 + (pixel_y[7:0] >> 2);
-                                pixel_word0      <= {8'd0, 8'd0, 8'd255, 8'd0};
-                                pixel_word1      <= {sky_r, sky_g, sky_b, 8'hFF};
-                                pixel_word2      <= {8'd0, 8'd0, 8'd127, 8'd0};
-                                pixel_reflection <= 8'd0;
-                                pixel_refraction <= 8'd0;
-                                pixel_attenuation<= 8'd255;
-                                pixel_emission   <= 8'd0;
-                                pixel_r          <= sky_r;
-                                pixel_g          <= sky_g;
-                                pixel_b          <= sky_b;
-                                pixel_material_id<= 8'hFF;
-                                pixel_normal_x   <= 8'd0;
-                                pixel_normal_y   <= 8'd0;
-                                pixel_normal_z   <= 8'd127;
-                                pixel_curvature  <= 8'd0;
+                                sky_pixel(pixel_y);
                                 state            <= S_WRITE;
                             end else begin
                                 hit <= best_hit;
-                                compute_pixel_data();
+                                compute_pixel_data(payload_data, voxel_x, voxel_y, voxel_z, ray_steps);
                                 state <= S_WRITE;
                             end
                         end else begin
@@ -397,34 +1307,120 @@ module voxel_raycaster_core_pipelined #(
                             // Move to next slice (ray_steps mirrors slice count for attenuation)
                             ray_steps <= slice_idx + 1'b1;
                         end
+                    end else if (dda_walk) begin
+                        // Test the word read for the previous voxel (it is
+                        // valid now), then issue the read for the next one.
+                        if (dda_pending && trace_solid && trace_glass && comp_mode) begin
+                            // payload_read_en fetches the word for S_BLEND.
+                            dda_pending <= 1'b0;
+                            state       <= S_BLEND;
+                        end else if (dda_pending && trace_solid) begin
+                            // payload_read_en fetches the word this cycle.
+                            hit           <= 1'b1;
+                            dda_pending   <= 1'b0;
+                            dbg_hit_count <= dbg_hit_count + 1'b1;
+
+                            if (cursor_sample && !cursor_hit_valid) begin
+                                cursor_hit_valid    <= 1'b1;
+                                cursor_voxel_x      <= voxel_x;
+                                cursor_voxel_y      <= voxel_y;
+                                cursor_voxel_z      <= voxel_z;
+                                cursor_fetch        <= 1'b1;
+                            end
+                            state <= S_SHADE;
+                        end else if (dda_out || ray_steps >= DDA_MAX_STEPS) begin
+                            sky_pixel(pixel_y);
+                            dda_pending      <= 1'b0;
+                            state            <= S_WRITE;
+                        end else if ((skip_mode && !brick_occupied) ||
+                                     (sdf_mode && dda_pending && voxel_trace[3:0] >= 4'd2)) begin
+                            // Cross an empty box without reading it: the rest
+                            // of the brick, or the distance field's cube.
+                            reg               brick;
+                            reg [2:0]         rx, ry, rz;
+                            reg [T_WIDTH-1:0] ex, ey, ez;
+                            reg [3:0]         nx, ny, nz;
+                            reg               exit_x, exit_y;
+                            brick = skip_mode && !brick_occupied;
+                            if (brick) begin
+                                rx = dda_neg_x ? dda_x[2:0] : ~dda_x[2:0];
+                                ry = dda_neg_y ? dda_y[2:0] : ~dda_y[2:0];
+                                rz = dda_neg_z ? dda_z[2:0] : ~dda_z[2:0];
+                            end else begin
+                                rx = box_reach(dda_x, dda_neg_x, sdf_reach);
+                                ry = box_reach(dda_y, dda_neg_y, sdf_reach);
+                                rz = box_reach(dda_z, dda_neg_z, sdf_reach);
+                            end
+                            ex = t_after(dda_tmax_x, dda_tdelta_x, {1'b0, rx});
+                            ey = t_after(dda_tmax_y, dda_tdelta_y, {1'b0, ry});
+                            ez = t_after(dda_tmax_z, dda_tdelta_z, {1'b0, rz});
+                            exit_x = ex <= ey && ex <= ez;
+                            exit_y = !exit_x && ey <= ez;
+                            // The exit crossing leaves the grid when the box
+                            // reaches its edge.
+                            if (exit_x) begin
+                                nx = {1'b0, rx} + 4'd1;
+                                ny = brick_steps(dda_tmax_y, dda_tdelta_y, ex, 1'b0);
+                                nz = brick_steps(dda_tmax_z, dda_tdelta_z, ex, 1'b0);
+                                dda_out <= {3'd0, rx} == grid_left(dda_x, dda_neg_x);
+                            end else if (exit_y) begin
+                                nx = brick_steps(dda_tmax_x, dda_tdelta_x, ey, 1'b1);
+                                ny = {1'b0, ry} + 4'd1;
+                                nz = brick_steps(dda_tmax_z, dda_tdelta_z, ey, 1'b0);
+                                dda_out <= {3'd0, ry} == grid_left(dda_y, dda_neg_y);
+                            end else begin
+                                nx = brick_steps(dda_tmax_x, dda_tdelta_x, ez, 1'b1);
+                                ny = brick_steps(dda_tmax_y, dda_tdelta_y, ez, 1'b1);
+                                nz = {1'b0, rz} + 4'd1;
+                                dda_out <= {3'd0, rz} == grid_left(dda_z, dda_neg_z);
+                            end
+                            dda_x      <= dda_neg_x ? dda_x - $signed({3'd0, nx}) : dda_x + $signed({3'd0, nx});
+                            dda_y      <= dda_neg_y ? dda_y - $signed({3'd0, ny}) : dda_y + $signed({3'd0, ny});
+                            dda_z      <= dda_neg_z ? dda_z - $signed({3'd0, nz}) : dda_z + $signed({3'd0, nz});
+                            dda_tmax_x <= t_after(dda_tmax_x, dda_tdelta_x, nx);
+                            dda_tmax_y <= t_after(dda_tmax_y, dda_tdelta_y, ny);
+                            dda_tmax_z <= t_after(dda_tmax_z, dda_tdelta_z, nz);
+                            ray_steps   <= ray_steps + nx + ny + nz;
+                            dda_pending <= 1'b0;
+                            if (brick)
+                                dbg_skip_count <= dbg_skip_count + 1'b1;
+                        end else begin
+                            voxel_x       <= dda_x[5:0];
+                            voxel_y       <= dda_y[5:0];
+                            voxel_z       <= dda_z[5:0];
+                            voxel_addr    <= {dda_x[5:0], dda_y[5:0], dda_z[5:0]};
+                            voxel_read_en <= 1'b1;
+                            dda_pending   <= 1'b1;
+                            ray_steps     <= ray_steps + 1'b1;
+                            state         <= S_FETCH;
+                        end
                     end else begin
                         if (ray_steps >= 8'd128 || hit) begin
                             if (!hit) begin
-                                // sky pixel (dark blue) with slight vertical gradient
-                                reg [7:0] sky_r, sky_g, sky_b;
-                                sky_r = 8'd10 + (pixel_y[7:0] >> 3);
-                                sky_g = 8'd40 + (pixel_y[7:0] >> 3);
-                                sky_b = 8'd90 + (pixel_y[7:0] >> 2);
-                                pixel_word0      <= {8'd0, 8'd0, 8'd255, 8'd0};
-                                pixel_word1      <= {sky_r, sky_g, sky_b, 8'hFF};
-                                pixel_word2      <= {8'd0, 8'd0, 8'd127, 8'd0};
-                                pixel_reflection <= 8'd0;
-                                pixel_refraction <= 8'd0;
-                                pixel_attenuation<= 8'd255;
-                                pixel_emission   <= 8'd0;
-                                pixel_r          <= sky_r;
-                                pixel_g          <= sky_g;
-                                pixel_b          <= sky_b;
-                                pixel_material_id<= 8'hFF;
-                                pixel_normal_x   <= 8'd0;
-                                pixel_normal_y   <= 8'd0;
-                                pixel_normal_z   <= 8'd127;
-                                pixel_curvature  <= 8'd0;
+                                sky_pixel(pixel_y);
                                 state            <= S_WRITE;
                             end else begin
-                                compute_pixel_data();
+                                compute_pixel_data(payload_data, voxel_x, voxel_y, voxel_z, ray_steps);
                                 state <= S_WRITE;
                             end
+                        end else if (skip_mode && !brick_occupied && !trace_solid) begin
+                            // Empty brick: on to the first sample below it. The
+                            // last sample (pos -0.5, wrapped to x = 63) is the
+                            // only one with a negative position.
+                            reg signed [ACC_WIDTH-1:0] base;
+                            reg signed [ACC_WIDTH-1:0] past;
+                            base = $signed({{(ACC_WIDTH-FRAC_BITS-6){1'b0}},
+                                            ray_pos_x[FRAC_BITS+5:FRAC_BITS+3], 3'd0,
+                                            {FRAC_BITS{1'b0}}});
+                            past = (ray_pos_x - base) >>> (FRAC_BITS-1);
+                            if (ray_pos_x < 0) begin
+                                ray_pos_x <= ray_pos_x - (18'sd1 <<< (FRAC_BITS-1));
+                                ray_steps <= ray_steps + 1'b1;
+                            end else begin
+                                ray_pos_x <= base - (18'sd1 <<< (FRAC_BITS-1));
+                                ray_steps <= ray_steps + past[7:0] + 1'b1;
+                            end
+                            dbg_skip_count <= dbg_skip_count + 1'b1;
                         end else begin
                             // Sample current ray position -> voxel coords (wrap into 0..63)
                             reg signed [ACC_WIDTH-1:0] wide_x;
@@ -459,48 +1455,51 @@ module voxel_raycaster_core_pipelined #(
                 S_FETCH: begin
                     // Sample, test occupancy
                     if (diag_slice_mode) begin
-                        if (voxel_data != 64'd0 && voxel_data[47:40] > 8'd10 && !best_hit) begin
+                        if (trace_solid && !best_hit) begin
                             best_hit         <= 1'b1;
-                            best_emissive    <= voxel_data[55:48];
                             hit              <= 1'b1;
                             dbg_hit_count    <= dbg_hit_count + 1'b1;
 
-                            voxel_material_props <= voxel_data[63:56];
-                            voxel_emissive       <= voxel_data[55:48];
-                            voxel_alpha          <= voxel_data[47:40];
-                            voxel_light          <= voxel_data[39:32];
-                            voxel_color          <= voxel_data[31:8];
-                            voxel_material_type  <= voxel_data[7:4];
-
+                            // Still the previous hit's type: the payload
+                            // read for this one lands next cycle.
                             if (cursor_sample && !cursor_hit_valid) begin
                                 cursor_hit_valid    <= 1'b1;
                                 cursor_voxel_x      <= voxel_x;
                                 cursor_voxel_y      <= voxel_y;
                                 cursor_voxel_z      <= voxel_z;
                                 cursor_material_id  <= {voxel_material_type, 4'h0};
-                                cursor_voxel_data   <= voxel_data;
+                                cursor_fetch        <= 1'b1;
                             end
                         end
                         slice_idx <= slice_idx + 1'b1;
+                    end else if (dda_walk) begin
+                        // The read is still in flight; advance to the next
+                        // voxel across the nearest boundary (ties: X, Y, Z).
+                        if (dda_tmax_x <= dda_tmax_y && dda_tmax_x <= dda_tmax_z) begin
+                            dda_x      <= dda_neg_x ? dda_x - 7'sd1 : dda_x + 7'sd1;
+                            dda_tmax_x <= t_add(dda_tmax_x, dda_tdelta_x);
+                            dda_out    <= dda_neg_x ? (dda_x == 7'sd0) : (dda_x == 7'sd63);
+                        end else if (dda_tmax_y <= dda_tmax_z) begin
+                            dda_y      <= dda_neg_y ? dda_y - 7'sd1 : dda_y + 7'sd1;
+                            dda_tmax_y <= t_add(dda_tmax_y, dda_tdelta_y);
+                            dda_out    <= dda_neg_y ? (dda_y == 7'sd0) : (dda_y == 7'sd63);
+                        end else begin
+                            dda_z      <= dda_neg_z ? dda_z - 7'sd1 : dda_z + 7'sd1;
+                            dda_tmax_z <= t_add(dda_tmax_z, dda_tdelta_z);
+                            dda_out    <= dda_neg_z ? (dda_z == 7'sd0) : (dda_z == 7'sd63);
+                        end
                     end else begin
-                        if (!hit && voxel_data != 64'd0 && voxel_data[47:40] > 8'd10) begin
+                        if (!hit && trace_solid) begin
                             hit <= 1'b1;
                             dbg_hit_count <= dbg_hit_count + 1'b1;
 
-                            voxel_material_props <= voxel_data[63:56];
-                            voxel_emissive       <= voxel_data[55:48];
-                            voxel_alpha          <= voxel_data[47:40];
-                            voxel_light          <= voxel_data[39:32];
-                            voxel_color          <= voxel_data[31:8];
-                            voxel_material_type  <= voxel_data[7:4];
-
                             if (cursor_sample && !cursor_hit_valid) begin
                                 cursor_hit_valid    <= 1'b1;
                                 cursor_voxel_x      <= voxel_x;
                                 cursor_voxel_y      <= voxel_y;
                                 cursor_voxel_z      <= voxel_z;
                                 cursor_material_id  <= {voxel_material_type, 4'h0};
-                                cursor_voxel_data   <= voxel_data;
+                                cursor_fetch        <= 1'b1;
                             end
                         end
                     end
@@ -508,30 +1507,320 @@ module voxel_raycaster_core_pipelined #(
                     state <= S_STEP;
                 end
 
+                // Composite: the translucent voxel S_STEP found, its payload
+                // word read last cycle (see "Composite" above).
+                S_BLEND: begin
+                    begin : blend
+                        reg [16:0] wide;
+                        reg [8:0]  contrib;
+                        reg [8:0]  t_next;
+                        reg [5:0]  left;
+                        wide    = comp_t * payload_data[47:40];
+                        contrib = {1'b0, wide[15:8]};
+                        t_next  = comp_t - contrib;
+                        if (9'd256 - t_next >= {1'b0, comp_threshold}) begin
+                            left = 6'd63;
+                            if (dda_tdelta_x != T_INF && grid_left({1'b0, voxel_x}, dda_neg_x) < left)
+                                left = grid_left({1'b0, voxel_x}, dda_neg_x);
+                            if (dda_tdelta_y != T_INF && grid_left({1'b0, voxel_y}, dda_neg_y) < left)
+                                left = grid_left({1'b0, voxel_y}, dda_neg_y);
+                            if (dda_tdelta_z != T_INF && grid_left({1'b0, voxel_z}, dda_neg_z) < left)
+                                left = grid_left({1'b0, voxel_z}, dda_neg_z);
+                            dbg_ets_count <= dbg_ets_count + left;
+                            hit           <= 1'b1;
+                            dbg_hit_count <= dbg_hit_count + 1'b1;
+
+                            // payload_data holds the word for S_SHADE.
+                            if (cursor_sample && !cursor_hit_valid) begin
+                                cursor_hit_valid    <= 1'b1;
+                                cursor_voxel_x      <= voxel_x;
+                                cursor_voxel_y      <= voxel_y;
+                                cursor_voxel_z      <= voxel_z;
+                                cursor_fetch        <= 1'b1;
+                            end
+                            state <= S_SHADE;
+                        end else begin
+                            wide   = contrib * payload_data[31:24];
+                            comp_r <= comp_r + wide[15:8];
+                            wide   = contrib * payload_data[23:16];
+                            comp_g <= comp_g + wide[15:8];
+                            wide   = contrib * payload_data[15:8];
+                            comp_b <= comp_b + wide[15:8];
+                            comp_t <= t_next;
+                            state  <= S_STEP;
+                        end
+                    end
+                end
+
+                // DDA hit: the payload word read last cycle. DDA has no fetch
+                // skew, so the cursor takes the hit's own type.
+                S_SHADE: begin
+                    if (cursor_fetch)
+                        cursor_material_id <= {voxel_material_type, 4'h0};
+                    compute_pixel_data(payload_data, voxel_x, voxel_y, voxel_z, ray_steps);
+                    state <= S_WRITE;
+                end
+
                 S_WRITE: begin
                     pixel_addr     <= pixel_y * SCREEN_WIDTH + pixel_x;
                     pixel_write_en <= 1'b1;
+                    if (memo_mode && !memo_valid[map_voxel_z]) begin
+                        memo_words[map_voxel_z] <= {pixel_word0, pixel_word1, pixel_word2};
+                        memo_valid[map_voxel_z] <= 1'b1;
+                    end
                     state          <= S_NEXT_PIXEL;
                 end
 
                 S_NEXT_PIXEL: begin
-                    if (pixel_x == SCREEN_WIDTH-1) begin
-                        pixel_x <= 11'd0;
-                        if (pixel_y == SCREEN_HEIGHT-1) begin
+                    if (tile_mode) begin
+                        if (pixel_x != tile_x1) begin
+                            pixel_x   <= pixel_x + 1'b1;
+                            ray_dir_x <= ray_dir_x + ray_dx_x;
+                            ray_dir_y <= ray_dir_y + ray_dx_y;
+                            ray_dir_z <= ray_dir_z + ray_dx_z;
+                            state     <= S_RENDER_PIXEL;
+                        end else if (pixel_y != tile_y1) begin
+                            pixel_x   <= tile_x0;
+                            pixel_y   <= pixel_y + NUM_LANES;
+                            ray_row_x <= ray_row_x - ray_du_x;
+                            ray_row_y <= ray_row_y - ray_du_y;
+                            ray_row_z <= ray_row_z - ray_du_z;
+                            ray_dir_x <= ray_row_x - ray_du_x;
+                            ray_dir_y <= ray_row_y - ray_du_y;
+                            ray_dir_z <= ray_row_z - ray_du_z;
+                            state     <= S_RENDER_PIXEL;
+                        end else if (tile_d == {2*TILE_BITS{1'b0}}) begin
+                            // The last cell was this tile.
+                            pixel_x <= 11'd0;
                             pixel_y <= 11'd0;
                             busy    <= 1'b0;
                             done    <= 1'b1;
                             state   <= S_IDLE;
                         end else begin
-                            pixel_y <= pixel_y + 1'b1;
-                            state   <= S_RENDER_PIXEL;
+                            state   <= S_NEXT_TILE;
                         end
                     end else begin
-                        pixel_x <= pixel_x + 1'b1;
-                        state   <= S_RENDER_PIXEL;
+                        if (pixel_x == SCREEN_WIDTH-1) begin
+                            pixel_x   <= 11'd0;
+                            ray_row_x <= ray_row_x - ray_du_x;
+                            ray_row_y <= ray_row_y - ray_du_y;
+                            ray_row_z <= ray_row_z - ray_du_z;
+                            ray_dir_x <= ray_row_x - ray_du_x;
+                            ray_dir_y <= ray_row_y - ray_du_y;
+                            ray_dir_z <= ray_row_z - ray_du_z;
+                            if (pixel_y == LAST_ROW) begin
+                                pixel_y <= 11'd0;
+                                busy    <= 1'b0;
+                                done    <= 1'b1;
+                                state   <= S_IDLE;
+                            end else begin
+                                pixel_y <= pixel_y + NUM_LANES;
+                                state   <= S_RENDER_PIXEL;
+                            end
+                        end else begin
+                            pixel_x   <= pixel_x + 1'b1;
+                            ray_dir_x <= ray_dir_x + ray_dx_x;
+                            ray_dir_y <= ray_dir_y + ray_dx_y;
+                            ray_dir_z <= ray_dir_z + ray_dx_z;
+                            state     <= S_RENDER_PIXEL;
+                        end
                     end
                 end
 
+                // Tile order: test cell tile_d; a tile on screen starts at
+                // its top-left pixel, with the perspective direction of that
+                // pixel rebuilt from the frame's base.
+                S_NEXT_TILE: begin : next_tile
+                    reg [2*TILE_BITS-1:0] cell;
+                    reg signed [31:0]     k0, x0;
+                    cell   = tile_cell(tile_order, tile_d);
+                    k0     = {21'd0, tile_row0(cell)};
+                    x0     = {21'd0, tile_left(cell)};
+                    tile_d <= tile_d + 1'b1;
+                    if (tile_on_screen(cell)) begin
+                        pixel_x   <= tile_left(cell);
+                        pixel_y   <= tile_top(cell);
+                        tile_x0   <= tile_left(cell);
+                        tile_x1   <= tile_right(cell);
+                        tile_y1   <= tile_bottom(cell);
+                        ray_row_x <= ray_base_x - k0 * ray_du_x + x0 * ray_dx_x;
+                        ray_row_y <= ray_base_y - k0 * ray_du_y + x0 * ray_dx_y;
+                        ray_row_z <= ray_base_z - k0 * ray_du_z + x0 * ray_dx_z;
+                        ray_dir_x <= ray_base_x - k0 * ray_du_x + x0 * ray_dx_x;
+                        ray_dir_y <= ray_base_y - k0 * ray_du_y + x0 * ray_dx_y;
+                        ray_dir_z <= ray_base_z - k0 * ray_du_z + x0 * ray_dx_z;
+                        state     <= S_RENDER_PIXEL;
+                    end else if (&tile_d) begin
+                        pixel_x <= 11'd0;
+                        pixel_y <= 11'd0;
+                        busy    <= 1'b0;
+                        done    <= 1'b1;
+                        state   <= S_IDLE;
+                    end
+                end
+
+                // Pipelined DDA: launch, step, return, payload and write all
+                // run every clock, each on a different slot.
+                S_PIPE: begin
+                    if (!pipe_launched && pipe_seek) begin : pipe_next_tile
+                        reg [2*TILE_BITS-1:0] cell;
+                        cell   = tile_cell(tile_order, tile_d);
+                        tile_d <= tile_d + 1'b1;
+                        if (tile_on_screen(cell)) begin
+                            pipe_lx   <= tile_left(cell);
+                            pipe_ly   <= tile_top(cell);
+                            tile_x0   <= tile_left(cell);
+                            tile_x1   <= tile_right(cell);
+                            tile_y1   <= tile_bottom(cell);
+                            pipe_seek <= 1'b0;
+                        end else if (&tile_d) begin
+                            pipe_launched <= 1'b1;
+                        end
+                    end else if (!pipe_launched && slot_state[pipe_tail] == P_FREE) begin
+                        slot_state[pipe_tail] <= P_TRACE;
+                        slot_x[pipe_tail]     <= 7'sd63;
+                        slot_y[pipe_tail]     <= pix_map_y[5:0];
+                        slot_z[pipe_tail]     <= pix_map_z[5:0];
+                        slot_steps[pipe_tail] <= 8'd0;
+                        slot_pend[pipe_tail]  <= 1'b0;
+                        slot_out[pipe_tail]   <= 1'b0;
+                        slot_hit[pipe_tail]   <= 1'b0;
+                        slot_read[pipe_tail]  <= 1'b0;
+                        slot_px[pipe_tail]    <= pipe_lx;
+                        slot_py[pipe_tail]    <= pipe_ly;
+                        pipe_tail             <= pipe_tail + 1'b1;
+                        if (tile_mode) begin
+                            if (pipe_lx != tile_x1) begin
+                                pipe_lx <= pipe_lx + 1'b1;
+                            end else if (pipe_ly != tile_y1) begin
+                                pipe_lx <= tile_x0;
+                                pipe_ly <= pipe_ly + NUM_LANES;
+                            end else if (tile_d == {2*TILE_BITS{1'b0}}) begin
+                                pipe_launched <= 1'b1;
+                            end else begin
+                                pipe_seek <= 1'b1;
+                            end
+                        end else if (pipe_lx == SCREEN_WIDTH-1) begin
+                            pipe_lx <= 11'd0;
+                            if (pipe_ly == LAST_ROW)
+                                pipe_launched <= 1'b1;
+                            else
+                                pipe_ly <= pipe_ly + NUM_LANES;
+                        end else begin
+                            pipe_lx <= pipe_lx + 1'b1;
+                        end
+                    end
+
+                    if (pipe_pick_valid) begin : pipe_step
+                        reg signed [6:0] px;
+                        reg        [3:0] reach;
+                        reg        [2:0] r;
+                        reg              brick;
+                        px    = slot_x[pipe_pick];
+                        brick = skip_mode && !brick_occupied;
+                        if (brick || (sdf_mode && slot_pend[pipe_pick] && slot_dist[pipe_pick] >= 4'd2)) begin
+                            // Same boxes as S_STEP; an orthographic ray only
+                            // crosses X boundaries, so only X moves.
+                            reach = slot_dist[pipe_pick] > 4'd9 ? 4'd7 : slot_dist[pipe_pick] - 4'd2;
+                            r     = brick ? px[2:0] : box_reach(px, 1'b1, reach);
+                            slot_x[pipe_pick]     <= px - $signed({3'd0, {1'b0, r} + 4'd1});
+                            slot_steps[pipe_pick] <= slot_steps[pipe_pick] + r + 1'b1;
+                            slot_pend[pipe_pick]  <= 1'b0;
+                            if ({3'd0, r} == px[5:0])
+                                slot_state[pipe_pick] <= P_DONE;   // left the grid: sky
+                            if (brick)
+                                dbg_skip_count <= dbg_skip_count + 1'b1;
+                        end else begin
+                            voxel_addr            <= {px[5:0], slot_y[pipe_pick], slot_z[pipe_pick]};
+                            voxel_read_en         <= 1'b1;
+                            iss_valid             <= 1'b1;
+                            iss_slot              <= pipe_pick;
+                            iss_x                 <= px[5:0];
+                            slot_x[pipe_pick]     <= px - 7'sd1;
+                            slot_out[pipe_pick]   <= px == 7'sd0;
+                            slot_steps[pipe_pick] <= slot_steps[pipe_pick] + 1'b1;
+                            slot_read[pipe_pick]  <= 1'b1;
+                            slot_lastx[pipe_pick] <= px[5:0];
+                            slot_state[pipe_pick] <= P_WAIT;
+                        end
+                    end
+
+                    // voxel_trace is the word for the read issued two clocks
+                    // ago; a solid one has its payload read this clock.
+                    if (ret_valid) begin
+                        if (trace_solid) begin
+                            slot_hit[ret_slot]   <= 1'b1;
+                            slot_hx[ret_slot]    <= ret_x;
+                            slot_state[ret_slot] <= P_PAYLOAD;
+                            pay_valid            <= 1'b1;
+                            pay_slot             <= ret_slot;
+                        end else if (slot_out[ret_slot]) begin
+                            slot_state[ret_slot] <= P_DONE;
+                        end else begin
+                            slot_pend[ret_slot]  <= 1'b1;
+                            slot_dist[ret_slot]  <= voxel_trace[3:0];
+                            slot_state[ret_slot] <= P_TRACE;
+                        end
+                    end
+
+                    if (pay_valid) begin
+                        slot_word[pay_slot]  <= payload_data;
+                        slot_state[pay_slot] <= P_DONE;
+                    end
+
+                    if (slot_state[pipe_head] == P_DONE) begin
+                        if (slot_hit[pipe_head]) begin
+                            compute_pixel_data(slot_word[pipe_head], slot_hx[pipe_head],
+                                               slot_y[pipe_head], slot_z[pipe_head],
+                                               slot_steps[pipe_head]);
+                            dbg_hit_count  <= dbg_hit_count + 1'b1;
+                            last_hit_addr  <= {slot_hx[pipe_head], slot_y[pipe_head], slot_z[pipe_head]};
+                            last_hit_valid <= 1'b1;
+                            if (slot_px[pipe_head] == (SCREEN_WIDTH >> 1) &&
+                                slot_py[pipe_head] == (SCREEN_HEIGHT >> 1) &&
+                                !cursor_hit_valid) begin
+                                cursor_hit_valid   <= 1'b1;
+                                cursor_voxel_x     <= slot_hx[pipe_head];
+                                cursor_voxel_y     <= slot_y[pipe_head];
+                                cursor_voxel_z     <= slot_z[pipe_head];
+                                cursor_material_id <= {slot_word[pipe_head][7:4], 4'h0};
+                                cursor_voxel_data  <= slot_word[pipe_head];
+                            end
+                        end else begin
+                            sky_pixel(slot_py[pipe_head]);
+                        end
+                        if (slot_read[pipe_head]) begin
+                            last_read_addr  <= {slot_lastx[pipe_head], slot_y[pipe_head], slot_z[pipe_head]};
+                            last_read_valid <= 1'b1;
+                        end
+                        pixel_addr            <= slot_py[pipe_head] * SCREEN_WIDTH + slot_px[pipe_head];
+                        pixel_write_en        <= 1'b1;
+                        slot_state[pipe_head] <= P_FREE;
+                        pipe_head             <= pipe_head + 1'b1;
+                        // Everything launched and this is the last slot.
+                        if (pipe_launched && pipe_head + 1'b1 == pipe_tail)
+                            state <= S_PIPE_END;
+                    end else if (pipe_launched && pipe_head == pipe_tail &&
+                                 slot_state[pipe_head] == P_FREE) begin
+                        // The tile walk found no more cells after the last
+                        // slot had already gone.
+                        state <= S_PIPE_END;
+                    end
+                end
+
+                // Leave the trace and payload registers holding the last
+                // words of the last pixel in order, as the sequential DDA
+                // does (payload_read_en re-reads the last hit).
+                S_PIPE_END: begin
+                    pixel_x       <= 11'd0;
+                    pixel_y       <= 11'd0;
+                    voxel_addr    <= last_read_addr;
+                    voxel_read_en <= last_read_valid;
+                    busy          <= 1'b0;
+                    done          <= 1'b1;
+                    state         <= S_IDLE;
+                end
+
                 default: state <= S_IDLE;
             endcase
         end
@@ -0,0 +1,233 @@
+// ============================================================================
+// camera_path.cpp
+// - .hcp camera path reader/writer.
+// ============================================================================
+#include "camera_path.h"
+
+#include <cstring>
+
+static const char     kHcpMagic[4]  = {'H', 'C', 'P', '\0'};
+static const uint16_t kHcpVersion   = 1;
+static const long     kHcpCountOffs = 12;
+
+// Flag word bit positions. Append new flags at the top; never renumber.
+enum : uint32_t {
+    HCP_FLAG_SMOOTH      = 1u << 0,
+    HCP_FLAG_CURVATURE   = 1u << 1,
+    HCP_FLAG_EXTRA_LIGHT = 1u << 2,
+    HCP_FLAG_DIAG_SLICE  = 1u << 3,
+    HCP_FLAG_DDA         = 1u << 4,
+    HCP_FLAG_PERSPECTIVE = 1u << 5,
+    HCP_FLAG_MEMO        = 1u << 6,
+    HCP_FLAG_SKIP_EMPTY  = 1u << 7,
+    HCP_FLAG_SDF         = 1u << 8,
+    HCP_FLAG_PIPELINE    = 1u << 9,
+    HCP_TILE_ORDER_SHIFT = 10,          // two bits: RenderFlags::tile_order
+    HCP_FLAG_COMPOSITE   = 1u << 12,
+    HCP_ALPHA_THR_SHIFT  = 16,          // eight bits: RenderFlags::alpha_threshold
+};
+
+uint32_t render_flags_pack(const RenderFlags& f) {
+    uint32_t bits = 0;
+    if (f.smooth_surfaces) bits |= HCP_FLAG_SMOOTH;
+    if (f.curvature)       bits |= HCP_FLAG_CURVATURE;
+    if (f.extra_light)     bits |= HCP_FLAG_EXTRA_LIGHT;
+    if (f.diag_slice)      bits |= HCP_FLAG_DIAG_SLICE;
+    if (f.dda)             bits |= HCP_FLAG_DDA;
+    if (f.perspective)     bits |= HCP_FLAG_PERSPECTIVE;
+    if (f.memo)            bits |= HCP_FLAG_MEMO;
+    if (f.skip_empty)      bits |= HCP_FLAG_SKIP_EMPTY;
+    if (f.sdf)             bits |= HCP_FLAG_SDF;
+    if (f.pipeline)        bits |= HCP_FLAG_PIPELINE;
+    if (f.composite)       bits |= HCP_FLAG_COMPOSITE;
+    bits |= uint32_t(f.tile_order & 3) << HCP_TILE_ORDER_SHIFT;
+    bits |= uint32_t(f.alpha_threshold) << HCP_ALPHA_THR_SHIFT;
+    return bits;
+}
+
+RenderFlags render_flags_unpack(uint32_t bits) {
+    RenderFlags f;
+    f.smooth_surfaces = (bits & HCP_FLAG_SMOOTH) != 0;
+    f.curvature       = (bits & HCP_FLAG_CURVATURE) != 0;
+    f.extra_light     = (bits & HCP_FLAG_EXTRA_LIGHT) != 0;
+    f.diag_slice      = (bits & HCP_FLAG_DIAG_SLICE) != 0;
+    f.dda             = (bits & HCP_FLAG_DDA) != 0;
+    f.perspective     = (bits & HCP_FLAG_PERSPECTIVE) != 0;
+    f.memo            = (bits & HCP_FLAG_MEMO) != 0;
+    f.skip_empty      = (bits & HCP_FLAG_SKIP_EMPTY) != 0;
+    f.sdf             = (bits & HCP_FLAG_SDF) != 0;
+    f.pipeline        = (bits & HCP_FLAG_PIPELINE) != 0;
+    f.tile_order      = int(bits >> HCP_TILE_ORDER_SHIFT) & 3;
+    f.composite       = (bits & HCP_FLAG_COMPOSITE) != 0;
+    f.alpha_threshold = uint8_t(bits >> HCP_ALPHA_THR_SHIFT);
+    return f;
+}
+
+// ---------------------------------------------------------------------------
+// Little-endian field helpers
+// ---------------------------------------------------------------------------
+static void put_u8(std::vector<uint8_t>& b, uint8_t v) { b.push_back(v); }
+static void put_u16(std::vector<uint8_t>& b, uint16_t v) {
+    b.push_back(uint8_t(v)); b.push_back(uint8_t(v >> 8));
+}
+static void put_u32(std::vector<uint8_t>& b, uint32_t v) {
+    for (int i = 0; i < 4; ++i) b.push_back(uint8_t(v >> (8 * i)));
+}
+static void put_u64(std::vector<uint8_t>& b, uint64_t v) {
+    for (int i = 0; i < 8; ++i) b.push_back(uint8_t(v >> (8 * i)));
+}
+static void put_f32(std::vector<uint8_t>& b, float f) {
+    uint32_t v;
+    std::memcpy(&v, &f, 4);
+    put_u32(b, v);
+}
+
+static bool get_bytes(FILE* f, uint8_t* dst, size_t n) {
+    return std::fread(dst, 1, n, f) == n;
+}
+static uint16_t le16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+static uint32_t le32(const uint8_t* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+static uint64_t le64(const uint8_t* p) {
+    return uint64_t(le32(p)) | (uint64_t(le32(p + 4)) << 32);
+}
+static float lef32(const uint8_t* p) {
+    uint32_t v = le32(p);
+    float f;
+    std::memcpy(&f, &v, 4);
+    return f;
+}
+
+// Fixed part of a record: 5 floats, flag word, sel active/x/y/z, edit count.
+static const size_t kRecordFixed = 5 * 4 + 4 + 4 + 2;
+static const size_t kEditSize    = 4 + 8;
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+CameraPathWriter::~CameraPathWriter() {
+    close();
+}
+
+bool CameraPathWriter::open(const std::string& path, int width, int height,
+                            std::string* err) {
+    close();
+    f_ = std::fopen(path.c_str(), "wb");
+    if (!f_) {
+        if (err) *err = "cannot create " + path;
+        return false;
+    }
+    std::vector<uint8_t> hdr;
+    hdr.insert(hdr.end(), kHcpMagic, kHcpMagic + 4);
+    put_u16(hdr, kHcpVersion);
+    put_u16(hdr, 0);
+    put_u16(hdr, uint16_t(width));
+    put_u16(hdr, uint16_t(height));
+    put_u32(hdr, 0);   // frame count, patched by close()
+    std::fwrite(hdr.data(), 1, hdr.size(), f_);
+    frames_ = 0;
+    return true;
+}
+
+void CameraPathWriter::append(const PathFrame& fr) {
+    if (!f_) return;
+    std::vector<uint8_t> b;
+    b.reserve(kRecordFixed + fr.edits.size() * kEditSize);
+    put_f32(b, fr.cam.pos_x);
+    put_f32(b, fr.cam.pos_y);
+    put_f32(b, fr.cam.pos_z);
+    put_f32(b, fr.cam.yaw);
+    put_f32(b, fr.cam.pitch);
+    put_u32(b, render_flags_pack(fr.flags));
+    put_u8(b, fr.sel.active ? 1 : 0);
+    put_u8(b, fr.sel.x);
+    put_u8(b, fr.sel.y);
+    put_u8(b, fr.sel.z);
+    put_u16(b, uint16_t(fr.edits.size()));
+    for (const VoxelEdit& e : fr.edits) {
+        put_u32(b, e.addr);
+        put_u64(b, e.data);
+    }
+    std::fwrite(b.data(), 1, b.size(), f_);
+    ++frames_;
+}
+
+bool CameraPathWriter::close() {
+    if (!f_) return true;
+    std::vector<uint8_t> cnt;
+    put_u32(cnt, frames_);
+    bool ok = std::fseek(f_, kHcpCountOffs, SEEK_SET) == 0 &&
+              std::fwrite(cnt.data(), 1, 4, f_) == 4;
+    ok = (std::fclose(f_) == 0) && ok;
+    f_ = nullptr;
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+bool camera_path_read(const std::string& path, int* width, int* height,
+                      std::vector<PathFrame>& out, std::string* err) {
+    out.clear();
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        if (err) *err = "cannot open " + path;
+        return false;
+    }
+    uint8_t hdr[16];
+    if (!get_bytes(f, hdr, sizeof(hdr)) || std::memcmp(hdr, kHcpMagic, 4) != 0 ||
+        le16(hdr + 4) != kHcpVersion) {
+        std::fclose(f);
+        if (err) *err = path + " is not a v1 camera path";
+        return false;
+    }
+    if (width)  *width  = le16(hdr + 8);
+    if (height) *height = le16(hdr + 10);
+    const uint32_t count = le32(hdr + 12);
+
+    uint8_t rec[kRecordFixed];
+    while (count == 0 || out.size() < count) {
+        if (!get_bytes(f, rec, sizeof(rec)))
+            break;
+        PathFrame fr;
+        fr.cam.pos_x  = lef32(rec + 0);
+        fr.cam.pos_y  = lef32(rec + 4);
+        fr.cam.pos_z  = lef32(rec + 8);
+        fr.cam.yaw    = lef32(rec + 12);
+        fr.cam.pitch  = lef32(rec + 16);
+        fr.flags      = render_flags_unpack(le32(rec + 20));
+        fr.sel.active = rec[24] != 0;
+        fr.sel.x      = rec[25];
+        fr.sel.y      = rec[26];
+        fr.sel.z      = rec[27];
+        const uint16_t n_edits = le16(rec + 28);
+
+        bool complete = true;
+        for (uint16_t i = 0; i < n_edits; ++i) {
+            uint8_t e[kEditSize];
+            if (!get_bytes(f, e, sizeof(e))) { complete = false; break; }
+            fr.edits.push_back(VoxelEdit{le32(e), le64(e + 4)});
+        }
+        if (!complete)
+            break;
+        out.push_back(fr);
+    }
+    std::fclose(f);
+
+    if (count != 0 && out.size() != count) {
+        if (err) *err = path + " is truncated";
+        return false;
+    }
+    return true;
+}
+
+void camera_path_apply(VoxelSim& sim, const PathFrame& frame) {
+    sim.apply_camera(frame.cam);
+    sim.apply_flags(frame.flags);
+    sim.apply_selection(frame.sel);
+    for (const VoxelEdit& e : frame.edits) {
+        sim.write_voxel(e.addr, e.data);
+        sim.step(1);
+    }
+}
@@ -0,0 +1,58 @@
+// ============================================================================
+// camera_path.h
+// - Frame-locked recording/replay of camera, flags, selection and voxel edits.
+// - .hcp file: 16-byte header ("HCP\0", version, frame size, frame count),
+//   then one variable-length record per frame, all little-endian.
+// - Record k holds the state applied at the boundary before frame k and the
+//   voxel edits made since the previous boundary.
+// ============================================================================
+#pragma once
+
+#include "voxel_sim.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct VoxelEdit {
+    uint32_t addr = 0;
+    uint64_t data = 0;
+};
+
+struct PathFrame {
+    CameraPose             cam;
+    RenderFlags            flags;
+    SelectionState         sel;
+    std::vector<VoxelEdit> edits;
+};
+
+// RenderFlags <-> the 32-bit flag word stored per record.
+uint32_t    render_flags_pack(const RenderFlags& f);
+RenderFlags render_flags_unpack(uint32_t bits);
+
+class CameraPathWriter {
+public:
+    ~CameraPathWriter();
+
+    bool open(const std::string& path, int width, int height, std::string* err);
+    void append(const PathFrame& frame);
+    // Patches the frame count into the header. Also run by the destructor.
+    bool close();
+
+    bool     is_open() const { return f_ != nullptr; }
+    uint32_t frames() const { return frames_; }
+
+private:
+    FILE*    f_ = nullptr;
+    uint32_t frames_ = 0;
+};
+
+// Reads every record. A file whose header count was never patched (crashed
+// recorder) is read up to the last complete record.
+bool camera_path_read(const std::string& path, int* width, int* height,
+                      std::vector<PathFrame>& out, std::string* err);
+
+// Apply a record at a frame boundary. Each voxel edit is clocked in on its
+// own cycle, like the live debug-write path.
+void camera_path_apply(VoxelSim& sim, const PathFrame& frame);
@@ -0,0 +1,56 @@
+// ============================================================================
+// damage_tracker.cpp
+// - Tile map -> damage rectangle merge.
+// ============================================================================
+#include "damage_tracker.h"
+
+#include <algorithm>
+
+void DamageTracker::resize(int width, int height) {
+    width_   = width;
+    height_  = height;
+    tiles_x_ = (width + kTile - 1) / kTile;
+    tiles_y_ = (height + kTile - 1) / kTile;
+    dirty_.assign(size_t(tiles_x_) * size_t(tiles_y_), 0);
+}
+
+void DamageTracker::mark_all() {
+    std::fill(dirty_.begin(), dirty_.end(), uint8_t(1));
+}
+
+void DamageTracker::take(std::vector<DamageRect>& out) {
+    out.clear();
+    // Indices into out of rects that reach the bottom of the previous tile
+    // row; a run with the same columns extends one of those downwards.
+    std::vector<size_t> open, next_open;
+
+    for (int ty = 0; ty < tiles_y_; ++ty) {
+        const uint8_t* row = &dirty_[size_t(ty) * tiles_x_];
+        const int y0 = ty * kTile;
+        const int h  = std::min(kTile, height_ - y0);
+        next_open.clear();
+
+        for (int tx = 0; tx < tiles_x_; ) {
+            if (!row[tx]) { ++tx; continue; }
+            const int run0 = tx;
+            while (tx < tiles_x_ && row[tx]) ++tx;
+            const int x0 = run0 * kTile;
+            const int w  = std::min(tx * kTile, width_) - x0;
+
+            size_t idx = out.size();
+            for (size_t i : open) {
+                if (out[i].x == x0 && out[i].w == w) {
+                    idx = i;
+                    break;
+                }
+            }
+            if (idx == out.size())
+                out.push_back(DamageRect{x0, y0, w, h});
+            else
+                out[idx].h += h;
+            next_open.push_back(idx);
+        }
+        open.swap(next_open);
+    }
+    std::fill(dirty_.begin(), dirty_.end(), uint8_t(0));
+}
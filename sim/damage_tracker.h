@@ -0,0 +1,45 @@
+// ============================================================================
+// damage_tracker.h
+// - Per-tile record of framebuffer pixels whose value changed while a frame
+//   was drained, turned into damage rectangles at end of frame.
+// ============================================================================
+#pragma once
+
+#include "platform/platform.h"
+
+#include <cstdint>
+#include <vector>
+
+class DamageTracker {
+public:
+    static constexpr int kTile = 16;
+
+    void resize(int width, int height);
+
+    // Store v at framebuffer index addr; marks the tile only if the value
+    // changed. Returns true if it did.
+    bool write(std::vector<uint32_t>& fb, uint32_t addr, uint32_t v) {
+        uint32_t& px = fb[addr];
+        if (px == v)
+            return false;
+        px = v;
+        const uint32_t y = addr / uint32_t(width_);
+        const uint32_t x = addr - y * uint32_t(width_);
+        dirty_[(y / kTile) * tiles_x_ + x / kTile] = 1;
+        return true;
+    }
+
+    void mark_all();
+
+    // Emit this frame's damage into out and clear the tile map. Dirty tiles
+    // are merged into horizontal runs, and runs spanning the same columns
+    // on consecutive tile rows into one rect.
+    void take(std::vector<DamageRect>& out);
+
+private:
+    int width_   = 0;
+    int height_  = 0;
+    int tiles_x_ = 0;
+    int tiles_y_ = 0;
+    std::vector<uint8_t> dirty_;
+};
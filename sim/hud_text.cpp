@@ -0,0 +1,110 @@
+// ============================================================================
+// hud_text.cpp
+// - Glyph atlas build and cached line layout for the HUD.
+// ============================================================================
+#include "hud_text.h"
+
+#include <algorithm>
+
+HudText::~HudText() {
+    close();
+}
+
+void HudText::close() {
+    if (atlas_)
+        SDL_DestroyTexture(atlas_);
+    atlas_ = nullptr;
+    lines_.clear();
+}
+
+bool HudText::init(SDL_Renderer* ren, TTF_Font* font) {
+    ren_ = ren;
+    line_h_ = TTF_FontHeight(font);
+
+    // Rasterize each glyph as a one-character string so the surface carries
+    // the bearing; quads are then placed at the pen position as-is.
+    const SDL_Color white{255, 255, 255, 255};
+    SDL_Surface* surf[kGlyphs] = {};
+    int cell_w = 1;
+    int cell_h = std::max(line_h_, 1);
+    for (int i = 0; i < kGlyphs; ++i) {
+        const char str[2] = {char(kFirst + i), '\0'};
+        int minx, maxx, miny, maxy, advance = 0;
+        TTF_GlyphMetrics(font, uint16_t(kFirst + i), &minx, &maxx, &miny, &maxy, &advance);
+        glyphs_[i].advance = advance;
+        if (str[0] == ' ')
+            continue;
+        SDL_Surface* s = TTF_RenderText_Blended(font, str, white);
+        if (!s)
+            continue;
+        surf[i] = SDL_ConvertSurfaceFormat(s, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(s);
+        if (surf[i]) {
+            cell_w = std::max(cell_w, surf[i]->w);
+            cell_h = std::max(cell_h, surf[i]->h);
+        }
+    }
+
+    const int cols = 16;
+    const int rows = (kGlyphs + cols - 1) / cols;
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(
+        0, cols * cell_w, rows * cell_h, 32, SDL_PIXELFORMAT_ARGB8888);
+    bool ok = sheet != nullptr;
+    if (ok) {
+        SDL_FillRect(sheet, nullptr, 0);
+        for (int i = 0; i < kGlyphs; ++i) {
+            if (!surf[i])
+                continue;
+            SDL_Rect dst{(i % cols) * cell_w, (i / cols) * cell_h, surf[i]->w, surf[i]->h};
+            // Copy alpha as-is rather than blending onto the cleared sheet.
+            SDL_SetSurfaceBlendMode(surf[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surf[i], nullptr, sheet, &dst);
+            glyphs_[i].src = dst;
+        }
+        atlas_ = SDL_CreateTextureFromSurface(ren, sheet);
+        SDL_FreeSurface(sheet);
+        ok = atlas_ != nullptr;
+    }
+    for (SDL_Surface* s : surf)
+        if (s) SDL_FreeSurface(s);
+
+    if (ok)
+        SDL_SetTextureBlendMode(atlas_, SDL_BLENDMODE_BLEND);
+    return ok;
+}
+
+void HudText::layout(Line& line) const {
+    line.src.clear();
+    line.dst.clear();
+    int pen = line.x;
+    for (char c : line.text) {
+        int idx = int((unsigned char)c) - kFirst;
+        if (idx < 0 || idx >= kGlyphs)
+            idx = '?' - kFirst;
+        const Glyph& g = glyphs_[idx];
+        if (g.src.w > 0) {
+            line.src.push_back(g.src);
+            line.dst.push_back(SDL_Rect{pen, line.y, g.src.w, g.src.h});
+        }
+        pen += g.advance;
+    }
+}
+
+void HudText::draw(int slot, const char* text, int x, int y, SDL_Color color) {
+    if (!atlas_ || slot < 0)
+        return;
+    if (size_t(slot) >= lines_.size())
+        lines_.resize(size_t(slot) + 1);
+
+    Line& line = lines_[size_t(slot)];
+    if (line.x != x || line.y != y || line.text != text || line.src.empty()) {
+        line.text = text;
+        line.x = x;
+        line.y = y;
+        layout(line);
+    }
+
+    SDL_SetTextureColorMod(atlas_, color.r, color.g, color.b);
+    for (size_t i = 0; i < line.src.size(); ++i)
+        SDL_RenderCopy(ren_, atlas_, &line.src[i], &line.dst[i]);
+}
@@ -0,0 +1,62 @@
+// ============================================================================
+// hud_text.h
+// - HUD text from a glyph atlas: printable ASCII is rasterized once with
+//   SDL_ttf into a single texture, and each line is drawn as glyph quads.
+// - Lines are addressed by slot; a slot whose text did not change since the
+//   last frame reuses its laid-out quads.
+// ============================================================================
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <string>
+#include <vector>
+
+class HudText {
+public:
+    HudText() = default;
+    ~HudText();
+
+    HudText(const HudText&) = delete;
+    HudText& operator=(const HudText&) = delete;
+
+    // Builds the atlas. The font is only used here and may be closed after.
+    bool init(SDL_Renderer* ren, TTF_Font* font);
+
+    // Frees the atlas; call before the renderer is destroyed.
+    void close();
+
+    // Draws text into line slot `slot` at (x, y). Characters outside
+    // printable ASCII are drawn as '?'.
+    void draw(int slot, const char* text, int x, int y,
+              SDL_Color color = {255, 255, 255, 255});
+
+    int line_height() const { return line_h_; }
+
+private:
+    static const int kFirst  = 32;
+    static const int kLast   = 126;
+    static const int kGlyphs = kLast - kFirst + 1;
+
+    struct Glyph {
+        SDL_Rect src{0, 0, 0, 0};
+        int      advance = 0;
+    };
+
+    struct Line {
+        std::string           text;
+        int                   x = 0;
+        int                   y = 0;
+        std::vector<SDL_Rect> src;
+        std::vector<SDL_Rect> dst;
+    };
+
+    void layout(Line& line) const;
+
+    SDL_Renderer*     ren_   = nullptr;
+    SDL_Texture*      atlas_ = nullptr;
+    int               line_h_ = 0;
+    Glyph             glyphs_[kGlyphs];
+    std::vector<Line> lines_;
+};
@@ -6,8 +6,13 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <verilated.h>
-#include "Vvoxel_framebuffer_top.h"
-#include "Vvoxel_framebuffer_top___024root.h"
+#include "voxel_sim.h"
+#include "sim_thread.h"
+#include "camera_path.h"
+#include "hud_text.h"
+#include "model/tile_renderer.h"
+#include "model/voxel_model.h"
+#include "thread_pin.h"
 #include "platform/backend_selector.h"
 
 #include <cstdint>
@@ -19,31 +24,16 @@
 #include <cstring>
 #include <cstdlib>
 #include <cctype>
+#include <memory>
 
 static const int   SCREEN_WIDTH  = 480;
 static const int   SCREEN_HEIGHT = 360;
-static const int   HUD_HEIGHT    = 80;
-static const float FX            = 256.0f;  // fixed-point scale
+// Eleven 14-pixel HUD lines (the probe line only with a selection).
+static const int   HUD_HEIGHT    = 160;
 
-vluint64_t main_time = 0;
+uint64_t main_time = 0;
 double sc_time_stamp() { return main_time; }
 
-static uint32_t pixel96_to_argb(uint32_t w0, uint32_t w1, uint32_t w2) {
-    (void)w0; (void)w2;
-    uint8_t r = (w1 >> 24) & 0xFF;
-    uint8_t g = (w1 >> 16) & 0xFF;
-    uint8_t b = (w1 >>  8) & 0xFF;
-    uint8_t a = 0xFF;
-    return (uint32_t(a) << 24) |
-           (uint32_t(r) << 16) |
-           (uint32_t(g) << 8)  |
-            uint32_t(b);
-}
-
-static inline uint32_t voxel_addr_from_xyz(uint8_t x, uint8_t y, uint8_t z) {
-    return (uint32_t(x) << 12) | (uint32_t(y) << 6) | uint32_t(z);
-}
-
 static const char* backend_name(PlatformBackend b) {
     switch (b) {
         case PlatformBackend::SDL:    return "SDL";
@@ -117,63 +107,513 @@ static void die(const std::string& s) {
     std::exit(1);
 }
 
-static void draw_text(SDL_Renderer* ren, TTF_Font* font,
-                      const std::string& txt,
-                      int x, int y,
-                      SDL_Color color = {255,255,255,255})
-{
-    SDL_Surface* surf = TTF_RenderText_Blended(font, txt.c_str(), color);
-    if (!surf) return;
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(ren, surf);
-    SDL_FreeSurface(surf);
-    if (!tex) return;
-
-    int w, h;
-    SDL_QueryTexture(tex, nullptr, nullptr, &w, &h);
-    SDL_Rect dst{ x, y, w, h };
-    SDL_RenderCopy(ren, tex, nullptr, &dst);
-    SDL_DestroyTexture(tex);
+struct Options {
+    bool        headless = false;
+    uint64_t    frames   = 10;
+    std::string json_path;
+    // Empty = no pinning. Multi-threaded builds default to cpus 0..N-1.
+    std::vector<int> pin_cpus;
+    // Model state after world generation (--snapshot); empty = cold start.
+    std::string snapshot;
+    // .hvx volume preloaded instead of running voxel_world_gen (--scene).
+    std::string scene;
+    // Write the volume as .hvx once the world is up (--dump-scene).
+    std::string dump_scene;
+    // Camera path capture / frame-locked playback (.hcp).
+    std::string record;
+    std::string replay;
+    // Windowed mode only renders when the scene changes unless --free-run.
+    bool        free_run = false;
+    // Headless: render every frame with the C++ model too and compare.
+    bool        diff_model = false;
+    // --diff-model through the tiled renderer with this many threads (0: off).
+    int         model_tiles = 0;
+    // Start with 3D-DDA traversal on (render_config[2]); replays use the
+    // recorded flags.
+    bool        dda = false;
+    // Likewise for perspective camera rays (render_config[3]).
+    bool        perspective = false;
+    // Likewise for the ray memo (render_config[4]).
+    bool        memo = false;
+    // Likewise for empty-space skipping (render_config[5]).
+    bool        skip_empty = false;
+    // Likewise for distance-field jumps (render_config[6]).
+    bool        sdf = false;
+    // Likewise for the pipelined DDA (render_config[7]).
+    bool        pipeline = false;
+    // Likewise for the pixel order (render_config[9:8], kTileOrderNames).
+    int         tile_order = 0;
+    // Likewise for alpha compositing (render_config[10]) and the opacity at
+    // which it ends a ray (render_config[23:16]).
+    bool        composite = false;
+    int         alpha_threshold = 243;
+};
+
+// render_config[9:8] values, as --tile-order takes them.
+static const char* const kTileOrderNames[4] = {"raster", "tiles", "morton", "hilbert"};
+
+static void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s [--headless] [--frames N] [--json out.json] [--pin-cpus LIST|--no-pin]\n"
+        "          [--snapshot PATH] [--scene FILE.hvx] [--dump-scene FILE.hvx]\n"
+        "          [--record PATH.hcp | --replay PATH.hcp] [--free-run] [--diff-model]\n"
+        "          [--model-tiles N] [--dda] [--perspective] [--memo] [--skip-empty]\n"
+        "          [--sdf] [--pipeline] [--tile-order raster|tiles|morton|hilbert]\n"
+        "          [--composite] [--alpha-threshold N]\n"
+        "  --headless      run without SDL/TTF and report per-frame throughput\n"
+        "  --frames N      frames to simulate in headless mode (default 10)\n"
+        "  --json PATH     write per-frame stats as JSON\n"
+        "  --pin-cpus LIST pin the eval thread and model workers, e.g. 0-7 or 0,2,4\n"
+        "  --no-pin        leave sim threads floating (default for 1-thread builds)\n"
+        "  --snapshot PATH restore the post-world-gen model state from PATH, or\n"
+        "                  create it there if missing or from a different RTL build\n"
+        "  --scene FILE    mmap an .hvx volume into voxel_memory_64 and skip world_gen\n"
+        "  --dump-scene F  write voxel_memory_64 as .hvx once the world is ready\n"
+        "  --record PATH   log camera/flags/selection/voxel edits per frame\n"
+        "  --replay PATH   feed a recorded path back frame-locked (headless or windowed)\n"
+        "  --free-run      windowed: re-render continuously instead of on scene change\n"
+        "  --diff-model    headless: check every frame against the C++ model (sim/model)\n"
+        "  --model-tiles N render the --diff-model frames with the tiled renderer on N\n"
+        "                  threads\n"
+        "  --dda           start with 3D-DDA traversal on (toggle with [4])\n"
+        "  --perspective   start with perspective camera rays on (toggle with [5])\n"
+        "  --memo          start with the ray memo on (toggle with [6])\n"
+        "  --skip-empty    start with empty-space skipping on (toggle with [7])\n"
+        "  --sdf           start with distance-field jumps on (toggle with [8])\n"
+        "  --pipeline      start with the pipelined DDA on (toggle with [9]; needs --dda)\n"
+        "  --tile-order O  render each lane's pixels in raster order, 8x8 tiles, or 8x8\n"
+        "                  tiles in Morton or Hilbert order (cycle with [0])\n"
+        "  --composite     start with alpha compositing of glass and water on (toggle\n"
+        "                  with [T]; needs --dda or --perspective)\n"
+        "  --alpha-threshold N  opacity, 0..255 of 256, at which a composite ray ends\n"
+        "                  (default 243)\n",
+        argv0);
+}
+
+static Options parse_options(int argc, char** argv) {
+    Options opt;
+    for (int c = 0; VoxelSim::model_threads() > 1 && c < VoxelSim::model_threads(); ++c)
+        opt.pin_cpus.push_back(c);
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--headless") {
+            opt.headless = true;
+        } else if (a == "--frames" && i + 1 < argc) {
+            opt.frames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--json" && i + 1 < argc) {
+            opt.json_path = argv[++i];
+        } else if (a == "--pin-cpus" && i + 1 < argc) {
+            if (!parse_cpu_list(argv[++i], opt.pin_cpus))
+                die(std::string("bad cpu list: ") + argv[i]);
+        } else if (a == "--snapshot" && i + 1 < argc) {
+            opt.snapshot = argv[++i];
+        } else if (a == "--scene" && i + 1 < argc) {
+            opt.scene = argv[++i];
+        } else if (a == "--dump-scene" && i + 1 < argc) {
+            opt.dump_scene = argv[++i];
+        } else if (a == "--record" && i + 1 < argc) {
+            opt.record = argv[++i];
+        } else if (a == "--replay" && i + 1 < argc) {
+            opt.replay = argv[++i];
+        } else if (a == "--diff-model") {
+            opt.diff_model = true;
+        } else if (a == "--model-tiles" && i + 1 < argc) {
+            opt.model_tiles = std::atoi(argv[++i]);
+            if (opt.model_tiles < 1)
+                die("--model-tiles wants a thread count");
+        } else if (a == "--dda") {
+            opt.dda = true;
+        } else if (a == "--perspective") {
+            opt.perspective = true;
+        } else if (a == "--memo") {
+            opt.memo = true;
+        } else if (a == "--skip-empty") {
+            opt.skip_empty = true;
+        } else if (a == "--sdf") {
+            opt.sdf = true;
+        } else if (a == "--pipeline") {
+            opt.pipeline = true;
+        } else if (a == "--tile-order" && i + 1 < argc) {
+            const std::string o = argv[++i];
+            opt.tile_order = -1;
+            for (int k = 0; k < 4; ++k)
+                if (o == kTileOrderNames[k])
+                    opt.tile_order = k;
+            if (opt.tile_order < 0)
+                die("--tile-order wants raster, tiles, morton or hilbert");
+        } else if (a == "--composite") {
+            opt.composite = true;
+        } else if (a == "--alpha-threshold" && i + 1 < argc) {
+            opt.alpha_threshold = std::atoi(argv[++i]);
+            if (opt.alpha_threshold < 0 || opt.alpha_threshold > 255)
+                die("--alpha-threshold wants 0..255");
+        } else if (a == "--free-run") {
+            opt.free_run = true;
+        } else if (a == "--no-pin") {
+            opt.pin_cpus.clear();
+        } else if (a == "--help" || a == "-h") {
+            usage(argv[0]);
+            std::exit(0);
+        } else if (a.rfind("+", 0) == 0) {
+            // Verilator plusargs are handled by Verilated::commandArgs.
+        } else {
+            usage(argv[0]);
+            die("unknown argument: " + a);
+        }
+    }
+    if (!opt.record.empty() && !opt.replay.empty())
+        die("--record and --replay are mutually exclusive");
+    if (opt.diff_model && !opt.headless)
+        die("--diff-model needs --headless");
+    if (opt.model_tiles && !opt.diff_model)
+        die("--model-tiles needs --diff-model");
+    return opt;
+}
+
+struct RunReport {
+    uint64_t warmup_cycles = 0;
+    double   warmup_s      = 0.0;
+    bool     restored      = false;
+    std::vector<FrameStats> frames;
+};
+
+static void report_summary(const char* label, const Options& opt, const RunReport& r) {
+    uint64_t total_cycles = 0;
+    double   total_wall   = 0.0;
+    for (const FrameStats& f : r.frames) {
+        total_cycles += f.cycles;
+        total_wall   += f.wall_seconds;
+    }
+    const double avg_mcps = total_wall > 0.0 ? double(total_cycles) / total_wall / 1e6 : 0.0;
+
+    // With a replayed path the per-frame cycle counts are the comparison
+    // point between RTL revisions, so list them.
+    if (!opt.replay.empty()) {
+        for (const FrameStats& f : r.frames)
+            std::fprintf(stdout, "frame %llu cycles %llu (%.2f per pixel) hits %u\n",
+                         (unsigned long long)f.index, (unsigned long long)f.cycles,
+                         f.cycles_per_pixel, f.hit_count);
+    }
+
+    std::fprintf(stdout,
+        "%s: %dx%d, %d model thread(s), %zu frames, warmup %llu cycles (%.3f s%s), "
+        "%llu cycles in %.3f s = %.3f Mcycles/s\n",
+        label, SCREEN_WIDTH, SCREEN_HEIGHT, VoxelSim::model_threads(), r.frames.size(),
+        (unsigned long long)r.warmup_cycles, r.warmup_s, r.restored ? ", snapshot" : "",
+        (unsigned long long)total_cycles, total_wall, avg_mcps);
+
+    // Per-lane share of the core's frame time, averaged over the run.
+    if ((HYDRA_NUM_LANES > 1 || HYDRA_VOXEL_CACHE) && !r.frames.empty()) {
+        uint64_t core_cycles = 0;
+        for (const FrameStats& f : r.frames)
+            core_cycles += f.core_cycles;
+        for (int k = 0; k < HYDRA_NUM_LANES; ++k) {
+            LaneStats sum;
+            for (const FrameStats& f : r.frames) {
+                sum.active_cycles  += f.lanes[k].active_cycles;
+                sum.payload_stalls += f.lanes[k].payload_stalls;
+                sum.pixel_stalls   += f.lanes[k].pixel_stalls;
+                sum.miss_stalls    += f.lanes[k].miss_stalls;
+            }
+            const double n = double(r.frames.size());
+            std::fprintf(stdout,
+                "lane %d: %.1f%% utilised, %.0f payload-port, %.0f pixel-port and %.0f "
+                "cache-miss stalls per frame\n",
+                k, core_cycles ? 100.0 * double(sum.active_cycles) / double(core_cycles) : 0.0,
+                double(sum.payload_stalls) / n, double(sum.pixel_stalls) / n,
+                double(sum.miss_stalls) / n);
+        }
+    }
+
+    // Incomplete frames make every other figure suspect, so say so first.
+    {
+        uint64_t drops = 0, frames = 0;
+        for (const FrameStats& f : r.frames) {
+            drops  += f.ring_overflows;
+            frames += f.ring_overflows != 0;
+        }
+        if (drops)
+            std::fprintf(stdout,
+                "WARNING: pixel ring overflowed in %llu frame(s), %llu pixel(s)/frame mark(s) "
+                "dropped; those frames are incomplete\n",
+                (unsigned long long)frames, (unsigned long long)drops);
+    }
+
+    // Locality of the frame's trace reads (voxel_fetch_stats), in any build.
+    if (!r.frames.empty()) {
+        uint64_t reads = 0, reuse = 0;
+        for (const FrameStats& f : r.frames) {
+            reads += f.fetch_reads;
+            reuse += f.fetch_reuse;
+        }
+        const double n = double(r.frames.size());
+        std::fprintf(stdout,
+            "fetch locality (%s order): %.0f trace reads, %.2f%% reusing a recent line per "
+            "frame\n",
+            kTileOrderNames[opt.tile_order & 3], double(reads) / n,
+            reads ? 100.0 * double(reuse) / double(reads) : 0.0);
+    }
+
+    if (opt.composite && !r.frames.empty()) {
+        uint64_t saved = 0;
+        for (const FrameStats& f : r.frames)
+            saved += f.ets_saved;
+        std::fprintf(stdout,
+            "early ray termination (threshold %d/256): %.0f voxel reads saved per frame\n",
+            opt.alpha_threshold, double(saved) / double(r.frames.size()));
+    }
+
+    if (HYDRA_VOXEL_CACHE && !r.frames.empty()) {
+        uint64_t hits = 0, misses = 0, evictions = 0;
+        for (const FrameStats& f : r.frames) {
+            hits      += f.cache_hits;
+            misses    += f.cache_misses;
+            evictions += f.cache_evictions;
+        }
+        const double n = double(r.frames.size());
+        std::fprintf(stdout,
+            "voxel cache: %.0f reads, %.0f line fills (%.2f%% of reads), %.0f evictions "
+            "per frame\n",
+            double(hits) / n, double(misses) / n,
+            hits ? 100.0 * double(misses) / double(hits) : 0.0, double(evictions) / n);
+    }
+}
+
+static void write_report_json(const std::string& path, const Options& opt, const RunReport& r) {
+    uint64_t total_cycles = 0;
+    uint64_t total_pixels = 0;
+    double   total_wall   = 0.0;
+    for (const FrameStats& f : r.frames) {
+        total_cycles += f.cycles;
+        total_pixels += f.pixels_written;
+        total_wall   += f.wall_seconds;
+    }
+    const double avg_mcps = total_wall > 0.0 ? double(total_cycles) / total_wall / 1e6 : 0.0;
+
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f)
+        die("cannot open " + path);
+
+    std::fprintf(f, "{\n");
+    std::fprintf(f, "  \"width\": %d,\n  \"height\": %d,\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    std::fprintf(f, "  \"model_threads\": %d,\n  \"pinned_cpus\": %zu,\n",
+                 VoxelSim::model_threads(), opt.pin_cpus.size());
+    std::fprintf(f, "  \"num_lanes\": %d,\n", HYDRA_NUM_LANES);
+    std::fprintf(f, "  \"voxel_cache\": %s,\n", HYDRA_VOXEL_CACHE ? "true" : "false");
+    std::fprintf(f, "  \"tile_order\": \"%s\",\n", kTileOrderNames[opt.tile_order & 3]);
+    std::fprintf(f, "  \"composite\": %s,\n  \"alpha_threshold\": %d,\n",
+                 opt.composite ? "true" : "false", opt.alpha_threshold);
+    std::fprintf(f, "  \"warmup_cycles\": %llu,\n  \"warmup_wall_ms\": %.3f,\n",
+                 (unsigned long long)r.warmup_cycles, r.warmup_s * 1e3);
+    std::fprintf(f, "  \"snapshot_restored\": %s,\n", r.restored ? "true" : "false");
+    std::fprintf(f, "  \"replay\": \"%s\",\n", opt.replay.c_str());
+    std::fprintf(f, "  \"frames\": [\n");
+    for (size_t i = 0; i < r.frames.size(); ++i) {
+        const FrameStats& s = r.frames[i];
+        std::fprintf(f,
+            "    {\"frame\": %llu, \"cycles\": %llu, \"sim_ticks\": %llu, "
+            "\"wall_ms\": %.3f, \"mcycles_per_s\": %.3f, "
+            "\"pixels_written\": %llu, \"pixels_changed\": %llu, \"hit_count\": %u, "
+            "\"skip_count\": %u, \"cycles_per_pixel\": %.3f, \"cache_hits\": %u, "
+            "\"cache_misses\": %u, \"cache_evictions\": %u, \"fetch_reads\": %u, "
+            "\"fetch_reuse\": %u, \"ets_saved\": %u, \"ring_overflows\": %llu, \"lanes\": [",
+            (unsigned long long)s.index,
+            (unsigned long long)s.cycles,
+            (unsigned long long)s.sim_ticks,
+            s.wall_seconds * 1e3,
+            s.mcycles_per_second(),
+            (unsigned long long)s.pixels_written,
+            (unsigned long long)s.pixels_changed,
+            s.hit_count,
+            s.skip_count,
+            s.cycles_per_pixel,
+            s.cache_hits,
+            s.cache_misses,
+            s.cache_evictions,
+            s.fetch_reads,
+            s.fetch_reuse,
+            s.ets_saved,
+            (unsigned long long)s.ring_overflows);
+        for (int k = 0; k < HYDRA_NUM_LANES; ++k)
+            std::fprintf(f,
+                "%s{\"utilisation\": %.4f, \"payload_stalls\": %llu, \"pixel_stalls\": %llu, "
+                "\"miss_stalls\": %llu}",
+                k ? ", " : "", s.lane_utilisation(k),
+                (unsigned long long)s.lanes[k].payload_stalls,
+                (unsigned long long)s.lanes[k].pixel_stalls,
+                (unsigned long long)s.lanes[k].miss_stalls);
+        std::fprintf(f, "]}%s\n", (i + 1 < r.frames.size()) ? "," : "");
+    }
+    std::fprintf(f, "  ],\n");
+    std::fprintf(f,
+        "  \"summary\": {\"frames\": %zu, \"cycles\": %llu, \"pixels_written\": %llu, "
+        "\"wall_ms\": %.3f, \"mcycles_per_s\": %.3f}\n",
+        r.frames.size(), (unsigned long long)total_cycles,
+        (unsigned long long)total_pixels, total_wall * 1e3, avg_mcps);
+    std::fprintf(f, "}\n");
+    std::fclose(f);
+}
+
+static std::vector<PathFrame> load_replay(const Options& opt) {
+    std::vector<PathFrame> path;
+    if (opt.replay.empty())
+        return path;
+    int w = 0, h = 0;
+    std::string err;
+    if (!camera_path_read(opt.replay, &w, &h, path, &err))
+        die(err);
+    if (w != SCREEN_WIDTH || h != SCREEN_HEIGHT)
+        std::fprintf(stderr, "Warning: %s was recorded at %dx%d, replaying at %dx%d\n",
+                     opt.replay.c_str(), w, h, SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (path.empty())
+        die(opt.replay + " has no frames");
+    return path;
+}
+
+// Compare the frame the RTL just finished with the model's render of the
+// same state. Prints the first differing pixel; returns the number of
+// differing pixels, plus one for a cursor or hit-count mismatch.
+static uint64_t diff_model_frame(const VoxelSim& sim, const VoxelModel& model, uint64_t index) {
+    const std::vector<uint32_t>&   rtl = sim.words();
+    const std::vector<ModelPixel>& ref = model.pixels();
+    uint64_t bad = 0;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        const uint32_t* w = &rtl[i * 3];
+        if (w[0] == ref[i].w0 && w[1] == ref[i].w1 && w[2] == ref[i].w2)
+            continue;
+        if (bad++ == 0)
+            std::fprintf(stderr,
+                "diff-model: frame %llu pixel (%zu,%zu) rtl %08x %08x %08x model %08x %08x %08x\n",
+                (unsigned long long)index, i % size_t(SCREEN_WIDTH), i / size_t(SCREEN_WIDTH),
+                w[0], w[1], w[2], ref[i].w0, ref[i].w1, ref[i].w2);
+    }
+
+    const CursorInfo   c = sim.cursor();
+    const ModelCursor& m = model.cursor();
+    if (c.hit_valid != m.hit_valid || c.x != m.x || c.y != m.y || c.z != m.z ||
+        c.material_id != m.material_id || c.voxel_data != m.voxel_data ||
+        sim.hit_count() != model.hit_count() || sim.skip_count() != model.skips()) {
+        std::fprintf(stderr, "diff-model: frame %llu cursor/hit/skip count differs "
+                     "(rtl hits %u skips %u, model hits %u skips %u)\n",
+                     (unsigned long long)index, sim.hit_count(), sim.skip_count(),
+                     model.hit_count(), model.skips());
+        ++bad;
+    }
+    return bad;
+}
+
+// Headless benchmark: no window, no HUD, no vsync. World generation is timed
+// separately so the per-frame numbers only cover raycasting.
+static int run_headless(const Options& opt) {
+    VoxelSim sim(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (!opt.pin_cpus.empty())
+        sim.pin_threads(opt.pin_cpus);
+    sim.set_log_frames(std::getenv("LOG_FRAMES") != nullptr);
+    sim.set_scene(opt.scene);
+
+    const std::vector<PathFrame> replay = load_replay(opt);
+
+    RunReport report;
+    auto warm_t0 = std::chrono::steady_clock::now();
+    report.warmup_cycles = sim.boot(opt.snapshot, &report.restored);
+    report.warmup_s = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - warm_t0).count();
+    if (!sim.world_ready())
+        die("world generation did not complete");
+    if (!opt.dump_scene.empty() && !sim.dump_scene(opt.dump_scene))
+        die("cannot write " + opt.dump_scene);
+
+    CameraPathWriter recorder;
+    if (!opt.record.empty()) {
+        std::string err;
+        if (!recorder.open(opt.record, SCREEN_WIDTH, SCREEN_HEIGHT, &err))
+            die(err);
+    }
+
+    // The model starts from the same power-on registers and renders every
+    // frame the RTL does, so its carry-over state stays in lockstep.
+    VoxelModel model(SCREEN_WIDTH, SCREEN_HEIGHT);
+    std::unique_ptr<TileRenderer> tiles;
+    if (opt.model_tiles) {
+        TileRenderer::Options topt;
+        topt.threads = opt.model_tiles;
+        tiles.reset(new TileRenderer(model, topt));
+    }
+    uint64_t diff_frames = 0;
+    double   model_wall  = 0.0;
+    if (opt.diff_model)
+        sim.set_keep_words(true);
+
+    // Applied after boot so cold and restored runs start from the same state.
+    // Frame-locked: record k is applied at the boundary before frame k.
+    const uint64_t target = replay.empty() ? opt.frames : uint64_t(replay.size());
+    PathFrame idle;
+    idle.flags.dda = opt.dda;
+    idle.flags.perspective = opt.perspective;
+    idle.flags.memo = opt.memo;
+    idle.flags.skip_empty = opt.skip_empty;
+    idle.flags.sdf = opt.sdf;
+    idle.flags.pipeline = opt.pipeline;
+    idle.flags.tile_order = opt.tile_order;
+    idle.flags.composite = opt.composite;
+    idle.flags.alpha_threshold = uint8_t(opt.alpha_threshold);
+    report.frames.reserve(target);
+    while (report.frames.size() < target && !sim.got_finish()) {
+        const PathFrame& fr = replay.empty() ? idle : replay[report.frames.size()];
+        camera_path_apply(sim, fr);
+        recorder.append(fr);
+        if (opt.diff_model)
+            sim.sync_model(model);
+        while (!sim.step(1 << 20)) {
+            if (sim.got_finish())
+                break;
+        }
+        if (sim.got_finish())
+            break;
+        report.frames.push_back(sim.last_frame());
+        if (opt.diff_model) {
+            auto t0 = std::chrono::steady_clock::now();
+            if (tiles)
+                tiles->render();
+            else
+                model.render();
+            model_wall += std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - t0).count();
+            // A frame the pixel ring dropped words from cannot match.
+            diff_frames += diff_model_frame(sim, model, sim.last_frame().index) != 0 ||
+                           sim.last_frame().ring_overflows != 0;
+        }
+    }
+    recorder.close();
+
+    report_summary(replay.empty() ? "headless" : "replay", opt, report);
+    if (!opt.json_path.empty())
+        write_report_json(opt.json_path, opt, report);
+    if (opt.diff_model) {
+        std::fprintf(stdout, "diff-model: %llu of %zu frames differ, model %.3f ms/frame\n",
+                     (unsigned long long)diff_frames, report.frames.size(),
+                     report.frames.empty() ? 0.0 : model_wall * 1e3 / double(report.frames.size()));
+        if (diff_frames != 0)
+            return 1;
+    }
+    return 0;
 }
 
 int main(int argc, char** argv) {
     Verilated::commandArgs(argc, argv);
 
-    Vvoxel_framebuffer_top* top = new Vvoxel_framebuffer_top;
-    auto* root = top->rootp;  // Access internal regs exposed by Verilator
-    top->clk   = 0;
-    top->rst_n = 0;
-    // Default AXI shell inputs (unused in this harness)
-    top->cam_load        = 0;
-    top->cam_x_in        = 0;
-    top->cam_y_in        = 0;
-    top->cam_z_in        = 0;
-    top->cam_dir_x_in    = 0;
-    top->cam_dir_y_in    = 0;
-    top->cam_dir_z_in    = 0;
-    top->cam_plane_x_in  = 0;
-    top->cam_plane_y_in  = 0;
-    top->flags_load      = 0;
-    top->flag_smooth_in  = 0;
-    top->flag_curvature_in = 0;
-    top->flag_extra_light_in = 0;
-    top->flag_diag_slice_in  = 0;
-    top->sel_load        = 0;
-    top->sel_active_in   = 0;
-    top->sel_voxel_x_in  = 0;
-    top->sel_voxel_y_in  = 0;
-    top->sel_voxel_z_in  = 0;
-    top->dbg_ext_write_en   = 0;
-    top->dbg_ext_write_addr = 0;
-    top->dbg_ext_write_data = 0;
-    top->start_frame_ext   = 0;
-    top->soft_reset_ext    = 0;
+    const Options opt = parse_options(argc, argv);
+    if (opt.headless)
+        return run_headless(opt);
+
+    // The RTL model runs on its own thread; this thread only handles input,
+    // HUD and presentation of whichever frame the sim finished last.
+    SimThread sim(SCREEN_WIDTH, SCREEN_HEIGHT);
 
     const bool log_keys = (std::getenv("LOG_KEYS") != nullptr);
     const bool log_frames = (std::getenv("LOG_FRAMES") != nullptr);
     int log_keys_count = 0;
-    size_t pixels_this_frame = 0;
-    size_t frame_counter = 0;
-    int log_pixel_samples = 0;
 
     // Ensure SDL grabs keyboard focus and uses software paths by default.
     SDL_SetHint(SDL_HINT_GRAB_KEYBOARD, "1");
@@ -233,42 +673,60 @@ int main(int argc, char** argv) {
     TTF_Font* font = TTF_OpenFont(
         "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf", 11
     );
-    if (!font) {
-        std::fprintf(stderr, "Warning: could not open font, HUD text disabled\n");
+    // Glyphs are rasterized once into an atlas; the font is not needed after.
+    HudText hud;
+    bool hud_ok = false;
+    if (font) {
+        hud_ok = hud.init(ren, font);
+        TTF_CloseFont(font);
+        font = nullptr;
     }
-
-    const size_t NPIX = size_t(SCREEN_WIDTH) * SCREEN_HEIGHT;
-    std::vector<uint32_t> framebuffer(NPIX, 0);
-
-    // Reset sequence
-    for (int i = 0; i < 10; ++i) {
-        top->clk = 0; top->eval(); main_time++;
-        top->clk = 1; top->eval(); main_time++;
+    if (!hud_ok) {
+        std::fprintf(stderr, "Warning: could not open font, HUD text disabled\n");
     }
-    top->rst_n = 1;
 
-    float pos_x = 10.0f;
-    float pos_y = 10.0f;
-    float pos_z = 10.0f;
-    float yaw   = 0.0f;
-    float pitch = 0.0f;
+    CameraPose cam;
+    float& pos_x = cam.pos_x;
+    float& pos_y = cam.pos_y;
+    float& pos_z = cam.pos_z;
+    float& yaw   = cam.yaw;
+    float& pitch = cam.pitch;
 
     float move_speed      = 0.10f;
     float move_speed_fast = 0.35f;
     float turn_speed_keys = 0.04f;
     float mouse_sens      = 0.0025f;
 
-    bool smooth_surfaces = true;
-    bool curvature       = true;
-    bool extra_light     = false;
-    bool diag_slice      = false;
+    RenderFlags flags;
+    bool& smooth_surfaces = flags.smooth_surfaces;
+    bool& curvature       = flags.curvature;
+    bool& extra_light     = flags.extra_light;
+    bool& diag_slice      = flags.diag_slice;
+    bool& dda             = flags.dda;
+    bool& perspective     = flags.perspective;
+    bool& memo            = flags.memo;
+    bool& skip_empty      = flags.skip_empty;
+    bool& sdf             = flags.sdf;
+    bool& pipeline        = flags.pipeline;
+    int&  tile_order      = flags.tile_order;
+    bool& composite       = flags.composite;
+    dda = opt.dda;
+    perspective = opt.perspective;
+    memo = opt.memo;
+    skip_empty = opt.skip_empty;
+    sdf = opt.sdf;
+    pipeline = opt.pipeline;
+    tile_order = opt.tile_order;
+    composite = opt.composite;
+    flags.alpha_threshold = uint8_t(opt.alpha_threshold);
 
     bool mouse_captured  = true;
 
-    bool selection_active = false;
-    uint8_t selection_x = 0;
-    uint8_t selection_y = 0;
-    uint8_t selection_z = 0;
+    SelectionState sel;
+    bool&    selection_active = sel.active;
+    uint8_t& selection_x = sel.x;
+    uint8_t& selection_y = sel.y;
+    uint8_t& selection_z = sel.z;
     uint64_t selection_word = 0;
     InputState keys;
 
@@ -280,52 +738,41 @@ int main(int argc, char** argv) {
         SDL_ShowCursor(mouse_captured ? SDL_FALSE : SDL_TRUE);
     };
 
-    auto apply_camera_to_dut = [&]() {
-        float dx = std::cos(yaw) * std::cos(pitch);
-        float dy = std::sin(yaw) * std::cos(pitch);
-        float dz = std::sin(pitch);
-
-        float px = -dy * 0.66f;
-        float py =  dx * 0.66f;
-
-        root->voxel_framebuffer_top__DOT__cam_x       = int16_t(pos_x * FX);
-        root->voxel_framebuffer_top__DOT__cam_y       = int16_t(pos_y * FX);
-        root->voxel_framebuffer_top__DOT__cam_z       = int16_t(pos_z * FX);
-        root->voxel_framebuffer_top__DOT__cam_dir_x   = int16_t(dx * FX);
-        root->voxel_framebuffer_top__DOT__cam_dir_y   = int16_t(dy * FX);
-        root->voxel_framebuffer_top__DOT__cam_dir_z   = int16_t(dz * FX);
-        root->voxel_framebuffer_top__DOT__cam_plane_x = int16_t(px * FX);
-        root->voxel_framebuffer_top__DOT__cam_plane_y = int16_t(py * FX);
-    };
-
-    auto apply_flags_to_dut = [&]() {
-        root->voxel_framebuffer_top__DOT__cfg_smooth_surfaces = smooth_surfaces ? 1 : 0;
-        root->voxel_framebuffer_top__DOT__cfg_curvature       = curvature       ? 1 : 0;
-        root->voxel_framebuffer_top__DOT__cfg_extra_light     = extra_light     ? 1 : 0;
-        root->voxel_framebuffer_top__DOT__cfg_diag_slice      = diag_slice     ? 1 : 0;
-    };
-
-    auto apply_selection_to_dut = [&]() {
-        root->voxel_framebuffer_top__DOT__sel_active  = selection_active ? 1 : 0;
-        root->voxel_framebuffer_top__DOT__sel_voxel_x = selection_x;
-        root->voxel_framebuffer_top__DOT__sel_voxel_y = selection_y;
-        root->voxel_framebuffer_top__DOT__sel_voxel_z = selection_z;
-    };
-
-    apply_camera_to_dut();
-    apply_flags_to_dut();
-    apply_selection_to_dut();
+    auto apply_camera_to_dut    = [&]() { sim.set_camera(cam); };
+    auto apply_flags_to_dut     = [&]() { sim.set_flags(flags); };
+    auto apply_selection_to_dut = [&]() { sim.set_selection(sel); };
+
+    SimThreadConfig sim_cfg;
+    sim_cfg.log_frames = log_frames;
+    sim_cfg.pin_cpus   = opt.pin_cpus;
+    sim_cfg.snapshot   = opt.snapshot;
+    sim_cfg.scene      = opt.scene;
+    sim_cfg.dump_scene = opt.dump_scene;
+    sim_cfg.record_path = opt.record;
+    sim_cfg.replay      = load_replay(opt);
+    sim_cfg.render_on_demand = !opt.free_run;
+    sim.start(cam, flags, sel, sim_cfg);
     update_mouse_capture();
 
     auto reset_key_state = [&]() { keys = InputState{}; };
 
     bool running = true;
-    auto last_frame_time = std::chrono::high_resolution_clock::now();
+    // The window is redrawn for every sim frame, for UI events (toggles,
+    // expose, resize) and at least every hud_period, so the HUD and FPS stay
+    // live while render-on-demand leaves the sim idle.
+    const auto hud_period = std::chrono::milliseconds(250);
+    auto fps_sample_time = std::chrono::high_resolution_clock::now();
+    auto next_hud_time   = fps_sample_time + hud_period;
+    int  frames_since_sample = 0;
+    // Damage is relative to the sim's previous frame; if the UI skipped one
+    // (triple buffer overwrite) or has shown nothing yet, upload everything.
+    bool     presented_any = false;
+    uint64_t presented_index = 0;
     float fps = 0.0f;
 
-    while (running && !Verilated::gotFinish()) {
-        // Default: no debug write
-        root->voxel_framebuffer_top__DOT__dbg_write_en = 0;
+    while (running && !sim.finished()) {
+        bool cam_changed = false;
+        bool redraw = false;
 
         SDL_Event ev;
         while (SDL_PollEvent(&ev)) {
@@ -337,6 +784,9 @@ int main(int argc, char** argv) {
                     update_mouse_capture();
                 } else if (ev.window.event == SDL_WINDOWEVENT_FOCUS_LOST) {
                     reset_key_state();
+                } else if (ev.window.event == SDL_WINDOWEVENT_EXPOSED ||
+                           ev.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                    redraw = true;
                 }
             } else if (ev.type == SDL_KEYDOWN || ev.type == SDL_KEYUP) {
                 bool key_down = (ev.type == SDL_KEYDOWN);
@@ -354,6 +804,8 @@ int main(int argc, char** argv) {
                 }
 
                 if (key_down) {
+                    // Toggles show in the HUD at once, frame or not.
+                    redraw = true;
                     switch (keycode) {
                         case SDLK_ESCAPE:
                             running = false;
@@ -382,6 +834,71 @@ int main(int argc, char** argv) {
                                 ++log_keys_count;
                             }
                             break;
+                        case SDLK_4: case SDLK_KP_4:
+                            dda = !dda;
+                            apply_flags_to_dut();
+                            if (log_keys && log_keys_count < 200) {
+                                std::fprintf(stderr, "toggle dda -> %d\n", dda ? 1 : 0);
+                                ++log_keys_count;
+                            }
+                            break;
+                        case SDLK_5: case SDLK_KP_5:
+                            perspective = !perspective;
+                            apply_flags_to_dut();
+                            if (log_keys && log_keys_count < 200) {
+                                std::fprintf(stderr, "toggle perspective -> %d\n", perspective ? 1 : 0);
+                                ++log_keys_count;
+                            }
+                            break;
+                        case SDLK_6: case SDLK_KP_6:
+                            memo = !memo;
+                            apply_flags_to_dut();
+                            if (log_keys && log_keys_count < 200) {
+                                std::fprintf(stderr, "toggle memo -> %d\n", memo ? 1 : 0);
+                                ++log_keys_count;
+                            }
+                            break;
+                        case SDLK_7: case SDLK_KP_7:
+                            skip_empty = !skip_empty;
+                            apply_flags_to_dut();
+                            if (log_keys && log_keys_count < 200) {
+                                std::fprintf(stderr, "toggle skip_empty -> %d\n", skip_empty ? 1 : 0);
+                                ++log_keys_count;
+                            }
+                            break;
+                        case SDLK_8: case SDLK_KP_8:
+                            sdf = !sdf;
+                            apply_flags_to_dut();
+                            if (log_keys && log_keys_count < 200) {
+                                std::fprintf(stderr, "toggle sdf -> %d\n", sdf ? 1 : 0);
+                                ++log_keys_count;
+                            }
+                            break;
+                        case SDLK_9: case SDLK_KP_9:
+                            pipeline = !pipeline;
+                            apply_flags_to_dut();
+                            if (log_keys && log_keys_count < 200) {
+                                std::fprintf(stderr, "toggle pipeline -> %d\n", pipeline ? 1 : 0);
+                                ++log_keys_count;
+                            }
+                            break;
+                        case SDLK_0: case SDLK_KP_0:
+                            tile_order = (tile_order + 1) & 3;
+                            apply_flags_to_dut();
+                            if (log_keys && log_keys_count < 200) {
+                                std::fprintf(stderr, "tile order -> %s\n",
+                                             kTileOrderNames[tile_order]);
+                                ++log_keys_count;
+                            }
+                            break;
+                        case SDLK_t:
+                            composite = !composite;
+                            apply_flags_to_dut();
+                            if (log_keys && log_keys_count < 200) {
+                                std::fprintf(stderr, "toggle composite -> %d\n", composite ? 1 : 0);
+                                ++log_keys_count;
+                            }
+                            break;
                         case SDLK_o:
                             diag_slice = !diag_slice;
                             apply_flags_to_dut();
@@ -394,16 +911,18 @@ int main(int argc, char** argv) {
                             mouse_captured = !mouse_captured;
                             update_mouse_capture();
                             break;
-                        case SDLK_f:
-                            if (root->voxel_framebuffer_top__DOT__cursor_hit_valid) {
+                        case SDLK_f: {
+                            const CursorInfo& cur = sim.frame().cursor;
+                            if (cur.hit_valid) {
                                 selection_active = true;
-                                selection_x = static_cast<uint8_t>(root->voxel_framebuffer_top__DOT__cursor_voxel_x);
-                                selection_y = static_cast<uint8_t>(root->voxel_framebuffer_top__DOT__cursor_voxel_y);
-                                selection_z = static_cast<uint8_t>(root->voxel_framebuffer_top__DOT__cursor_voxel_z);
-                                selection_word = static_cast<uint64_t>(root->voxel_framebuffer_top__DOT__cursor_voxel_data);
+                                selection_x = cur.x;
+                                selection_y = cur.y;
+                                selection_z = cur.z;
+                                selection_word = cur.voxel_data;
                                 apply_selection_to_dut();
                             }
                             break;
+                        }
                         case SDLK_g:
                             selection_active = false;
                             selection_word   = 0;
@@ -465,9 +984,7 @@ int main(int argc, char** argv) {
                         if (do_write) {
                             selection_word = w;
                             uint32_t addr = voxel_addr_from_xyz(selection_x, selection_y, selection_z);
-                            root->voxel_framebuffer_top__DOT__dbg_write_addr = addr;
-                            root->voxel_framebuffer_top__DOT__dbg_write_data = w;
-                            root->voxel_framebuffer_top__DOT__dbg_write_en   = 1;
+                            sim.write_voxel(addr, w);
                         }
                     }
                 }
@@ -478,12 +995,10 @@ int main(int argc, char** argv) {
                 pitch -= dy * mouse_sens;
                 if (pitch >  1.50f) pitch =  1.50f;
                 if (pitch < -1.50f) pitch = -1.50f;
-                apply_camera_to_dut();
+                cam_changed = true;
             }
         }
 
-        bool cam_changed = false;
-
         float fdx = std::cos(yaw);
         float fdy = std::sin(yaw);
         float rdx = -std::sin(yaw);
@@ -515,72 +1030,64 @@ int main(int argc, char** argv) {
             }
         }
 
-        // Simulate HDL
-        const int cycles_per_chunk = 2000;
-        bool frame_done = false;
-
-        for (int i = 0; i < cycles_per_chunk; ++i) {
-            top->clk = 1; top->eval(); main_time++;
-
-            if (top->pixel_write_en) {
-                uint32_t addr = top->pixel_addr;
-                if (addr < NPIX) {
-                    uint32_t w0 = top->pixel_word0;
-                    uint32_t w1 = top->pixel_word1;
-                    uint32_t w2 = top->pixel_word2;
-                    framebuffer[addr] = pixel96_to_argb(w0, w1, w2);
-
-                    if (log_frames && log_pixel_samples < 8) {
-                        std::fprintf(stderr, "pix addr=%u w0=%08x w1=%08x w2=%08x argb=%08x\n",
-                                     addr, w0, w1, w2,
-                                     pixel96_to_argb(w0, w1, w2));
-                        ++log_pixel_samples;
-                    }
-                }
-                ++pixels_this_frame;
-            }
-
-            if (top->frame_done)
-                frame_done = true;
-
-            top->clk = 0; top->eval(); main_time++;
-        }
+        // Pick up the newest frame the sim thread finished, if any.
+        const bool frame_done = sim.poll_frame();
 
         if (frame_done) {
-            if (log_frames) {
-                size_t nonzero = 0;
-                for (uint32_t v : framebuffer) {
-                    if (v != 0) ++nonzero;
-                }
-                uint32_t sample0 = framebuffer.empty() ? 0 : framebuffer[0];
-                uint32_t sample_mid = framebuffer.empty() ? 0 : framebuffer[NPIX/2];
-                std::fprintf(stderr,
-                    "frame %zu done, pixels_written=%zu nonzero=%zu sample0=%08x mid=%08x\n",
-                    frame_counter, pixels_this_frame, nonzero, sample0, sample_mid);
-            }
-            ++frame_counter;
+            const SimFrame& frame = sim.frame();
+            const std::vector<uint32_t>& framebuffer = frame.pixels;
 
-            auto now = std::chrono::high_resolution_clock::now();
-            float dt = std::chrono::duration<float>(now - last_frame_time).count();
-            last_frame_time = now;
-            if (dt > 0.0f) fps = 1.0f / dt;
+            ++frames_since_sample;
+
+            FrameDamage damage;
+            damage.full  = !presented_any || frame.stats.index != presented_index + 1;
+            damage.rects = frame.damage.data();
+            damage.count = int(frame.damage.size());
+            presented_any   = true;
+            presented_index = frame.stats.index;
 
             if (use_platform_present) {
                 present_backend(backend, plat_ctx, framebuffer.data(),
-                                SCREEN_WIDTH, SCREEN_HEIGHT);
+                                SCREEN_WIDTH, SCREEN_HEIGHT, damage);
             }
 
-            void* pixels = nullptr;
-            int pitch_bytes = 0;
-            if (SDL_LockTexture(tex, nullptr, &pixels, &pitch_bytes) != 0)
-                die("LockTexture failed");
+            if (damage.full) {
+                void* pixels = nullptr;
+                int pitch_bytes = 0;
+                if (SDL_LockTexture(tex, nullptr, &pixels, &pitch_bytes) != 0)
+                    die("LockTexture failed");
 
-            for (int y = 0; y < SCREEN_HEIGHT; ++y) {
-                uint32_t* row = (uint32_t*)((uint8_t*)pixels + y * pitch_bytes);
-                std::memcpy(row, &framebuffer[size_t(y)*SCREEN_WIDTH],
-                            SCREEN_WIDTH * sizeof(uint32_t));
+                for (int y = 0; y < SCREEN_HEIGHT; ++y) {
+                    uint32_t* row = (uint32_t*)((uint8_t*)pixels + y * pitch_bytes);
+                    std::memcpy(row, &framebuffer[size_t(y)*SCREEN_WIDTH],
+                                SCREEN_WIDTH * sizeof(uint32_t));
+                }
+                SDL_UnlockTexture(tex);
+            } else {
+                for (const DamageRect& r : frame.damage) {
+                    SDL_Rect rect{r.x, r.y, r.w, r.h};
+                    SDL_UpdateTexture(tex, &rect,
+                                      &framebuffer[size_t(r.y) * SCREEN_WIDTH + r.x],
+                                      SCREEN_WIDTH * sizeof(uint32_t));
+                }
             }
-            SDL_UnlockTexture(tex);
+        }
+
+        const auto now = std::chrono::high_resolution_clock::now();
+        if (now >= next_hud_time) {
+            // Sim frames shown per second over the last sample.
+            const float dt = std::chrono::duration<float>(now - fps_sample_time).count();
+            fps = dt > 0.0f ? float(frames_since_sample) / dt : 0.0f;
+            frames_since_sample = 0;
+            fps_sample_time = now;
+            next_hud_time   = now + hud_period;
+            redraw = true;
+        }
+
+        // The texture keeps the last frame, so a redraw without a new one
+        // repaints it under a fresh HUD.
+        if ((frame_done || redraw) && presented_any) {
+            const SimFrame& frame = sim.frame();
 
             SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
             SDL_RenderClear(ren);
@@ -591,56 +1098,92 @@ int main(int argc, char** argv) {
             SDL_Rect hud_rect{0, SCREEN_HEIGHT - HUD_HEIGHT, SCREEN_WIDTH, HUD_HEIGHT};
             SDL_RenderFillRect(ren, &hud_rect);
 
-            if (font) {
+            if (hud_ok) {
                 char buf[256];
-                uint32_t hits = root->voxel_framebuffer_top__DOT__core_dbg_hit_count;
+                int line = 0;
+                uint32_t hits = frame.stats.hit_count;
+                const CursorInfo& cur = frame.cursor;
                 const int hud_y = SCREEN_HEIGHT - HUD_HEIGHT + 4;
                 int yoff = hud_y;
 
+                // During replay the pose comes from the path, not the keyboard.
+                const CameraPose hud_cam = sim_cfg.replay.empty() ? cam : frame.cam;
                 std::snprintf(buf, sizeof(buf),
-                    "FPS %.1f | Pos %.1f %.1f %.1f",
-                    fps, pos_x, pos_y, pos_z);
-                draw_text(ren, font, buf, 6, yoff);
+                    "FPS %.1f | Sim %.2f Mcyc/s | Pos %.1f %.1f %.1f",
+                    fps, frame.stats.mcycles_per_second(),
+                    hud_cam.pos_x, hud_cam.pos_y, hud_cam.pos_z);
+                hud.draw(line++, buf, 6, yoff);
                 yoff += 14;
 
                 std::snprintf(buf, sizeof(buf),
-                    "Yaw %.2f  Pitch %.2f",
-                    yaw, pitch);
-                draw_text(ren, font, buf, 6, yoff);
+                    "Yaw %.2f  Pitch %.2f%s",
+                    hud_cam.yaw, hud_cam.pitch,
+                    sim_cfg.replay.empty() ? "" : "  [replay]");
+                hud.draw(line++, buf, 6, yoff);
                 yoff += 14;
 
                 std::snprintf(buf, sizeof(buf),
-                    "[1] Smooth %s  [2] Curv %s  [3] Extra %s",
+                    "[1] Smooth %s  [2] Curv %s  [3] Extra %s  [M] Mouse %s",
                     smooth_surfaces ? "ON" : "OFF",
                     curvature       ? "ON" : "OFF",
-                    extra_light     ? "ON" : "OFF");
-                draw_text(ren, font, buf, 6, yoff);
+                    extra_light     ? "ON" : "OFF",
+                    mouse_captured  ? "ON" : "OFF");
+                hud.draw(line++, buf, 6, yoff);
+                yoff += 14;
+
+                // Traversal, then acceleration, then pixel order and
+                // compositing; each line stays under ~70 characters so the
+                // 480-pixel HUD does not clip it.
+                std::snprintf(buf, sizeof(buf),
+                    "[4] DDA %s  [5] Persp %s  [6] Memo %s  [O] Slice %s",
+                    dda            ? "ON" : "OFF",
+                    perspective    ? "ON" : "OFF",
+                    memo           ? "ON" : "OFF",
+                    diag_slice     ? "ON" : "OFF");
+                hud.draw(line++, buf, 6, yoff);
+                yoff += 14;
+
+                std::snprintf(buf, sizeof(buf),
+                    "[7] Skip %s  [8] SDF %s  [9] Pipe %s",
+                    skip_empty     ? "ON" : "OFF",
+                    sdf            ? "ON" : "OFF",
+                    pipeline       ? "ON" : "OFF");
+                hud.draw(line++, buf, 6, yoff);
                 yoff += 14;
 
                 std::snprintf(buf, sizeof(buf),
-                    "[O] Slice %s  [M] Mouse %s",
-                    diag_slice     ? "ON" : "OFF",
-                    mouse_captured ? "ON" : "OFF");
-                draw_text(ren, font, buf, 6, yoff);
+                    "[0] Order %s  [T] Alpha %s (threshold %u)",
+                    kTileOrderNames[tile_order & 3],
+                    composite      ? "ON" : "OFF",
+                    (unsigned)flags.alpha_threshold);
+                hud.draw(line++, buf, 6, yoff);
                 yoff += 14;
 
                 std::snprintf(buf, sizeof(buf),
-                    "Hits this frame: %u", hits);
-                draw_text(ren, font, buf, 6, yoff);
+                    "Hits this frame: %u  Bricks skipped %u  Skipped %llu", hits,
+                    frame.stats.skip_count, (unsigned long long)sim.skipped_frames());
+                hud.draw(line++, buf, 6, yoff);
                 yoff += 14;
 
-                if (root->voxel_framebuffer_top__DOT__cursor_hit_valid) {
+                std::snprintf(buf, sizeof(buf),
+                    "Cyc/pixel %.2f  Line reuse %.1f%%  ETS saved %u",
+                    frame.stats.cycles_per_pixel, 100.0 * frame.stats.fetch_reuse_rate(),
+                    frame.stats.ets_saved);
+                hud.draw(line++, buf, 6, yoff);
+                yoff += 14;
+
+                if (cur.hit_valid) {
                     std::snprintf(buf, sizeof(buf),
                         "Cursor: (%u,%u,%u) mat=0x%02X",
-                        (unsigned)root->voxel_framebuffer_top__DOT__cursor_voxel_x,
-                        (unsigned)root->voxel_framebuffer_top__DOT__cursor_voxel_y,
-                        (unsigned)root->voxel_framebuffer_top__DOT__cursor_voxel_z,
-                        (unsigned)(root->voxel_framebuffer_top__DOT__cursor_material_id & 0xFF));
+                        (unsigned)cur.x,
+                        (unsigned)cur.y,
+                        (unsigned)cur.z,
+                        (unsigned)cur.material_id);
                 } else {
                     std::snprintf(buf, sizeof(buf),
                         "Cursor: (no hit)");
                 }
-                draw_text(ren, font, buf, 6, yoff);
+                hud.draw(line++, buf, 6, yoff);
                 yoff += 14;
 
                 if (selection_active) {
@@ -653,7 +1196,7 @@ int main(int argc, char** argv) {
                     std::snprintf(buf, sizeof(buf),
                         "Sel: (none)  (aim + F to select)");
                 }
-                draw_text(ren, font, buf, 6, yoff);
+                hud.draw(line++, buf, 6, yoff);
                 yoff += 14;
 
                 if (selection_active) {
@@ -671,25 +1214,31 @@ int main(int argc, char** argv) {
                         "Probe RGBA %3u/%3u/%3u/%3u L%3u MT%u MP=%02X E%3u",
                         r, g, b, alpha, light,
                         material_type, material_props, emissive);
-                    draw_text(ren, font, buf, 6, yoff);
+                    hud.draw(line++, buf, 6, yoff);
                 }
             }
 
             SDL_RenderPresent(ren);
-
-            pixels_this_frame = 0;
+        } else {
+            // Nothing to draw yet; don't spin the UI thread.
+            SDL_Delay(1);
         }
-
-        SDL_Delay(1);
     }
 
-    top->final();
-    delete top;
+    sim.stop();
+
+    if (!opt.replay.empty() || !opt.json_path.empty()) {
+        RunReport report;
+        report.frames = sim.frame_log();
+        report_summary(opt.replay.empty() ? "windowed" : "replay", opt, report);
+        if (!opt.json_path.empty())
+            write_report_json(opt.json_path, opt, report);
+    }
 
     if (use_platform_present)
         shutdown_backend(backend, plat_ctx);
 
-    if (font) TTF_CloseFont(font);
+    hud.close();
     TTF_Quit();
     SDL_DestroyTexture(tex);
     SDL_DestroyRenderer(ren);
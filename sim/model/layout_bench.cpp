@@ -0,0 +1,395 @@
+// ============================================================================
+// layout_bench.cpp
+// - Compares the voxel_memory_64 word orders (scene/voxel_layout.h) under
+//   the read streams of one frame: the orthographic DDA scan (the core's
+//   exact read order: x = 63 down to the hit, pixel by pixel), perspective
+//   rays from the viewer's default pose, and perspective rays from a
+//   diagonal pose that crosses all three axes.
+// - --order replays each stream with the pixels in raster order or in the
+//   core's 8x8 tile orders (render_config[9:8], VoxelModel::tile_cell).
+// - Each stream is replayed per layout through set-associative LRU caches,
+//   a DRAM page model (a switch whenever a read leaves the last read's
+//   page) and a host-side gather over a volume stored in that layout.
+// ============================================================================
+#include "model/voxel_model.h"
+#include "scene/hvx.h"
+#include "scene/voxel_layout.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct Options {
+    int              width      = 480;
+    int              height     = 360;
+    int              line_words = 8;      // 64-byte lines
+    int              ways       = 4;
+    int              page_words = 256;    // 2 KiB DRAM pages
+    std::vector<int> cache_kib  = {4, 16, 64};
+    std::vector<int> orders     = {0};    // render_config[9:8] values
+    std::string      hvx;
+};
+
+static const char* const kOrderNames[4] = {"raster", "tiles", "morton", "hilbert"};
+
+[[noreturn]] static void die(const char* msg) {
+    std::fprintf(stderr, "Error: %s\n", msg);
+    std::exit(2);
+}
+
+static void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s [--size WxH] [--hvx SCENE.hvx] [--cache-kib LIST] [--line-words N]\n"
+        "          [--ways N] [--page-words N] [--order LIST]\n"
+        "  --cache-kib LIST cache sizes to model, e.g. 4,16,64 (default)\n"
+        "  --line-words N   64-bit words per cache line (default 8)\n"
+        "  --ways N         associativity (default 4)\n"
+        "  --page-words N   64-bit words per DRAM page (default 256)\n"
+        "  --order LIST     pixel orders to compare: raster (default), tiles, morton,\n"
+        "                   hilbert, e.g. raster,hilbert\n",
+        argv0);
+}
+
+static bool pow2(int v) {
+    return v > 0 && (v & (v - 1)) == 0;
+}
+
+static Options parse_args(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool has_val = i + 1 < argc;
+        if (a == "--size" && has_val) {
+            if (std::sscanf(argv[++i], "%dx%d", &opt.width, &opt.height) != 2 ||
+                opt.width < 2 || opt.height < 2)
+                die("--size wants WxH, at least 2x2");
+        } else if (a == "--hvx" && has_val) {
+            opt.hvx = argv[++i];
+        } else if (a == "--cache-kib" && has_val) {
+            opt.cache_kib.clear();
+            const char* p = argv[++i];
+            while (*p) {
+                char* end = nullptr;
+                const long n = std::strtol(p, &end, 10);
+                if (end == p || !pow2(int(n)) || n > 65536 || (*end && *end != ','))
+                    die("--cache-kib wants a comma-separated list of powers of two");
+                opt.cache_kib.push_back(int(n));
+                p = *end == ',' ? end + 1 : end;
+            }
+        } else if (a == "--line-words" && has_val) {
+            opt.line_words = std::atoi(argv[++i]);
+            if (!pow2(opt.line_words) || opt.line_words > 512)
+                die("--line-words wants a power of two up to 512");
+        } else if (a == "--ways" && has_val) {
+            opt.ways = std::atoi(argv[++i]);
+            if (opt.ways < 1 || opt.ways > 64)
+                die("--ways wants 1..64");
+        } else if (a == "--page-words" && has_val) {
+            opt.page_words = std::atoi(argv[++i]);
+            if (!pow2(opt.page_words))
+                die("--page-words wants a power of two");
+        } else if (a == "--order" && has_val) {
+            opt.orders.clear();
+            std::string list = argv[++i];
+            size_t pos = 0;
+            while (pos <= list.size()) {
+                const size_t end = std::min(list.find(',', pos), list.size());
+                const std::string name = list.substr(pos, end - pos);
+                int order = -1;
+                for (int k = 0; k < 4; ++k)
+                    if (name == kOrderNames[k])
+                        order = k;
+                if (order < 0)
+                    die("--order wants a comma-separated list of raster, tiles, morton, hilbert");
+                opt.orders.push_back(order);
+                pos = end + 1;
+            }
+        } else if (a == "--help" || a == "-h") {
+            usage(argv[0]);
+            std::exit(0);
+        } else {
+            usage(argv[0]);
+            std::exit(2);
+        }
+    }
+    return opt;
+}
+
+static bool solid(uint64_t w) {
+    return w != 0 && ((w >> 40) & 0xFF) > 10;
+}
+
+static uint32_t addr_of(int x, int y, int z) {
+    return (uint32_t(x) << 12) | (uint32_t(y) << 6) | uint32_t(z);
+}
+
+struct Pixel {
+    int x, y;
+};
+
+// The pixels of one frame in the core's order on one lane: rows top to
+// bottom, or 8x8 tiles in cell order with raster order inside a tile.
+static std::vector<Pixel> pixel_order(const Options& opt, int order) {
+    std::vector<Pixel> out;
+    out.reserve(size_t(opt.width) * size_t(opt.height));
+    if (order == 0) {
+        for (int py = 0; py < opt.height; ++py)
+            for (int px = 0; px < opt.width; ++px)
+                out.push_back({px, py});
+        return out;
+    }
+    const int t = VoxelModel::kTile;
+    const int tiles_x = (opt.width + t - 1) / t, tiles_y = (opt.height + t - 1) / t;
+    const int bits = VoxelModel::tile_bits(tiles_x, tiles_y);
+    for (uint32_t d = 0; d < 1u << (2 * bits); ++d) {
+        int tx, ty;
+        VoxelModel::tile_cell(order, bits, d, tx, ty);
+        if (tx >= tiles_x || ty >= tiles_y)
+            continue;
+        for (int py = ty * t; py < std::min(ty * t + t, opt.height); ++py)
+            for (int px = tx * t; px < std::min(tx * t + t, opt.width); ++px)
+                out.push_back({px, py});
+    }
+    return out;
+}
+
+// The core's orthographic DDA scan without skipping: every pixel reads its
+// (map_y, map_z) column from x = 63 down to the first solid voxel.
+static void ortho_stream(const Options& opt, const std::vector<Pixel>& pixels,
+                         const uint64_t* vox, std::vector<uint32_t>& out) {
+    for (const Pixel& p : pixels) {
+        const int my = ((opt.height - 1 - p.y) * 63) / (opt.height - 1);
+        const int mz = (p.x * 63) / (opt.width - 1);
+        for (int x = 63; x >= 0; --x) {
+            const uint32_t a = addr_of(x, my, mz);
+            out.push_back(a);
+            if (solid(vox[a]))
+                break;
+        }
+    }
+}
+
+// Voxel-by-voxel walk of one ray (voxel coordinates, y up) until it hits,
+// leaves the volume or has read 192 voxels.
+static void walk_ray(const double org[3], const double dir[3], const uint64_t* vox,
+                     std::vector<uint32_t>& out) {
+    double t0 = 0.0, t1 = 1e30;
+    for (int a = 0; a < 3; ++a) {
+        if (std::fabs(dir[a]) < 1e-12) {
+            if (org[a] < 0.0 || org[a] >= 64.0)
+                return;
+            continue;
+        }
+        double ta = (0.0 - org[a]) / dir[a], tb = (64.0 - org[a]) / dir[a];
+        if (ta > tb)
+            std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+    }
+    if (t0 >= t1)
+        return;
+
+    int    pos[3], step[3];
+    double tmax[3], tdelta[3];
+    for (int a = 0; a < 3; ++a) {
+        const double p = org[a] + dir[a] * (t0 + 1e-9);
+        pos[a]  = std::min(63, std::max(0, int(std::floor(p))));
+        step[a] = dir[a] < 0.0 ? -1 : 1;
+        if (std::fabs(dir[a]) < 1e-12) {
+            tmax[a] = tdelta[a] = 1e30;
+            continue;
+        }
+        const double edge = dir[a] < 0.0 ? pos[a] : pos[a] + 1;
+        tmax[a]   = (edge - org[a]) / dir[a];
+        tdelta[a] = 1.0 / std::fabs(dir[a]);
+    }
+    for (int n = 0; n < 192; ++n) {
+        const uint32_t addr = addr_of(pos[0], pos[1], pos[2]);
+        out.push_back(addr);
+        if (solid(vox[addr]))
+            return;
+        const int a = tmax[0] <= tmax[1] && tmax[0] <= tmax[2] ? 0 : tmax[1] <= tmax[2] ? 1 : 2;
+        pos[a] += step[a];
+        if (pos[a] < 0 || pos[a] > 63)
+            return;
+        tmax[a] += tdelta[a];
+    }
+}
+
+// One ray per pixel from eye towards target, 90-degree horizontal field of
+// view, y up.
+static void perspective_stream(const Options& opt, const std::vector<Pixel>& pixels,
+                               const uint64_t* vox, const double eye[3], const double target[3],
+                               std::vector<uint32_t>& out) {
+    double f[3], r[3], u[3];
+    for (int a = 0; a < 3; ++a)
+        f[a] = target[a] - eye[a];
+    const double fl = std::sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    for (double& v : f)
+        v /= fl;
+    // right = forward x up(0,1,0), up = right x forward
+    r[0] = -f[2];
+    r[1] = 0.0;
+    r[2] = f[0];
+    const double rl = std::sqrt(r[0] * r[0] + r[2] * r[2]);
+    for (double& v : r)
+        v /= rl;
+    u[0] = r[1] * f[2] - r[2] * f[1];
+    u[1] = r[2] * f[0] - r[0] * f[2];
+    u[2] = r[0] * f[1] - r[1] * f[0];
+
+    const double aspect = double(opt.height) / double(opt.width);
+    for (const Pixel& p : pixels) {
+        const double sy = (1.0 - 2.0 * p.y / (opt.height - 1)) * aspect;
+        const double sx = 2.0 * p.x / (opt.width - 1) - 1.0;
+        double d[3];
+        for (int a = 0; a < 3; ++a)
+            d[a] = f[a] + sx * r[a] + sy * u[a];
+        walk_ray(eye, d, vox, out);
+    }
+}
+
+// Set-associative LRU cache over line numbers.
+class Cache {
+public:
+    Cache(int lines, int ways) : sets_(std::max(1, lines / ways)), ways_(ways),
+                                 tags_(size_t(sets_) * size_t(ways), ~0u) {}
+
+    // True on a hit. Each set keeps its ways most recent first.
+    bool access(uint32_t line) {
+        uint32_t* set = &tags_[size_t(line % uint32_t(sets_)) * size_t(ways_)];
+        int w = 0;
+        while (w < ways_ && set[w] != line)
+            ++w;
+        const bool hit = w < ways_;
+        for (int i = std::min(w, ways_ - 1); i > 0; --i)
+            set[i] = set[i - 1];
+        set[0] = line;
+        return hit;
+    }
+
+private:
+    int                   sets_;
+    int                   ways_;
+    std::vector<uint32_t> tags_;
+};
+
+// Keeps the gather loop from being optimised away.
+static volatile uint64_t g_sink;
+
+struct LayoutResult {
+    std::vector<uint64_t> misses;   // per cache size
+    uint64_t              lines    = 0;   // distinct lines touched
+    uint64_t              switches = 0;   // DRAM page switches
+    double                ns_per_read = 0.0;
+};
+
+static LayoutResult replay(const Options& opt, VoxelLayout layout,
+                           const std::vector<uint32_t>& stream, const uint64_t* stored) {
+    LayoutResult res;
+    std::vector<uint32_t> index(stream.size());
+    for (size_t i = 0; i < stream.size(); ++i)
+        index[i] = voxel_layout_index(layout, stream[i]);
+
+    const uint32_t line_shift = uint32_t(__builtin_ctz(unsigned(opt.line_words)));
+    const uint32_t page_shift = uint32_t(__builtin_ctz(unsigned(opt.page_words)));
+    for (int kib : opt.cache_kib) {
+        Cache cache(kib * 1024 / (8 * opt.line_words), opt.ways);
+        uint64_t misses = 0;
+        for (uint32_t i : index)
+            misses += !cache.access(i >> line_shift);
+        res.misses.push_back(misses);
+    }
+    std::vector<uint8_t> seen((kLayoutVoxels >> line_shift) + 1, 0);
+    uint32_t page = ~0u;
+    for (uint32_t i : index) {
+        res.lines += !seen[i >> line_shift];
+        seen[i >> line_shift] = 1;
+        res.switches += (i >> page_shift) != page;
+        page = i >> page_shift;
+    }
+
+    // Host gather along the same stream; best of five.
+    double best = 1e30;
+    for (int rep = 0; rep < 5; ++rep) {
+        const auto t0 = std::chrono::steady_clock::now();
+        uint64_t acc = 0;
+        for (uint32_t i : index)
+            acc += stored[i];
+        const auto t1 = std::chrono::steady_clock::now();
+        g_sink = g_sink + acc;
+        best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+    }
+    res.ns_per_read = stream.empty() ? 0.0 : best * 1e9 / double(stream.size());
+    return res;
+}
+
+int main(int argc, char** argv) {
+    const Options opt = parse_args(argc, argv);
+
+    std::vector<uint64_t> vox;
+    if (opt.hvx.empty()) {
+        VoxelModel model(2, 2);
+        model.generate_world();
+        vox.assign(model.volume(), model.volume() + VoxelModel::kVoxels);
+    } else {
+        HvxFile f;
+        std::string err;
+        if (!f.open(opt.hvx, &err))
+            die(err.c_str());
+        if (f.count() != kLayoutVoxels)
+            die("scene must be 64x64x64");
+        hvx_words_xyz(f, vox);
+    }
+
+    struct Stream {
+        const char*           name;
+        int                   order;
+        std::vector<uint32_t> reads;
+    };
+    // The viewer's default pose: outside the volume on -X, looking along +X.
+    const double eye0[3] = {-24.0, 28.0, 32.0}, at0[3] = {64.0, 28.0, 32.0};
+    const double eye1[3] = {84.0, 60.0, 88.0}, at1[3] = {32.0, 12.0, 32.0};
+    std::vector<Stream> streams;
+    for (const char* name : {"ortho", "persp", "diagonal"}) {
+        for (int order : opt.orders) {
+            const std::vector<Pixel> pixels = pixel_order(opt, order);
+            Stream s{name, order, {}};
+            if (s.name[0] == 'o')
+                ortho_stream(opt, pixels, vox.data(), s.reads);
+            else if (s.name[0] == 'p')
+                perspective_stream(opt, pixels, vox.data(), eye0, at0, s.reads);
+            else
+                perspective_stream(opt, pixels, vox.data(), eye1, at1, s.reads);
+            streams.push_back(std::move(s));
+        }
+    }
+
+    std::printf("layout_bench: %dx%d, %d-word lines, %d-way LRU, %d-word DRAM pages\n",
+                opt.width, opt.height, opt.line_words, opt.ways, opt.page_words);
+    std::printf("%-9s %-7s %-7s %10s", "stream", "order", "layout", "reads");
+    for (int kib : opt.cache_kib)
+        std::printf("  %4dKiB miss", kib);
+    std::printf("  %8s  %12s  %11s\n", "lines", "page switch", "host ns/rd");
+
+    std::vector<uint64_t> stored(kLayoutVoxels);
+    for (const Stream& s : streams) {
+        for (VoxelLayout l : {VoxelLayout::Xyz, VoxelLayout::Morton, VoxelLayout::Brick}) {
+            voxel_layout_convert(VoxelLayout::Xyz, l, vox.data(), stored.data());
+            const LayoutResult r = replay(opt, l, s.reads, stored.data());
+            const double n = double(std::max<size_t>(1, s.reads.size()));
+            std::printf("%-9s %-7s %-7s %10zu", s.name, kOrderNames[s.order],
+                        voxel_layout_name(l), s.reads.size());
+            for (uint64_t m : r.misses)
+                std::printf("  %11.2f%%", 100.0 * double(m) / n);
+            std::printf("  %8llu  %11.2f%%  %11.2f\n", (unsigned long long)r.lines,
+                        100.0 * double(r.switches) / n, r.ns_per_read);
+        }
+    }
+    return 0;
+}
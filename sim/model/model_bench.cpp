@@ -0,0 +1,319 @@
+// ============================================================================
+// model_bench.cpp
+// - Thread-scaling benchmark for TileRenderer: renders the world (or an .hvx
+//   scene) at each requested thread count, checks every frame set against
+//   the single-thread model and reports per-tile timing.
+// ============================================================================
+#include "model/tile_renderer.h"
+#include "model/voxel_model.h"
+#include "scene/distance_field.h"
+#include "scene/hvx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Options {
+    int              width  = 480;
+    int              height = 360;
+    int              tile_w = 32;
+    int              tile_h = 32;
+    int              frames = 50;
+    int              lanes  = 1;
+    std::vector<int> threads;
+    std::string      hvx;
+    std::string      tiles_csv;
+    std::string      simd;
+    bool             dda = false;
+    bool             perspective = false;
+    bool             memo = false;
+    bool             skip_empty = false;
+    bool             sdf = false;
+    int              tile_order = 0;
+    bool             composite = false;
+};
+
+[[noreturn]] static void die(const char* msg) {
+    std::fprintf(stderr, "Error: %s\n", msg);
+    std::exit(2);
+}
+
+static void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s [--size WxH] [--tile WxH] [--threads LIST] [--frames N]\n"
+        "          [--simd scalar|avx2|avx512] [--hvx SCENE.hvx] [--tiles-csv PATH] [--dda]\n"
+        "          [--perspective] [--memo] [--skip-empty] [--sdf] [--lanes N]\n"
+        "          [--tile-order N] [--composite]\n"
+        "  --threads LIST  thread counts to sweep, e.g. 1,2,4,8,16,32 (default:\n"
+        "                  powers of two up to the host's hardware threads)\n"
+        "  --tiles-csv     per-tile times of the last frame at each thread count\n"
+        "  --dda           render with 3D-DDA traversal (render_config[2])\n"
+        "  --perspective   perspective rays (render_config[3]) from the viewer's\n"
+        "                  default pose, outside the volume looking along +X\n"
+        "  --memo          trace each orthographic ray once (render_config[4])\n"
+        "  --skip-empty    skip empty 8^3 bricks without reading them (render_config[5])\n"
+        "  --sdf           bake a distance field into the volume and let DDA and\n"
+        "                  perspective rays jump with it (render_config[6])\n"
+        "  --lanes N       render as N raycaster lanes (voxel_framebuffer_top\n"
+        "                  NUM_LANES, 1..8): core cycles are the slowest lane's\n"
+        "  --tile-order N  walk the frame in 8x8 tiles (render_config[9:8]): 1 tile\n"
+        "                  raster, 2 Morton, 3 Hilbert\n"
+        "  --composite     blend translucent voxels (render_config[10])\n"
+        "memo and composite frames fall back to the single-thread model; the\n"
+        "table says so in place of the tile times.\n",
+        argv0);
+}
+
+static bool parse_pair(const char* s, int& a, int& b) {
+    return std::sscanf(s, "%dx%d", &a, &b) == 2 && a > 0 && b > 0;
+}
+
+static Options parse_args(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool has_val = i + 1 < argc;
+        if (a == "--size" && has_val) {
+            if (!parse_pair(argv[++i], opt.width, opt.height) || opt.width < 2 || opt.height < 2)
+                die("--size wants WxH, at least 2x2");
+        } else if (a == "--tile" && has_val) {
+            if (!parse_pair(argv[++i], opt.tile_w, opt.tile_h))
+                die("--tile wants WxH");
+        } else if (a == "--threads" && has_val) {
+            const char* p = argv[++i];
+            while (*p) {
+                char* end = nullptr;
+                const long n = std::strtol(p, &end, 10);
+                if (end == p || n < 1 || n > 1024)
+                    die("--threads wants a comma-separated list of counts");
+                opt.threads.push_back(int(n));
+                p = *end == ',' ? end + 1 : end;
+                if (*end && *end != ',')
+                    die("--threads wants a comma-separated list of counts");
+            }
+        } else if (a == "--frames" && has_val) {
+            opt.frames = std::atoi(argv[++i]);
+            if (opt.frames < 1)
+                die("--frames must be positive");
+        } else if (a == "--simd" && has_val) {
+            opt.simd = argv[++i];
+        } else if (a == "--hvx" && has_val) {
+            opt.hvx = argv[++i];
+        } else if (a == "--tiles-csv" && has_val) {
+            opt.tiles_csv = argv[++i];
+        } else if (a == "--dda") {
+            opt.dda = true;
+        } else if (a == "--perspective") {
+            opt.perspective = true;
+        } else if (a == "--memo") {
+            opt.memo = true;
+        } else if (a == "--skip-empty") {
+            opt.skip_empty = true;
+        } else if (a == "--sdf") {
+            opt.sdf = true;
+        } else if (a == "--tile-order" && has_val) {
+            opt.tile_order = std::atoi(argv[++i]);
+            if (opt.tile_order < 0 || opt.tile_order > 3)
+                die("--tile-order wants 0..3");
+        } else if (a == "--composite") {
+            opt.composite = true;
+        } else if (a == "--lanes" && has_val) {
+            opt.lanes = std::atoi(argv[++i]);
+            if (opt.lanes < 1 || opt.lanes > VoxelModel::kMaxLanes)
+                die("--lanes wants 1..8");
+        } else if (a == "--help" || a == "-h") {
+            usage(argv[0]);
+            std::exit(0);
+        } else {
+            usage(argv[0]);
+            std::exit(2);
+        }
+    }
+    if (opt.threads.empty()) {
+        const int hw = std::max(1, int(std::thread::hardware_concurrency()));
+        for (int n = 1; n < hw; n *= 2)
+            opt.threads.push_back(n);
+        opt.threads.push_back(hw);
+    }
+    return opt;
+}
+
+static void load_scene(const Options& opt, VoxelModel& model) {
+    if (opt.hvx.empty()) {
+        model.generate_world();
+        return;
+    }
+    HvxFile f;
+    std::string err;
+    if (!f.open(opt.hvx, &err))
+        die(err.c_str());
+    if (f.count() != VoxelModel::kVoxels)
+        die("scene must be 64x64x64");
+    std::vector<uint64_t> words;
+    hvx_words_xyz(f, words);
+    model.load_volume(words.data());
+}
+
+// The model carries the volume as loaded, so bake the field on a copy.
+static void bake_distance_field(VoxelModel& model) {
+    std::vector<uint64_t> words(model.volume(), model.volume() + VoxelModel::kVoxels);
+    distance_field_build(words.data());
+    model.load_volume(words.data());
+}
+
+static SimdLevel pick_simd(const std::string& name) {
+    const SimdLevel best = simd_detect();
+    if (name.empty())
+        return best;
+    for (SimdLevel l : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        if (name == simd_name(l)) {
+            if (l > best)
+                die("--simd level not supported by this CPU/build");
+            return l;
+        }
+    }
+    die("--simd wants scalar, avx2 or avx512");
+}
+
+static bool same_frame(const VoxelModel& a, const VoxelModel& b) {
+    const ModelCursor& ca = a.cursor();
+    const ModelCursor& cb = b.cursor();
+    return std::memcmp(a.pixels().data(), b.pixels().data(),
+                       a.pixels().size() * sizeof(ModelPixel)) == 0 &&
+           a.hit_count() == b.hit_count() && a.cycles() == b.cycles() &&
+           a.reads() == b.reads() && a.skips() == b.skips() &&
+           ca.hit_valid == cb.hit_valid && ca.voxel_data == cb.voxel_data;
+}
+
+int main(int argc, char** argv) {
+    const Options opt = parse_args(argc, argv);
+    const SimdLevel simd = pick_simd(opt.simd);
+
+    FILE* csv = nullptr;
+    if (!opt.tiles_csv.empty()) {
+        csv = std::fopen(opt.tiles_csv.c_str(), "w");
+        if (!csv)
+            die("cannot open --tiles-csv file");
+        std::fprintf(csv, "threads,tx,ty,worker,ns\n");
+    }
+
+    // Single-thread reference, stepped frame by frame beside each run so the
+    // carry-over registers match too.
+    static const char* const kOrders[] = {"", " + tile raster", " + morton", " + hilbert"};
+    std::printf("model_bench: %dx%d, tiles %dx%d, simd %s, %s%s%s%s%s%s, %d lane(s), "
+                "%d frames per run\n",
+                opt.width, opt.height, opt.tile_w, opt.tile_h, simd_name(simd),
+                opt.perspective ? "perspective" : opt.dda ? "dda" : "march",
+                opt.memo ? " + memo" : "", opt.skip_empty ? " + skip" : "",
+                opt.sdf ? " + sdf" : "", kOrders[opt.tile_order],
+                opt.composite ? " + composite" : "", opt.lanes, opt.frames);
+    ModelConfig cfg;
+    cfg.dda  = opt.dda;
+    cfg.memo = opt.memo;
+    cfg.skip_empty = opt.skip_empty;
+    cfg.sdf = opt.sdf;
+    cfg.lanes = opt.lanes;
+    cfg.tile_order = opt.tile_order;
+    cfg.composite = opt.composite;
+    if (opt.perspective) {
+        cfg.perspective = true;
+        cfg.cam_x       = -24 * 256;
+        cfg.cam_y       = 32 * 256;
+        cfg.cam_z       = 28 * 256;
+        cfg.cam_dir_x   = 256;
+        cfg.cam_dir_y   = 0;
+        cfg.cam_dir_z   = 0;
+        cfg.cam_plane_x = 0;
+        cfg.cam_plane_y = 168;
+    }
+    bool printed_core = false;
+
+    double base_ms = 0.0;
+    int    mismatches = 0;
+    for (int threads : opt.threads) {
+        VoxelModel ref(opt.width, opt.height);
+        VoxelModel model(opt.width, opt.height);
+        ref.set_simd(simd);
+        model.set_simd(simd);
+        ref.set_config(cfg);
+        model.set_config(cfg);
+        load_scene(opt, ref);
+        load_scene(opt, model);
+        if (opt.sdf) {
+            bake_distance_field(ref);
+            bake_distance_field(model);
+        }
+
+        TileRenderer::Options topt;
+        topt.threads = threads;
+        topt.tile_w  = opt.tile_w;
+        topt.tile_h  = opt.tile_h;
+        TileRenderer tiles(model, topt);
+
+        // First frames: check, and warm the column cache and pool.
+        for (int i = 0; i < 2; ++i) {
+            ref.render();
+            tiles.render();
+            if (!same_frame(ref, model)) {
+                std::fprintf(stderr, "model_bench: %d threads: frame %d differs from the "
+                             "single-thread model\n", threads, i);
+                ++mismatches;
+            }
+        }
+        if (!printed_core) {
+            // What the RTL core would spend on the same frame.
+            std::printf("core: %llu voxel reads, %llu cycles, %u bricks skipped per frame\n",
+                        (unsigned long long)ref.reads(), (unsigned long long)ref.cycles(),
+                        ref.skips());
+            // Split planes: one trace byte per read, one payload word per
+            // hit (memo copies fetch nothing, so that is an upper bound).
+            std::printf("core: %.1f KiB voxel traffic per frame (%.1f KiB as 64-bit reads)\n",
+                        (ref.reads() + 8.0 * ref.hit_count()) / 1024.0,
+                        8.0 * ref.reads() / 1024.0);
+            printed_core = true;
+            std::printf("threads  ms/frame  speedup  steals/frame  tile us min/med/max  "
+                        "summary/scan/tiles ms\n");
+        }
+
+        TileFrameStats sum;
+        uint64_t steals = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int f = 0; f < opt.frames; ++f) {
+            tiles.render();
+            const TileFrameStats& s = tiles.stats();
+            sum.summary_ms += s.summary_ms;
+            sum.scan_ms    += s.scan_ms;
+            sum.tiles_ms   += s.tiles_ms;
+            steals         += s.steals;
+        }
+        const double ms = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - t0).count() / opt.frames;
+        if (base_ms == 0.0)
+            base_ms = ms * threads;   // first entry normalised to one thread
+
+        std::vector<uint32_t> ns;
+        for (const TileTiming& t : tiles.tile_times()) {
+            ns.push_back(t.ns);
+            if (csv)
+                std::fprintf(csv, "%d,%u,%u,%u,%u\n", threads, t.tx, t.ty, t.worker, t.ns);
+        }
+        if (const char* why = tiles.stats().fallback) {
+            std::printf("%7d  %8.3f  %7.2f  %12s  single-thread fallback (%s)\n",
+                        threads, ms, base_ms / ms, "-", why);
+            continue;
+        }
+        std::sort(ns.begin(), ns.end());
+        std::printf("%7d  %8.3f  %7.2f  %12.1f  %6.1f/%6.1f/%6.1f  %6.3f/%6.3f/%6.3f\n",
+                    threads, ms, base_ms / ms, double(steals) / opt.frames,
+                    ns.front() / 1e3, ns[ns.size() / 2] / 1e3, ns.back() / 1e3,
+                    sum.summary_ms / opt.frames, sum.scan_ms / opt.frames,
+                    sum.tiles_ms / opt.frames);
+    }
+    if (csv)
+        std::fclose(csv);
+    return mismatches ? 1 : 0;
+}
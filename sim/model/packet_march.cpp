@@ -0,0 +1,301 @@
+// ============================================================================
+// packet_march.cpp
+// - Scalar, AVX2 and AVX-512 column march and shading kernels.
+// ============================================================================
+#include "packet_march.h"
+#include "voxel_model.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HYDRA_MODEL_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+static bool solid_word(uint64_t v) { return ((v >> 40) & 0xFF) > 10; }
+
+SimdLevel simd_detect() {
+#ifdef HYDRA_MODEL_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::Avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::Avx2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+const char* simd_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2:   return "avx2";
+        case SimdLevel::Avx512: return "avx512";
+        default:                return "scalar";
+    }
+}
+
+int simd_lanes(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2:   return 8;
+        case SimdLevel::Avx512: return 16;
+        default:                return 1;
+    }
+}
+
+void ShadeRow::resize(size_t n) {
+    const size_t padded = (n + 15) & ~size_t(15);
+    for (std::vector<uint32_t>* v : {&lo, &hi, &x, &y, &z, &steps, &normals, &hit})
+        v->assign(padded, 0);
+}
+
+// ---------------------------------------------------------------------------
+// Column march
+// ---------------------------------------------------------------------------
+static void march_scalar(const uint64_t* vox, const uint16_t* columns, size_t n,
+                         uint8_t* steps) {
+    for (size_t i = 0; i < n; ++i) {
+        steps[i] = 0;
+        for (int t = 0; t < kMarchTests; ++t) {
+            if (solid_word(vox[(uint32_t(63 - t) << 12) | columns[i]])) {
+                steps[i] = uint8_t(march_test_step(t));
+                break;
+            }
+        }
+    }
+}
+
+#ifdef HYDRA_MODEL_X86_SIMD
+
+// Lanes whose word is occupied: alpha (bits 47:40) > 10, compared in place.
+static const long long kAlphaMask = 0xFFll << 40;
+static const long long kAlphaMin  = 10ll << 40;
+
+__attribute__((target("avx2")))
+static inline int solid_mask4(__m256i d) {
+    const __m256i alpha = _mm256_and_si256(d, _mm256_set1_epi64x(kAlphaMask));
+    const __m256i hit   = _mm256_cmpgt_epi64(alpha, _mm256_set1_epi64x(kAlphaMin));
+    return _mm256_movemask_pd(_mm256_castsi256_pd(hit));
+}
+
+__attribute__((target("avx2")))
+static void march_avx2(const uint64_t* vox, const uint16_t* columns, size_t n,
+                       uint8_t* steps) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i idx_lo = _mm_set_epi32(columns[i + 3], columns[i + 2],
+                                             columns[i + 1], columns[i + 0]);
+        const __m128i idx_hi = _mm_set_epi32(columns[i + 7], columns[i + 6],
+                                             columns[i + 5], columns[i + 4]);
+        for (int l = 0; l < 8; ++l)
+            steps[i + l] = 0;
+        unsigned live = 0xFF;   // lanes still marching
+        for (int t = 0; t < kMarchTests && live; ++t) {
+            const long long* plane =
+                reinterpret_cast<const long long*>(vox + (size_t(63 - t) << 12));
+            const int m = solid_mask4(_mm256_i32gather_epi64(plane, idx_lo, 8)) |
+                          (solid_mask4(_mm256_i32gather_epi64(plane, idx_hi, 8)) << 4);
+            unsigned fresh = unsigned(m) & live;
+            live &= ~fresh;
+            while (fresh) {
+                const int l = __builtin_ctz(fresh);
+                steps[i + l] = uint8_t(march_test_step(t));
+                fresh &= fresh - 1;
+            }
+        }
+    }
+    march_scalar(vox, columns + i, n - i, steps + i);
+}
+
+__attribute__((target("avx512f")))
+static inline unsigned solid_mask8(__m512i d) {
+    const __m512i alpha = _mm512_and_si512(d, _mm512_set1_epi64(kAlphaMask));
+    return _mm512_cmpgt_epu64_mask(alpha, _mm512_set1_epi64(kAlphaMin));
+}
+
+__attribute__((target("avx512f")))
+static void march_avx512(const uint64_t* vox, const uint16_t* columns, size_t n,
+                         uint8_t* steps) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        alignas(32) int32_t idx[16];
+        for (int l = 0; l < 16; ++l) {
+            idx[l] = columns[i + l];
+            steps[i + l] = 0;
+        }
+        const __m256i idx_lo = _mm256_load_si256(reinterpret_cast<const __m256i*>(idx));
+        const __m256i idx_hi = _mm256_load_si256(reinterpret_cast<const __m256i*>(idx + 8));
+        // Masked gathers with a zero source: the unmasked form starts from an
+        // undefined vector, which GCC 12 flags as maybe-uninitialized.
+        const __m512i zero = _mm512_setzero_si512();
+        unsigned live = 0xFFFF;
+        for (int t = 0; t < kMarchTests && live; ++t) {
+            const void* plane = vox + (size_t(63 - t) << 12);
+            const __m512i lo = _mm512_mask_i32gather_epi64(zero, 0xFF, idx_lo, plane, 8);
+            const __m512i hi = _mm512_mask_i32gather_epi64(zero, 0xFF, idx_hi, plane, 8);
+            const unsigned m = solid_mask8(lo) | (solid_mask8(hi) << 8);
+            unsigned fresh = m & live;
+            live &= ~fresh;
+            while (fresh) {
+                const int l = __builtin_ctz(fresh);
+                steps[i + l] = uint8_t(march_test_step(t));
+                fresh &= fresh - 1;
+            }
+        }
+    }
+    march_scalar(vox, columns + i, n - i, steps + i);
+}
+
+#endif
+
+void packet_march_columns(SimdLevel level, const uint64_t* vox,
+                          const uint16_t* columns, size_t n, uint8_t* steps) {
+#ifdef HYDRA_MODEL_X86_SIMD
+    if (level == SimdLevel::Avx512)
+        return march_avx512(vox, columns, n, steps);
+    if (level == SimdLevel::Avx2)
+        return march_avx2(vox, columns, n, steps);
+#endif
+    (void)level;
+    march_scalar(vox, columns, n, steps);
+}
+
+// ---------------------------------------------------------------------------
+// Shading
+// ---------------------------------------------------------------------------
+#ifdef HYDRA_MODEL_X86_SIMD
+
+// GCC/Clang generic vectors; each kernel instance is inlined into a
+// target("avx2") / target("avx512f") entry point below.
+typedef uint32_t u32x8  __attribute__((vector_size(32)));
+typedef uint32_t u32x16 __attribute__((vector_size(64)));
+
+// The helpers below take and return vectors wider than the baseline ABI, but
+// are always inlined into the target() entry points, so no call crosses it.
+// (GCC reports this at the end of the file, hence no matching pop.)
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template <typename V>
+static inline __attribute__((always_inline)) V sel(const V& mask, const V& a, const V& b) {
+    return (mask & a) | (~mask & b);
+}
+
+// tmp = a + b in a 9-bit temporary, then clamped to 8 bits.
+template <typename V>
+static inline __attribute__((always_inline)) V add_sat(const V& a, const V& b) {
+    const V tmp = (a + b) & 0x1FF;
+    return sel<V>((V)(tmp > 255), V{} + 255, tmp);
+}
+
+template <typename V>
+static inline __attribute__((always_inline)) V load(const std::vector<uint32_t>& v, size_t i) {
+    V out;
+    __builtin_memcpy(&out, v.data() + i, sizeof(V));
+    return out;
+}
+
+// compute_pixel_data on one packet; mirrors VoxelModel::shade() line by line.
+template <typename V, int N>
+static inline __attribute__((always_inline))
+void shade_lanes(const ShadeRow& row, size_t i, size_t n, const ShadeParams& p,
+                 ModelPixel* out) {
+    const V lo    = load<V>(row.lo, i);
+    const V hi    = load<V>(row.hi, i);
+    const V x     = load<V>(row.x, i);
+    const V y     = load<V>(row.y, i);
+    const V z     = load<V>(row.z, i);
+    const V steps = load<V>(row.steps, i);
+    const V hit   = load<V>(row.hit, i);
+
+    const V props    = hi >> 24;
+    const V emissive = (hi >> 16) & 0xFF;
+    const V light    = hi & 0xFF;
+    const V cr       = lo >> 24;
+    const V cg       = (lo >> 16) & 0xFF;
+    const V cb       = (lo >> 8) & 0xFF;
+    const V type     = (lo >> 4) & 0xF;
+
+    // Base light sized at 8 bits, then the all-zero fallback.
+    V r = ((cr * light) & 0xFF) >> 8;
+    V g = ((cg * light) & 0xFF) >> 8;
+    V b = ((cb * light) & 0xFF) >> 8;
+    const V dark = (V)((r | g | b) == 0);
+    r = sel(dark, cr, r);
+    g = sel(dark, cg, g);
+    b = sel(dark, cb, b);
+
+    // Emission sized at 9 bits.
+    const V emit_on = (V)(emissive != 0);
+    r = sel(emit_on, add_sat(r, ((emissive * r) & 0x1FF) >> 8), r);
+    g = sel(emit_on, add_sat(g, ((emissive * g) & 0x1FF) >> 8), g);
+    b = sel(emit_on, add_sat(b, ((emissive * b) & 0x1FF) >> 8), b);
+
+    const V material_id = type << 4;
+    const V reflection  = sel((V)(type == 3), V{} + 255,
+                          sel((V)(type == 5), V{} + 200, props & 0xE0));
+    const V refraction  = sel((V)(type == 5), V{} + 128,
+                          sel((V)(type == 2), V{} + 85, V{}));
+    const V emission    = sel((V)(type == 1), emissive, V{});
+
+    const V normals   = p.smooth_surfaces ? load<V>(row.normals, i) : V{} + (127u << 8);
+    const V curvature = normals & 0xFF;
+
+    if (p.extra_light) {
+        const V boost = (V)(curvature > 32);
+        r = sel(boost, add_sat(r, curvature >> 4), r);
+        b = sel(boost, add_sat(b, curvature >> 4), b);
+    }
+
+    // Floor shadow; the squares wrap but their sum is exact.
+    const V floor_band = (V)(y >= 8) & (V)(y <= 16);
+    const V dx = x - 32;
+    const V dz = z - 32;
+    const V shadow = (V)(dx * dx + dz * dz <= 324);
+    const V scale  = sel(shadow, V{} + 80, V{} + 206);
+    const V sr = (r * scale) >> 8;
+    const V sg = (g * scale) >> 8;
+    const V sb = (b * scale) >> 8;
+    r = sel(floor_band, sel(shadow, sr, add_sat(sr, V{} + 20)), r);
+    g = sel(floor_band, sel(shadow, sg, add_sat(sg, V{} + 12)), g);
+    b = sel(floor_band, sel(shadow, sb, add_sat(sb, V{} + 4)), b);
+
+    if (p.sel_active) {
+        const V picked = (V)(x == p.sel_x) & (V)(y == p.sel_y) & (V)(z == p.sel_z);
+        r = sel(picked, add_sat(r, V{} + 96), r);
+        g = sel(picked, add_sat(g, V{} + 16), g);
+        b = sel(picked, add_sat(b, V{} + 96), b);
+    }
+
+    const V w0 = sel(hit, (reflection << 24) | (refraction << 16) | (steps << 8) | emission,
+                     V{} + (255u << 8));
+    const V w1 = sel(hit, (r << 24) | (g << 16) | (b << 8) | material_id, V{} + row.sky_w1);
+    const V w2 = sel(hit, normals, V{} + (127u << 8));
+
+    const size_t lanes = n - i < size_t(N) ? n - i : size_t(N);
+    for (size_t l = 0; l < lanes; ++l) {
+        out[i + l].w0 = w0[l];
+        out[i + l].w1 = w1[l];
+        out[i + l].w2 = w2[l];
+    }
+}
+
+__attribute__((target("avx2")))
+static void shade_avx2(const ShadeRow& row, size_t n, const ShadeParams& p, ModelPixel* out) {
+    for (size_t i = 0; i < n; i += 8)
+        shade_lanes<u32x8, 8>(row, i, n, p, out);
+}
+
+__attribute__((target("avx512f")))
+static void shade_avx512(const ShadeRow& row, size_t n, const ShadeParams& p, ModelPixel* out) {
+    for (size_t i = 0; i < n; i += 16)
+        shade_lanes<u32x16, 16>(row, i, n, p, out);
+}
+
+#endif
+
+void packet_shade(SimdLevel level, const ShadeRow& row, size_t n,
+                  const ShadeParams& params, ModelPixel* out) {
+#ifdef HYDRA_MODEL_X86_SIMD
+    if (level == SimdLevel::Avx512)
+        return shade_avx512(row, n, params, out);
+    if (level == SimdLevel::Avx2)
+        return shade_avx2(row, n, params, out);
+#endif
+    (void)level; (void)row; (void)n; (void)params; (void)out;
+}
@@ -0,0 +1,62 @@
+// ============================================================================
+// packet_march.h
+// - Packet (8/16-ray) kernels for VoxelModel: the legacy -X column march with
+//   gathers from the 64^3 volume, and compute_pixel_data shading.
+// - AVX2 (8 lanes) and AVX-512 (16 lanes) variants are compiled with target
+//   attributes and picked at runtime; other compilers/CPUs take the scalar
+//   path. Every variant is bit-exact with VoxelModel's scalar shade().
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ModelPixel;
+
+enum class SimdLevel : uint8_t { Scalar, Avx2, Avx512 };
+
+// Best level supported by both this build and the running CPU.
+SimdLevel   simd_detect();
+const char* simd_name(SimdLevel level);
+int         simd_lanes(SimdLevel level);
+
+// The half-voxel march revisits each x twice, so only the first sample on a
+// new x can be the first to see an occupied word. Test t (0..63) is sample
+// k = max(1, 2t), which tests the word read at x = 63 - t.
+static constexpr int kMarchTests = 64;
+static inline int march_test_step(int t) { return t == 0 ? 1 : 2 * t; }
+
+// For each column (y << 6) | z, the first sample whose fetch hits assuming
+// the pixel's first sample did not (0 = none); see VoxelModel::Column.
+void packet_march_columns(SimdLevel level, const uint64_t* vox,
+                          const uint16_t* columns, size_t n, uint8_t* steps);
+
+// One screen row of resolved pixels, structure-of-arrays. Arrays are padded
+// to a whole number of 16-lane packets.
+struct ShadeRow {
+    std::vector<uint32_t> lo;        // voxel word [31:0]
+    std::vector<uint32_t> hi;        // voxel word [63:32]
+    std::vector<uint32_t> x;         // sample coordinates
+    std::vector<uint32_t> y;
+    std::vector<uint32_t> z;
+    std::vector<uint32_t> steps;     // ray_steps at compute_pixel_data
+    std::vector<uint32_t> normals;   // {nx, ny, nz, curvature} carried in
+    std::vector<uint32_t> hit;       // ~0 = hit, 0 = sky
+    uint32_t sky_w1 = 0;
+
+    void resize(size_t n);
+};
+
+struct ShadeParams {
+    bool     smooth_surfaces = true;
+    bool     extra_light     = false;
+    bool     sel_active      = false;
+    uint32_t sel_x = 0;
+    uint32_t sel_y = 0;
+    uint32_t sel_z = 0;
+};
+
+// Shade row[0..n) into out. level must not be Scalar.
+void packet_shade(SimdLevel level, const ShadeRow& row, size_t n,
+                  const ShadeParams& params, ModelPixel* out);
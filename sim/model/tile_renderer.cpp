@@ -0,0 +1,514 @@
+// ============================================================================
+// tile_renderer.cpp
+// - Segment summaries, carry scan and the work-stealing tile pool.
+// ============================================================================
+#include "tile_renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using Clock = std::chrono::steady_clock;
+
+static double ms_between(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+static uint64_t pack_range(uint32_t begin, uint32_t end) {
+    return (uint64_t(end) << 32) | begin;
+}
+
+// Any word with alpha > 10 stands in for "the incoming read word is solid";
+// its value never reaches a summary (see hit_is_read_in). No voxel can equal
+// both probes.
+static const uint64_t kSolidProbe  = uint64_t(0xFF) << 40;
+static const uint64_t kSolidProbe2 = uint64_t(0xFE) << 40;
+
+TileRenderer::TileRenderer(VoxelModel& model, const Options& opt)
+    : model_(model),
+      threads_(opt.threads > 0 ? opt.threads : int(std::thread::hardware_concurrency())),
+      tile_w_(std::max(1, opt.tile_w)),
+      tile_h_(std::max(1, opt.tile_h)) {
+    threads_ = std::max(1, threads_);
+    const int w = model_.width();
+    const int h = model_.height();
+    tiles_x_ = (w + tile_w_ - 1) / tile_w_;
+    tiles_y_ = (h + tile_h_ - 1) / tile_h_;
+
+    build_keys(false);
+    seg_in_.resize(size_t(h) * size_t(tiles_x_));
+
+    scratch_.resize(size_t(threads_));
+    for (ShadeRow& row : scratch_)
+        row.resize(size_t(tile_w_));
+    reset_times();
+
+    ranges_.reset(new WorkRange[size_t(threads_)]);
+    for (int i = 1; i < threads_; ++i)
+        pool_.emplace_back(&TileRenderer::worker_main, this, i);
+}
+
+TileRenderer::~TileRenderer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    start_cv_.notify_all();
+    for (std::thread& t : pool_)
+        t.join();
+}
+
+// ---------------------------------------------------------------------------
+// Pool
+// ---------------------------------------------------------------------------
+void TileRenderer::worker_main(int w) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return quit_ || generation_ != seen; });
+            if (quit_)
+                return;
+            seen = generation_;
+        }
+        run_items(w);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--running_ == 0)
+                done_cv_.notify_one();
+        }
+    }
+}
+
+void TileRenderer::run(int count, const std::function<void(int, int)>& fn) {
+    // Contiguous even split to start with; stealing evens out the rest.
+    for (int w = 0; w < threads_; ++w) {
+        const uint32_t begin = uint32_t(int64_t(count) * w / threads_);
+        const uint32_t end   = uint32_t(int64_t(count) * (w + 1) / threads_);
+        ranges_[w].range.store(pack_range(begin, end), std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_     = &fn;
+        running_ = threads_ - 1;
+        ++generation_;
+    }
+    start_cv_.notify_all();
+    run_items(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return running_ == 0; });
+    job_ = nullptr;
+}
+
+void TileRenderer::run_items(int w) {
+    int item;
+    while (take(w, item) || steal(w, item))
+        (*job_)(w, item);
+}
+
+bool TileRenderer::take(int w, int& item) {
+    std::atomic<uint64_t>& r = ranges_[w].range;
+    uint64_t cur = r.load(std::memory_order_acquire);
+    for (;;) {
+        const uint32_t begin = uint32_t(cur), end = uint32_t(cur >> 32);
+        if (begin >= end)
+            return false;
+        if (r.compare_exchange_weak(cur, pack_range(begin + 1, end),
+                                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+            item = int(begin);
+            return true;
+        }
+    }
+}
+
+// Split the back half off the first victim with work left. Only the owner
+// ever refills its own (empty) range, so a plain store is enough there.
+bool TileRenderer::steal(int w, int& item) {
+    for (int i = 1; i < threads_; ++i) {
+        const int v = (w + i) % threads_;
+        std::atomic<uint64_t>& r = ranges_[v].range;
+        uint64_t cur = r.load(std::memory_order_acquire);
+        for (;;) {
+            const uint32_t begin = uint32_t(cur), end = uint32_t(cur >> 32);
+            if (begin >= end)
+                break;
+            const uint32_t mid = begin + (end - begin) / 2;
+            if (r.compare_exchange_weak(cur, pack_range(begin, mid),
+                                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+                ranges_[w].range.store(pack_range(mid + 1, end), std::memory_order_release);
+                steals_.fetch_add(1, std::memory_order_relaxed);
+                item = int(mid);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Frame
+// ---------------------------------------------------------------------------
+// map_y is monotonic, so rows sharing a voxel row are contiguous. Perspective
+// rays differ on every row.
+void TileRenderer::build_keys(bool per_row) {
+    const int h = model_.height();
+    keys_per_row_ = per_row;
+    key_rows_.clear();
+    row_key_.resize(size_t(h));
+    for (int py = 0; py < h; ++py) {
+        if (per_row || py == 0 || model_.map_y(py) != model_.map_y(py - 1))
+            key_rows_.push_back(py);
+        row_key_[size_t(py)] = int(key_rows_.size()) - 1;
+    }
+    summaries_.resize(key_rows_.size() * size_t(tiles_x_));
+}
+
+// Segment (voxel row key, tile column) from both possible carry-ins. The
+// pixels do not depend on the screen row beyond its voxel row, and the
+// incoming hit_data/normals only pass through, so one summary serves every
+// screen row of the key.
+void TileRenderer::summarise(int item) {
+    const int key = item / tiles_x_;
+    const int tx  = item % tiles_x_;
+    const int py  = key_rows_[size_t(key)];
+    const int px0 = tx * tile_w_;
+    const int n   = std::min(tile_w_, model_.width() - px0);
+    summarise_chain(summaries_[size_t(item)], n, [&](VoxelModel::PixelState& st, int first,
+                                                      int count) {
+        model_.render_span(st, py, px0 + first, count, params_, nullptr);
+    });
+}
+
+// What a pass over a chain's pixels did, from read word read_in with the
+// other registers zero; a normals reset shows up as 0x7F00.
+TileRenderer::SegCase TileRenderer::seg_case(const VoxelModel::PixelState& st) {
+    SegCase k;
+    k.read_out      = st.carry.read_data;
+    k.read_passes   = st.reads == 0;
+    k.last_hit      = st.carry.hit_data;
+    k.any_hit       = st.hits != 0;
+    k.normals_reset = st.carry.normals != 0;
+    k.hits          = st.hits;
+    k.cycles        = st.cycles;
+    k.reads         = st.reads;
+    k.skips         = st.skips;
+    return k;
+}
+
+TileRenderer::SegCase TileRenderer::chain(const SegCase& first, const SegCase& rest) {
+    SegCase k;
+    k.read_out       = rest.read_passes ? first.read_out : rest.read_out;
+    k.read_passes    = first.read_passes && rest.read_passes;
+    k.any_hit        = first.any_hit || rest.any_hit;
+    k.last_hit       = rest.any_hit ? rest.last_hit : first.last_hit;
+    k.hit_is_read_in = first.hit_is_read_in && !rest.any_hit;
+    k.normals_reset  = first.normals_reset || rest.normals_reset;
+    k.hits           = first.hits + rest.hits;
+    k.cycles         = first.cycles + rest.cycles;
+    k.reads          = first.reads + rest.reads;
+    k.skips          = first.skips + rest.skips;
+    return k;
+}
+
+// A chain of n pixels from both carry-ins; walk(st, first, count) advances
+// st over pixels [first, first + count) of the chain.
+void TileRenderer::summarise_chain(SegSummary& s, int n, const ChainWalk& walk) const {
+    auto pass = [&](uint64_t read_in, int first, int count) {
+        VoxelModel::PixelState st;
+        st.emit = VoxelModel::Emit::None;
+        st.carry.read_data = read_in;
+        walk(st, first, count);
+        return seg_case(st);
+    };
+
+    // Only the first pixel sees the incoming word. In the marching modes a
+    // solid one hits there and becomes hit_data (DDA ignores it); after that
+    // both cases continue from a known read word, usually the same one, or
+    // from the probes themselves while perspective rays miss the volume.
+    s.clear = pass(0, 0, 1);
+    s.solid = pass(kSolidProbe, 0, 1);
+    s.solid.hit_is_read_in = s.solid.any_hit && s.solid.last_hit == kSolidProbe &&
+                             pass(kSolidProbe2, 0, 1).last_hit == kSolidProbe2;
+    if (n > 1) {
+        const SegCase rest = pass(s.clear.read_out, 1, n - 1);
+        const SegCase rest_solid = s.solid.read_out == s.clear.read_out
+                                       ? rest : pass(s.solid.read_out, 1, n - 1);
+        s.clear = chain(s.clear, rest);
+        s.solid = chain(s.solid, rest_solid);
+    }
+}
+
+// Carry registers after a chain summarised by s, and the frame totals.
+void TileRenderer::apply(const SegSummary& s, ModelCarry& c, FrameTotals& t) {
+    const SegCase& k = VoxelModel::solid(c.read_data) ? s.solid : s.clear;
+    if (k.any_hit)
+        c.hit_data = k.hit_is_read_in ? c.read_data : k.last_hit;
+    if (!k.read_passes)
+        c.read_data = k.read_out;
+    if (k.normals_reset)
+        c.normals = 127u << 8;
+    t.hits   += k.hits;
+    t.cycles += k.cycles;
+    t.reads  += k.reads;
+    t.skips  += k.skips;
+}
+
+void TileRenderer::render_tile(int w, int tile) {
+    const Clock::time_point t0 = Clock::now();
+    VoxelModel& m = model_;
+    const int tx  = tile % tiles_x_;
+    const int ty  = tile / tiles_x_;
+    const int px0 = tx * tile_w_;
+    const int n   = std::min(tile_w_, m.width() - px0);
+    const int py0 = ty * tile_h_;
+    const int py1 = std::min(py0 + tile_h_, m.height());
+    const int cursor_x = m.width() >> 1;
+    const int cursor_y = m.height() >> 1;
+
+    VoxelModel::PixelState st;
+    st.emit = m.simd_ == SimdLevel::Scalar ? VoxelModel::Emit::Scalar : VoxelModel::Emit::Packet;
+    st.row  = &scratch_[size_t(w)];
+
+    const ModelCarry* prev_in = nullptr;
+    int prev_key = -1;
+    for (int py = py0; py < py1; ++py) {
+        ModelPixel* out = &m.pixels_[size_t(py) * size_t(m.width()) + size_t(px0)];
+        const ModelCarry& in = seg_in_[size_t(py) * size_t(tiles_x_) + size_t(tx)];
+        const int key = row_key_[size_t(py)];
+        const bool cursor_row = py == cursor_y && cursor_x >= px0 && cursor_x < px0 + n;
+
+        // Same voxel row and carry-in as the row above: same segment, bar
+        // the sky gradient.
+        if (prev_in && key == prev_key && in == *prev_in && !cursor_row) {
+            std::memcpy(out, out - m.width(), sizeof(ModelPixel) * size_t(n));
+            m.patch_sky(out, n, py);
+        } else {
+            st.carry  = in;
+            st.cursor = cursor_row ? &m.cursor_ : nullptr;
+            m.render_span(st, py, px0, n, params_, out);
+        }
+        prev_in  = &in;
+        prev_key = key;
+    }
+
+    TileTiming& t = times_[size_t(tile)];
+    t.worker = uint16_t(w);
+    t.ns = uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+}
+
+void TileRenderer::render() {
+    VoxelModel& m = model_;
+    const Clock::time_point t0 = Clock::now();
+    steals_.store(0, std::memory_order_relaxed);
+
+    if (m.memo() || m.composite()) {
+        m.render();
+        stats_ = TileFrameStats();
+        stats_.total_ms = ms_between(t0, Clock::now());
+        stats_.fallback = m.memo() ? "memo" : "composite";
+        times_.clear();
+        times_raster_ = false;
+        return;
+    }
+
+    // S_IDLE with start
+    m.cursor_.hit_valid  = false;
+    m.cursor_.voxel_data = 0;
+    const bool persp = m.perspective();
+    if (persp != keys_per_row_)
+        build_keys(persp);
+    if (persp) {
+        const VoxelModel::RayBasis basis = m.ray_basis();
+        run(tiles_x_ * tiles_y_, [this, &basis](int, int tile) {
+            const int px0 = (tile % tiles_x_) * tile_w_;
+            const int py0 = (tile / tiles_x_) * tile_h_;
+            model_.trace_rays(basis, py0, std::min(py0 + tile_h_, model_.height()),
+                              px0, std::min(px0 + tile_w_, model_.width()));
+        });
+    } else if (!m.cfg_.diag_slice) {
+        m.refresh_columns();
+    }
+    params_ = m.shade_params();
+    if (m.tile_order()) {
+        render_tile_order(t0);
+        return;
+    }
+    if (!times_raster_)
+        reset_times();
+
+    run(int(summaries_.size()), [this](int, int item) { summarise(item); });
+    const Clock::time_point t1 = Clock::now();
+
+    // Raster-order scan over segments: each one's carry-in from its lane's
+    // registers, and the frame totals.
+    const int lanes = m.lanes();
+    ModelCarry  lane_carry[VoxelModel::kMaxLanes];
+    FrameTotals lane_tot[VoxelModel::kMaxLanes];
+    std::copy(m.carry_, m.carry_ + lanes, lane_carry);
+    for (int py = 0; py < m.height(); ++py) {
+        const SegSummary* row = &summaries_[size_t(row_key_[size_t(py)]) * size_t(tiles_x_)];
+        ModelCarry& c = lane_carry[py % lanes];
+        for (int tx = 0; tx < tiles_x_; ++tx) {
+            seg_in_[size_t(py) * size_t(tiles_x_) + size_t(tx)] = c;
+            apply(row[tx], c, lane_tot[py % lanes]);
+        }
+    }
+    const Clock::time_point t2 = Clock::now();
+
+    run(tiles_x_ * tiles_y_, [this](int w, int tile) { render_tile(w, tile); });
+    finish_frame(lane_carry, lane_tot, t0, t1, t2);
+}
+
+void TileRenderer::finish_frame(const ModelCarry* lane_carry, const FrameTotals* lane_tot,
+                                Clock::time_point t0, Clock::time_point t1,
+                                Clock::time_point t2) {
+    const Clock::time_point t3 = Clock::now();
+    VoxelModel& m = model_;
+    const int lanes = m.lanes();
+    std::copy(lane_carry, lane_carry + lanes, m.carry_);
+    m.hit_count_ = 0;
+    m.cycles_    = 0;
+    m.reads_     = 0;
+    m.skips_     = 0;
+    m.ets_saved_ = 0;
+    for (int k = 0; k < lanes; ++k) {
+        m.hit_count_ += lane_tot[k].hits;
+        m.cycles_     = std::max(m.cycles_, lane_tot[k].cycles);
+        m.reads_     += lane_tot[k].reads;
+        m.skips_     += lane_tot[k].skips;
+    }
+
+    stats_.summary_ms = ms_between(t0, t1);
+    stats_.scan_ms    = ms_between(t1, t2);
+    stats_.tiles_ms   = ms_between(t2, t3);
+    stats_.total_ms   = ms_between(t0, t3);
+    stats_.steals     = steals_.load(std::memory_order_relaxed);
+    stats_.fallback   = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Tile order
+// ---------------------------------------------------------------------------
+void TileRenderer::reset_times() {
+    times_raster_ = true;
+    times_.assign(size_t(tiles_x_) * size_t(tiles_y_), TileTiming());
+    for (int t = 0; t < tiles_x_ * tiles_y_; ++t) {
+        times_[size_t(t)].tx = uint16_t(t % tiles_x_);
+        times_[size_t(t)].ty = uint16_t(t / tiles_x_);
+    }
+}
+
+// Cells off the lane's rows are walked (and timed by tile_cells()) but hold
+// no pixels.
+void TileRenderer::build_core_tiles() {
+    const VoxelModel& m = model_;
+    const int kTile = VoxelModel::kTile;
+    core_tiles_.clear();
+    for (int lane = 0; lane < m.lanes(); ++lane) {
+        const int rows    = m.lane_rows(lane);
+        const int tiles_x = (m.width() + kTile - 1) / kTile;
+        const int tiles_y = (rows + kTile - 1) / kTile;
+        const int bits    = VoxelModel::tile_bits(tiles_x, tiles_y);
+        const int cells   = m.tile_cells(rows);
+        for (int d = 0; d < cells; ++d) {
+            int tx, ty;
+            VoxelModel::tile_cell(m.tile_order(), bits, uint32_t(d), tx, ty);
+            if (tx >= tiles_x || ty >= tiles_y)
+                continue;
+            CoreTile t;
+            t.lane = uint16_t(lane);
+            t.tx   = uint16_t(tx);
+            t.ty   = uint16_t(ty);
+            core_tiles_.push_back(t);
+        }
+    }
+    core_sums_.resize(core_tiles_.size());
+    core_in_.resize(core_tiles_.size());
+    core_order_ = m.tile_order();
+    core_lanes_ = m.lanes();
+}
+
+// Inside a core tile the pixels go in raster order (VoxelModel::render_tiles()).
+void TileRenderer::walk_core_tile(VoxelModel::PixelState& st, int item, int first, int count,
+                                  bool emit) const {
+    const VoxelModel& m = model_;
+    const int kTile = VoxelModel::kTile;
+    const CoreTile& t = core_tiles_[size_t(item)];
+    const int x0 = t.tx * kTile;
+    const int w  = std::min(kTile, m.width() - x0);
+    for (int j = first; j < first + count; ++j) {
+        const int px = x0 + j % w;
+        const int py = t.lane + (t.ty * kTile + j / w) * m.lanes();
+        ModelPixel* row = emit ? &model_.pixels_[size_t(py) * size_t(m.width())] : nullptr;
+        m.render_pixel(st, px, px, py, m.map_y(py), m.map_z(px), row);
+    }
+}
+
+void TileRenderer::summarise_core_tile(int item) {
+    const CoreTile& t = core_tiles_[size_t(item)];
+    const int kTile = VoxelModel::kTile;
+    const int n = std::min(kTile, model_.width() - t.tx * kTile) *
+                  std::min(kTile, model_.lane_rows(t.lane) - t.ty * kTile);
+    summarise_chain(core_sums_[size_t(item)], n, [&](VoxelModel::PixelState& st, int first,
+                                                      int count) {
+        walk_core_tile(st, item, first, count, false);
+    });
+}
+
+void TileRenderer::render_core_tile(int w, int item) {
+    const Clock::time_point t0 = Clock::now();
+    const VoxelModel& m = model_;
+    const CoreTile& t = core_tiles_[size_t(item)];
+    const int kTile = VoxelModel::kTile;
+    const int n = std::min(kTile, m.width() - t.tx * kTile) *
+                  std::min(kTile, m.lane_rows(t.lane) - t.ty * kTile);
+
+    // Only the tile holding the centre pixel may capture the cursor.
+    const int cursor_x = m.width() >> 1;
+    const int cursor_y = m.height() >> 1;
+    const int cursor_k = (cursor_y - t.lane) / m.lanes();
+    const bool cursor_tile = (cursor_y - t.lane) % m.lanes() == 0 &&
+                             cursor_x / kTile == t.tx && cursor_k / kTile == t.ty;
+
+    VoxelModel::PixelState st;
+    st.emit   = VoxelModel::Emit::Scalar;
+    st.carry  = core_in_[size_t(item)];
+    st.cursor = cursor_tile ? &model_.cursor_ : nullptr;
+    walk_core_tile(st, item, 0, n, true);
+
+    TileTiming& tt = times_[size_t(item)];
+    tt.tx     = t.tx;
+    tt.ty     = t.ty;
+    tt.worker = uint16_t(w);
+    tt.ns = uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+}
+
+// Each lane's core tiles from both carry-ins on the pool, a scan in walk
+// order, then every core tile on the pool from its carry-in.
+void TileRenderer::render_tile_order(Clock::time_point t0) {
+    VoxelModel& m = model_;
+    if (core_order_ != m.tile_order() || core_lanes_ != m.lanes())
+        build_core_tiles();
+    times_.resize(core_tiles_.size());
+    times_raster_ = false;
+    const int count = int(core_tiles_.size());
+
+    run(count, [this](int, int item) { summarise_core_tile(item); });
+    const Clock::time_point t1 = Clock::now();
+
+    const int lanes = m.lanes();
+    ModelCarry  lane_carry[VoxelModel::kMaxLanes];
+    FrameTotals lane_tot[VoxelModel::kMaxLanes];
+    std::copy(m.carry_, m.carry_ + lanes, lane_carry);
+    for (int k = 0; k < lanes; ++k)
+        lane_tot[k].cycles += uint64_t(m.tile_cells(m.lane_rows(k)));
+    for (int i = 0; i < count; ++i) {
+        const int lane = core_tiles_[size_t(i)].lane;
+        core_in_[size_t(i)] = lane_carry[lane];
+        apply(core_sums_[size_t(i)], lane_carry[lane], lane_tot[lane]);
+    }
+    const Clock::time_point t2 = Clock::now();
+
+    run(count, [this](int w, int item) { render_core_tile(w, item); });
+    finish_frame(lane_carry, lane_tot, t0, t1, t2);
+}
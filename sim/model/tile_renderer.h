@@ -0,0 +1,188 @@
+// ============================================================================
+// tile_renderer.h
+// - Multi-threaded VoxelModel::render(): the frame is cut into tiles that a
+//   work-stealing pool renders in parallel, bit-exact with the single-thread
+//   model (and so with the RTL).
+// - The core's carry registers (last read word, latched hit, normals) chain
+//   every pixel to the one before it in raster order (in its lane's rows
+//   when ModelConfig::lanes > 1). A pixel's outgoing
+//   read word depends at most on whether the incoming one is solid (or is
+//   the incoming one, for a perspective ray that reads nothing), so each
+//   tile row segment is summarised for both cases in parallel, a serial scan
+//   over the (tiny) segment list fixes every segment's carry-in, and the
+//   tiles are then rendered independently.
+// - Perspective frames trace their rays tile by tile on the pool first.
+// - Tile-order frames chain the carry registers through each lane's 8x8
+//   core tiles in walk order instead, so the same summaries are taken per
+//   core tile, scanned in walk order and rendered one core tile per item.
+// - Ray-memo frames trace one pixel per screen bucket, chained through the
+//   carry registers in raster order, and in composite frames a ray that
+//   blends and misses still changes the latched payload word; both go to
+//   VoxelModel::render() on the calling thread, which stats() reports.
+// - Per-tile wall time is kept for the last frame.
+// ============================================================================
+#pragma once
+
+#include "voxel_model.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct TileTiming {
+    uint16_t tx = 0;
+    uint16_t ty = 0;
+    uint16_t worker = 0;
+    uint32_t ns = 0;
+};
+
+// Wall time of each phase of the last frame.
+struct TileFrameStats {
+    double   summary_ms = 0.0;   // columns or rays + per-segment summaries
+    double   scan_ms    = 0.0;   // serial carry scan
+    double   tiles_ms   = 0.0;   // tile rendering
+    double   total_ms   = 0.0;
+    uint64_t steals     = 0;     // successful steals over both parallel phases
+    // Why VoxelModel::render() drew the frame on one thread ("memo",
+    // "composite"); null when the pool did.
+    const char* fallback = nullptr;
+};
+
+class TileRenderer {
+public:
+    struct Options {
+        int threads = 0;    // 0 = std::thread::hardware_concurrency()
+        int tile_w  = 32;
+        int tile_h  = 32;
+    };
+
+    // Renders into model (pixels, cursor, counters and carry registers), so
+    // model.render() and TileRenderer::render() can be mixed frame by frame.
+    TileRenderer(VoxelModel& model, const Options& opt);
+    explicit TileRenderer(VoxelModel& model) : TileRenderer(model, Options()) {}
+    ~TileRenderer();
+
+    TileRenderer(const TileRenderer&) = delete;
+    TileRenderer& operator=(const TileRenderer&) = delete;
+
+    void render();
+
+    int threads() const { return threads_; }
+    int tiles_x() const { return tiles_x_; }
+    int tiles_y() const { return tiles_y_; }
+    // Last frame, row-major by tile; for tile-order frames, one per core
+    // tile in each lane's walk order (tx, ty in core tiles of the lane's
+    // rows); empty after a fallback.
+    const std::vector<TileTiming>& tile_times() const { return times_; }
+    const TileFrameStats& stats() const { return stats_; }
+
+private:
+    // Segment result for one carry-in case; see summarise().
+    struct SegCase {
+        uint64_t read_out = 0;
+        uint64_t last_hit = 0;
+        bool     any_hit  = false;   // false: hit_data passes through
+        bool     read_passes = false;   // no reads: read_data passes through
+        bool     hit_is_read_in = false;
+        bool     normals_reset  = false;
+        uint32_t hits   = 0;
+        uint64_t cycles = 0;
+        uint64_t reads  = 0;
+        uint32_t skips  = 0;
+    };
+    struct SegSummary {
+        SegCase clear;   // incoming read word not solid
+        SegCase solid;   // incoming read word solid
+    };
+
+    // One 8x8 core tile of a lane's rows (tile-order frames).
+    struct CoreTile {
+        uint16_t lane = 0;
+        uint16_t tx   = 0;
+        uint16_t ty   = 0;
+    };
+
+    // One lane's frame counters.
+    struct FrameTotals {
+        uint32_t hits   = 0;
+        uint64_t cycles = 1;   // S_IDLE with start
+        uint64_t reads  = 0;
+        uint32_t skips  = 0;
+    };
+    using ChainWalk = std::function<void(VoxelModel::PixelState&, int, int)>;
+
+    // Per-worker lock-free range of item indices: low 32 bits next, high 32
+    // bits end. The owner takes from the front, thieves split off the back.
+    struct alignas(64) WorkRange {
+        std::atomic<uint64_t> range{0};
+    };
+
+    void worker_main(int w);
+    // Run fn(worker, item) for item in [0, count) on every thread.
+    void run(int count, const std::function<void(int, int)>& fn);
+    void run_items(int w);
+    bool take(int w, int& item);
+    bool steal(int w, int& item);
+
+    static SegCase seg_case(const VoxelModel::PixelState& st);
+    static SegCase chain(const SegCase& first, const SegCase& rest);
+    void summarise_chain(SegSummary& s, int n, const ChainWalk& walk) const;
+    static void apply(const SegSummary& s, ModelCarry& c, FrameTotals& t);
+
+    // Summary keys: one per distinct map_y, or one per screen row.
+    void build_keys(bool per_row);
+    void summarise(int item);
+    void render_tile(int w, int tile);
+    void finish_frame(const ModelCarry* lane_carry, const FrameTotals* lane_tot,
+                      std::chrono::steady_clock::time_point t0,
+                      std::chrono::steady_clock::time_point t1,
+                      std::chrono::steady_clock::time_point t2);
+    void reset_times();
+    // Tile-order frames: on-screen core tiles lane by lane in walk order.
+    void build_core_tiles();
+    // Pixels [first, first + count) of core tile item in walk order.
+    void walk_core_tile(VoxelModel::PixelState& st, int item, int first, int count,
+                        bool emit) const;
+    void summarise_core_tile(int item);
+    void render_core_tile(int w, int item);
+    void render_tile_order(std::chrono::steady_clock::time_point t0);
+
+    VoxelModel& model_;
+    int threads_;
+    int tile_w_, tile_h_;
+    int tiles_x_, tiles_y_;
+
+    // Frame state shared by the phases.
+    std::vector<int>        row_key_;      // py -> index into key_rows_
+    std::vector<int>        key_rows_;     // representative py per distinct voxel row
+    bool                    keys_per_row_ = false;
+    std::vector<SegSummary> summaries_;    // [key][tx]
+    std::vector<ModelCarry> seg_in_;       // [py][tx] carry-in
+    ShadeParams             params_;
+    std::vector<ShadeRow>   scratch_;      // per worker
+    std::vector<TileTiming> times_;
+    TileFrameStats          stats_;
+    std::vector<CoreTile>   core_tiles_;
+    std::vector<SegSummary> core_sums_;    // [core tile]
+    std::vector<ModelCarry> core_in_;      // [core tile] carry-in
+    int                     core_order_ = -1;   // tile_order() core_tiles_ was built for
+    int                     core_lanes_ = 0;
+    bool                    times_raster_ = true;   // times_ holds the screen tiles
+
+    // Pool.
+    std::vector<std::thread> pool_;
+    std::unique_ptr<WorkRange[]> ranges_;
+    const std::function<void(int, int)>* job_ = nullptr;
+    std::mutex              mutex_;
+    std::condition_variable start_cv_, done_cv_;
+    uint64_t                generation_ = 0;
+    int                     running_ = 0;
+    bool                    quit_ = false;
+    std::atomic<uint64_t>   steals_{0};
+};
@@ -0,0 +1,1017 @@
+// ============================================================================
+// voxel_model.cpp
+// - voxel_raycaster_core_pipelined / voxel_world_gen mirrored in C++.
+// ============================================================================
+#include "voxel_model.h"
+
+#include <algorithm>
+#include <cstring>
+
+// voxel_world_gen / shading constants (same names as the RTL localparams).
+static const int FLOOR_MIN_Y    = 8;
+static const int FLOOR_MAX_Y    = 16;
+static const int LIGHT_PLANE_Y  = 52;
+static const int LIGHT_Y0       = 50;
+static const int LIGHT_Y1       = 56;
+static const int SLAB_MAX_X     = 44;
+static const int SHADOW_CX      = 32;
+static const int SHADOW_CZ      = 32;
+static const int SHADOW_RADIUS2 = 324;
+static const int NUM_SLICES     = 7;
+static const int SLICE_X_START  = 56;
+static const int SLICE_STEP     = 8;
+
+// DDA ray parameters: Q16.8 in 24 bits, all ones for "never".
+static const uint32_t T_INF    = 0xFFFFFF;
+static const int      GRID_END = VoxelModel::kGrid << 8;
+
+// {material_props, emissive, alpha, light, R, G, B, material_type, 4'h0}
+static uint64_t voxel_word(uint8_t props, uint8_t emissive, uint8_t alpha, uint8_t light,
+                           uint32_t rgb, uint8_t type) {
+    return (uint64_t(props) << 56) | (uint64_t(emissive) << 48) |
+           (uint64_t(alpha) << 40) | (uint64_t(light) << 32) |
+           (uint64_t(rgb & 0xFFFFFF) << 8) | (uint64_t(type & 0xF) << 4);
+}
+
+// tmp = a + b in a 9-bit temporary, then clamped to 8 bits.
+static uint8_t add_sat(unsigned a, unsigned b) {
+    const unsigned tmp = (a + b) & 0x1FF;
+    return tmp > 255 ? 255 : uint8_t(tmp);
+}
+
+VoxelModel::VoxelModel(int width, int height)
+    : width_(width),
+      height_(height),
+      vox_(kVoxels, 0),
+      column_step_(size_t(kGrid) * kGrid, 0),
+      column_valid_(size_t(kGrid) * kGrid, 0),
+      brick_count_(size_t(kBricks), 0),
+      pixels_(size_t(width) * size_t(height)),
+      rays_(size_t(width) * size_t(height)),
+      simd_(simd_detect()) {
+    column_todo_.reserve(column_step_.size());
+    column_out_.resize(column_step_.size());
+    shade_row_.resize(size_t(width));
+}
+
+void VoxelModel::reset() {
+    std::fill(std::begin(carry_), std::end(carry_), ModelCarry());
+    cursor_    = ModelCursor();
+    hit_count_ = 0;
+    cycles_    = 0;
+    reads_     = 0;
+    skips_     = 0;
+}
+
+void VoxelModel::write_voxel(uint32_t addr, uint64_t data) {
+    addr &= uint32_t(kVoxels - 1);
+    note_write(addr, vox_[addr], data);
+    vox_[addr] = data;
+    column_valid_[addr & 0xFFF] = 0;
+}
+
+void VoxelModel::load_volume(const uint64_t* words) {
+    for (size_t i = 0; i < kVoxels; ++i) {
+        if (vox_[i] != words[i]) {
+            note_write(uint32_t(i), vox_[i], words[i]);
+            vox_[i] = words[i];
+            column_valid_[i & 0xFFF] = 0;
+        }
+    }
+}
+
+void VoxelModel::clear_volume() {
+    std::fill(vox_.begin(), vox_.end(), 0);
+    std::fill(column_valid_.begin(), column_valid_.end(), 0);
+    std::fill(brick_count_.begin(), brick_count_.end(), 0);
+}
+
+void VoxelModel::rebuild_bricks() {
+    std::fill(brick_count_.begin(), brick_count_.end(), 0);
+    for (size_t i = 0; i < kVoxels; ++i)
+        if (solid(vox_[i]))
+            ++brick_count_[brick_of(uint32_t(i))];
+}
+
+void VoxelModel::generate_world() {
+    clear_volume();
+    const uint64_t floor_word = voxel_word(196, 0,   255, 150, 0x405060, 6);
+    const uint64_t light_word = voxel_word(255, 255, 255, 255, 0xFFD0A0, 1);
+    const uint64_t sph0_word  = voxel_word(180, 0,   255, 220, 0x40C0FF, 5);
+    const uint64_t sph1_word  = voxel_word(64,  200, 255, 220, 0xFF40FF, 1);
+
+    // Same pass order as the generator FSM: planes, then each sphere
+    // overwriting what came before.
+    for (int x = 0; x < kGrid; ++x)
+        for (int y = 0; y < kGrid; ++y)
+            for (int z = 0; z < kGrid; ++z) {
+                if (y >= FLOOR_MIN_Y && y <= FLOOR_MAX_Y && x <= SLAB_MAX_X)
+                    vox_[addr_of(x, y, z)] = floor_word;
+                else if (y >= LIGHT_Y0 && y <= LIGHT_Y1 && x <= SLAB_MAX_X)
+                    vox_[addr_of(x, y, z)] = light_word;
+            }
+    for (int x = 0; x < kGrid; ++x)
+        for (int y = 0; y < kGrid; ++y)
+            for (int z = 0; z < kGrid; ++z) {
+                const int dx = x - 32, dy = y - 32, dz = z - 32;
+                if (dx * dx + dy * dy + dz * dz <= 18 * 18)
+                    vox_[addr_of(x, y, z)] = sph0_word;
+            }
+    for (int x = 0; x < kGrid; ++x)
+        for (int y = 0; y < kGrid; ++y)
+            for (int z = 0; z < kGrid; ++z) {
+                const int dx = x - 38, dy = y - 32, dz = z - 28;
+                if (dx * dx + dy * dy + dz * dz <= 7 * 7)
+                    vox_[addr_of(x, y, z)] = sph1_word;
+            }
+    rebuild_bricks();
+}
+
+// ray_pos_x starts at 63.0 and drops half a voxel per sample; the arithmetic
+// shift makes the last sample (k = 127, pos -0.5) wrap to x = 63.
+int VoxelModel::march_x(int k) {
+    const int pos = (kGrid - 1) * 256 - 128 * k;
+    return (pos >> 8) & (kGrid - 1);
+}
+
+// Skipping march: samples 0..14 lie in brick 7, then 16 per brick down to
+// brick 0 (111..126), and the wrapped sample 127 is back in brick 7. A skip
+// can only start where the ray enters a brick, and not at the hit sample
+// (the word under test is solid there).
+int VoxelModel::march_skips(int my, int mz, int last, bool hit, int& skips,
+                            int& last_read) const {
+    const int by = my >> kBrickShift, bz = mz >> kBrickShift;
+    int reads = 0;
+    skips     = 0;
+    last_read = -1;
+    for (int seg = 0; seg <= 8; ++seg) {
+        const int first = seg == 0 ? 0 : 16 * seg - 1;
+        const int end   = seg == 8 ? kMaxSteps - 1 : 16 * seg + 14;
+        const int bx    = seg == 8 ? 7 : 7 - seg;
+        if (first > last)
+            break;
+        if (!brick_occupied(bx, by, bz) && !(hit && first == last)) {
+            ++skips;
+            continue;
+        }
+        last_read = std::min(end, last);
+        reads += last_read - first + 1;
+    }
+    return reads;
+}
+
+// DDA along -X from voxel 63, S_STEP by S_STEP: the pending word is tested
+// first, then an empty brick is skipped to its far side, then a distance
+// d >= 2 in the pending word clears min(d - 2, 7) more voxels past the
+// current one (down to x = 0).
+int VoxelModel::dda_walk(int my, int mz, int& skips, int& jumps, int& last_read) const {
+    const int by = my >> kBrickShift, bz = mz >> kBrickShift;
+    const bool skip = skip_empty(), jump = sdf();
+    int      reads = 0, x = kGrid - 1;
+    bool     pending = false;
+    uint64_t word = 0;
+    skips     = 0;
+    jumps     = 0;
+    last_read = -1;
+    while (!(pending && solid(word)) && x >= 0) {
+        if (skip && !brick_occupied(x >> kBrickShift, by, bz)) {
+            x = (x & ~7) - 1;
+            ++skips;
+        } else if (jump && pending && (word & 0xF) >= 2) {
+            x -= std::min(std::min(int(word & 0xF) - 2, 7), x) + 1;
+            ++jumps;
+        } else {
+            word = vox_[addr_of(x, my, mz)];
+            last_read = x--;
+            ++reads;
+            pending = true;
+            continue;
+        }
+        pending = false;
+    }
+    return reads;
+}
+
+void VoxelModel::refresh_columns() {
+    column_todo_.clear();
+    for (size_t idx = 0; idx < column_valid_.size(); ++idx)
+        if (!column_valid_[idx])
+            column_todo_.push_back(uint16_t(idx));
+    if (column_todo_.empty())
+        return;
+    packet_march_columns(simd_, vox_.data(), column_todo_.data(), column_todo_.size(),
+                         column_out_.data());
+    for (size_t i = 0; i < column_todo_.size(); ++i) {
+        column_step_[column_todo_[i]]  = column_out_[i];
+        column_valid_[column_todo_[i]] = 1;
+    }
+}
+
+// S_FETCH (S_STEP for DDA) on the first occupied word: bump the hit counter,
+// capture the cursor with material type cursor_type and latch the voxel
+// fields.
+void VoxelModel::fetch_hit(PixelState& st, uint64_t data, int x, int y, int z,
+                           bool cursor_sample, unsigned cursor_type) {
+    ++st.hits;
+    ModelCursor* cur = st.cursor;
+    if (cursor_sample && cur && !cur->hit_valid) {
+        cur->hit_valid   = true;
+        cur->x           = uint8_t(x);
+        cur->y           = uint8_t(y);
+        cur->z           = uint8_t(z);
+        cur->material_id = uint8_t((cursor_type & 0xF) << 4);
+        cur->voxel_data  = data;
+    }
+    st.carry.hit_data = data;
+}
+
+// compute_pixel_data for the latched hit at sample coordinates (x, y, z).
+ModelPixel VoxelModel::shade(ModelCarry& c, int x, int y, int z, uint8_t steps) const {
+    const uint64_t hit_data = c.hit_data;
+    const uint8_t props    = uint8_t(hit_data >> 56);
+    const uint8_t emissive = uint8_t(hit_data >> 48);
+    const uint8_t light    = uint8_t(hit_data >> 32);
+    const uint8_t cr       = uint8_t(hit_data >> 24);
+    const uint8_t cg       = uint8_t(hit_data >> 16);
+    const uint8_t cb       = uint8_t(hit_data >> 8);
+    const uint8_t type     = uint8_t((hit_data >> 4) & 0xF);
+
+    // (color * light) >> 8 is sized by its 8-bit target: the product is
+    // truncated before the shift, which always yields 0 and the fallback.
+    uint8_t r = uint8_t(uint8_t(cr * light) >> 8);
+    uint8_t g = uint8_t(uint8_t(cg * light) >> 8);
+    uint8_t b = uint8_t(uint8_t(cb * light) >> 8);
+    if (r == 0 && g == 0 && b == 0) {
+        r = cr;
+        g = cg;
+        b = cb;
+    }
+
+    // Emission: the product is sized by the 9-bit tmp.
+    if (emissive != 0) {
+        r = add_sat(r, ((unsigned(emissive) * r) & 0x1FF) >> 8);
+        g = add_sat(g, ((unsigned(emissive) * g) & 0x1FF) >> 8);
+        b = add_sat(b, ((unsigned(emissive) * b) & 0x1FF) >> 8);
+    }
+
+    const uint8_t material_id = uint8_t(type << 4);
+    uint8_t reflection;
+    if (type == 3)      reflection = 255;
+    else if (type == 5) reflection = 200;
+    else                reflection = props & 0xE0;
+    uint8_t refraction;
+    if (type == 5)      refraction = 128;
+    else if (type == 2) refraction = 85;
+    else                refraction = 0;
+    const uint8_t attenuation = steps;
+    const uint8_t emission    = type == 1 ? emissive : 0;
+
+    uint32_t normals = c.normals;
+    if (!cfg_.smooth_surfaces)
+        normals = 127u << 8;   // nx = 0, ny = 0, nz = 127, curvature = 0
+    const uint8_t curvature = uint8_t(normals);
+
+    // apply_advanced_lighting
+    if (cfg_.extra_light && curvature > 32) {
+        r = add_sat(r, curvature >> 4);
+        b = add_sat(b, curvature >> 4);
+    }
+
+    if (y >= FLOOR_MIN_Y && y <= FLOOR_MAX_Y) {
+        const int dx = x - SHADOW_CX;
+        const int dz = z - SHADOW_CZ;
+        const bool shadow_hit = dx * dx + dz * dz <= SHADOW_RADIUS2;
+        const unsigned scale = shadow_hit ? 80u : unsigned(180 + (LIGHT_PLANE_Y >> 1));
+        r = uint8_t((r * scale) >> 8);
+        g = uint8_t((g * scale) >> 8);
+        b = uint8_t((b * scale) >> 8);
+        if (!shadow_hit) {
+            r = add_sat(r, 20);
+            g = add_sat(g, 12);
+            b = add_sat(b, 4);
+        }
+    }
+
+    if (cfg_.sel_active &&
+        x == (cfg_.sel_x & 63) && y == (cfg_.sel_y & 63) && z == (cfg_.sel_z & 63)) {
+        r = add_sat(r, 96);
+        g = add_sat(g, 16);
+        b = add_sat(b, 96);
+    }
+
+    c.normals = normals;
+
+    ModelPixel p;
+    p.w0 = (uint32_t(reflection) << 24) | (uint32_t(refraction) << 16) |
+           (uint32_t(attenuation) << 8) | emission;
+    p.w1 = (uint32_t(r) << 24) | (uint32_t(g) << 16) | (uint32_t(b) << 8) | material_id;
+    p.w2 = normals;
+    return p;
+}
+
+// A value of a 32-bit RTL register.
+static int32_t wrap32(int64_t v) {
+    return int32_t(uint32_t(uint64_t(v)));
+}
+
+static uint32_t t_sat(uint64_t v) {
+    return v >= T_INF ? T_INF : uint32_t(v);
+}
+
+static uint32_t t_add(uint32_t a, uint32_t b) {
+    return t_sat(uint64_t(a) + b);
+}
+
+// Crossings on one axis before the brick-exit crossing at t_exit.
+static int brick_steps(uint32_t tmax, uint32_t tdelta, uint32_t t_exit, bool tie_first) {
+    int n = 0;
+    for (int c = 0; c < 8; ++c) {
+        const uint32_t t = t_sat(uint64_t(tmax) + uint64_t(c) * tdelta);
+        if (t < t_exit || (tie_first && t == t_exit))
+            ++n;
+    }
+    return n;
+}
+
+// Voxels left before the grid edge in the direction of travel.
+static int grid_left(int pos, bool neg) {
+    return neg ? pos : VoxelModel::kGrid - 1 - pos;
+}
+
+// S_STEP over an empty box reaching r[a] more voxels along each axis: the
+// boundary crossing that leaves it (ties X, Y, Z) and every earlier crossing
+// on the other axes, in one go. Returns the voxels passed.
+static int cross_box(int pos[3], const bool neg[3], uint32_t tmax[3], const uint32_t tdelta[3],
+                     const int r[3], bool& out) {
+    uint32_t t_exit[3];
+    for (int a = 0; a < 3; ++a)
+        t_exit[a] = t_sat(uint64_t(tmax[a]) + uint64_t(r[a]) * tdelta[a]);
+    const int e = t_exit[0] <= t_exit[1] && t_exit[0] <= t_exit[2] ? 0
+                : t_exit[1] <= t_exit[2]                           ? 1 : 2;
+    out = r[e] == grid_left(pos[e], neg[e]);
+    int passed = 0;
+    for (int a = 0; a < 3; ++a) {
+        const int n = a == e ? r[a] + 1 : brick_steps(tmax[a], tdelta[a], t_exit[e], a < e);
+        pos[a] += neg[a] ? -n : n;
+        tmax[a] = t_sat(uint64_t(tmax[a]) + uint64_t(n) * tdelta[a]);
+        passed += n;
+    }
+    return passed;
+}
+
+// S_IDLE cam_setup: up = dir x plane in camera axes, then camera (x, y, z)
+// becomes voxel (x, z, y).
+VoxelModel::RayBasis VoxelModel::ray_basis() const {
+    const int64_t dx = cfg_.cam_dir_x, dy = cfg_.cam_dir_y, dz = cfg_.cam_dir_z;
+    const int64_t px = cfg_.cam_plane_x, py = cfg_.cam_plane_y;
+    const int32_t fwd[3]   = {int32_t(dx), int32_t(dz), int32_t(dy)};
+    const int32_t right[3] = {int32_t(px), 0, int32_t(py)};
+    const int32_t up[3]    = {wrap32(-(py * dz)) >> 8,
+                              wrap32(py * dx - px * dy) >> 8,
+                              wrap32(px * dz) >> 8};
+    RayBasis b;
+    for (int a = 0; a < 3; ++a) {
+        b.dx[a]  = wrap32((int64_t(right[a]) << 17) / width_);
+        b.du[a]  = wrap32((int64_t(up[a]) << 17) / width_);
+        b.row[a] = wrap32(int64_t(fwd[a]) * 65536 - int64_t(width_ / 2) * b.dx[a] +
+                          int64_t(height_ / 2) * b.du[a]);
+    }
+    b.org[0] = cfg_.cam_x;
+    b.org[1] = cfg_.cam_z;
+    b.org[2] = cfg_.cam_y;
+    return b;
+}
+
+// S_RENDER_PIXEL .. S_RAY_TMAX, then the DDA walk of S_STEP/S_FETCH. The
+// direction registers only ever add dx per pixel and subtract du per row,
+// which modulo 2^32 is the same as the products used here.
+VoxelModel::RayHit VoxelModel::trace_ray(const RayBasis& b, int px, int py, Composite* comp) const {
+    int32_t  d[3];
+    bool     neg[3];
+    uint32_t inv[3];
+    for (int a = 0; a < 3; ++a) {
+        const uint32_t dir = uint32_t(b.row[a]) - uint32_t(py) * uint32_t(b.du[a]) +
+                             uint32_t(px) * uint32_t(b.dx[a]);
+        d[a]   = int32_t(dir) >> 8;
+        neg[a] = d[a] < 0;
+        const uint32_t mag = uint32_t(neg[a] ? -d[a] : d[a]);
+        const uint32_t q   = mag ? (1u << 24) / mag : ~0u;
+        inv[a] = q >= T_INF ? T_INF : q;
+    }
+
+    // S_RAY_CLIP
+    uint32_t t_in = 0, t_out = T_INF;
+    bool     out  = false;
+    for (int a = 0; a < 3; ++a) {
+        const int org = b.org[a];
+        if (inv[a] == T_INF) {
+            out |= org < 0 || org >= GRID_END;
+            continue;
+        }
+        const int dn = neg[a] ? org - GRID_END : -org;
+        const int df = neg[a] ? org : GRID_END - org;
+        const uint32_t t_near = dn <= 0 ? 0 : t_sat((uint64_t(dn) * inv[a]) >> 8);
+        const uint32_t t_far  = df <= 0 ? 0 : t_sat((uint64_t(df) * inv[a]) >> 8);
+        out  |= df <= 0;
+        t_in  = std::max(t_in, t_near);
+        t_out = std::min(t_out, t_far);
+    }
+    out |= t_in >= t_out;
+
+    // S_RAY_ENTER / S_RAY_TMAX
+    int      pos[3];
+    uint32_t tmax[3];
+    for (int a = 0; a < 3; ++a) {
+        const int64_t p = b.org[a] + ((int64_t(d[a]) * t_in) >> 16);
+        pos[a] = p < 0 ? 0 : p >= GRID_END ? kGrid - 1 : int(p >> 8);
+        const int dist = neg[a] ? b.org[a] - (pos[a] << 8) : ((pos[a] + 1) << 8) - b.org[a];
+        tmax[a] = inv[a] == T_INF ? T_INF
+                : dist <= 0       ? 0
+                                  : t_sat((uint64_t(dist) * inv[a]) >> 8);
+    }
+    return walk_ray(pos, neg, tmax, inv, out, comp);
+}
+
+VoxelModel::RayHit VoxelModel::walk_ray(int pos[3], const bool neg[3], uint32_t tmax[3],
+                                        const uint32_t inv[3], bool out, Composite* comp) const {
+    RayHit r;
+    uint64_t word = 0;
+    bool pending = false;
+    const bool skip = skip_empty(), jump = sdf();
+    for (;;) {
+        if (pending && solid(word)) {
+            if (!comp || !translucent(word)) {
+                r.hit = 1;
+                break;
+            }
+            if (blend(*comp, word)) {
+                // Voxels past this one before the nearest face the ray
+                // leaves through: all it had left when orthographic.
+                const int v[3] = {r.x, r.y, r.z};
+                int left = kGrid - 1;
+                for (int a = 0; a < 3; ++a)
+                    if (inv[a] != T_INF)
+                        left = std::min(left, grid_left(v[a], neg[a]));
+                comp->saved = uint8_t(left);
+                r.hit = 1;
+                break;
+            }
+            pending = false;
+            continue;
+        }
+        if (out || r.steps >= kDdaMaxSteps)
+            break;
+        if (skip && !brick_occupied(pos[0] >> kBrickShift, pos[1] >> kBrickShift,
+                                    pos[2] >> kBrickShift)) {
+            int reach[3];
+            for (int a = 0; a < 3; ++a)
+                reach[a] = neg[a] ? (pos[a] & 7) : 7 - (pos[a] & 7);
+            r.steps = uint8_t(r.steps + cross_box(pos, neg, tmax, inv, reach, out));
+            ++r.skips;
+            pending = false;
+            continue;
+        }
+        if (jump && pending && (word & 0xF) >= 2) {
+            // The cube of radius d - 1 around the voxel just read is clear,
+            // so is the one of radius d - 2 around its neighbour.
+            const int d = std::min(int(word & 0xF) - 2, 7);
+            int reach[3];
+            for (int a = 0; a < 3; ++a)
+                reach[a] = std::min(d, grid_left(pos[a], neg[a]));
+            r.steps = uint8_t(r.steps + cross_box(pos, neg, tmax, inv, reach, out));
+            ++r.jumps;
+            pending = false;
+            continue;
+        }
+        r.x = uint8_t(pos[0]);
+        r.y = uint8_t(pos[1]);
+        r.z = uint8_t(pos[2]);
+        word = vox_[addr_of(pos[0], pos[1], pos[2])];
+        pending = true;
+        ++r.reads;
+        ++r.steps;
+        const int a = tmax[0] <= tmax[1] && tmax[0] <= tmax[2] ? 0 : tmax[1] <= tmax[2] ? 1 : 2;
+        out      = neg[a] ? pos[a] == 0 : pos[a] == kGrid - 1;
+        pos[a]  += neg[a] ? -1 : 1;
+        tmax[a]  = t_add(tmax[a], inv[a]);
+    }
+    return r;
+}
+
+void VoxelModel::trace_rays(const RayBasis& b, int py0, int py1, int px0, int px1) {
+    const bool comp = composite();
+    if (comp)
+        comps_.resize(rays_.size());
+    for (int py = py0; py < py1; ++py)
+        for (int px = px0; px < px1; ++px) {
+            const size_t i = size_t(py) * size_t(width_) + size_t(px);
+            if (comp)
+                comps_[i] = Composite();
+            rays_[i] = trace_ray(b, px, py, comp ? &comps_[i] : nullptr);
+        }
+}
+
+// S_BLEND: a voxel that would take the opacity to the threshold ends the
+// ray and is shaded as the surface, with the transmittance in front of it;
+// any other adds alpha of what is left of its colour.
+bool VoxelModel::blend(Composite& c, uint64_t word) const {
+    const unsigned alpha   = unsigned(word >> 40) & 0xFF;
+    const unsigned contrib = (unsigned(c.t) * alpha) >> 8;
+    c.last = word;
+    if (256 - (c.t - contrib) >= cfg_.alpha_threshold) {
+        c.ended = true;
+        return true;
+    }
+    c.r = uint8_t(c.r + ((contrib * ((word >> 24) & 0xFF)) >> 8));
+    c.g = uint8_t(c.g + ((contrib * ((word >> 16) & 0xFF)) >> 8));
+    c.b = uint8_t(c.b + ((contrib * ((word >> 8) & 0xFF)) >> 8));
+    c.t = uint16_t(c.t - contrib);
+    ++c.blends;
+    return false;
+}
+
+// The surface (or sky) colour seen through the blended voxels.
+void VoxelModel::composite_over(const Composite& c, ModelPixel& p) {
+    const unsigned acc[3] = {c.r, c.g, c.b};
+    uint32_t w1 = p.w1 & 0xFF;
+    for (int k = 0; k < 3; ++k) {
+        const int      shift = 24 - 8 * k;
+        const unsigned s     = (p.w1 >> shift) & 0xFF;
+        w1 |= ((acc[k] + ((unsigned(c.t) * s) >> 8)) & 0xFF) << shift;
+    }
+    p.w1 = w1;
+}
+
+// Dark blue with a vertical gradient; material ID 0xFF.
+static uint32_t sky_w1(int pixel_y) {
+    const uint8_t sky_r = uint8_t(10 + ((pixel_y & 0xFF) >> 3));
+    const uint8_t sky_g = uint8_t(40 + ((pixel_y & 0xFF) >> 3));
+    const uint8_t sky_b = uint8_t(90 + ((pixel_y & 0xFF) >> 2));
+    return (uint32_t(sky_r) << 24) | (uint32_t(sky_g) << 16) | (uint32_t(sky_b) << 8) | 0xFF;
+}
+
+ModelPixel VoxelModel::sky(ModelCarry& c, int pixel_y) {
+    c.normals = 127u << 8;
+
+    ModelPixel p;
+    p.w0 = 255u << 8;
+    p.w1 = sky_w1(pixel_y);
+    p.w2 = 127u << 8;
+    return p;
+}
+
+void VoxelModel::finish_hit(PixelState& st, int i, int x, int y, int z, uint8_t steps,
+                            ModelPixel* out) const {
+    if (st.emit == Emit::Scalar) {
+        out[i] = shade(st.carry, x, y, z, steps);
+        return;
+    }
+    if (st.emit == Emit::Packet) {
+        ShadeRow& s = *st.row;
+        s.lo[i]      = uint32_t(st.carry.hit_data);
+        s.hi[i]      = uint32_t(st.carry.hit_data >> 32);
+        s.x[i]       = uint32_t(x);
+        s.y[i]       = uint32_t(y);
+        s.z[i]       = uint32_t(z);
+        s.steps[i]   = steps;
+        s.normals[i] = st.carry.normals;
+        s.hit[i]     = ~0u;
+    }
+    // The only register shade() changes besides the pixel.
+    if (!cfg_.smooth_surfaces)
+        st.carry.normals = 127u << 8;
+}
+
+void VoxelModel::finish_sky(PixelState& st, int i, int pixel_y, ModelPixel* out) {
+    if (st.emit == Emit::Scalar) {
+        out[i] = sky(st.carry, pixel_y);
+        return;
+    }
+    if (st.emit == Emit::Packet)
+        st.row->hit[i] = 0;
+    st.carry.normals = 127u << 8;
+}
+
+// S_RAY_ENTER, S_RAY_TMAX, S_STEP/S_FETCH per read, a cycle per skip or
+// jump, the final S_STEP, S_SHADE on a hit, S_WRITE, S_NEXT_PIXEL; and with
+// composite, S_BLEND per translucent voxel plus its S_STEP unless it ended
+// the ray.
+uint32_t VoxelModel::ray_tail(size_t idx) const {
+    const RayHit& r = rays_[idx];
+    uint32_t n = 2u * r.reads + r.skips + r.jumps + r.hit + 5u;
+    if (composite()) {
+        const Composite& c = comps_[idx];
+        n += 2u * c.blends + (c.ended ? 1u : 0u);
+    }
+    return n;
+}
+
+int VoxelModel::ray_setup_cycles(int px, int py) const {
+    int prev_x, prev_y;
+    if (tile_order()) {
+        const int x0 = px & ~(kTile - 1);
+        if (px != x0) {
+            prev_x = px - 1;
+            prev_y = py;
+        } else if (((py / lanes()) & (kTile - 1)) != 0) {
+            prev_x = std::min(x0 + kTile, width_) - 1;
+            prev_y = py - lanes();
+        } else {
+            return kRaySetupCycles;
+        }
+    } else if (px != 0) {
+        prev_x = px - 1;
+        prev_y = py;
+    } else if (py >= lanes()) {
+        prev_x = width_ - 1;
+        prev_y = py - lanes();
+    } else {
+        return kRaySetupCycles;
+    }
+    const uint32_t tail = ray_tail(size_t(prev_y) * size_t(width_) + size_t(prev_x));
+    return 3 + (tail >= uint32_t(kRecipCycles - 1) ? 0 : int(kRecipCycles - 1 - tail));
+}
+
+// One pixel from S_RENDER_PIXEL to S_NEXT_PIXEL, written to out[i], with
+// its reads and clock cycles added to st.
+void VoxelModel::render_pixel(PixelState& st, int i, int px, int py, int my, int mz,
+                              ModelPixel* out) const {
+    const bool cursor_sample = px == (width_ >> 1) && py == (height_ >> 1);
+    uint64_t& read_data = st.carry.read_data;
+    const unsigned prev_type = unsigned(st.carry.hit_data >> 4) & 0xF;
+    // S_RENDER_PIXEL, STEP/FETCH per sample, final STEP, WRITE, NEXT.
+    auto account = [&st](int samples) {
+        st.reads  += uint64_t(samples);
+        st.cycles += uint64_t(2 * samples + 4);
+    };
+
+    if (cfg_.diag_slice) {
+        // One sample per slice; compute_pixel_data sees the last slice's
+        // coordinates whichever slice hit.
+        bool best_hit = false;
+        int  x = 0;
+        for (int s = 0; s < NUM_SLICES; ++s) {
+            x = SLICE_X_START - s * SLICE_STEP;
+            if (!best_hit && solid(read_data)) {
+                best_hit = true;
+                fetch_hit(st, read_data, x, my, mz, cursor_sample, prev_type);
+            }
+            read_data = vox_[addr_of(x, my, mz)];
+        }
+        if (best_hit)
+            finish_hit(st, i, x, my, mz, uint8_t(NUM_SLICES), out);
+        else
+            finish_sky(st, i, py, out);
+        account(NUM_SLICES);
+        return;
+    }
+
+    if (composite()) {
+        composite_pixel(st, i, px, py, my, mz, cursor_sample, out);
+        return;
+    }
+
+    if (perspective()) {
+        const RayHit& r = rays_[size_t(py) * size_t(width_) + size_t(px)];
+        if (r.reads)
+            read_data = vox_[addr_of(r.x, r.y, r.z)];
+        if (r.hit) {
+            fetch_hit(st, read_data, r.x, r.y, r.z, cursor_sample, unsigned(read_data >> 4) & 0xF);
+            finish_hit(st, i, r.x, r.y, r.z, r.steps, out);
+            st.cycles += 1;   // S_SHADE
+        } else {
+            finish_sky(st, i, py, out);
+        }
+        account(r.reads);
+        st.cycles += uint64_t(ray_setup_cycles(px, py)) + r.skips + r.jumps;
+        st.skips  += r.skips;
+        return;
+    }
+
+    const int k = column_step_[size_t(my) * kGrid + size_t(mz)];
+    // Skipped bricks and distance-field jumps: one S_STEP cycle each, no
+    // reads.
+    int skips = 0, jumps = 0;
+    auto account_skips = [&st, &skips, &jumps]() {
+        st.cycles += uint64_t(skips + jumps);
+        st.skips  += uint32_t(skips);
+    };
+
+    if (cfg_.dda) {
+        // The ray enters at x = 63 and visits every voxel down to x = 0; the
+        // incoming read word plays no part.
+        const int x = k == 0 ? 0 : march_x(k - 1);
+        const int visited = kGrid - x;
+        int reads = visited, last = x;
+        if (skip_empty() || sdf())
+            reads = dda_walk(my, mz, skips, jumps, last);
+        if (last >= 0)
+            read_data = vox_[addr_of(last, my, mz)];
+        if (k == 0) {
+            finish_sky(st, i, py, out);
+        } else {
+            fetch_hit(st, read_data, x, my, mz, cursor_sample, unsigned(read_data >> 4) & 0xF);
+            finish_hit(st, i, x, my, mz, uint8_t(visited), out);
+            st.cycles += 1;   // S_SHADE
+        }
+        account(reads);
+        account_skips();
+        return;
+    }
+
+    if (solid(read_data)) {
+        // Hit on the first sample with the previous pixel's last word.
+        const int x = march_x(0);
+        fetch_hit(st, read_data, x, my, mz, cursor_sample, prev_type);
+        read_data = vox_[addr_of(x, my, mz)];
+        finish_hit(st, i, x, my, mz, 1, out);
+        account(1);
+        return;
+    }
+
+    // Last sample issued without skipping: the hit sample, or 127.
+    const int last = k == 0 ? kMaxSteps - 1 : k;
+    int reads = last + 1, last_read = last;
+    if (skip_empty())
+        reads = march_skips(my, mz, last, k != 0, skips, last_read);
+    if (k != 0)
+        fetch_hit(st, vox_[addr_of(march_x(k - 1), my, mz)], march_x(k), my, mz, cursor_sample,
+                  prev_type);
+    if (last_read >= 0)
+        read_data = vox_[addr_of(march_x(last_read), my, mz)];
+    if (k == 0)
+        finish_sky(st, i, py, out);
+    else
+        finish_hit(st, i, march_x(k), my, mz, uint8_t(k + 1), out);
+    account(reads);
+    account_skips();
+}
+
+// The orthographic ray is the DDA from the centre of voxel (63, my, mz)
+// along -X. Each voxel blended without ending the ray costs its test in
+// S_STEP and S_BLEND; the one that ends it, S_BLEND.
+void VoxelModel::composite_pixel(PixelState& st, int i, int px, int py, int my, int mz,
+                                 bool cursor_sample, ModelPixel* out) const {
+    RayHit    r;
+    Composite c;
+    if (perspective()) {
+        const size_t idx = size_t(py) * size_t(width_) + size_t(px);
+        r = rays_[idx];
+        c = comps_[idx];
+        st.cycles += uint64_t(ray_setup_cycles(px, py));
+    } else {
+        int            pos[3]  = {kGrid - 1, my, mz};
+        const bool     neg[3]  = {true, false, false};
+        uint32_t       tmax[3] = {128, T_INF, T_INF};
+        const uint32_t inv[3]  = {256, T_INF, T_INF};
+        r = walk_ray(pos, neg, tmax, inv, false, &c);
+    }
+
+    uint64_t& read_data = st.carry.read_data;
+    if (r.reads)
+        read_data = vox_[addr_of(r.x, r.y, r.z)];
+    if (c.blends || c.ended)
+        st.carry.hit_data = c.last;   // payload_data
+    if (r.hit) {
+        fetch_hit(st, read_data, r.x, r.y, r.z, cursor_sample, unsigned(read_data >> 4) & 0xF);
+        finish_hit(st, i, r.x, r.y, r.z, r.steps, out);
+        st.cycles += 1;   // S_SHADE
+    } else {
+        finish_sky(st, i, py, out);
+    }
+    composite_over(c, out[i]);
+    st.reads  += r.reads;
+    st.cycles += 2 * uint64_t(r.reads) + 4 + r.skips + r.jumps + 2 * uint64_t(c.blends) +
+                 (c.ended ? 1 : 0);
+    st.skips  += r.skips;
+    st.saved  += c.saved;
+}
+
+void VoxelModel::render_span(PixelState& st, int py, int px0, int n, const ShadeParams& params,
+                             ModelPixel* out) const {
+    const int my = map_y(py);
+    for (int i = 0; i < n; ++i) {
+        const int px = px0 + i;
+        render_pixel(st, i, px, py, my, map_z(px), out);
+    }
+    if (st.emit == Emit::Packet) {
+        st.row->sky_w1 = sky_w1(py);
+        packet_shade(simd_, *st.row, size_t(n), params, out);
+    }
+}
+
+// Sky pixels are the only ones with material ID 0xFF; give a copied row its
+// own gradient.
+void VoxelModel::patch_sky(ModelPixel* row, int n, int pixel_y) const {
+    const uint32_t sky = sky_w1(pixel_y);
+    for (int i = 0; i < n; ++i)
+        if ((row[i].w1 & 0xFF) == 0xFF)
+            row[i].w1 = sky;
+}
+
+ShadeParams VoxelModel::shade_params() const {
+    ShadeParams params;
+    params.smooth_surfaces = cfg_.smooth_surfaces;
+    params.extra_light     = cfg_.extra_light;
+    params.sel_active      = cfg_.sel_active;
+    params.sel_x = cfg_.sel_x & 63;
+    params.sel_y = cfg_.sel_y & 63;
+    params.sel_z = cfg_.sel_z & 63;
+    return params;
+}
+
+void VoxelModel::render_rows(PixelState& st, const ShadeParams& params, int lane) {
+    const bool persp = perspective();
+    const int cursor_y = height_ >> 1;
+    const int step = lanes();
+
+    row_memo_.valid = false;
+    for (int py = lane; py < height_; py += step) {
+        const int my = map_y(py);
+        ModelPixel* row = &pixels_[size_t(py) * size_t(width_)];
+
+        // Rows mapping to the same voxel row with the same carry-in repeat
+        // the lane's previous row except for the sky gradient (not so for
+        // perspective rays, which differ per row).
+        RowMemo& rm = row_memo_;
+        if (rm.valid && rm.my == my && py != cursor_y && rm.in == st.carry) {
+            std::memcpy(row, row - size_t(step) * size_t(width_), sizeof(ModelPixel) * size_t(width_));
+            patch_sky(row, width_, py);
+            st.carry   = rm.out;
+            st.hits   += rm.hits;
+            st.cycles += rm.cycles;
+            st.reads  += rm.reads;
+            st.skips  += rm.skips;
+            continue;
+        }
+        rm.valid = py != cursor_y && !persp && !composite();
+        rm.my    = my;
+        rm.in    = st.carry;
+        const uint32_t row_hits   = st.hits;
+        const uint64_t row_cycles = st.cycles;
+        const uint64_t row_reads  = st.reads;
+        const uint32_t row_skips  = st.skips;
+
+        // The carry registers chain every pixel to the one before it, so hits
+        // resolve in order; with SIMD on, shading then runs a packet at a time.
+        render_span(st, py, 0, width_, params, row);
+
+        rm.out    = st.carry;
+        rm.hits   = st.hits - row_hits;
+        rm.cycles = st.cycles - row_cycles;
+        rm.reads  = st.reads - row_reads;
+        rm.skips  = st.skips - row_skips;
+    }
+}
+
+// The first pixel of each (map_y, map_z) bucket fills the line buffer; the
+// others copy it (S_RENDER_PIXEL, S_WRITE, S_NEXT_PIXEL). The buffer empties
+// when map_y changes between the lane's rows, and the cursor pixel always
+// traces.
+void VoxelModel::render_memo(PixelState& st, int lane) {
+    const int cursor_x = width_ >> 1;
+    const int cursor_y = height_ >> 1;
+    ModelPixel memo[kGrid];
+    uint64_t   valid = 0;
+    int        memo_row = -1;
+
+    st.emit = Emit::Scalar;
+    for (int py = lane; py < height_; py += lanes()) {
+        const int my = map_y(py);
+        ModelPixel* row = &pixels_[size_t(py) * size_t(width_)];
+        if (my != memo_row) {
+            valid    = 0;
+            memo_row = my;
+        }
+        const uint32_t sky = sky_w1(py);
+        for (int px = 0; px < width_; ++px) {
+            const int mz = map_z(px);
+            const uint64_t bit = uint64_t(1) << mz;
+            if ((valid & bit) && !(px == cursor_x && py == cursor_y)) {
+                row[px] = memo[mz];
+                if ((row[px].w1 & 0xFF) == 0xFF)
+                    row[px].w1 = sky;
+                else
+                    ++st.hits;
+                st.cycles += 3;
+                continue;
+            }
+            render_pixel(st, px, px, py, my, mz, row);
+            if (!(valid & bit)) {
+                memo[mz] = row[px];
+                valid |= bit;
+            }
+        }
+    }
+}
+
+void VoxelModel::tile_cell(int order, int bits, uint32_t d, int& tx, int& ty) {
+    tx = 0;
+    ty = 0;
+    if (order == 2) {
+        for (int b = 0; b < bits; ++b) {
+            tx |= int((d >> (2 * b)) & 1) << b;
+            ty |= int((d >> (2 * b + 1)) & 1) << b;
+        }
+    } else if (order == 3) {
+        // Hilbert d2xy, finest quadrant first.
+        for (int b = 0; b < bits; ++b, d >>= 2) {
+            const int rx = int(d >> 1) & 1;
+            const int ry = int(d ^ uint32_t(rx)) & 1;
+            if (!ry) {
+                if (rx) {
+                    tx = (1 << b) - 1 - tx;
+                    ty = (1 << b) - 1 - ty;
+                }
+                std::swap(tx, ty);
+            }
+            tx |= rx << b;
+            ty |= ry << b;
+        }
+    } else {
+        tx = int(d & ((1u << bits) - 1));
+        ty = int(d >> bits);
+    }
+}
+
+int VoxelModel::tile_bits(int tiles_x, int tiles_y) {
+    int bits = 1;
+    while ((1 << bits) < std::max(tiles_x, tiles_y))
+        ++bits;
+    return bits;
+}
+
+int VoxelModel::tile_cells(int rows) const {
+    const int bits = tile_bits((width_ + kTile - 1) / kTile, (rows + kTile - 1) / kTile);
+    return 1 << (2 * bits);
+}
+
+// S_NEXT_TILE takes a clock per cell, on screen or not; inside a tile the
+// pixels go as in raster order, each chained to the one walked before it.
+void VoxelModel::render_tiles(PixelState& st, int lane) {
+    const int rows    = lane_rows(lane);
+    const int tiles_x = (width_ + kTile - 1) / kTile;
+    const int tiles_y = (rows + kTile - 1) / kTile;
+    const int bits    = tile_bits(tiles_x, tiles_y);
+    const int cells   = tile_cells(rows);
+
+    st.emit = Emit::Scalar;
+    st.cycles += uint64_t(cells);
+    for (int d = 0; d < cells; ++d) {
+        int tx, ty;
+        tile_cell(tile_order(), bits, uint32_t(d), tx, ty);
+        if (tx >= tiles_x || ty >= tiles_y)
+            continue;
+        const int k1 = std::min(ty * kTile + kTile, rows);
+        const int x1 = std::min(tx * kTile + kTile, width_);
+        for (int k = ty * kTile; k < k1; ++k) {
+            const int py = lane + k * lanes();
+            const int my = map_y(py);
+            ModelPixel* row = &pixels_[size_t(py) * size_t(width_)];
+            for (int px = tx * kTile; px < x1; ++px)
+                render_pixel(st, px, px, py, my, map_z(px), row);
+        }
+    }
+}
+
+void VoxelModel::render() {
+    // S_IDLE with start
+    cursor_.hit_valid  = false;
+    cursor_.voxel_data = 0;
+
+    const bool persp = perspective();
+    if (persp)
+        trace_rays(ray_basis(), 0, height_, 0, width_);
+    else if (!cfg_.diag_slice)
+        refresh_columns();
+
+    const ShadeParams params = shade_params();
+
+    hit_count_ = 0;
+    cycles_    = 0;
+    reads_     = 0;
+    skips_     = 0;
+    ets_saved_ = 0;
+    for (int lane = 0; lane < lanes(); ++lane) {
+        PixelState st;
+        st.carry  = carry_[lane];
+        st.cursor = &cursor_;
+        st.cycles = 1;
+        st.emit   = simd_ == SimdLevel::Scalar || composite() ? Emit::Scalar : Emit::Packet;
+        st.row    = &shade_row_;
+
+        if (tile_order())
+            render_tiles(st, lane);
+        else if (memo())
+            render_memo(st, lane);
+        else
+            render_rows(st, params, lane);
+
+        carry_[lane] = st.carry;
+        hit_count_  += st.hits;
+        cycles_      = std::max(cycles_, st.cycles);
+        reads_      += st.reads;
+        skips_      += st.skips;
+        ets_saved_  += st.saved;
+    }
+}
@@ -0,0 +1,395 @@
+// ============================================================================
+// voxel_model.h
+// - Bit-exact C++ model of voxel_raycaster_core_pipelined over a 64^3 volume
+//   laid out like voxel_memory_64 ({x,y,z} -> (x << 12) | (y << 6) | z).
+// - Reproduces the RTL as it behaves, not as its comments describe it:
+//   * voxel_memory_64 has a registered read, so S_FETCH tests the word read
+//     for the previous sample (the first sample of a pixel sees the last word
+//     read for the pixel before it).
+//   * The base light product is evaluated at 8 bits and the emission product
+//     at 9, so base colour is the voxel colour and emission adds at most 1.
+//   * Normals/curvature carry over from the previous pixel; curvature never
+//     leaves 0, so extra-light mode never boosts anything.
+//   * Cursor material_id is taken from the previous hit's material type.
+// - DDA mode (render_config[2]) visits each voxel of the ray once and tests
+//   every read after it lands, so it has no fetch skew and its cursor
+//   material_id is the hit's own type.
+// - Perspective mode (render_config[3]) traces every pixel's ray once per
+//   frame with the core's integer setup (add-stepped directions, 2^24 / |d|,
+//   clip, entry voxel) and the same DDA walk. A ray that misses the volume
+//   reads nothing, so the carried read word passes through it.
+// - Ray memo (render_config[4]) traces only the first pixel of each
+//   (map_y, map_z) bucket and the cursor pixel; the rest copy the bucket's
+//   words in 3 cycles and leave the carry registers alone.
+// - Empty-space skipping (render_config[5]) crosses 8^3 bricks with no
+//   solid voxel in one cycle each, without reading them. Pixels and hits are
+//   as without it. Reads, cycles and the carried read word (a sky ray that
+//   skips every brick reads nothing) follow the core. The brick counts are
+//   kept up to date on every volume write, like voxel_occupancy.
+// - Distance-field jumps (render_config[6]) take the distance in the low
+//   nibble of each non-solid word as written (see scene/distance_field.h)
+//   and cross the cube it clears in one cycle, in DDA and perspective mode.
+//   With a current field pixels are as without it.
+// - Pipelined DDA (render_config[7]) writes the orthographic DDA's pixels,
+//   hits, skips and cursor with the ray memo off. cycles() and reads() stay
+//   those of the sequential walk; the pipeline's own schedule is not
+//   modelled.
+// - Lanes (ModelConfig::lanes, voxel_framebuffer_top NUM_LANES): lane k
+//   renders rows k, k + lanes, ... with carry registers of its own, so a
+//   row's first pixel follows the lane's previous row. hit_count(), reads()
+//   and skips() are totals; cycles() is the slowest lane's, without the
+//   top's payload-port and pixel-port stalls.
+// - Tile order (ModelConfig::tile_order, render_config[9:8]) walks each
+//   lane's pixels in 8x8 tiles (tile_cell()) with the carry registers
+//   chained in that order, the ray memo off, and one cycle per tile cell
+//   the core tests (tile_cells()).
+// - Composite mode (ModelConfig::composite, render_config[10]) blends the
+//   translucent voxels (solid, material type 2 or 5) a DDA or perspective
+//   ray meets front to back, one S_BLEND cycle each, until an opaque hit,
+//   the sky, or a voxel that would take the opacity to alpha_threshold; that
+//   one is shaded as the surface. ets_saved() counts the voxels such early
+//   ends left unread. Pipeline and ray memo are off while it is on.
+// - Carry-over registers persist across render() calls, so a model rendering
+//   every frame the RTL renders stays in lockstep with it.
+// - Column marches and shading run in 8/16-ray packets where the CPU allows
+//   (see packet_march.h); set_simd(SimdLevel::Scalar) forces the reference
+//   scalar path.
+// - No Verilator dependency; used by sim_voxel --diff-model and standalone.
+// ============================================================================
+#pragma once
+
+#include "packet_march.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One 96-bit extended pixel as the core writes it:
+// w0: [31:24] reflection, [23:16] refraction, [15:8] attenuation, [7:0] emission
+// w1: [31:24] R, [23:16] G, [15:8] B, [7:0] material ID
+// w2: [31:24] nx, [23:16] ny, [15:8] nz, [7:0] curvature
+struct ModelPixel {
+    uint32_t w0 = 0;
+    uint32_t w1 = 0;
+    uint32_t w2 = 0;
+
+    // Same mapping as the viewer: alpha 0xFF, R/G/B from w1[31:8].
+    uint32_t argb() const { return 0xFF000000u | (w1 >> 8); }
+};
+
+// Core inputs sampled while a frame renders.
+struct ModelConfig {
+    bool    smooth_surfaces = true;
+    bool    extra_light     = false;   // render_config[0]
+    bool    diag_slice      = false;   // render_config[1]
+    bool    dda             = false;   // render_config[2]; diag_slice wins
+    bool    perspective     = false;   // render_config[3]; over dda, under diag_slice
+    bool    memo            = false;   // render_config[4]; off while perspective is
+    bool    skip_empty      = false;   // render_config[5]; off in diag_slice
+    bool    sdf             = false;   // render_config[6]; DDA and perspective only
+    bool    pipeline        = false;   // render_config[7]; orthographic DDA only
+    int     lanes           = 1;       // NUM_LANES, 1 .. VoxelModel::kMaxLanes
+    // render_config[9:8]: 0 raster, else 8x8 tiles in tile-row (1), Morton
+    // (2) or Hilbert (3) order
+    int     tile_order      = 0;
+    bool    composite       = false;   // render_config[10]; DDA and perspective only
+    // render_config[23:16]: opacity (of 256) at which a composite ray ends
+    uint8_t alpha_threshold = 243;
+    // cam_* inputs, Q8.8 in camera axes (z up), at their reset values. Only
+    // perspective mode reads them.
+    int16_t cam_x = 10 * 256;
+    int16_t cam_y = 10 * 256;
+    int16_t cam_z = 10 * 256;
+    int16_t cam_dir_x   = 256;
+    int16_t cam_dir_y   = 0;
+    int16_t cam_dir_z   = 0;
+    int16_t cam_plane_x = 0;
+    int16_t cam_plane_y = 170;
+    bool    sel_active      = false;
+    uint8_t sel_x = 0;
+    uint8_t sel_y = 0;
+    uint8_t sel_z = 0;
+};
+
+// cursor_* outputs; hit_valid and voxel_data clear at frame start, the rest
+// hold their last value like the RTL registers.
+struct ModelCursor {
+    bool     hit_valid   = false;
+    uint8_t  x = 0;
+    uint8_t  y = 0;
+    uint8_t  z = 0;
+    uint8_t  material_id = 0;
+    uint64_t voxel_data  = 0;
+};
+
+// Registers one pixel hands to the next (and the last pixel of a frame to
+// the first of the next frame).
+struct ModelCarry {
+    uint64_t read_data = 0;   // voxel_memory_64 read_data
+    uint64_t hit_data  = 0;   // voxel_material_props .. material_type
+    uint32_t normals   = 0;   // {normal_x, normal_y, normal_z, curvature}
+
+    bool operator==(const ModelCarry& o) const {
+        return read_data == o.read_data && hit_data == o.hit_data && normals == o.normals;
+    }
+    bool operator!=(const ModelCarry& o) const { return !(*this == o); }
+};
+
+class VoxelModel {
+public:
+    static constexpr int    kGrid   = 64;
+    static constexpr size_t kVoxels = size_t(kGrid) * kGrid * kGrid;
+    static constexpr int    kMaxSteps = 128;
+    static constexpr int    kDdaMaxSteps = 192;
+    // Divider (13) + S_RAY_CLIP/ENTER/TMAX: what a perspective pixel with
+    // nothing to overlap its divide with spends on setup (ray_setup_cycles()).
+    static constexpr int    kRecipCycles = 13;
+    static constexpr int    kRaySetupCycles = kRecipCycles + 3;
+    // voxel_occupancy bricks: 8^3 voxels, {x[5:3], y[5:3], z[5:3]}.
+    static constexpr int    kBrickShift = 3;
+    static constexpr int    kBricks = (kGrid >> kBrickShift) * (kGrid >> kBrickShift) *
+                                      (kGrid >> kBrickShift);
+    static constexpr int    kMaxLanes = 8;
+
+    VoxelModel(int width = 480, int height = 360);
+
+    // Power-on register state (everything zero, empty volume untouched).
+    void reset();
+
+    // Volume access. Every mutation invalidates the cached march of the
+    // (y, z) columns it touches.
+    const uint64_t* volume() const { return vox_.data(); }
+    uint64_t voxel(uint32_t addr) const { return vox_[addr & (kVoxels - 1)]; }
+    void write_voxel(uint32_t addr, uint64_t data);
+    // Copy a full volume in; only words that differ invalidate columns.
+    void load_volume(const uint64_t* words);
+    void clear_volume();
+    // The scene voxel_world_gen writes: floor and ceiling slabs, two spheres.
+    void generate_world();
+
+    void set_config(const ModelConfig& cfg) { cfg_ = cfg; }
+    const ModelConfig& config() const { return cfg_; }
+
+    // Packet width for render(); defaults to simd_detect(). Levels the CPU
+    // does not support must not be selected.
+    void set_simd(SimdLevel level) { simd_ = level; }
+    SimdLevel simd() const { return simd_; }
+
+    // Render one frame (start .. done) into pixels().
+    void render();
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    const std::vector<ModelPixel>& pixels() const { return pixels_; }
+    const ModelCursor& cursor() const { return cursor_; }
+    uint32_t hit_count() const { return hit_count_; }
+    // Core clock cycles from the start pulse to done for the last frame.
+    uint64_t cycles() const { return cycles_; }
+    // voxel_read_en pulses (trace-plane reads) in the last frame. Payload
+    // reads are one per traced hit.
+    uint64_t reads() const { return reads_; }
+    // dbg_skip_count: empty bricks skipped in the last frame.
+    uint32_t skips() const { return skips_; }
+    // dbg_ets_count: voxels early ray termination left unread in the last
+    // frame (composite mode). Voxels, not steps: with skip_empty or sdf the
+    // walk would have jumped most of them anyway.
+    uint32_t ets_saved() const { return ets_saved_; }
+    // A brick holds a voxel the core would hit.
+    bool brick_occupied(int bx, int by, int bz) const {
+        return brick_count_[size_t((bx << 6) | (by << 3) | bz)] != 0;
+    }
+
+    static uint32_t addr_of(int x, int y, int z) {
+        return (uint32_t(x & 63) << 12) | (uint32_t(y & 63) << 6) | uint32_t(z & 63);
+    }
+
+    // Tile order, as the core walks it: 8x8 tiles over a lane's rows, cells
+    // d = 0 .. 4^bits - 1 of a 2^bits square, off-screen cells skipped.
+    static constexpr int kTile = 8;
+    // Cell d of order 1 (tile rows), 2 (Morton) or 3 (Hilbert) as (tx, ty).
+    static void tile_cell(int order, int bits, uint32_t d, int& tx, int& ty);
+    // Smallest square side, in bits, that covers tiles_x x tiles_y (>= 1).
+    static int tile_bits(int tiles_x, int tiles_y);
+    // Cells S_NEXT_TILE tests in one frame of a lane with `rows` rows.
+    int tile_cells(int rows) const;
+    // Rows lane k renders.
+    int lane_rows(int lane) const { return (height_ - 1 - lane) / lanes() + 1; }
+
+private:
+    friend class TileRenderer;
+
+    // What a span pass does with each resolved pixel: shade it on the spot,
+    // queue it for packet_shade(), or only advance the registers.
+    enum class Emit : uint8_t { Scalar, Packet, None };
+
+    // Everything one pass over a run of pixels reads and writes besides the
+    // volume, so disjoint spans can run on different threads.
+    struct PixelState {
+        ModelCarry   carry;
+        ModelCursor* cursor = nullptr;   // null: cursor capture disabled
+        uint32_t     hits   = 0;
+        uint64_t     cycles = 0;
+        uint64_t     reads  = 0;
+        uint32_t     skips  = 0;
+        uint32_t     saved  = 0;          // dbg_ets_count
+        Emit         emit   = Emit::Scalar;
+        ShadeRow*    row    = nullptr;   // Emit::Packet scratch, >= span width
+    };
+
+    // A traced perspective ray: the last voxel it read (if any), whether
+    // that read hit, and ray_steps (reads plus voxels in skipped bricks and
+    // distance-field jumps).
+    struct RayHit {
+        uint8_t x = 0;
+        uint8_t y = 0;
+        uint8_t z = 0;
+        uint8_t hit = 0;
+        uint8_t reads = 0;
+        uint8_t steps = 0;
+        uint8_t skips = 0;
+        uint8_t jumps = 0;
+    };
+
+    // What S_BLEND leaves of one composite ray: the colour the translucent
+    // voxels in front of the surface add, the transmittance (of 256) they
+    // let through, and the voxels the early end saved (ended only).
+    struct Composite {
+        uint16_t t = 256;
+        uint8_t  r = 0;
+        uint8_t  g = 0;
+        uint8_t  b = 0;
+        uint8_t  blends = 0;      // voxels blended without ending the ray
+        bool     ended = false;   // the hit is the voxel that ended it
+        uint8_t  saved = 0;
+        uint64_t last = 0;        // last translucent word fetched
+    };
+
+    // cam_setup in voxel axes: directions Q8.24, position Q8.8.
+    struct RayBasis {
+        int32_t row[3];   // direction of pixel (0, 0)
+        int32_t dx[3];    // added per pixel
+        int32_t du[3];    // subtracted per row
+        int32_t org[3];
+    };
+
+    // Carry-in/out of the last fully rendered row; see render().
+    struct RowMemo {
+        bool       valid = false;
+        int        my = 0;
+        ModelCarry in, out;
+        uint32_t   hits = 0;
+        uint64_t   cycles = 0;
+        uint64_t   reads = 0;
+        uint32_t   skips = 0;
+    };
+
+    // Legacy -X march of every invalid (y, z) column, assuming the first
+    // sample does not hit. column_step_ holds the first sample to hit
+    // (0 = none); it tested the word read by step - 1, which is also the
+    // first solid voxel a DDA ray meets.
+    void refresh_columns();
+    static bool solid(uint64_t v) { return v != 0 && ((v >> 40) & 0xFF) > 10; }
+    // Glass and water, which composite mode blends.
+    static bool translucent(uint64_t v) {
+        const unsigned type = unsigned(v >> 4) & 0xF;
+        return solid(v) && (type == 2 || type == 5);
+    }
+    static int  march_x(int k);
+    int map_y(int py) const { return ((height_ - 1 - py) * (kGrid - 1)) / (height_ - 1); }
+    int map_z(int px) const { return (px * (kGrid - 1)) / (width_ - 1); }
+    ShadeParams shade_params() const;
+    bool perspective() const { return cfg_.perspective && !cfg_.diag_slice; }
+    bool composite() const { return cfg_.composite && (cfg_.dda || cfg_.perspective) && !cfg_.diag_slice; }
+    bool pipeline() const {
+        return cfg_.pipeline && cfg_.dda && !perspective() && !cfg_.diag_slice && !composite();
+    }
+    bool memo() const {
+        return cfg_.memo && !perspective() && !pipeline() && !tile_order() && !composite();
+    }
+    int  tile_order() const { return cfg_.tile_order & 3; }
+    bool skip_empty() const { return cfg_.skip_empty && !cfg_.diag_slice; }
+    bool sdf() const { return cfg_.sdf && !cfg_.diag_slice; }
+    int  lanes() const { return std::min(std::max(cfg_.lanes, 1), kMaxLanes); }
+    static size_t brick_of(uint32_t addr) {
+        return size_t(((addr >> 9) & 0x1C0) | ((addr >> 6) & 0x38) | ((addr >> 3) & 0x7));
+    }
+    // One occupancy change of the voxel at addr.
+    void note_write(uint32_t addr, uint64_t old_word, uint64_t new_word) {
+        if (solid(old_word) != solid(new_word))
+            brick_count_[brick_of(addr)] += solid(new_word) ? 1 : -1;
+    }
+    void rebuild_bricks();
+    // Reads of the skipping orthographic march of column (my, mz) up to and
+    // including sample `last`, with the bricks it skipped and the last
+    // sample it read (-1: none).
+    int march_skips(int my, int mz, int last, bool hit, int& skips, int& last_read) const;
+    // Reads of the orthographic DDA ray of column (my, mz) with brick skips
+    // and distance-field jumps, and the last x it read (-1: none).
+    int dda_walk(int my, int mz, int& skips, int& jumps, int& last_read) const;
+
+    RayBasis ray_basis() const;
+    // Ray of pixel (px, py) into rays_, for rows [py0, py1) and columns
+    // [px0, px1).
+    void trace_rays(const RayBasis& b, int py0, int py1, int px0, int px1);
+    RayHit trace_ray(const RayBasis& b, int px, int py, Composite* comp = nullptr) const;
+    // Cycles from S_RAY_ENTER to S_NEXT_PIXEL of the traced ray at rays_[idx].
+    uint32_t ray_tail(size_t idx) const;
+    // Setup cycles after S_RENDER_PIXEL of pixel (px, py)'s perspective ray:
+    // the divide for it starts in the S_RAY_CLIP of the pixel before it in
+    // the lane's walk order and runs through that ray's tail, so only the
+    // first pixel of a frame (or of a tile) pays kRaySetupCycles.
+    int ray_setup_cycles(int px, int py) const;
+    // S_STEP/S_FETCH from voxel pos with the DDA registers as given; with
+    // comp, S_BLEND on translucent voxels too.
+    RayHit walk_ray(int pos[3], const bool neg[3], uint32_t tmax[3], const uint32_t inv[3], bool out,
+                    Composite* comp) const;
+    // S_BLEND of word: whether the ray ends on it.
+    bool blend(Composite& c, uint64_t word) const;
+    static void composite_over(const Composite& c, ModelPixel& p);
+
+    static void fetch_hit(PixelState& st, uint64_t data, int x, int y, int z, bool cursor_sample,
+                          unsigned cursor_type);
+    ModelPixel shade(ModelCarry& c, int x, int y, int z, uint8_t steps) const;
+    static ModelPixel sky(ModelCarry& c, int pixel_y);
+    void finish_hit(PixelState& st, int i, int x, int y, int z, uint8_t steps, ModelPixel* out) const;
+    static void finish_sky(PixelState& st, int i, int pixel_y, ModelPixel* out);
+    void render_pixel(PixelState& st, int i, int px, int py, int my, int mz, ModelPixel* out) const;
+    void composite_pixel(PixelState& st, int i, int px, int py, int my, int mz, bool cursor_sample,
+                         ModelPixel* out) const;
+    // Pixels [px0, px0 + n) of row py into out[0..n), timing included.
+    void render_span(PixelState& st, int py, int px0, int n, const ShadeParams& params,
+                     ModelPixel* out) const;
+    void patch_sky(ModelPixel* row, int n, int pixel_y) const;
+    // Rows lane, lane + lanes(), ... in order.
+    void render_rows(PixelState& st, const ShadeParams& params, int lane);
+    void render_memo(PixelState& st, int lane);
+    // The lane's pixels tile by tile in tile_order().
+    void render_tiles(PixelState& st, int lane);
+
+    int width_;
+    int height_;
+    std::vector<uint64_t>   vox_;
+    std::vector<uint8_t>    column_step_;
+    std::vector<uint8_t>    column_valid_;
+    std::vector<uint16_t>   column_todo_;
+    std::vector<uint16_t>   brick_count_;   // solid voxels per brick
+    std::vector<uint8_t>    column_out_;
+    std::vector<ModelPixel> pixels_;
+    std::vector<RayHit>     rays_;
+    std::vector<Composite>  comps_;   // composite perspective frames, per ray
+    ModelConfig cfg_;
+    RowMemo     row_memo_;
+    SimdLevel   simd_;
+    ShadeRow    shade_row_;
+
+    // Registers that survive from one pixel (and frame) to the next, per
+    // lane.
+    ModelCarry  carry_[kMaxLanes];
+    ModelCursor cursor_;
+    uint32_t hit_count_ = 0;
+    uint64_t cycles_ = 0;
+    uint64_t reads_ = 0;
+    uint32_t skips_ = 0;
+    uint32_t ets_saved_ = 0;
+};
@@ -0,0 +1,52 @@
+// ============================================================================
+// pixel_ring.cpp
+// - DPI-C entry points for the pixel port and the batch ARGB conversion.
+// ============================================================================
+#include "pixel_ring.h"
+#include "voxel_sim.h"
+
+#ifdef HYDRA_DPI_PIXELS
+#include "Vvoxel_framebuffer_top__Dpi.h"
+#endif
+
+PixelRing& hydra_pixel_ring() {
+    static PixelRing ring;
+    return ring;
+}
+
+void pixel96_to_argb_batch(const uint32_t* __restrict w1,
+                           uint32_t* __restrict argb, size_t n) {
+    // Same mapping as pixel96_to_argb(): alpha 0xFF, R/G/B from w1[31:8].
+    for (size_t i = 0; i < n; ++i)
+        argb[i] = 0xFF000000u | (w1[i] >> 8);
+}
+
+#ifdef HYDRA_DPI_PIXELS
+
+void hydra_pixel_push(int addr, int w0, int w1, int w2) {
+    PixelRing& r = hydra_pixel_ring();
+    if (r.head - r.tail >= PixelRing::kCapacity) {
+        ++r.overflows;
+        return;
+    }
+    const uint32_t i = uint32_t(r.head) & PixelRing::kMask;
+    r.addr[i] = uint32_t(addr);
+    r.w0[i]   = uint32_t(w0);
+    r.w1[i]   = uint32_t(w1);
+    r.w2[i]   = uint32_t(w2);
+    ++r.head;
+}
+
+void hydra_frame_done() {
+    PixelRing& r = hydra_pixel_ring();
+    if (r.mark_head - r.mark_tail >= PixelRing::kMaxMarks) {
+        ++r.lost_marks;
+        return;
+    }
+    const uint32_t m = r.mark_head % PixelRing::kMaxMarks;
+    r.mark_pos[m]  = r.head;
+    r.mark_time[m] = main_time;
+    ++r.mark_head;
+}
+
+#endif
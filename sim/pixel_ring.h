@@ -0,0 +1,54 @@
+// ============================================================================
+// pixel_ring.h
+// - Host side of the HYDRA_DPI_PIXELS path: the RTL calls hydra_pixel_push()
+//   and hydra_frame_done() from inside eval, the harness drains in bulk.
+// - Structure-of-arrays storage so the ARGB conversion over a drained batch
+//   is a straight, vectorisable loop.
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct PixelRing {
+    // Max pixels between drains is one per cycle, so this only has to cover
+    // the harness sub-chunk (VoxelSim::kDrainCycles).
+    static constexpr uint32_t kCapacity = 1u << 14;
+    static constexpr uint32_t kMask     = kCapacity - 1;
+    static constexpr uint32_t kMaxMarks = 16;
+
+    uint32_t addr[kCapacity];
+    uint32_t w0[kCapacity];
+    uint32_t w1[kCapacity];
+    uint32_t w2[kCapacity];
+
+    // Free-running counters; index with & kMask.
+    uint64_t head = 0;
+    uint64_t tail = 0;
+
+    // frame_done events: ring position and main_time at the call.
+    uint64_t mark_pos[kMaxMarks];
+    uint64_t mark_time[kMaxMarks];
+    uint32_t mark_head = 0;
+    uint32_t mark_tail = 0;
+
+    // Pixels and frame marks dropped because the ring was full. Either
+    // leaves the frame it belongs to incomplete; VoxelSim::finish_frame
+    // reports the count per frame (FrameStats::ring_overflows).
+    uint64_t overflows  = 0;
+    uint64_t lost_marks = 0;
+
+    size_t pending() const { return size_t(head - tail); }
+    bool   frame_pending() const { return mark_head != mark_tail; }
+
+    void clear() {
+        head = tail = 0;
+        mark_head = mark_tail = 0;
+    }
+};
+
+// The single ring the DPI imports write into.
+PixelRing& hydra_pixel_ring();
+
+// Convert n pixels to ARGB8888 (0xFF, then w1[31:8] as R,G,B).
+void pixel96_to_argb_batch(const uint32_t* w1, uint32_t* argb, size_t n);
@@ -71,20 +71,14 @@ static bool fbdev_init(PlatformContext& ctx, const PlatformConfig&) {
     return true;
 }
 
-static void fbdev_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h) {
+static void fbdev_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h,
+                          const FrameDamage& damage) {
     if (!ctx.user || !pixels) return;
     FbdevContext* fc = static_cast<FbdevContext*>(ctx.user);
     if (!fc->map || fc->stride <= 0) return;
 
-    const int copy_w = (w < fc->width) ? w : fc->width;
-    const int copy_h = (h < fc->height) ? h : fc->height;
-    const size_t src_pitch = static_cast<size_t>(w) * 4;
-
-    for (int y = 0; y < copy_h; ++y) {
-        const uint8_t* src_row = reinterpret_cast<const uint8_t*>(pixels) + static_cast<size_t>(y) * src_pitch;
-        uint8_t* dst_row = fc->map + static_cast<size_t>(y) * static_cast<size_t>(fc->stride);
-        std::memcpy(dst_row, src_row, static_cast<size_t>(copy_w) * 4);
-    }
+    copy_damage(pixels, w, h, fc->map, static_cast<size_t>(fc->stride),
+                fc->width, fc->height, damage);
 }
 
 BackendOps get_ops_fbdev() {
@@ -73,7 +73,10 @@ static bool gl_init(PlatformContext& ctx, const PlatformConfig& cfg) {
     return true;
 }
 
-static void gl_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h) {
+// The back buffer is undefined after a swap, so every present redraws the
+// whole frame and damage is not used.
+static void gl_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h,
+                       const FrameDamage&) {
     if (!ctx.user || !pixels || w <= 0 || h <= 0) return;
     GlContext* gc = static_cast<GlContext*>(ctx.user);
     SDL_GL_MakeCurrent(gc->window, gc->glctx);
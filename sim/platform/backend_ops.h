@@ -4,16 +4,23 @@
 // ============================================================================
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include "platform.h"
 
 struct BackendOps {
     bool (*init)(PlatformContext&, const PlatformConfig&) = nullptr;
-    void (*present)(PlatformContext&, const uint32_t*, int, int) = nullptr;
+    void (*present)(PlatformContext&, const uint32_t*, int, int, const FrameDamage&) = nullptr;
     void (*shutdown)(PlatformContext&) = nullptr;
 };
 
 BackendOps make_stub_ops();
+
+// Copy the damaged regions of a w x h frame into dst (dst_pitch bytes per
+// row), clipped to clip_w x clip_h. Copies every row when damage.full is set.
+void copy_damage(const uint32_t* src, int w, int h,
+                 uint8_t* dst, size_t dst_pitch, int clip_w, int clip_h,
+                 const FrameDamage& damage);
 BackendOps get_ops_sdl();
 BackendOps get_ops_gl();
 BackendOps get_ops_vulkan();
@@ -49,7 +49,8 @@ static bool ensure_texture(SdlContext& sc, int w, int h) {
     return true;
 }
 
-static void sdl_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h) {
+static void sdl_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h,
+                        const FrameDamage& damage) {
     if (!ctx.user || !pixels || w <= 0 || h <= 0)
         return;
 
@@ -57,21 +58,33 @@ static void sdl_present(PlatformContext& ctx, const uint32_t* pixels, int w, int
     if (!sc->renderer)
         return;
 
+    const SDL_Texture* old_tex = sc->texture;
     if (!ensure_texture(*sc, w, h))
         return;
-
-    void* tex_pixels = nullptr;
-    int pitch_bytes = 0;
-    if (SDL_LockTexture(sc->texture, nullptr, &tex_pixels, &pitch_bytes) == 0) {
-        const uint8_t* src = reinterpret_cast<const uint8_t*>(pixels);
-        uint8_t* dst = static_cast<uint8_t*>(tex_pixels);
-        const size_t src_pitch = static_cast<size_t>(w) * 4;
-        for (int y = 0; y < h; ++y) {
-            std::memcpy(dst + static_cast<size_t>(y) * pitch_bytes,
-                        src + static_cast<size_t>(y) * src_pitch,
-                        src_pitch);
+    const bool full = damage.full || sc->texture != old_tex;
+
+    if (full) {
+        void* tex_pixels = nullptr;
+        int pitch_bytes = 0;
+        if (SDL_LockTexture(sc->texture, nullptr, &tex_pixels, &pitch_bytes) == 0) {
+            const uint8_t* src = reinterpret_cast<const uint8_t*>(pixels);
+            uint8_t* dst = static_cast<uint8_t*>(tex_pixels);
+            const size_t src_pitch = static_cast<size_t>(w) * 4;
+            for (int y = 0; y < h; ++y) {
+                std::memcpy(dst + static_cast<size_t>(y) * pitch_bytes,
+                            src + static_cast<size_t>(y) * src_pitch,
+                            src_pitch);
+            }
+            SDL_UnlockTexture(sc->texture);
+        }
+    } else {
+        // Streaming textures keep their contents, so only changed rects move.
+        for (int i = 0; i < damage.count; ++i) {
+            const DamageRect& r = damage.rects[i];
+            SDL_Rect rect{ r.x, r.y, r.w, r.h };
+            SDL_UpdateTexture(sc->texture, &rect,
+                              pixels + static_cast<size_t>(r.y) * w + r.x, w * 4);
         }
-        SDL_UnlockTexture(sc->texture);
     }
 
     SDL_SetRenderDrawColor(sc->renderer, 0, 0, 0, 255);
@@ -42,8 +42,9 @@ bool init_backend(PlatformBackend backend, const PlatformConfig& cfg, PlatformCo
     return platform_init(backend, cfg, ctx);
 }
 
-void present_backend(PlatformBackend backend, PlatformContext& ctx, const uint32_t* pixels, int w, int h) {
-    platform_present(backend, ctx, pixels, w, h);
+void present_backend(PlatformBackend backend, PlatformContext& ctx, const uint32_t* pixels, int w, int h,
+                     const FrameDamage& damage) {
+    platform_present(backend, ctx, pixels, w, h, damage);
 }
 
 void shutdown_backend(PlatformBackend backend, PlatformContext& ctx) {
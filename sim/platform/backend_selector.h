@@ -8,5 +8,6 @@
 
 PlatformBackend select_default_backend();
 bool init_backend(PlatformBackend backend, const PlatformConfig& cfg, PlatformContext& ctx);
-void present_backend(PlatformBackend backend, PlatformContext& ctx, const uint32_t* pixels, int w, int h);
+void present_backend(PlatformBackend backend, PlatformContext& ctx, const uint32_t* pixels, int w, int h,
+                     const FrameDamage& damage = FrameDamage());
 void shutdown_backend(PlatformBackend backend, PlatformContext& ctx);
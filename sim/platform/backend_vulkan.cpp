@@ -32,6 +32,8 @@ struct VulkanContext {
     VkBuffer             staging_buf = VK_NULL_HANDLE;
     VkDeviceMemory       staging_mem = VK_NULL_HANDLE;
     VkDeviceSize         staging_size = 0;
+    int                  staging_w = 0;   // frame size the staging contents hold
+    int                  staging_h = 0;
 };
 
 static uint32_t find_mem_type(VkPhysicalDevice pdev, uint32_t type_bits, VkMemoryPropertyFlags flags) {
@@ -76,6 +78,8 @@ static void destroy_staging(VulkanContext& vc) {
         vc.staging_mem = VK_NULL_HANDLE;
     }
     vc.staging_size = 0;
+    vc.staging_w = 0;
+    vc.staging_h = 0;
 }
 
 static void vk_shutdown(PlatformContext& ctx) {
@@ -346,18 +350,29 @@ static bool vk_init(PlatformContext& ctx, const PlatformConfig& cfg) {
     return true;
 }
 
-static void record_and_submit(VulkanContext& vc, uint32_t image_index, const uint32_t* pixels, int w, int h) {
+static void record_and_submit(VulkanContext& vc, uint32_t image_index, const uint32_t* pixels, int w, int h,
+                              const FrameDamage& damage) {
     const VkDeviceSize copy_size = static_cast<VkDeviceSize>(w) * static_cast<VkDeviceSize>(h) * 4;
     if (!ensure_staging(vc, copy_size))
         return;
 
+    // The previous copy must be done reading staging before it is updated.
+    vkWaitForFences(vc.dev, 1, &vc.in_flight, VK_TRUE, UINT64_MAX);
+
+    // Staging keeps the last frame, so only damaged rects are rewritten; the
+    // swapchain image itself is always refilled from the whole buffer.
+    FrameDamage dmg = damage;
+    if (vc.staging_w != w || vc.staging_h != h)
+        dmg.full = true;
+
     void* data = nullptr;
     if (vkMapMemory(vc.dev, vc.staging_mem, 0, copy_size, 0, &data) != VK_SUCCESS)
         return;
-    std::memcpy(data, pixels, static_cast<size_t>(copy_size));
+    copy_damage(pixels, w, h, static_cast<uint8_t*>(data), static_cast<size_t>(w) * 4, w, h, dmg);
     vkUnmapMemory(vc.dev, vc.staging_mem);
+    vc.staging_w = w;
+    vc.staging_h = h;
 
-    vkWaitForFences(vc.dev, 1, &vc.in_flight, VK_TRUE, UINT64_MAX);
     vkResetFences(vc.dev, 1, &vc.in_flight);
 
     vkResetCommandBuffer(vc.cmd, 0);
@@ -419,10 +434,17 @@ static void record_and_submit(VulkanContext& vc, uint32_t image_index, const uin
     vkQueueSubmit(vc.queue, 1, &si, vc.in_flight);
 }
 
-static void vk_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h) {
+static void vk_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h,
+                       const FrameDamage& damage) {
     if (!ctx.user || !pixels || w <= 0 || h <= 0) return;
     VulkanContext* vc = static_cast<VulkanContext*>(ctx.user);
 
+    // Nothing changed and the swapchain still matches: the last presented
+    // image stays on screen.
+    if (!damage.full && damage.count == 0 && vc->swapchain != VK_NULL_HANDLE &&
+        vc->staging_w == w && vc->staging_h == h)
+        return;
+
     if (vc->swapchain == VK_NULL_HANDLE || vc->extent.width != static_cast<uint32_t>(w) || vc->extent.height != static_cast<uint32_t>(h)) {
         vkDeviceWaitIdle(vc->dev);
         create_swapchain(*vc, w, h);
@@ -438,7 +460,7 @@ static void vk_present(PlatformContext& ctx, const uint32_t* pixels, int w, int
     if (ar != VK_SUCCESS && ar != VK_SUBOPTIMAL_KHR)
         return;
 
-    record_and_submit(*vc, image_index, pixels, w, h);
+    record_and_submit(*vc, image_index, pixels, w, h, damage);
 
     VkPresentInfoKHR pi{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
     pi.waitSemaphoreCount = 1;
@@ -196,28 +196,38 @@ static bool wayland_init(PlatformContext& ctx, const PlatformConfig& cfg) {
     return true;
 }
 
-static void wayland_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h) {
+static void wayland_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h,
+                            const FrameDamage& damage) {
     if (!ctx.user || !pixels) return;
     WaylandContext* wc = static_cast<WaylandContext*>(ctx.user);
     if (!wc->display || !wc->surface || !wc->buffer || !wc->shm_data)
         return;
 
+    FrameDamage dmg = damage;
     if (w != wc->width || h != wc->height) {
         wl_buffer* new_buf = create_buffer(*wc, w, h);
         if (!new_buf)
             return;
         wc->buffer = new_buf;
+        dmg.full = true;
     }
 
-    const size_t src_pitch = static_cast<size_t>(w) * 4;
-    for (int y = 0; y < h; ++y) {
-        const uint8_t* src_row = reinterpret_cast<const uint8_t*>(pixels) + static_cast<size_t>(y) * src_pitch;
-        uint8_t* dst_row = static_cast<uint8_t*>(wc->shm_data) + static_cast<size_t>(y) * static_cast<size_t>(wc->stride);
-        std::memcpy(dst_row, src_row, src_pitch);
-    }
+    // Nothing changed: leave the committed buffer on screen.
+    if (!dmg.full && dmg.count == 0)
+        return;
+
+    copy_damage(pixels, w, h, static_cast<uint8_t*>(wc->shm_data),
+                static_cast<size_t>(wc->stride), w, h, dmg);
 
     wl_surface_attach(wc->surface, wc->buffer, 0, 0);
-    wl_surface_damage(wc->surface, 0, 0, w, h);
+    if (dmg.full) {
+        wl_surface_damage(wc->surface, 0, 0, w, h);
+    } else {
+        for (int i = 0; i < dmg.count; ++i) {
+            const DamageRect& r = dmg.rects[i];
+            wl_surface_damage(wc->surface, r.x, r.y, r.w, r.h);
+        }
+    }
     wl_surface_commit(wc->surface);
     wl_display_flush(wc->display);
 }
@@ -104,30 +104,38 @@ static bool x11_init(PlatformContext& ctx, const PlatformConfig& cfg) {
     return true;
 }
 
-static void x11_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h) {
+static void x11_present(PlatformContext& ctx, const uint32_t* pixels, int w, int h,
+                        const FrameDamage& damage) {
     if (!ctx.user || !pixels) return;
     X11Context* xc = static_cast<X11Context*>(ctx.user);
+    const XImage* old_image = xc->image;
     if (!ensure_image(*xc, w, h))
         return;
 
+    FrameDamage dmg = damage;
+    if (xc->image != old_image)
+        dmg.full = true;
+
     const size_t pitch = static_cast<size_t>(w) * 4;
-    for (int y = 0; y < h; ++y) {
-        std::memcpy(
-            xc->buffer + static_cast<size_t>(y) * pitch,
-            reinterpret_cast<const uint8_t*>(pixels) + static_cast<size_t>(y) * pitch,
-            pitch
-        );
+    copy_damage(pixels, w, h, xc->buffer, pitch, w, h, dmg);
+
+    // The server keeps the window contents, so only damaged rects are sent.
+    if (dmg.full) {
+        XPutImage(xc->display, xc->window, xc->gc, xc->image,
+                  0, 0, 0, 0,
+                  static_cast<unsigned int>(w),
+                  static_cast<unsigned int>(h));
+    } else {
+        if (dmg.count == 0)
+            return;
+        for (int i = 0; i < dmg.count; ++i) {
+            const DamageRect& r = dmg.rects[i];
+            XPutImage(xc->display, xc->window, xc->gc, xc->image,
+                      r.x, r.y, r.x, r.y,
+                      static_cast<unsigned int>(r.w),
+                      static_cast<unsigned int>(r.h));
+        }
     }
-
-    XPutImage(
-        xc->display,
-        xc->window,
-        xc->gc,
-        xc->image,
-        0, 0, 0, 0,
-        static_cast<unsigned int>(w),
-        static_cast<unsigned int>(h)
-    );
     XFlush(xc->display);
 }
 
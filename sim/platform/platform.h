@@ -29,14 +29,32 @@ struct PlatformContext {
     void* user = nullptr;
 };
 
+// Pixel rectangle that changed since the previously presented frame.
+struct DamageRect {
+    int x = 0;
+    int y = 0;
+    int w = 0;
+    int h = 0;
+};
+
+// What changed in the frame handed to present. With full set the rects are
+// ignored and the whole frame is uploaded; otherwise only the rects are (an
+// empty list means nothing changed).
+struct FrameDamage {
+    const DamageRect* rects = nullptr;
+    int               count = 0;
+    bool              full  = true;
+};
+
 // Returns true if the backend is deemed supported (stub always false except SDL).
 bool platform_backend_supported(PlatformBackend backend);
 
 // Initialize backend (stub: returns false for non-SDL).
 bool platform_init(PlatformBackend backend, const PlatformConfig& cfg, PlatformContext& ctx);
 
-// Present one frame (stub: no-op).
-void platform_present(PlatformBackend backend, PlatformContext& ctx, const uint32_t* pixels, int width, int height);
+// Present one frame (stub: no-op). Backends upload only the damaged regions.
+void platform_present(PlatformBackend backend, PlatformContext& ctx, const uint32_t* pixels, int width, int height,
+                      const FrameDamage& damage = FrameDamage());
 
 // Tear down backend (stub: no-op).
 void platform_shutdown(PlatformBackend backend, PlatformContext& ctx);
@@ -2,6 +2,9 @@
 
 #include "backend_ops.h"
 
+#include <algorithm>
+#include <cstring>
+
 static bool is_linux() {
 #if defined(__linux__)
     return true;
@@ -66,11 +69,40 @@ BackendOps make_stub_ops() {
         ctx.user = reinterpret_cast<void*>(0x1);
         return true;
     };
-    ops.present = [](PlatformContext&, const uint32_t*, int, int) {};
+    ops.present = [](PlatformContext&, const uint32_t*, int, int, const FrameDamage&) {};
     ops.shutdown= [](PlatformContext&) {};
     return ops;
 }
 
+static void copy_rect(const uint32_t* src, int w, uint8_t* dst, size_t dst_pitch,
+                      int x0, int y0, int x1, int y1) {
+    if (x1 <= x0 || y1 <= y0)
+        return;
+    const size_t bytes = static_cast<size_t>(x1 - x0) * 4;
+    for (int y = y0; y < y1; ++y) {
+        std::memcpy(dst + static_cast<size_t>(y) * dst_pitch + static_cast<size_t>(x0) * 4,
+                    src + static_cast<size_t>(y) * static_cast<size_t>(w) + x0,
+                    bytes);
+    }
+}
+
+void copy_damage(const uint32_t* src, int w, int h,
+                 uint8_t* dst, size_t dst_pitch, int clip_w, int clip_h,
+                 const FrameDamage& damage) {
+    const int max_x = std::min(w, clip_w);
+    const int max_y = std::min(h, clip_h);
+    if (damage.full) {
+        copy_rect(src, w, dst, dst_pitch, 0, 0, max_x, max_y);
+        return;
+    }
+    for (int i = 0; i < damage.count; ++i) {
+        const DamageRect& r = damage.rects[i];
+        copy_rect(src, w, dst, dst_pitch,
+                  std::max(r.x, 0), std::max(r.y, 0),
+                  std::min(r.x + r.w, max_x), std::min(r.y + r.h, max_y));
+    }
+}
+
 // Backend-specific ops (strong definitions can override these stubs in other files)
 static BackendOps get_ops(PlatformBackend backend) {
     switch (backend) {
@@ -93,11 +125,12 @@ bool platform_init(PlatformBackend backend, const PlatformConfig& cfg, PlatformC
     return ops.init ? ops.init(ctx, cfg) : false;
 }
 
-void platform_present(PlatformBackend backend, PlatformContext& ctx, const uint32_t* pixels, int w, int h) {
+void platform_present(PlatformBackend backend, PlatformContext& ctx, const uint32_t* pixels, int w, int h,
+                      const FrameDamage& damage) {
     if (!platform_backend_supported(backend))
         return;
     BackendOps ops = get_ops(backend);
-    if (ops.present) ops.present(ctx, pixels, w, h);
+    if (ops.present) ops.present(ctx, pixels, w, h, damage);
 }
 
 void platform_shutdown(PlatformBackend backend, PlatformContext& ctx) {
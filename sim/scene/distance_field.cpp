@@ -0,0 +1,133 @@
+// ============================================================================
+// distance_field.cpp
+// - Separable Chebyshev distance transform, capped at DF_MAX.
+// ============================================================================
+#include "distance_field.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+// Half-open voxel box [lo, hi) per axis.
+struct Box {
+    int lo[3];
+    int hi[3];
+    int dim(int a) const { return hi[a] - lo[a]; }
+    size_t size() const { return size_t(dim(0)) * size_t(dim(1)) * size_t(dim(2)); }
+    size_t index(int x, int y, int z) const {
+        return (size_t(x - lo[0]) * size_t(dim(1)) + size_t(y - lo[1])) * size_t(dim(2)) +
+               size_t(z - lo[2]);
+    }
+};
+
+Box around(uint32_t addr, int radius) {
+    const int c[3] = {int(addr >> 12) & 63, int(addr >> 6) & 63, int(addr) & 63};
+    Box b;
+    for (int a = 0; a < 3; ++a) {
+        b.lo[a] = std::max(0, c[a] - radius);
+        b.hi[a] = std::min(int(DF_GRID), c[a] + radius + 1);
+    }
+    return b;
+}
+
+uint32_t addr_of(int x, int y, int z) {
+    return uint32_t(x << 12) | uint32_t(y << 6) | uint32_t(z);
+}
+
+// One axis of the transform over a line of n values at stride:
+// out[i] = min over k of max(|i - k|, in[k]), capped at DF_MAX.
+void pass_line(const uint8_t* in, uint8_t* out, int n, size_t stride) {
+    const int r = int(DF_MAX);
+    for (int i = 0; i < n; ++i) {
+        unsigned best = DF_MAX;
+        const int k0 = std::max(0, i - r), k1 = std::min(n - 1, i + r);
+        for (int k = k0; k <= k1 && best; ++k) {
+            const unsigned d = unsigned(std::max(std::abs(i - k), int(in[size_t(k) * stride])));
+            best = std::min(best, d);
+        }
+        out[size_t(i) * stride] = uint8_t(best);
+    }
+}
+
+// Lines [first, last) of one pass; lines are numbered over the two other
+// axes of the box.
+void pass_lines(const Box& b, int axis, const uint8_t* in, uint8_t* out, int first, int last) {
+    const size_t stride[3] = {size_t(b.dim(1)) * size_t(b.dim(2)), size_t(b.dim(2)), 1};
+    const int    u = axis == 0 ? 1 : 0, v = axis == 2 ? 1 : 2;
+    for (int line = first; line < last; ++line) {
+        const size_t base = size_t(line / b.dim(v)) * stride[u] + size_t(line % b.dim(v)) * stride[v];
+        pass_line(in + base, out + base, b.dim(axis), stride[axis]);
+    }
+}
+
+template <typename F> void parallel_lines(int lines, int threads, F f) {
+    threads = std::max(1, std::min(threads, lines));
+    if (threads == 1) {
+        f(0, lines);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back(f, lines * t / threads, lines * (t + 1) / threads);
+    for (std::thread& th : pool)
+        th.join();
+}
+
+// Distances for every voxel of b, looking only at solids inside b.
+std::vector<uint8_t> transform(const uint64_t* words, const Box& b, int threads) {
+    std::vector<uint8_t> d(b.size()), tmp(b.size());
+    for (int x = b.lo[0]; x < b.hi[0]; ++x)
+        for (int y = b.lo[1]; y < b.hi[1]; ++y)
+            for (int z = b.lo[2]; z < b.hi[2]; ++z)
+                d[b.index(x, y, z)] = df_solid(words[addr_of(x, y, z)]) ? 0 : uint8_t(DF_MAX);
+    // z, then y, then x; the result ends up back in d.
+    for (int axis = 2; axis >= 0; --axis) {
+        const int lines = int(b.size()) / b.dim(axis);
+        parallel_lines(lines, threads, [&](int first, int last) {
+            pass_lines(b, axis, d.data(), tmp.data(), first, last);
+        });
+        d.swap(tmp);
+    }
+    return d;
+}
+
+bool pack(uint64_t& w, unsigned d) {
+    if (df_solid(w))
+        return false;
+    const uint64_t packed = (w & ~DF_MASK) | d;
+    const bool changed = packed != w;
+    w = packed;
+    return changed;
+}
+
+}  // namespace
+
+void distance_field_build(uint64_t* words, int threads) {
+    if (threads <= 0)
+        threads = int(std::max(1u, std::thread::hardware_concurrency()));
+    const Box all = {{0, 0, 0}, {int(DF_GRID), int(DF_GRID), int(DF_GRID)}};
+    const std::vector<uint8_t> d = transform(words, all, threads);
+    for (uint32_t a = 0; a < DF_GRID * DF_GRID * DF_GRID; ++a)
+        pack(words[a], d[a]);
+}
+
+size_t distance_field_update(uint64_t* words, uint32_t addr, std::vector<uint32_t>* changed) {
+    // A voxel's capped distance only depends on solids within DF_MAX of it.
+    const Box dst = around(addr, int(DF_MAX));
+    const Box src = around(addr, 2 * int(DF_MAX));
+    const std::vector<uint8_t> d = transform(words, src, 1);
+    size_t n = 0;
+    for (int x = dst.lo[0]; x < dst.hi[0]; ++x)
+        for (int y = dst.lo[1]; y < dst.hi[1]; ++y)
+            for (int z = dst.lo[2]; z < dst.hi[2]; ++z) {
+                const uint32_t a = addr_of(x, y, z);
+                if (pack(words[a], d[src.index(x, y, z)]) && a != addr) {
+                    ++n;
+                    if (changed)
+                        changed->push_back(a);
+                }
+            }
+    return n;
+}
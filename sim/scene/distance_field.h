@@ -0,0 +1,45 @@
+// ============================================================================
+// distance_field.h
+// - Host-side distance field for the core's sdf mode (FLAGS[9],
+//   render_config[6]) over a 64^3 volume in voxel_memory_64 order.
+// - Every non-solid word (zero, or alpha <= 10) gets its Chebyshev distance
+//   to the nearest solid voxel in the reserved nibble [3:0], saturating at
+//   15. Solid words are left alone. Distance d means every voxel within
+//   max(|dx|, |dy|, |dz|) < d is non-solid; voxels outside the grid count as
+//   non-solid.
+// - distance_field_build() computes the whole field, split across threads.
+//   distance_field_update() fixes it up after one voxel edit: only the
+//   31^3 box around the edit can change, and only the 61^3 box around it
+//   is looked at.
+// - The core trusts the field: a stale one makes rays jump over voxels.
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+static const unsigned DF_GRID     = 64;
+static const unsigned DF_MAX      = 15;           // saturated distance
+static const uint64_t DF_MASK     = 0xF;          // word bits [3:0]
+
+// The core's hit test: nonzero word with alpha > 10.
+inline bool df_solid(uint64_t w) {
+    return w != 0 && ((w >> 40) & 0xFF) > 10;
+}
+
+// Stored distance of a non-solid word (0 = unknown); 0 for solid words.
+inline unsigned df_distance(uint64_t w) {
+    return df_solid(w) ? 0 : unsigned(w & DF_MASK);
+}
+
+// Recompute the field over all DF_GRID^3 words. threads <= 0 uses one per
+// hardware thread.
+void distance_field_build(uint64_t* words, int threads = 0);
+
+// Recompute the field around words[addr] after it was written. Returns the
+// number of other words whose distance changed; their addresses are
+// appended to changed when given. words[addr] itself is repacked if it is
+// non-solid.
+size_t distance_field_update(uint64_t* words, uint32_t addr,
+                             std::vector<uint32_t>* changed = nullptr);
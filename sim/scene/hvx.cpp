@@ -0,0 +1,216 @@
+// ============================================================================
+// hvx.cpp
+// - .hvx load/store and memh conversion helpers.
+// ============================================================================
+#include "hvx.h"
+#include "voxel_layout.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HVX_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool fail(std::string* err, const std::string& msg) {
+    if (err) *err = msg;
+    return false;
+}
+
+static bool validate_header(const HvxHeader& h, uint64_t file_len, std::string* err) {
+    if (std::memcmp(h.magic, HVX_MAGIC, sizeof(h.magic)) != 0)
+        return fail(err, "not an .hvx file (bad magic)");
+    if (h.version != HVX_VERSION)
+        return fail(err, "unsupported .hvx version " + std::to_string(h.version));
+    if (h.header_size != sizeof(HvxHeader) || h.word_bits != 64 || h.layout > HVX_LAYOUT_BRICK)
+        return fail(err, "unsupported .hvx header/word size/layout");
+    if (uint64_t(h.dim_x) * h.dim_y * h.dim_z != h.voxel_count)
+        return fail(err, "voxel_count does not match grid dims");
+    if (h.layout != HVX_LAYOUT_XYZ && (h.dim_x != 64 || h.dim_y != 64 || h.dim_z != 64))
+        return fail(err, "morton/brick layouts need a 64x64x64 volume");
+    if (h.data_offset < sizeof(HvxHeader) || (h.data_offset & 7) != 0)
+        return fail(err, "bad data_offset");
+    if (h.data_offset + h.voxel_count * 8 > file_len)
+        return fail(err, "file is truncated");
+    return true;
+}
+
+HvxFile::~HvxFile() {
+    close();
+}
+
+void HvxFile::close() {
+#ifdef HVX_HAVE_MMAP
+    if (map_)
+        munmap(map_, map_len_);
+#endif
+    map_ = nullptr;
+    map_len_ = 0;
+    words_ = nullptr;
+    fallback_.clear();
+}
+
+bool HvxFile::open(const std::string& path, std::string* err) {
+    close();
+
+#ifdef HVX_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return fail(err, "cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(HvxHeader)) {
+        ::close(fd);
+        return fail(err, path + ": too small for an .hvx header");
+    }
+    map_len_ = size_t(st.st_size);
+    map_ = mmap(nullptr, map_len_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        return fail(err, "mmap failed for " + path);
+    }
+    std::memcpy(&hdr_, map_, sizeof(hdr_));
+    if (!validate_header(hdr_, map_len_, err)) {
+        close();
+        return false;
+    }
+    words_ = reinterpret_cast<const uint64_t*>(
+        static_cast<const uint8_t*>(map_) + hdr_.data_offset);
+    return true;
+#else
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return fail(err, "cannot open " + path);
+    std::fseek(f, 0, SEEK_END);
+    const long len = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (len < (long)sizeof(HvxHeader) || std::fread(&hdr_, sizeof(hdr_), 1, f) != 1) {
+        std::fclose(f);
+        return fail(err, path + ": too small for an .hvx header");
+    }
+    if (!validate_header(hdr_, uint64_t(len), err)) {
+        std::fclose(f);
+        return false;
+    }
+    fallback_.resize(size_t(hdr_.voxel_count));
+    std::fseek(f, long(hdr_.data_offset), SEEK_SET);
+    const size_t got = std::fread(fallback_.data(), 8, fallback_.size(), f);
+    std::fclose(f);
+    if (got != fallback_.size())
+        return fail(err, path + ": short read");
+    words_ = fallback_.data();
+    return true;
+#endif
+}
+
+bool hvx_write(const std::string& path, uint32_t dim_x, uint32_t dim_y, uint32_t dim_z,
+               const uint64_t* words, std::string* err, uint32_t layout) {
+    if (layout > HVX_LAYOUT_BRICK ||
+        (layout != HVX_LAYOUT_XYZ && (dim_x != 64 || dim_y != 64 || dim_z != 64)))
+        return fail(err, "bad layout for " + path);
+    HvxHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, HVX_MAGIC, sizeof(h.magic));
+    h.version     = HVX_VERSION;
+    h.header_size = sizeof(HvxHeader);
+    h.dim_x       = dim_x;
+    h.dim_y       = dim_y;
+    h.dim_z       = dim_z;
+    h.word_bits   = 64;
+    h.layout      = layout;
+    h.voxel_count = uint64_t(dim_x) * dim_y * dim_z;
+    h.data_offset = HVX_DATA_OFFSET;
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return fail(err, "cannot create " + path);
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+              std::fwrite(words, 8, size_t(h.voxel_count), f) == size_t(h.voxel_count);
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok)
+        return fail(err, "write failed for " + path);
+    return true;
+}
+
+void hvx_words_xyz(const HvxFile& f, std::vector<uint64_t>& out) {
+    out.resize(f.count());
+    if (f.header().layout == HVX_LAYOUT_XYZ)
+        std::memcpy(out.data(), f.words(), f.count() * sizeof(uint64_t));
+    else
+        voxel_layout_convert(VoxelLayout(f.header().layout), VoxelLayout::Xyz, f.words(),
+                             out.data());
+}
+
+bool memh_read(const std::string& path, size_t depth, std::vector<uint64_t>& out,
+               std::string* err) {
+    FILE* f = std::fopen(path.c_str(), "r");
+    if (!f)
+        return fail(err, "cannot open " + path);
+
+    out.assign(depth, 0);
+    size_t addr = 0;
+    std::string tok;
+    int c;
+    auto flush = [&]() -> bool {
+        if (tok.empty()) return true;
+        bool is_addr = tok[0] == '@';
+        const char* s = tok.c_str() + (is_addr ? 1 : 0);
+        char* end = nullptr;
+        unsigned long long v = std::strtoull(s, &end, 16);
+        if (*s == '\0' || *end != '\0') {
+            tok.clear();
+            return fail(err, path + ": bad token near word " + std::to_string(addr));
+        }
+        if (is_addr) {
+            addr = size_t(v);
+        } else {
+            if (addr >= depth) {
+                tok.clear();
+                return fail(err, path + ": address beyond depth");
+            }
+            out[addr++] = uint64_t(v);
+        }
+        tok.clear();
+        return true;
+    };
+
+    bool ok = true;
+    while (ok && (c = std::fgetc(f)) != EOF) {
+        if (c == '/') {
+            int n = std::fgetc(f);
+            if (n == '/') {
+                while ((c = std::fgetc(f)) != EOF && c != '\n') {}
+                ok = flush();
+                continue;
+            }
+            ok = fail(err, path + ": stray '/'");
+            break;
+        }
+        if (std::isspace(c)) {
+            ok = flush();
+        } else if (c != '_') {
+            tok.push_back(char(c));
+        }
+    }
+    if (ok) ok = flush();
+    std::fclose(f);
+    return ok;
+}
+
+bool memh_write(const std::string& path, const uint64_t* words, size_t count,
+                std::string* err) {
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f)
+        return fail(err, "cannot create " + path);
+    for (size_t i = 0; i < count; ++i)
+        std::fprintf(f, "%016llx\n", (unsigned long long)words[i]);
+    if (std::fclose(f) != 0)
+        return fail(err, "write failed for " + path);
+    return true;
+}
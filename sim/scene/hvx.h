@@ -0,0 +1,78 @@
+// ============================================================================
+// hvx.h
+// - .hvx binary voxel scene format (version 1) and memh helpers.
+// - Layout: 64-byte little-endian header, then dim_x*dim_y*dim_z 64-bit voxel
+//   words at data_offset, by default in logical address order
+//   ({x[5:0], y[5:0], z[5:0]} -> word index (x << 12) | (y << 6) | z).
+//   64^3 volumes may instead be stored in one of the other voxel_memory_64
+//   layouts (voxel_layout.h); the header's layout field says which.
+// - Files are mmapped on POSIX hosts so loading is a single memcpy into the
+//   Verilated vox array.
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+static const char     HVX_MAGIC[4]      = {'H', 'V', 'X', '\0'};
+static const uint16_t HVX_VERSION       = 1;
+static const uint32_t HVX_LAYOUT_XYZ    = 0;   // index = (x << 12) | (y << 6) | z
+static const uint32_t HVX_LAYOUT_MORTON = 1;   // VoxelLayout::Morton, 64^3 only
+static const uint32_t HVX_LAYOUT_BRICK  = 2;   // VoxelLayout::Brick, 64^3 only
+static const uint64_t HVX_DATA_OFFSET   = 64;
+
+struct HvxHeader {
+    char     magic[4];       // "HVX\0"
+    uint16_t version;        // HVX_VERSION
+    uint16_t header_size;    // sizeof(HvxHeader)
+    uint32_t dim_x;
+    uint32_t dim_y;
+    uint32_t dim_z;
+    uint32_t word_bits;      // 64
+    uint32_t layout;         // HVX_LAYOUT_*
+    uint32_t flags;          // reserved, 0
+    uint64_t voxel_count;    // dim_x * dim_y * dim_z
+    uint64_t data_offset;    // byte offset of the first voxel word
+    uint64_t reserved[2];
+};
+static_assert(sizeof(HvxHeader) == 64, "HvxHeader must stay 64 bytes");
+
+// Read-only view of an .hvx file (mmapped where available).
+class HvxFile {
+public:
+    HvxFile() = default;
+    ~HvxFile();
+
+    HvxFile(const HvxFile&) = delete;
+    HvxFile& operator=(const HvxFile&) = delete;
+
+    bool open(const std::string& path, std::string* err);
+    void close();
+
+    const HvxHeader& header() const { return hdr_; }
+    const uint64_t*  words() const { return words_; }
+    size_t           count() const { return size_t(hdr_.voxel_count); }
+
+private:
+    HvxHeader             hdr_{};
+    const uint64_t*       words_ = nullptr;
+    void*                 map_ = nullptr;
+    size_t                map_len_ = 0;
+    std::vector<uint64_t> fallback_;   // hosts without mmap
+};
+
+bool hvx_write(const std::string& path, uint32_t dim_x, uint32_t dim_y, uint32_t dim_z,
+               const uint64_t* words, std::string* err, uint32_t layout = HVX_LAYOUT_XYZ);
+
+// f's words in HVX_LAYOUT_XYZ order, reordered if the file uses another
+// layout.
+void hvx_words_xyz(const HvxFile& f, std::vector<uint64_t>& out);
+
+// $readmemh-style text: hex words separated by whitespace, optional
+// @address records and // comments. Unwritten words are zero.
+bool memh_read(const std::string& path, size_t depth, std::vector<uint64_t>& out,
+               std::string* err);
+bool memh_write(const std::string& path, const uint64_t* words, size_t count,
+                std::string* err);
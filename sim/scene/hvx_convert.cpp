@@ -0,0 +1,135 @@
+// ============================================================================
+// hvx_convert.cpp
+// - Convert voxel scenes between $readmemh text and .hvx binary.
+// - Generator output: run `sim_voxel --dump-scene world.hvx` (or convert a
+//   memh dump of voxel_memory_64) to capture voxel_world_gen's volume.
+// - --distance-field bakes the sdf-mode distance field into a 64^3 .hvx.
+// - --layout rewrites a 64^3 .hvx in another voxel_memory_64 word order
+//   (voxel_layout.h). hvx -> memh keeps the file's order, so the memh is an
+//   INIT_FILE for a build with that layout; memh -> hvx assumes xyz.
+// ============================================================================
+#include "distance_field.h"
+#include "hvx.h"
+#include "voxel_layout.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static const uint32_t GRID = 64;
+
+static bool ends_with(const std::string& s, const char* suffix) {
+    const std::string suf(suffix);
+    return s.size() >= suf.size() && s.compare(s.size() - suf.size(), suf.size(), suf) == 0;
+}
+
+static int usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s IN OUT     convert memh <-> hvx (direction from OUT suffix)\n"
+        "       %s --info FILE.hvx\n"
+        "       %s --distance-field IN.hvx OUT.hvx\n"
+        "       %s --layout xyz|morton|brick IN.hvx OUT.hvx\n",
+        argv0, argv0, argv0, argv0);
+    return 2;
+}
+
+static int info(const std::string& path) {
+    HvxFile f;
+    std::string err;
+    if (!f.open(path, &err)) {
+        std::fprintf(stderr, "Error: %s\n", err.c_str());
+        return 1;
+    }
+    const HvxHeader& h = f.header();
+    size_t nonzero = 0;
+    for (size_t i = 0; i < f.count(); ++i)
+        nonzero += f.words()[i] != 0;
+    std::printf("%s: hvx v%u %ux%ux%u, %s layout, %llu voxels, %zu non-empty\n",
+                path.c_str(), h.version, h.dim_x, h.dim_y, h.dim_z,
+                voxel_layout_name(VoxelLayout(h.layout)), (unsigned long long)h.voxel_count,
+                nonzero);
+    return 0;
+}
+
+static int distance_field(const std::string& in, const std::string& out) {
+    HvxFile f;
+    std::string err;
+    if (!f.open(in, &err)) {
+        std::fprintf(stderr, "Error: %s\n", err.c_str());
+        return 1;
+    }
+    const HvxHeader& h = f.header();
+    if (h.dim_x != GRID || h.dim_y != GRID || h.dim_z != GRID || f.count() != size_t(GRID) * GRID * GRID) {
+        std::fprintf(stderr, "Error: %s: distance field needs a %ux%ux%u volume\n", in.c_str(), GRID, GRID, GRID);
+        return 1;
+    }
+    std::vector<uint64_t> words;
+    hvx_words_xyz(f, words);
+    distance_field_build(words.data());
+    // Written back in the input's layout.
+    std::vector<uint64_t> stored(words.size());
+    voxel_layout_convert(VoxelLayout::Xyz, VoxelLayout(h.layout), words.data(), stored.data());
+    if (!hvx_write(out, GRID, GRID, GRID, stored.data(), &err, h.layout)) {
+        std::fprintf(stderr, "Error: %s\n", err.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+static int relayout(const std::string& name, const std::string& in, const std::string& out) {
+    VoxelLayout to;
+    if (!voxel_layout_parse(name, to)) {
+        std::fprintf(stderr, "Error: --layout wants xyz, morton or brick\n");
+        return 2;
+    }
+    HvxFile f;
+    std::string err;
+    if (!f.open(in, &err)) {
+        std::fprintf(stderr, "Error: %s\n", err.c_str());
+        return 1;
+    }
+    const HvxHeader& h = f.header();
+    if (h.dim_x != GRID || h.dim_y != GRID || h.dim_z != GRID) {
+        std::fprintf(stderr, "Error: %s: --layout needs a %ux%ux%u volume\n", in.c_str(), GRID, GRID, GRID);
+        return 1;
+    }
+    std::vector<uint64_t> words(f.count());
+    voxel_layout_convert(VoxelLayout(h.layout), to, f.words(), words.data());
+    if (!hvx_write(out, GRID, GRID, GRID, words.data(), &err, uint32_t(to))) {
+        std::fprintf(stderr, "Error: %s\n", err.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::string(argv[1]) == "--info")
+        return info(argv[2]);
+    if (argc == 4 && std::string(argv[1]) == "--distance-field")
+        return distance_field(argv[2], argv[3]);
+    if (argc == 5 && std::string(argv[1]) == "--layout")
+        return relayout(argv[2], argv[3], argv[4]);
+    if (argc != 3)
+        return usage(argv[0]);
+
+    const std::string in  = argv[1];
+    const std::string out = argv[2];
+    std::string err;
+
+    if (ends_with(out, ".hvx")) {
+        std::vector<uint64_t> words;
+        if (!memh_read(in, size_t(GRID) * GRID * GRID, words, &err) ||
+            !hvx_write(out, GRID, GRID, GRID, words.data(), &err)) {
+            std::fprintf(stderr, "Error: %s\n", err.c_str());
+            return 1;
+        }
+    } else {
+        HvxFile f;
+        if (!f.open(in, &err) || !memh_write(out, f.words(), f.count(), &err)) {
+            std::fprintf(stderr, "Error: %s\n", err.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+// ============================================================================
+// voxel_layout.h
+// - Physical word order of the 64^3 volume, mirroring rtl/voxel_addr_map.sv.
+//   Everything outside voxel_memory_64 (core, world_gen, debug writes,
+//   voxel_addr_from_xyz()) uses logical {x[5:0], y[5:0], z[5:0]} addresses;
+//   only the RAM index changes.
+//   * Xyz:    (x << 12) | (y << 6) | z, the original layout.
+//   * Morton: x, y, z bits interleaved, z lowest: bit 3i+2 = x[i],
+//             bit 3i+1 = y[i], bit 3i = z[i].
+//   * Brick:  8x8x8 bricks of 512 words, {x[5:3], y[5:3], z[5:3]} in the
+//             top nine bits (the voxel_occupancy brick number), then
+//             {x[2:0], y[2:0], z[2:0]}.
+// - The Verilated build picks one with VOXEL_LAYOUT=xyz|morton|brick in
+//   sim/Makefile, which defines HYDRA_VOXEL_LAYOUT for the RTL and the
+//   harness alike. Host tools convert between all three at run time.
+// ============================================================================
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+enum class VoxelLayout : uint32_t {
+    Xyz    = 0,
+    Morton = 1,
+    Brick  = 2,
+};
+
+#ifndef HYDRA_VOXEL_LAYOUT
+#define HYDRA_VOXEL_LAYOUT 0
+#endif
+
+// The layout of voxel_memory_64 in this build.
+static const VoxelLayout kVoxelLayout = VoxelLayout(HYDRA_VOXEL_LAYOUT);
+
+static const uint32_t kLayoutVoxels = 64u * 64u * 64u;
+
+// Spread the low 6 bits of v to bits 0, 3, 6, ... 15.
+inline uint32_t voxel_layout_spread3(uint32_t v) {
+    v &= 0x3F;
+    v = (v | (v << 8)) & 0x0000F00F;
+    v = (v | (v << 4)) & 0x000C30C3;
+    v = (v | (v << 2)) & 0x00249249;
+    return v;
+}
+
+// Inverse of voxel_layout_spread3.
+inline uint32_t voxel_layout_compact3(uint32_t v) {
+    v &= 0x00249249;
+    v = (v | (v >> 2)) & 0x000C30C3;
+    v = (v | (v >> 4)) & 0x0000F00F;
+    v = (v | (v >> 8)) & 0x0000003F;
+    return v;
+}
+
+// Logical {x,y,z} address -> RAM index.
+inline uint32_t voxel_layout_index(VoxelLayout l, uint32_t xyz) {
+    const uint32_t x = (xyz >> 12) & 63, y = (xyz >> 6) & 63, z = xyz & 63;
+    switch (l) {
+    case VoxelLayout::Morton:
+        return (voxel_layout_spread3(x) << 2) | (voxel_layout_spread3(y) << 1) |
+               voxel_layout_spread3(z);
+    case VoxelLayout::Brick:
+        return ((x >> 3) << 15) | ((y >> 3) << 12) | ((z >> 3) << 9) |
+               ((x & 7) << 6) | ((y & 7) << 3) | (z & 7);
+    default:
+        return xyz & (kLayoutVoxels - 1);
+    }
+}
+
+// RAM index -> logical {x,y,z} address.
+inline uint32_t voxel_layout_xyz(VoxelLayout l, uint32_t index) {
+    switch (l) {
+    case VoxelLayout::Morton:
+        return (voxel_layout_compact3(index >> 2) << 12) |
+               (voxel_layout_compact3(index >> 1) << 6) | voxel_layout_compact3(index);
+    case VoxelLayout::Brick: {
+        const uint32_t x = (((index >> 15) & 7) << 3) | ((index >> 6) & 7);
+        const uint32_t y = (((index >> 12) & 7) << 3) | ((index >> 3) & 7);
+        const uint32_t z = (((index >> 9) & 7) << 3) | (index & 7);
+        return (x << 12) | (y << 6) | z;
+    }
+    default:
+        return index & (kLayoutVoxels - 1);
+    }
+}
+
+// Reorder a full 64^3 volume; in and out must not overlap.
+inline void voxel_layout_convert(VoxelLayout from, VoxelLayout to, const uint64_t* in,
+                                 uint64_t* out) {
+    if (from == to) {
+        std::memcpy(out, in, sizeof(uint64_t) * kLayoutVoxels);
+        return;
+    }
+    for (uint32_t i = 0; i < kLayoutVoxels; ++i)
+        out[voxel_layout_index(to, voxel_layout_xyz(from, i))] = in[i];
+}
+
+inline const char* voxel_layout_name(VoxelLayout l) {
+    switch (l) {
+    case VoxelLayout::Morton: return "morton";
+    case VoxelLayout::Brick:  return "brick";
+    default:                  return "xyz";
+    }
+}
+
+inline bool voxel_layout_parse(const std::string& name, VoxelLayout& out) {
+    for (VoxelLayout l : {VoxelLayout::Xyz, VoxelLayout::Morton, VoxelLayout::Brick}) {
+        if (name == voxel_layout_name(l)) {
+            out = l;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,215 @@
+// ============================================================================
+// sim_thread.cpp
+// - Simulation thread loop: drain commands, step the model, publish frames.
+// ============================================================================
+#include "sim_thread.h"
+
+#include <chrono>
+#include <cstdio>
+
+SimThread::SimThread(int width, int height)
+    : width_(width), height_(height) {
+    const size_t npix = size_t(width) * size_t(height);
+    for (int i = 0; i < 3; ++i)
+        frames_.slot(i).pixels.assign(npix, 0);
+}
+
+SimThread::~SimThread() {
+    stop();
+}
+
+void SimThread::start(const CameraPose& cam, const RenderFlags& flags,
+                      const SelectionState& sel, const SimThreadConfig& cfg) {
+    thread_ = std::thread(&SimThread::run, this, cam, flags, sel, cfg);
+}
+
+void SimThread::stop() {
+    if (!thread_.joinable())
+        return;
+    SimCommand quit;
+    quit.kind = SimCommand::Quit;
+    send(quit);
+    thread_.join();
+}
+
+void SimThread::send(const SimCommand& cmd) {
+    while (!commands_.push(cmd)) {
+        if (finished())
+            return;
+        std::this_thread::yield();
+    }
+}
+
+void SimThread::set_camera(const CameraPose& cam) {
+    SimCommand c;
+    c.kind = SimCommand::Camera;
+    c.cam  = cam;
+    send(c);
+}
+
+void SimThread::set_flags(const RenderFlags& flags) {
+    SimCommand c;
+    c.kind  = SimCommand::Flags;
+    c.flags = flags;
+    send(c);
+}
+
+void SimThread::set_selection(const SelectionState& sel) {
+    SimCommand c;
+    c.kind = SimCommand::Selection;
+    c.sel  = sel;
+    send(c);
+}
+
+void SimThread::write_voxel(uint32_t addr, uint64_t data) {
+    SimCommand c;
+    c.kind = SimCommand::WriteVoxel;
+    c.addr = addr;
+    c.data = data;
+    send(c);
+}
+
+void SimThread::publish(const VoxelSim& sim, const CameraPose& cam) {
+    SimFrame& slot = frames_.back();
+    slot.pixels = sim.framebuffer();
+    slot.stats  = sim.last_frame();
+    slot.cursor = sim.cursor();
+    slot.cam    = cam;
+    slot.damage = sim.damage();
+    frames_.publish();
+    frame_log_.push_back(sim.last_frame());
+}
+
+void SimThread::run(CameraPose cam, RenderFlags flags, SelectionState sel,
+                    SimThreadConfig cfg) {
+    // The model is created on this thread and never touched by the UI.
+    VoxelSim sim(width_, height_);
+    if (!cfg.pin_cpus.empty())
+        sim.pin_threads(cfg.pin_cpus);
+    sim.set_log_frames(cfg.log_frames);
+    // Without a snapshot or scene, world generation runs inside the normal
+    // stepping loop; with either it is a file load up front. Scene dumps and
+    // camera paths also need the world finished before the first frame.
+    sim.set_scene(cfg.scene);
+    const bool path_mode = !cfg.replay.empty() || !cfg.record_path.empty();
+    if (!cfg.snapshot.empty() || !cfg.scene.empty() || !cfg.dump_scene.empty() || path_mode)
+        sim.boot(cfg.snapshot);
+    else
+        sim.reset();
+    if (!cfg.dump_scene.empty())
+        sim.dump_scene(cfg.dump_scene);
+
+    if (!cfg.replay.empty()) {
+        run_replay(sim, cfg.replay);
+        finished_.store(true, std::memory_order_release);
+        return;
+    }
+
+    sim.apply_camera(cam);
+    sim.apply_flags(flags);
+    sim.apply_selection(sel);
+    sim.set_render_on_demand(cfg.render_on_demand);
+
+    CameraPathWriter recorder;
+    PathFrame pending;   // state for the next boundary + edits since the last
+    if (!cfg.record_path.empty()) {
+        std::string err;
+        if (!recorder.open(cfg.record_path, width_, height_, &err))
+            std::fprintf(stderr, "Warning: %s, not recording\n", err.c_str());
+        pending.cam   = cam;
+        pending.flags = flags;
+        pending.sel   = sel;
+        recorder.append(pending);
+    }
+
+    auto frame_finished = [&]() {
+        publish(sim, pending.cam);
+        if (recorder.is_open()) {
+            recorder.append(pending);
+            pending.edits.clear();
+        }
+    };
+
+    const int cycles_per_chunk = 2000;
+    const auto idle_poll = std::chrono::milliseconds(1);
+    // Display refresh the harness stands in for: one frame_tick per period.
+    const auto refresh = std::chrono::microseconds(16667);
+    auto next_refresh = std::chrono::steady_clock::now() + refresh;
+    bool running = true;
+
+    while (running && !sim.got_finish()) {
+        SimCommand cmd;
+        while (commands_.pop(cmd)) {
+            switch (cmd.kind) {
+                case SimCommand::Camera:
+                    sim.apply_camera(cmd.cam);
+                    pending.cam = cmd.cam;
+                    break;
+                case SimCommand::Flags:
+                    sim.apply_flags(cmd.flags);
+                    pending.flags = cmd.flags;
+                    break;
+                case SimCommand::Selection:
+                    sim.apply_selection(cmd.sel);
+                    pending.sel = cmd.sel;
+                    break;
+                case SimCommand::WriteVoxel:
+                    // The debug write port takes one write per clock; clock it
+                    // in before the next command can overwrite it.
+                    sim.write_voxel(cmd.addr, cmd.data);
+                    pending.edits.push_back(VoxelEdit{cmd.addr, cmd.data});
+                    if (sim.step(1))
+                        frame_finished();
+                    break;
+                case SimCommand::Quit:
+                    running = false;
+                    break;
+            }
+        }
+        if (!running)
+            break;
+
+        // Nothing owed: wait for the next command instead of clocking the
+        // model through an identical frame.
+        // Refreshes that pass while a frame renders are not skipped, so
+        // the tick is only clocked in here.
+        if (sim.idle()) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= next_refresh) {
+                sim.frame_tick();
+                skipped_frames_.store(sim.skipped_frames(), std::memory_order_relaxed);
+                while (next_refresh <= now)
+                    next_refresh += refresh;
+            }
+            std::this_thread::sleep_for(idle_poll);
+            continue;
+        }
+
+        if (sim.step(cycles_per_chunk))
+            frame_finished();
+    }
+
+    recorder.close();
+    finished_.store(true, std::memory_order_release);
+}
+
+void SimThread::run_replay(VoxelSim& sim, const std::vector<PathFrame>& path) {
+    // Frame-locked: apply record k at the boundary, then run to frame_done.
+    // UI commands other than Quit are ignored.
+    const int cycles_per_chunk = 2000;
+    for (const PathFrame& fr : path) {
+        camera_path_apply(sim, fr);
+        bool done = false;
+        while (!done && !sim.got_finish()) {
+            SimCommand cmd;
+            while (commands_.pop(cmd)) {
+                if (cmd.kind == SimCommand::Quit)
+                    return;
+            }
+            done = sim.step(cycles_per_chunk);
+        }
+        if (!done)
+            return;
+        publish(sim, fr.cam);
+    }
+}
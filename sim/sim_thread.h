@@ -0,0 +1,165 @@
+// ============================================================================
+// sim_thread.h
+// - Runs VoxelSim on a dedicated thread so vsync/HUD cost does not throttle
+//   the RTL model.
+// - Finished frames go to the UI through a lock-free triple buffer.
+// - Camera/flag/selection/voxel edits come back through an SPSC queue.
+// ============================================================================
+#pragma once
+
+#include "voxel_sim.h"
+#include "camera_path.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Single-producer/single-consumer ring. Capacity must be a power of two; one
+// slot is kept free to tell full from empty.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+public:
+    bool push(const T& v) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t next = (head + 1) & (Capacity - 1);
+        if (next == tail_.load(std::memory_order_acquire))
+            return false;
+        buf_[head] = v;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire))
+            return false;
+        out = buf_[tail];
+        tail_.store((tail + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    T buf_[Capacity];
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+// Lock-free triple buffer. The producer always has a private back slot, the
+// consumer a private front slot; the middle slot is swapped atomically. The
+// producer never waits, the consumer only ever sees the newest frame.
+template <typename T>
+class TripleBuffer {
+public:
+    T& back() { return slots_[back_]; }
+
+    // Publish back() and take the old middle slot as the new back slot.
+    void publish() {
+        back_ = middle_.exchange(back_ | kDirty, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Swap in the newest published slot if there is one. Returns false when
+    // nothing new arrived since the last call; front() is unchanged then.
+    bool consume() {
+        if (!(middle_.load(std::memory_order_relaxed) & kDirty))
+            return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    const T& front() const { return slots_[front_]; }
+    T& slot(int i) { return slots_[i]; }
+
+private:
+    static constexpr unsigned kDirty     = 0x4;
+    static constexpr unsigned kIndexMask = 0x3;
+
+    T slots_[3];
+    unsigned back_  = 0;
+    unsigned front_ = 1;
+    alignas(64) std::atomic<unsigned> middle_{2};
+};
+
+struct SimCommand {
+    enum Kind : uint8_t { Camera, Flags, Selection, WriteVoxel, Quit };
+
+    Kind           kind = Quit;
+    CameraPose     cam;
+    RenderFlags    flags;
+    SelectionState sel;
+    uint32_t       addr = 0;
+    uint64_t       data = 0;
+};
+
+struct SimThreadConfig {
+    bool             log_frames = false;
+    std::vector<int> pin_cpus;        // empty = leave threads floating
+    std::string      snapshot;        // see VoxelSim::boot()
+    std::string      scene;           // .hvx preload, skips world_gen
+    std::string      dump_scene;      // write the volume as .hvx once ready
+    std::string      record_path;     // .hcp camera path to record
+    std::vector<PathFrame> replay;    // frame-locked replay instead of input
+    bool             render_on_demand = false;  // FLAGS[4]; ignored in replay
+};
+
+struct SimFrame {
+    std::vector<uint32_t> pixels;
+    FrameStats            stats;
+    CursorInfo            cursor;
+    CameraPose            cam;        // camera the frame was rendered with
+    std::vector<DamageRect> damage;   // changed vs. frame stats.index - 1
+};
+
+class SimThread {
+public:
+    SimThread(int width, int height);
+    ~SimThread();
+
+    SimThread(const SimThread&) = delete;
+    SimThread& operator=(const SimThread&) = delete;
+
+    // Start stepping with the given initial state.
+    void start(const CameraPose& cam, const RenderFlags& flags,
+               const SelectionState& sel, const SimThreadConfig& cfg);
+    // Send Quit and join. Safe to call more than once.
+    void stop();
+
+    // UI side. Commands are retried with a yield when the queue is full so
+    // voxel writes are never dropped.
+    void send(const SimCommand& cmd);
+    void set_camera(const CameraPose& cam);
+    void set_flags(const RenderFlags& flags);
+    void set_selection(const SelectionState& sel);
+    void write_voxel(uint32_t addr, uint64_t data);
+
+    // Returns true and swaps front() when the sim published a newer frame.
+    bool poll_frame() { return frames_.consume(); }
+    const SimFrame& frame() const { return frames_.front(); }
+
+    bool finished() const { return finished_.load(std::memory_order_acquire); }
+
+    // Render-on-demand: the RTL's SKIPPED_FRAMES, i.e. 60 Hz frame_tick
+    // pulses that found an unchanged scene, as of the last pulse.
+    uint64_t skipped_frames() const { return skipped_frames_.load(std::memory_order_relaxed); }
+
+    // Stats of every frame the sim finished. Only read after stop().
+    const std::vector<FrameStats>& frame_log() const { return frame_log_; }
+
+private:
+    void run(CameraPose cam, RenderFlags flags, SelectionState sel,
+             SimThreadConfig cfg);
+    void run_replay(VoxelSim& sim, const std::vector<PathFrame>& path);
+    void publish(const VoxelSim& sim, const CameraPose& cam);
+
+    int width_;
+    int height_;
+    std::thread thread_;
+    SpscQueue<SimCommand, 256> commands_;
+    TripleBuffer<SimFrame> frames_;
+    std::atomic<bool> finished_{false};
+    std::atomic<uint64_t> skipped_frames_{0};
+    std::vector<FrameStats> frame_log_;
+};
@@ -59,6 +59,7 @@ async def smoke_irq_and_crc(dut):
     dut.s_axil_bready.value = 0
     dut.s_axil_arvalid.value = 0
     dut.s_axil_rready.value = 0
+    dut.frame_tick.value = 0
 
     # Reset
     dut.rst_n.value = 0
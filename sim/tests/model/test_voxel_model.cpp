@@ -0,0 +1,1703 @@
+// ============================================================================
+// test_voxel_model.cpp
+// - Checks VoxelModel against a literal clock-by-clock transcription of the
+//   voxel_raycaster_core_pipelined FSM and voxel_memory_64 read ports (trace
+//   byte per step, payload word per hit).
+// - Runs the scalar path, every packet width the CPU supports and the tiled
+//   multi-threaded renderer side by side, each against the same reference
+//   frames.
+// - Covers the world_gen scene, diag-slice, DDA, perspective, ray-memo and
+//   empty-space skipping modes, distance-field jumps, the pipelined DDA
+//   (S_PIPE, transcribed slot by slot), lanes (one transcribed core per
+//   lane, on its own rows), tile order (S_NEXT_TILE, and the pipeline's
+//   tile walk), composite mode (S_BLEND and early ray termination),
+//   selection, smooth surfaces off, voxel edits between frames, and
+//   frame-to-frame carry-over.
+// - Checks the distance field against brute force, and incremental updates
+//   against a rebuild.
+// - Checks the voxel_memory_64 layouts are permutations that round-trip a
+//   volume, with the bit assignment of rtl/voxel_addr_map.sv.
+// ============================================================================
+#include "model/tile_renderer.h"
+#include "model/voxel_model.h"
+#include "scene/distance_field.h"
+#include "scene/voxel_layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                              \
+    do {                                                              \
+        if (!(cond)) {                                                \
+            std::fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            std::fprintf(stderr, __VA_ARGS__);                        \
+            std::fprintf(stderr, "\n");                               \
+            ++failures;                                               \
+        }                                                             \
+    } while (0)
+
+// One register per RTL reg, updated state by state. Deliberately naive: no
+// column cache, no shortcuts.
+struct FsmCore {
+    enum State { IDLE, RENDER_PIXEL, STEP, FETCH, SHADE, WRITE, NEXT_PIXEL,
+                 RAY_DIV, RAY_CLIP, RAY_ENTER, RAY_TMAX, NEXT_TILE, BLEND };
+    static const uint32_t T_INF = 0xFFFFFF;
+    static const int      GRID_END = 64 << 8;
+
+    int W, H;
+    const std::vector<uint64_t>* vox = nullptr;
+    ModelConfig cfg;
+    // LANE / NUM_LANES: this core renders rows lane, lane + lanes, ...
+    int lane = 0, lanes = 1;
+    int last_row() const { return H - 1 - (H - 1 - lane) % lanes; }
+
+    // Tile order: LANE_ROWS, TILES_X/Y, TILE_BITS as the core derives them.
+    int tile_order() const { return cfg.tile_order & 3; }
+    int lane_rows() const { return (last_row() - lane) / lanes + 1; }
+    int tiles_x() const { return (W + 7) / 8; }
+    int tiles_y() const { return (lane_rows() + 7) / 8; }
+    int tile_bits() const {
+        const int span = std::max(tiles_x(), tiles_y());
+        int b = 0;
+        while ((1 << b) < span)
+            ++b;
+        return span > 1 ? b : 1;
+    }
+    // tile_cell: {ty, tx} of cell d.
+    void tile_cell(uint32_t d, int& tx, int& ty) const {
+        const int bits = tile_bits();
+        const uint32_t m = (1u << bits) - 1;
+        uint32_t x = 0, y = 0;
+        if (tile_order() == 2) {
+            for (int b = 0; b < bits; ++b) {
+                x |= ((d >> (2 * b)) & 1) << b;
+                y |= ((d >> (2 * b + 1)) & 1) << b;
+            }
+        } else if (tile_order() == 3) {
+            uint32_t t = d;
+            for (int b = 0; b < bits; ++b) {
+                const uint32_t mask = (1u << b) - 1;
+                const uint32_t rx = (t >> 1) & 1, ry = (t ^ (t >> 1)) & 1;
+                if (!ry) {
+                    if (rx) { x = (mask - x) & m; y = (mask - y) & m; }
+                    std::swap(x, y);
+                }
+                x = (x & ~(1u << b)) | (rx << b);
+                y = (y & ~(1u << b)) | (ry << b);
+                t >>= 2;
+            }
+        } else {
+            x = d & m;
+            y = (d >> bits) & m;
+        }
+        tx = int(x);
+        ty = int(y);
+    }
+    bool tile_on_screen(int tx, int ty) const { return tx < tiles_x() && ty < tiles_y(); }
+    int  tile_top(int ty) const { return lane + 8 * ty * lanes; }
+    int  tile_right(int tx) const { return std::min(8 * tx + 7, W - 1); }
+    int  tile_bottom(int ty) const { return std::min(tile_top(ty) + 7 * lanes, last_row()); }
+
+    // voxel_memory_64 read side: trace byte {solid, translucent, 2'b0, dist}
+    // per step, payload word per hit and per blended voxel
+    uint8_t  read_data = 0;
+    uint64_t payload_data = 0;
+    uint32_t trace_addr = 0;
+    bool     payload_en = false;
+    bool     cursor_fetch = false;
+
+    // core registers
+    int      pixel_x = 0, pixel_y = 0;
+    bool     cursor_sample = false;
+    int      voxel_x = 0, voxel_y = 0, voxel_z = 0;
+    unsigned ray_steps = 0;
+    bool     hit = false;
+    int      ray_pos_x = 0;
+    int      map_y = 0, map_z = 0;
+    int      slice_idx = 0;
+    bool     best_hit = false;
+    int      dda_x = 0, dda_y = 0, dda_z = 0;
+    bool     dda_neg[3] = {false, false, false};
+    uint32_t dda_tmax[3] = {0, 0, 0}, dda_tdelta[3] = {0, 0, 0};
+    bool     dda_pending = false, dda_out = false;
+    int32_t  ray_row[3] = {}, ray_dir[3] = {}, ray_dx[3] = {}, ray_du[3] = {};
+    int32_t  ray_base[3] = {};
+    uint32_t tile_d = 0;
+    int      tile_x0 = 0, tile_x1 = 0, tile_y1 = 0;
+    int      org[3] = {}, ray_d[3] = {};
+    uint32_t div_mag[3] = {}, div_rem[3] = {}, div_q[3] = {};
+    int      div_cnt = 0;
+    bool     div_run = false, div_next = false, div_loaded = false;
+    uint32_t clip_t_enter = 0;
+    unsigned comp_t = 256, acc_r = 0, acc_g = 0, acc_b = 0;
+    ModelPixel memo_words[64];
+    uint64_t memo_valid = 0;
+    int      memo_row = 0;
+    unsigned nx = 0, ny = 0, nz = 0, curv = 0;
+    ModelCursor cursor;
+    uint32_t hits = 0;
+    uint32_t skips = 0;
+    uint32_t ets = 0;
+    uint64_t blends = 0;   // payload fetches for voxels that did not end a ray
+    uint64_t cycles = 0;
+    uint64_t reads = 0;
+    uint64_t payload_reads = 0;
+    uint64_t end_reads = 0, end_fetches = 0;   // S_PIPE_END's re-reads
+    std::vector<ModelPixel> out;
+
+    // voxel_occupancy, rebuilt from the volume each frame (edits only happen
+    // between frames).
+    bool brick_occ[512] = {};
+
+    FsmCore(int w, int h) : W(w), H(h), out(size_t(w) * size_t(h)) {}
+
+    static unsigned sat(unsigned v) { v &= 0x1FF; return v > 255 ? 255 : v; }
+    static bool solid(uint64_t d) { return d != 0 && ((d >> 40) & 0xFF) > 10; }
+    static uint8_t trace_byte(uint64_t d) {
+        const unsigned type = (d >> 4) & 0xF;
+        const bool glass = solid(d) && (type == 2 || type == 5);
+        return uint8_t((solid(d) ? 0x80 : 0) | (glass ? 0x40 : 0) | (d & 0xF));
+    }
+    bool comp_mode() const { return cfg.composite && (cfg.dda || cfg.perspective) && !cfg.diag_slice; }
+    // The surface seen through what S_BLEND accumulated.
+    ModelPixel over(ModelPixel p) const {
+        if (!comp_mode())
+            return p;
+        const unsigned r = (acc_r + ((comp_t * ((p.w1 >> 24) & 0xFF)) >> 8)) & 0xFF;
+        const unsigned g = (acc_g + ((comp_t * ((p.w1 >> 16) & 0xFF)) >> 8)) & 0xFF;
+        const unsigned b = (acc_b + ((comp_t * ((p.w1 >> 8) & 0xFF)) >> 8)) & 0xFF;
+        p.w1 = (r << 24) | (g << 16) | (b << 8) | (p.w1 & 0xFF);
+        return p;
+    }
+
+    ModelPixel sky() {
+        ModelPixel p;
+        const unsigned r = (10 + ((pixel_y & 0xFF) >> 3)) & 0xFF;
+        const unsigned g = (40 + ((pixel_y & 0xFF) >> 3)) & 0xFF;
+        const unsigned b = (90 + ((pixel_y & 0xFF) >> 2)) & 0xFF;
+        p.w0 = 0x0000FF00u;
+        p.w1 = (r << 24) | (g << 16) | (b << 8) | 0xFF;
+        p.w2 = 0x00007F00u;
+        nx = 0; ny = 0; nz = 127; curv = 0;
+        return p;
+    }
+
+    ModelPixel compute(uint64_t w, int vx, int vy, int vz, unsigned steps) {
+        const unsigned props = (w >> 56) & 0xFF, em = (w >> 48) & 0xFF;
+        const unsigned light = (w >> 32) & 0xFF, type = (w >> 4) & 0xF;
+        const unsigned cr = (w >> 24) & 0xFF, cg = (w >> 16) & 0xFF, cb = (w >> 8) & 0xFF;
+        unsigned r = ((cr * light) & 0xFF) >> 8;
+        unsigned g = ((cg * light) & 0xFF) >> 8;
+        unsigned b = ((cb * light) & 0xFF) >> 8;
+        if (r == 0 && g == 0 && b == 0) { r = cr; g = cg; b = cb; }
+        if (em) {
+            r = sat(r + (((em * r) & 0x1FF) >> 8));
+            g = sat(g + (((em * g) & 0x1FF) >> 8));
+            b = sat(b + (((em * b) & 0x1FF) >> 8));
+        }
+        const unsigned refl = type == 3 ? 255 : type == 5 ? 200 : (((props >> 5) << 5) & 0xFF);
+        const unsigned refr = type == 5 ? 128 : type == 2 ? 85 : 0;
+        const unsigned emis = type == 1 ? em : 0;
+        unsigned onx = nx, ony = ny, onz = nz, oc = curv;
+        if (!cfg.smooth_surfaces) { onx = 0; ony = 0; onz = 127; oc = 0; }
+        if (cfg.extra_light && oc > 32) { r = sat(r + (oc >> 4)); b = sat(b + (oc >> 4)); }
+        if (vy >= 8 && vy <= 16) {
+            const int dx = vx - 32, dz = vz - 32;
+            const bool sh = dx * dx + dz * dz <= 324;
+            const unsigned sc = sh ? 80 : 206;
+            r = ((r * sc) >> 8) & 0xFF; g = ((g * sc) >> 8) & 0xFF; b = ((b * sc) >> 8) & 0xFF;
+            if (!sh) { r = sat(r + 20); g = sat(g + 12); b = sat(b + 4); }
+        }
+        if (cfg.sel_active && vx == cfg.sel_x && vy == cfg.sel_y && vz == cfg.sel_z) {
+            r = sat(r + 96); g = sat(g + 16); b = sat(b + 96);
+        }
+        nx = onx; ny = ony; nz = onz; curv = oc;
+        ModelPixel p;
+        p.w0 = (refl << 24) | (refr << 16) | ((steps & 0xFF) << 8) | emis;
+        p.w1 = (r << 24) | (g << 16) | (b << 8) | (type << 4);
+        p.w2 = (onx << 24) | (ony << 16) | (onz << 8) | oc;
+        return p;
+    }
+
+    // The payload read issues now and lands at the edge. The march and
+    // diag-slice cursor take the type still on the payload port; DDA sets
+    // it in SHADE.
+    void latch_hit(bool own_type, bool fetch = true) {
+        ++hits;
+        payload_en = fetch;
+        if (cursor_sample && !cursor.hit_valid) {
+            cursor.hit_valid   = true;
+            cursor.x           = uint8_t(voxel_x);
+            cursor.y           = uint8_t(voxel_y);
+            cursor.z           = uint8_t(voxel_z);
+            if (!own_type)
+                cursor.material_id = uint8_t(((payload_data >> 4) & 0xF) << 4);
+            cursor_fetch = true;
+        }
+    }
+
+    // dda_tdelta / dda_tmax0
+    static uint32_t tdelta(int dir) {
+        const uint32_t mag = uint32_t(dir < 0 ? -dir : dir) & 0xFFFF;
+        if (mag == 0)
+            return T_INF;
+        const uint32_t q = 0x10000u / mag;
+        return q > 0xFFFF ? 0xFFFF : q;
+    }
+    static uint32_t tmax0(int dir, uint32_t frac, uint32_t td) {
+        if (td == T_INF)
+            return T_INF;
+        const uint32_t dist = dir < 0 ? frac : 256 - frac;
+        return ((td * dist) >> 8) & T_INF;
+    }
+
+    // t_after / brick_steps
+    static uint32_t t_after(uint32_t tmax, uint32_t td, unsigned n) {
+        return t_sat(uint64_t(tmax) + uint64_t(n) * td);
+    }
+    static unsigned brick_steps(uint32_t tmax, uint32_t td, uint32_t t_exit, bool tie_first) {
+        unsigned n = 0;
+        for (unsigned c = 0; c < 8; ++c) {
+            const uint32_t t = t_after(tmax, td, c);
+            if (t < t_exit || (tie_first && t == t_exit))
+                ++n;
+        }
+        return n;
+    }
+
+    static int32_t reg32(int64_t v) { return int32_t(uint32_t(uint64_t(v))); }
+    static uint32_t t_sat(uint64_t v) { return v >= T_INF ? T_INF : uint32_t(v); }
+    static uint32_t t_add(uint32_t a, uint32_t b) {
+        const uint32_t sum = a + b;
+        return (sum >> 24) ? T_INF : sum;
+    }
+
+    // recip_step: two bits of the restoring division 2^24 / mag.
+    static void recip_step(uint32_t& rem, uint32_t& q, uint32_t mag, int cnt) {
+        for (int k = 0; k < 2; ++k) {
+            const int idx = 25 - 2 * cnt - k;
+            rem = ((rem << 1) | (idx == 24 ? 1u : 0u)) & 0x3FFFFFF;
+            if (rem >= mag) { rem -= mag; q = ((q << 1) | 1) & 0x3FFFFFF; }
+            else            { q = (q << 1) & 0x3FFFFFF; }
+        }
+    }
+    static uint32_t recip_tdelta(uint32_t mag, uint32_t q) {
+        return (mag == 0 || q >= T_INF) ? T_INF : q;
+    }
+    // clip_axis: returns miss, writes t_near / t_far.
+    static bool clip_axis(int o, bool neg, uint32_t inv, uint32_t& t_near, uint32_t& t_far) {
+        if (inv == T_INF) {
+            t_near = 0; t_far = T_INF;
+            return o < 0 || o >= GRID_END;
+        }
+        const int dn = neg ? o - GRID_END : 0 - o;
+        const int df = neg ? o : GRID_END - o;
+        t_near = dn <= 0 ? 0 : t_sat((uint64_t(dn) * inv) >> 8);
+        t_far  = df <= 0 ? 0 : t_sat((uint64_t(df) * inv) >> 8);
+        return df <= 0;
+    }
+    static int enter_voxel(int o, int d, uint32_t t) {
+        const int64_t p = o + ((int64_t(d) * int64_t(t)) >> 16);
+        return p < 0 ? 0 : p >= GRID_END ? 63 : int((p >> 8) & 63);
+    }
+    static uint32_t first_tmax(int o, bool neg, uint32_t inv, int v) {
+        const int bound = (v + (neg ? 0 : 1)) << 8;
+        const int dist  = neg ? o - bound : bound - o;
+        if (inv == T_INF) return T_INF;
+        if (dist <= 0) return 0;
+        return t_sat((uint64_t(dist) * inv) >> 8);
+    }
+
+    // Start 2^24 / |d| for direction dir (Q8.24).
+    void div_load(const int32_t dir[3]) {
+        for (int a = 0; a < 3; ++a) {
+            const int d = dir[a] >> 8;
+            div_mag[a] = uint32_t(d < 0 ? -d : d);
+            div_rem[a] = 0; div_q[a] = 0;
+        }
+        div_cnt = 0;
+        div_run = div_loaded = true;
+    }
+
+    void build_occupancy() {
+        for (int b = 0; b < 512; ++b) {
+            brick_occ[b] = false;
+            for (int v = 0; v < 512; ++v) {
+                const int x = ((b >> 6) << 3) | (v >> 6), y = (((b >> 3) & 7) << 3) | ((v >> 3) & 7);
+                const int z = ((b & 7) << 3) | (v & 7);
+                brick_occ[b] = brick_occ[b] || solid((*vox)[VoxelModel::addr_of(x, y, z)]);
+            }
+        }
+    }
+    bool brick_at(int x, int y, int z) const {
+        return brick_occ[((x >> 3 & 7) << 6) | ((y >> 3 & 7) << 3) | (z >> 3 & 7)];
+    }
+
+    // S_PIPE slot (one pixel's ray) and its states.
+    enum SlotState { P_FREE, P_TRACE, P_WAIT, P_PAYLOAD, P_DONE };
+    struct Slot {
+        SlotState state = P_FREE;
+        int       x = 0, y = 0, z = 0, hx = 0, lastx = 0;
+        unsigned  steps = 0, dist = 0;
+        bool      pend = false, out = false, hit = false, read = false;
+        uint64_t  word = 0;
+        int       px = 0, py = 0;
+    };
+    static const int kSlots = 16;
+    bool pipelined = false;
+
+    // Pipelined DDA: IDLE, S_PIPE until the last pixel is written, then
+    // S_PIPE_END. Every block below acts on the registers as they were
+    // before the edge; each touches a different slot. In tile order the
+    // launch side seeks the next tile cell instead of launching.
+    void pipe_frame() {
+        Slot slot[kSlots];
+        int  head = 0, tail = 0, lx = 0, ly = lane;
+        bool launched = false, seek = tile_order() != 0;
+        const uint32_t cells = 1u << (2 * tile_bits());
+        bool iss_valid = false, ret_valid = false, pay_valid = false;
+        int  iss_slot = 0, ret_slot = 0, pay_slot = 0, iss_x = 0, ret_x = 0;
+        bool last_read_valid = false, last_hit_valid = false;
+        uint32_t last_read_addr = 0, last_hit_addr = 0;
+        bool read_en = false;
+        uint32_t read_addr = 0;
+        const bool skip_mode = cfg.skip_empty;
+        const bool sdf_mode  = cfg.sdf;
+
+        cycles = 1;   // IDLE
+        tile_d = 0;
+        pixel_x = 0; pixel_y = lane;
+        cursor.hit_valid = false; cursor.voxel_data = 0; hits = 0; skips = 0;
+        ets = 0; blends = 0;
+        memo_valid = 0;
+        for (bool finished = false; !finished;) {
+            ++cycles;
+            const uint8_t  data = read_data;
+            const bool     rd_en = read_en;
+            const uint32_t rd_addr = read_addr;
+            const bool     ret = ret_valid, pay = pay_valid;
+            const int      rs = ret_slot, rx = ret_x, ps = pay_slot;
+            const bool     all_launched = launched;
+            const int      tail0 = tail;
+            SlotState st[kSlots];
+            for (int i = 0; i < kSlots; ++i)
+                st[i] = slot[i].state;
+            read_en = false;
+            ret_valid = iss_valid; ret_slot = iss_slot; ret_x = iss_x;
+            iss_valid = false;
+            pay_valid = false;
+            bool payload_en = false;
+
+            if (!launched && seek) {
+                int tx, ty;
+                tile_cell(tile_d, tx, ty);
+                if (tile_on_screen(tx, ty)) {
+                    lx = tile_x0 = 8 * tx;
+                    ly = tile_top(ty);
+                    tile_x1 = tile_right(tx);
+                    tile_y1 = tile_bottom(ty);
+                    seek = false;
+                } else if (tile_d == cells - 1) {
+                    launched = true;
+                }
+                tile_d = (tile_d + 1) & (cells - 1);
+            } else if (!launched && st[tail] == P_FREE) {
+                Slot& s = slot[tail];
+                s = Slot();
+                s.state = P_TRACE;
+                s.x = 63;
+                s.y = ((H - 1 - ly) * 63) / (H - 1);
+                s.z = (lx * 63) / (W - 1);
+                s.px = lx;
+                s.py = ly;
+                tail = (tail + 1) % kSlots;
+                if (tile_order()) {
+                    if (lx != tile_x1) ++lx;
+                    else if (ly != tile_y1) { lx = tile_x0; ly += lanes; }
+                    else if (tile_d == 0) launched = true;
+                    else seek = true;
+                } else if (lx == W - 1) {
+                    lx = 0;
+                    if (ly == last_row()) launched = true;
+                    else ly += lanes;
+                } else {
+                    ++lx;
+                }
+            }
+
+            int pick = -1;
+            for (int k = 0; k < kSlots && pick < 0; ++k)
+                if (st[(head + k) % kSlots] == P_TRACE)
+                    pick = (head + k) % kSlots;
+            if (pick >= 0) {
+                Slot& s = slot[pick];
+                const int  px = s.x;
+                const bool brick = skip_mode && !brick_at(px, s.y, s.z);
+                if (brick || (sdf_mode && s.pend && s.dist >= 2)) {
+                    const unsigned reach = s.dist > 9 ? 7 : s.dist - 2;
+                    const unsigned r = brick ? unsigned(px & 7) : std::min(reach, unsigned(px));
+                    s.x = px - int(r) - 1;
+                    s.steps += r + 1;
+                    s.pend = false;
+                    if (int(r) == px)
+                        s.state = P_DONE;
+                    if (brick)
+                        ++skips;
+                } else {
+                    read_en = true;
+                    read_addr = VoxelModel::addr_of(px, s.y, s.z);
+                    iss_valid = true; iss_slot = pick; iss_x = px;
+                    s.x = px - 1;
+                    s.out = px == 0;
+                    ++s.steps;
+                    s.read = true;
+                    s.lastx = px;
+                    s.state = P_WAIT;
+                }
+            }
+
+            if (ret) {
+                Slot& s = slot[rs];
+                if (data & 0x80) {
+                    s.hit = true; s.hx = rx; s.state = P_PAYLOAD;
+                    pay_valid = true; pay_slot = rs;
+                    payload_en = true;
+                } else if (s.out) {
+                    s.state = P_DONE;
+                } else {
+                    s.pend = true; s.dist = data & 0xF; s.state = P_TRACE;
+                }
+            }
+            if (pay) {
+                slot[ps].word = payload_data;
+                slot[ps].state = P_DONE;
+            }
+
+            if (st[head] == P_DONE) {
+                Slot& s = slot[head];
+                ModelPixel p;
+                if (s.hit) {
+                    p = compute(s.word, s.hx, s.y, s.z, s.steps);
+                    ++hits;
+                    last_hit_addr = VoxelModel::addr_of(s.hx, s.y, s.z);
+                    last_hit_valid = true;
+                    if (s.px == (W >> 1) && s.py == (H >> 1) && !cursor.hit_valid) {
+                        cursor.hit_valid   = true;
+                        cursor.x           = uint8_t(s.hx);
+                        cursor.y           = uint8_t(s.y);
+                        cursor.z           = uint8_t(s.z);
+                        cursor.material_id = uint8_t(((s.word >> 4) & 0xF) << 4);
+                        cursor.voxel_data  = s.word;
+                    }
+                } else {
+                    pixel_y = s.py;
+                    p = sky();
+                }
+                if (s.read) {
+                    last_read_addr = VoxelModel::addr_of(s.lastx, s.y, s.z);
+                    last_read_valid = true;
+                }
+                out[size_t(s.py) * size_t(W) + size_t(s.px)] = p;
+                s.state = P_FREE;
+                head = (head + 1) % kSlots;
+                if (all_launched && head == tail0)
+                    finished = true;
+            } else if (all_launched && head == tail0 && st[head] == P_FREE) {
+                finished = true;
+            }
+
+            if (payload_en) {
+                payload_data = (*vox)[trace_addr];
+                ++payload_reads;
+            }
+            if (rd_en) {
+                read_data = trace_byte((*vox)[rd_addr]);
+                trace_addr = rd_addr;
+                ++reads;
+            }
+        }
+        // S_PIPE_END re-fetches the last hit's payload at its edge and the
+        // last read's trace byte at the next.
+        ++cycles;
+        if (last_hit_valid) {
+            payload_data = (*vox)[last_hit_addr];
+            ++payload_reads;
+            ++end_fetches;
+        }
+        if (last_read_valid) {
+            read_data = trace_byte((*vox)[last_read_addr]);
+            trace_addr = last_read_addr;
+            ++reads;
+            ++end_reads;
+        }
+    }
+
+    void frame() {
+        State state = IDLE;
+        bool  read_en = false;
+        uint32_t read_addr = 0;
+        ModelPixel pending;
+        cycles = 0;
+        reads = 0;
+        payload_reads = 0;
+        end_reads = end_fetches = 0;
+        build_occupancy();
+        pipelined = cfg.pipeline && cfg.dda && !cfg.perspective && !cfg.diag_slice && !comp_mode();
+        if (pipelined) {
+            pipe_frame();
+            return;
+        }
+        const bool skip_mode = cfg.skip_empty && !cfg.diag_slice;
+        const bool sdf_mode  = cfg.sdf && !cfg.diag_slice;
+        for (;;) {
+            ++cycles;
+            // Memory samples the core's registered read request at this edge;
+            // the core sees read_data from before the edge.
+            const uint8_t  data = read_data;
+            const bool     rd_en = read_en;
+            const uint32_t rd_addr = read_addr;
+            const bool     fetched = cursor_fetch;
+            read_en = false;
+            payload_en = false;
+            cursor_fetch = false;
+            if (fetched)
+                cursor.voxel_data = payload_data;
+            bool finished = false;
+
+            switch (state) {
+            case IDLE:
+                pixel_x = 0; pixel_y = lane;
+                cursor.hit_valid = false; cursor.voxel_data = 0; hits = 0; skips = 0;
+                ets = 0; blends = 0;
+                memo_valid = 0;
+                tile_d = 0;
+                div_run = div_next = false;
+                state = tile_order() ? NEXT_TILE : RENDER_PIXEL;
+                {
+                    // cam_setup
+                    const int64_t dx = cfg.cam_dir_x, dy = cfg.cam_dir_y, dz = cfg.cam_dir_z;
+                    const int64_t px = cfg.cam_plane_x, py = cfg.cam_plane_y;
+                    const int32_t f[3] = {int32_t(dx), int32_t(dz), int32_t(dy)};
+                    const int32_t u[3] = {reg32(0 - py * dz) >> 8, reg32(py * dx - px * dy) >> 8,
+                                          reg32(px * dz) >> 8};
+                    const int32_t r[3] = {int32_t(px), 0, int32_t(py)};
+                    for (int a = 0; a < 3; ++a) {
+                        ray_dx[a]  = reg32((int64_t(r[a]) * 131072) / W);
+                        const int32_t du = reg32((int64_t(u[a]) * 131072) / W);
+                        ray_du[a]  = reg32(int64_t(du) * lanes);
+                        ray_row[a] = reg32(reg32(int64_t(f[a]) << 16) - int64_t(W / 2) * ray_dx[a] +
+                                           int64_t(H / 2 - lane) * du);
+                        ray_dir[a] = ray_row[a];
+                        ray_base[a] = ray_row[a];
+                    }
+                    org[0] = cfg.cam_x; org[1] = cfg.cam_z; org[2] = cfg.cam_y;
+                }
+                break;
+            case RENDER_PIXEL:
+                ray_steps = 0; hit = false; slice_idx = 0; best_hit = false;
+                comp_t = 256; acc_r = acc_g = acc_b = 0;
+                map_y = ((H - 1 - pixel_y) * 63) / (H - 1);
+                map_z = (pixel_x * 63) / (W - 1);
+                ray_pos_x = 63 << 8;
+                {
+                    const int dir[3] = {-256, 0, 0};
+                    dda_x = 63; dda_y = map_y & 63; dda_z = map_z & 63;
+                    for (int a = 0; a < 3; ++a) {
+                        dda_neg[a]    = dir[a] < 0;
+                        dda_tdelta[a] = tdelta(dir[a]);
+                        dda_tmax[a]   = tmax0(dir[a], 128, dda_tdelta[a]);
+                    }
+                    dda_pending = false; dda_out = false;
+                }
+                cursor_sample = pixel_x == (W >> 1) && pixel_y == (H >> 1);
+                if (cfg.perspective && !cfg.diag_slice) {
+                    for (int a = 0; a < 3; ++a) {
+                        ray_d[a]   = ray_dir[a] >> 8;
+                        dda_neg[a] = ray_dir[a] < 0;
+                    }
+                    if (div_next) {
+                        div_next = false;
+                        state = !div_run || div_cnt == 12 ? RAY_CLIP : RAY_DIV;
+                    } else {
+                        div_load(ray_dir);
+                        state = RAY_DIV;
+                    }
+                } else {
+                    state = STEP;
+                }
+                {
+                    const bool memo = cfg.memo && (cfg.diag_slice || !cfg.perspective) && !tile_order() &&
+                                      !comp_mode();
+                    const bool new_row = map_y != memo_row;
+                    if (new_row) { memo_valid = 0; memo_row = map_y; }
+                    if (memo && !new_row && ((memo_valid >> map_z) & 1) &&
+                        !(pixel_x == (W >> 1) && pixel_y == (H >> 1))) {
+                        pending = memo_words[map_z];
+                        if ((pending.w1 & 0xFF) == 0xFF) {
+                            const unsigned r = (10 + ((pixel_y & 0xFF) >> 3)) & 0xFF;
+                            const unsigned g = (40 + ((pixel_y & 0xFF) >> 3)) & 0xFF;
+                            const unsigned b = (90 + ((pixel_y & 0xFF) >> 2)) & 0xFF;
+                            pending.w1 = (r << 24) | (g << 16) | (b << 8) | 0xFF;
+                        } else {
+                            ++hits;
+                        }
+                        state = WRITE;
+                    }
+                }
+                break;
+            case RAY_DIV:
+                if (div_cnt == 12)
+                    state = RAY_CLIP;
+                break;
+            case RAY_CLIP: {
+                uint32_t t_in = 0, t_out = T_INF;
+                bool miss = false;
+                for (int a = 0; a < 3; ++a) {
+                    uint32_t tn, tf;
+                    dda_tdelta[a] = recip_tdelta(div_mag[a], div_q[a]);
+                    miss |= clip_axis(org[a], dda_neg[a], dda_tdelta[a], tn, tf);
+                    if (tn > t_in) t_in = tn;
+                    if (tf < t_out) t_out = tf;
+                }
+                clip_t_enter = t_in;
+                dda_out = miss || t_in >= t_out;
+                // Prefetch the divide for the direction NEXT_PIXEL steps to.
+                const bool in_row = tile_order() ? pixel_x != tile_x1 : pixel_x != W - 1;
+                const bool more = in_row || pixel_y != (tile_order() ? tile_y1 : last_row());
+                if (more) {
+                    int32_t next[3];
+                    for (int a = 0; a < 3; ++a)
+                        next[a] = in_row ? reg32(int64_t(ray_dir[a]) + ray_dx[a])
+                                         : reg32(int64_t(ray_row[a]) - ray_du[a]);
+                    div_load(next);
+                    div_next = true;
+                }
+                state = RAY_ENTER;
+                break;
+            }
+            case RAY_ENTER:
+                dda_x = enter_voxel(org[0], ray_d[0], clip_t_enter);
+                dda_y = enter_voxel(org[1], ray_d[1], clip_t_enter);
+                dda_z = enter_voxel(org[2], ray_d[2], clip_t_enter);
+                state = RAY_TMAX;
+                break;
+            case RAY_TMAX: {
+                const int v[3] = {dda_x, dda_y, dda_z};
+                for (int a = 0; a < 3; ++a)
+                    dda_tmax[a] = first_tmax(org[a], dda_neg[a], dda_tdelta[a], v[a]);
+                state = STEP;
+                break;
+            }
+            case STEP:
+                if (cfg.diag_slice) {
+                    if (slice_idx >= 7) {
+                        pending = best_hit ? compute(payload_data, voxel_x, voxel_y, voxel_z, ray_steps) : sky();
+                        state = WRITE;
+                    } else {
+                        voxel_x = 56 - slice_idx * 8; voxel_y = map_y; voxel_z = map_z;
+                        read_addr = VoxelModel::addr_of(voxel_x, voxel_y, voxel_z);
+                        read_en = true;
+                        ray_steps = unsigned(slice_idx + 1);
+                        state = FETCH;
+                    }
+                } else if (cfg.dda || cfg.perspective) {
+                    if (dda_pending && (data & 0x80) && comp_mode() && (data & 0x40)) {
+                        dda_pending = false;
+                        payload_en = true;
+                        state = BLEND;
+                    } else if (dda_pending && (data & 0x80)) {
+                        hit = true; dda_pending = false;
+                        latch_hit(true);
+                        state = SHADE;
+                    } else if (dda_out || ray_steps >= 192) {
+                        pending = over(sky());
+                        dda_pending = false;
+                        state = WRITE;
+                    } else if ((skip_mode && !brick_occ[((dda_x >> 3 & 7) << 6) |
+                                                        ((dda_y >> 3 & 7) << 3) | (dda_z >> 3 & 7)]) ||
+                               (sdf_mode && dda_pending && (data & 0xF) >= 2)) {
+                        const bool brick = skip_mode && !brick_occ[((dda_x >> 3 & 7) << 6) |
+                                                                   ((dda_y >> 3 & 7) << 3) | (dda_z >> 3 & 7)];
+                        const unsigned reach = (data & 0xF) > 9 ? 7 : unsigned(data & 0xF) - 2;
+                        int* pos[3] = {&dda_x, &dda_y, &dda_z};
+                        unsigned r[3], n[3], left[3];
+                        uint32_t te[3];
+                        for (int a = 0; a < 3; ++a) {
+                            left[a] = unsigned(dda_neg[a] ? *pos[a] : 63 - *pos[a]);
+                            r[a]  = brick ? (dda_neg[a] ? (*pos[a] & 7) : 7 - (*pos[a] & 7))
+                                          : (reach < left[a] ? reach : left[a]);
+                            te[a] = t_after(dda_tmax[a], dda_tdelta[a], r[a]);
+                        }
+                        const int e = te[0] <= te[1] && te[0] <= te[2] ? 0 : te[1] <= te[2] ? 1 : 2;
+                        for (int a = 0; a < 3; ++a)
+                            n[a] = a == e ? r[a] + 1
+                                          : brick_steps(dda_tmax[a], dda_tdelta[a], te[e], a < e);
+                        dda_out = r[e] == left[e];
+                        for (int a = 0; a < 3; ++a) {
+                            *pos[a] += dda_neg[a] ? -int(n[a]) : int(n[a]);
+                            dda_tmax[a] = t_after(dda_tmax[a], dda_tdelta[a], n[a]);
+                            ray_steps += n[a];
+                        }
+                        dda_pending = false;
+                        if (brick)
+                            ++skips;
+                    } else {
+                        voxel_x = dda_x; voxel_y = dda_y; voxel_z = dda_z;
+                        read_addr = VoxelModel::addr_of(voxel_x, voxel_y, voxel_z);
+                        read_en = true;
+                        dda_pending = true;
+                        ++ray_steps;
+                        state = FETCH;
+                    }
+                } else if (ray_steps >= 128 || hit) {
+                    pending = hit ? compute(payload_data, voxel_x, voxel_y, voxel_z, ray_steps) : sky();
+                    state = WRITE;
+                } else if (skip_mode && !(data & 0x80) &&
+                           !brick_occ[(((ray_pos_x >> 11) & 7) << 6) | ((map_y >> 3) << 3) | (map_z >> 3)]) {
+                    const int base = ((ray_pos_x >> 11) & 7) << 11;
+                    if (ray_pos_x < 0) {
+                        ray_pos_x -= 128;
+                        ray_steps += 1;
+                    } else {
+                        ray_steps += ((ray_pos_x - base) >> 7) + 1;
+                        ray_pos_x = base - 128;
+                    }
+                    ++skips;
+                } else {
+                    voxel_x = (ray_pos_x >> 8) & 63; voxel_y = map_y; voxel_z = map_z;
+                    read_addr = VoxelModel::addr_of(voxel_x, voxel_y, voxel_z);
+                    read_en = true;
+                    ray_pos_x -= 128;
+                    ++ray_steps;
+                    state = FETCH;
+                }
+                break;
+            case FETCH:
+                if (cfg.diag_slice) {
+                    if ((data & 0x80) && !best_hit) { best_hit = true; hit = true; latch_hit(false); }
+                    ++slice_idx;
+                } else if (cfg.dda || cfg.perspective) {
+                    int* pos[3] = {&dda_x, &dda_y, &dda_z};
+                    const int a = dda_tmax[0] <= dda_tmax[1] && dda_tmax[0] <= dda_tmax[2] ? 0
+                                : dda_tmax[1] <= dda_tmax[2] ? 1 : 2;
+                    dda_out = dda_neg[a] ? *pos[a] == 0 : *pos[a] == 63;
+                    *pos[a] += dda_neg[a] ? -1 : 1;
+                    dda_tmax[a] = t_add(dda_tmax[a], dda_tdelta[a]);
+                } else if (!hit && (data & 0x80)) {
+                    hit = true;
+                    latch_hit(false);
+                }
+                state = STEP;
+                break;
+            case SHADE:
+                if (fetched)
+                    cursor.material_id = uint8_t(((payload_data >> 4) & 0xF) << 4);
+                pending = over(compute(payload_data, voxel_x, voxel_y, voxel_z, ray_steps));
+                state = WRITE;
+                break;
+            case BLEND: {
+                const unsigned alpha   = (payload_data >> 40) & 0xFF;
+                const unsigned contrib = (comp_t * alpha) >> 8;
+                if (256 - (comp_t - contrib) >= cfg.alpha_threshold) {
+                    const int v[3] = {voxel_x, voxel_y, voxel_z};
+                    unsigned left = 63;
+                    for (int a = 0; a < 3; ++a)
+                        if (dda_tdelta[a] != T_INF)
+                            left = std::min(left, unsigned(dda_neg[a] ? v[a] : 63 - v[a]));
+                    ets += left;
+                    hit = true;
+                    latch_hit(true, false);
+                    state = SHADE;
+                } else {
+                    acc_r = (acc_r + ((contrib * ((payload_data >> 24) & 0xFF)) >> 8)) & 0xFF;
+                    acc_g = (acc_g + ((contrib * ((payload_data >> 16) & 0xFF)) >> 8)) & 0xFF;
+                    acc_b = (acc_b + ((contrib * ((payload_data >> 8) & 0xFF)) >> 8)) & 0xFF;
+                    comp_t -= contrib;
+                    ++blends;
+                    state = STEP;
+                }
+                break;
+            }
+            case WRITE:
+                out[size_t(pixel_y) * size_t(W) + size_t(pixel_x)] = pending;
+                if (cfg.memo && (cfg.diag_slice || !cfg.perspective) && !tile_order() && !comp_mode() &&
+                    !((memo_valid >> map_z) & 1)) {
+                    memo_words[map_z] = pending;
+                    memo_valid |= uint64_t(1) << map_z;
+                }
+                state = NEXT_PIXEL;
+                break;
+            case NEXT_PIXEL:
+                if (tile_order()) {
+                    if (pixel_x != tile_x1) {
+                        ++pixel_x;
+                        for (int a = 0; a < 3; ++a)
+                            ray_dir[a] = reg32(int64_t(ray_dir[a]) + ray_dx[a]);
+                        state = RENDER_PIXEL;
+                    } else if (pixel_y != tile_y1) {
+                        pixel_x = tile_x0;
+                        pixel_y += lanes;
+                        for (int a = 0; a < 3; ++a) {
+                            ray_row[a] = reg32(int64_t(ray_row[a]) - ray_du[a]);
+                            ray_dir[a] = ray_row[a];
+                        }
+                        state = RENDER_PIXEL;
+                    } else if (tile_d == 0) {
+                        finished = true;
+                    } else {
+                        state = NEXT_TILE;
+                    }
+                } else if (pixel_x == W - 1) {
+                    pixel_x = 0;
+                    for (int a = 0; a < 3; ++a) {
+                        ray_row[a] = reg32(int64_t(ray_row[a]) - ray_du[a]);
+                        ray_dir[a] = ray_row[a];
+                    }
+                    if (pixel_y == last_row()) finished = true;
+                    else { pixel_y += lanes; state = RENDER_PIXEL; }
+                } else {
+                    ++pixel_x;
+                    for (int a = 0; a < 3; ++a)
+                        ray_dir[a] = reg32(int64_t(ray_dir[a]) + ray_dx[a]);
+                    state = RENDER_PIXEL;
+                }
+                break;
+            case NEXT_TILE: {
+                const uint32_t cells = 1u << (2 * tile_bits());
+                int tx, ty;
+                tile_cell(tile_d, tx, ty);
+                if (tile_on_screen(tx, ty)) {
+                    pixel_x = tile_x0 = 8 * tx;
+                    pixel_y = tile_top(ty);
+                    tile_x1 = tile_right(tx);
+                    tile_y1 = tile_bottom(ty);
+                    for (int a = 0; a < 3; ++a) {
+                        ray_row[a] = reg32(int64_t(ray_base[a]) - int64_t(8 * ty) * ray_du[a] +
+                                           int64_t(8 * tx) * ray_dx[a]);
+                        ray_dir[a] = ray_row[a];
+                    }
+                    state = RENDER_PIXEL;
+                } else if (tile_d == cells - 1) {
+                    finished = true;
+                }
+                tile_d = (tile_d + 1) & (cells - 1);
+                break;
+            }
+            }
+            // The divider steps on its own unless a state loaded it.
+            if (div_run && !div_loaded) {
+                for (int a = 0; a < 3; ++a)
+                    recip_step(div_rem[a], div_q[a], div_mag[a], div_cnt);
+                if (div_cnt++ == 12)
+                    div_run = false;
+            }
+            div_loaded = false;
+            if (payload_en) {
+                payload_data = (*vox)[trace_addr];
+                ++payload_reads;
+            }
+            if (rd_en) {
+                read_data = trace_byte((*vox)[rd_addr]);
+                trace_addr = rd_addr;
+                ++reads;
+            }
+            if (finished)
+                return;
+        }
+    }
+};
+
+static void compare_one(const char* what, const char* level, const VoxelModel& model,
+                        const FsmCore& ref) {
+    size_t bad = 0;
+    for (size_t i = 0; i < ref.out.size(); ++i) {
+        const ModelPixel& a = model.pixels()[i];
+        const ModelPixel& b = ref.out[i];
+        if (a.w0 != b.w0 || a.w1 != b.w1 || a.w2 != b.w2) {
+            if (bad == 0)
+                std::fprintf(stderr, "%s/%s: pixel %zu model %08x %08x %08x fsm %08x %08x %08x\n",
+                             what, level, i, a.w0, a.w1, a.w2, b.w0, b.w1, b.w2);
+            ++bad;
+        }
+    }
+    CHECK(bad == 0, "%s/%s: %zu pixels differ", what, level, bad);
+    CHECK(model.hit_count() == ref.hits, "%s/%s: hits %u vs %u", what, level,
+          model.hit_count(), ref.hits);
+    // The model counts the sequential walk; the pipeline makes the same
+    // reads plus the end-of-frame re-read, in its own cycles.
+    CHECK(ref.pipelined || model.cycles() == ref.cycles, "%s/%s: cycles %llu vs %llu", what,
+          level, (unsigned long long)model.cycles(), (unsigned long long)ref.cycles);
+    CHECK(model.reads() + ref.end_reads == ref.reads, "%s/%s: reads %llu vs %llu", what, level,
+          (unsigned long long)model.reads(), (unsigned long long)ref.reads);
+    CHECK(model.skips() == ref.skips, "%s/%s: skips %u vs %u", what, level, model.skips(),
+          ref.skips);
+    CHECK(model.ets_saved() == ref.ets, "%s/%s: steps saved %u vs %u", what, level,
+          model.ets_saved(), ref.ets);
+    // One payload fetch per traced hit and blended voxel (and the
+    // pipeline's re-fetch of the last); memo copies fetch nothing.
+    const bool memo = ref.cfg.memo && !ref.pipelined && !ref.comp_mode();
+    CHECK(memo ? ref.payload_reads <= ref.hits
+               : ref.payload_reads == ref.hits + ref.blends + ref.end_fetches,
+          "%s/%s: %llu payload reads for %u hits", what, level,
+          (unsigned long long)ref.payload_reads, ref.hits);
+    const ModelCursor& c = model.cursor();
+    CHECK(c.hit_valid == ref.cursor.hit_valid && c.x == ref.cursor.x && c.y == ref.cursor.y &&
+          c.z == ref.cursor.z && c.material_id == ref.cursor.material_id &&
+          c.voxel_data == ref.cursor.voxel_data, "%s/%s: cursor differs", what, level);
+}
+
+// One model per SIMD level plus tiled renderers (thread count x tile size),
+// fed identical inputs.
+struct ModelSet {
+    struct Tiled {
+        std::unique_ptr<VoxelModel>   model;
+        std::unique_ptr<TileRenderer> renderer;
+        std::string                   name;
+    };
+    std::vector<VoxelModel> models;
+    std::vector<Tiled>      tiled;
+
+    ModelSet(int w, int h) {
+        models.reserve(3);
+        const SimdLevel best = simd_detect();
+        for (SimdLevel l : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+            if (l > best)
+                break;
+            models.emplace_back(w, h);
+            models.back().set_simd(l);
+        }
+    }
+    void add_tiled(int threads, int tile_w, int tile_h, SimdLevel level) {
+        Tiled t;
+        t.model.reset(new VoxelModel(front().width(), front().height()));
+        t.model->set_simd(level);
+        TileRenderer::Options opt;
+        opt.threads = threads;
+        opt.tile_w  = tile_w;
+        opt.tile_h  = tile_h;
+        t.renderer.reset(new TileRenderer(*t.model, opt));
+        t.name = "tiled " + std::to_string(threads) + "t " + std::to_string(tile_w) + "x" +
+                 std::to_string(tile_h) + " " + simd_name(level);
+        tiled.push_back(std::move(t));
+    }
+    template <typename F> void each(F f) {
+        for (VoxelModel& m : models) f(m);
+        for (Tiled& t : tiled) f(*t.model);
+    }
+    VoxelModel& front() { return models.front(); }
+    void generate_world() { each([](VoxelModel& m) { m.generate_world(); }); }
+    void set_config(const ModelConfig& c) { each([&](VoxelModel& m) { m.set_config(c); }); }
+    void write_voxel(uint32_t a, uint64_t d) { each([&](VoxelModel& m) { m.write_voxel(a, d); }); }
+    void load_volume(const uint64_t* w) { each([&](VoxelModel& m) { m.load_volume(w); }); }
+    // A host edit with the distance field kept current: the voxel, then
+    // every word whose distance changed.
+    void edit(std::vector<uint64_t>& field, uint32_t a, uint64_t d) {
+        std::vector<uint32_t> changed;
+        field[a] = d;
+        distance_field_update(field.data(), a, &changed);
+        write_voxel(a, field[a]);
+        for (uint32_t c : changed)
+            write_voxel(c, field[c]);
+    }
+};
+
+// Capped Chebyshev distance from voxel (x, y, z) to the nearest solid one.
+static unsigned brute_distance(const std::vector<uint64_t>& vol, int x, int y, int z) {
+    for (int r = 0; r < int(DF_MAX); ++r)
+        for (int i = std::max(0, x - r); i <= std::min(63, x + r); ++i)
+            for (int j = std::max(0, y - r); j <= std::min(63, y + r); ++j)
+                for (int k = std::max(0, z - r); k <= std::min(63, z + r); ++k)
+                    if (df_solid(vol[VoxelModel::addr_of(i, j, k)]))
+                        return unsigned(r);
+    return DF_MAX;
+}
+
+static size_t field_errors(const std::vector<uint64_t>& vol) {
+    size_t bad = 0;
+    for (uint32_t a = 0; a < VoxelModel::kVoxels; a += 1009)
+        if (!df_solid(vol[a]))
+            bad += df_distance(vol[a]) != brute_distance(vol, int(a >> 12), int(a >> 6) & 63, int(a) & 63);
+    return bad;
+}
+
+// Pixels that differ in any word; a length mismatch counts the extra ones.
+static size_t count_pixel_mismatches(const std::vector<ModelPixel>& a,
+                                     const std::vector<ModelPixel>& b) {
+    const size_t n = std::min(a.size(), b.size());
+    size_t bad = std::max(a.size(), b.size()) - n;
+    for (size_t i = 0; i < n; ++i)
+        bad += a[i].w0 != b[i].w0 || a[i].w1 != b[i].w1 || a[i].w2 != b[i].w2;
+    return bad;
+}
+
+static void compare(const char* what, ModelSet& set, FsmCore& ref) {
+    std::vector<uint64_t> vol(set.front().volume(), set.front().volume() + VoxelModel::kVoxels);
+    ref.vox = &vol;
+    ref.cfg = set.front().config();
+    ref.frame();
+    for (VoxelModel& m : set.models) {
+        m.render();
+        compare_one(what, simd_name(m.simd()), m, ref);
+    }
+    for (ModelSet::Tiled& t : set.tiled) {
+        t.renderer->render();
+        compare_one(what, t.name.c_str(), *t.model, ref);
+    }
+}
+
+// NUM_LANES cores, each on its own rows of the frame. The top's port
+// stalls change when a lane runs, not what it renders, so they are left
+// out and the frame takes the slowest lane's cycles.
+struct LaneArray {
+    std::vector<FsmCore> cores;
+    FsmCore              frame;   // pixels and totals as the top reports them
+
+    LaneArray(int w, int h, int lanes) : frame(w, h) {
+        for (int k = 0; k < lanes; ++k)
+            cores.emplace_back(w, h);
+        number();
+    }
+    // Lane 0 carries on from a single core's registers.
+    LaneArray(const FsmCore& single, int lanes) : frame(single.W, single.H) {
+        cores.push_back(single);
+        for (int k = 1; k < lanes; ++k)
+            cores.emplace_back(single.W, single.H);
+        number();
+    }
+    void number() {
+        for (size_t k = 0; k < cores.size(); ++k) {
+            cores[k].lane  = int(k);
+            cores[k].lanes = int(cores.size());
+        }
+    }
+
+    void run(const std::vector<uint64_t>* vol, const ModelConfig& cfg) {
+        FsmCore& f = frame;
+        const int lanes = int(cores.size());
+        f.cfg = cfg;
+        f.hits = f.skips = f.ets = 0;
+        f.cycles = f.reads = f.payload_reads = f.end_reads = f.end_fetches = f.blends = 0;
+        for (FsmCore& c : cores) {
+            c.vox = vol;
+            c.cfg = cfg;
+            c.frame();
+            for (int py = c.lane; py < f.H; py += lanes)
+                std::copy_n(&c.out[size_t(py) * size_t(f.W)], f.W, &f.out[size_t(py) * size_t(f.W)]);
+            f.pipelined      = c.pipelined;
+            f.hits          += c.hits;
+            f.skips         += c.skips;
+            f.ets           += c.ets;
+            f.blends        += c.blends;
+            f.cycles         = std::max(f.cycles, c.cycles);
+            f.reads         += c.reads;
+            f.payload_reads += c.payload_reads;
+            f.end_reads     += c.end_reads;
+            f.end_fetches   += c.end_fetches;
+        }
+        f.cursor = cores[size_t((f.H >> 1) % lanes)].cursor;
+    }
+};
+
+static void compare_lanes(const char* what, ModelSet& set, LaneArray& ref) {
+    std::vector<uint64_t> vol(set.front().volume(), set.front().volume() + VoxelModel::kVoxels);
+    ref.run(&vol, set.front().config());
+    for (VoxelModel& m : set.models) {
+        m.render();
+        compare_one(what, simd_name(m.simd()), m, ref.frame);
+    }
+    for (ModelSet::Tiled& t : set.tiled) {
+        t.renderer->render();
+        compare_one(what, t.name.c_str(), *t.model, ref.frame);
+    }
+}
+
+// The world at 97x61, whose odd sizes leave partial tiles and lanes of
+// different row counts, with two tiled renderers whose tiles do not divide
+// it.
+static const int kOddW = 97;
+static const int kOddH = 61;
+
+static ModelSet make_odd_fixture() {
+    ModelSet set(kOddW, kOddH);
+    set.add_tiled(3, 16, 8, SimdLevel::Scalar);
+    set.add_tiled(4, 5, 3, simd_detect());
+    set.generate_world();
+    return set;
+}
+
+// Perspective camera as VoxelSim::apply_camera sets it: position in voxels,
+// camera axes (z up), 0.66 field of view.
+static void aim(ModelConfig& cfg, float x, float y, float z, float yaw, float pitch) {
+    const float dx = std::cos(yaw) * std::cos(pitch);
+    const float dy = std::sin(yaw) * std::cos(pitch);
+    const float dz = std::sin(pitch);
+    cfg.perspective = true;
+    cfg.cam_x       = int16_t(x * 256);
+    cfg.cam_y       = int16_t(y * 256);
+    cfg.cam_z       = int16_t(z * 256);
+    cfg.cam_dir_x   = int16_t(dx * 256);
+    cfg.cam_dir_y   = int16_t(dy * 256);
+    cfg.cam_dir_z   = int16_t(dz * 256);
+    cfg.cam_plane_x = int16_t(-dy * 0.66f * 256);
+    cfg.cam_plane_y = int16_t(dx * 0.66f * 256);
+}
+
+int main() {
+    // Empty volume: all sky, 128 samples per pixel.
+    {
+        ModelSet set(32, 24);
+        for (VoxelModel& model : set.models) {
+            model.render();
+            CHECK(model.hit_count() == 0, "empty: %u hits", model.hit_count());
+            CHECK(model.cycles() == 1 + 32ull * 24 * (2 * 128 + 4), "empty: cycles");
+            CHECK(model.pixels()[0].w1 == 0x0A285AFFu, "empty: sky %08x", model.pixels()[0].w1);
+        }
+    }
+
+    // Odd sizes leave partial tiles on the right and bottom edges.
+    {
+        ModelSet set = make_odd_fixture();
+        FsmCore  ref(kOddW, kOddH);
+        compare("odd size", set, ref);
+        compare("odd size again", set, ref);
+        ModelConfig cfg;
+        cfg.dda = true;
+        set.set_config(cfg);
+        compare("odd size dda", set, ref);
+        aim(cfg, -20, 30, 24, 0.3f, 0.1f);
+        set.set_config(cfg);
+        compare("odd size perspective", set, ref);
+        cfg = ModelConfig();
+        cfg.memo = true;
+        set.set_config(cfg);
+        compare("odd size memo", set, ref);
+        cfg.dda = true;
+        cfg.pipeline = true;
+        set.set_config(cfg);
+        compare("odd size pipe", set, ref);
+    }
+
+    // The real scene at full size, with frame-to-frame carry-over.
+    ModelSet   model(480, 360);
+    FsmCore    ref(480, 360);
+    model.add_tiled(1, 32, 32, simd_detect());
+    model.add_tiled(8, 32, 32, simd_detect());
+    model.add_tiled(5, 24, 7, SimdLevel::Scalar);
+    model.generate_world();
+    compare("world", model, ref);
+    compare("world again", model, ref);
+
+    ModelConfig cfg;
+    cfg.diag_slice = true;
+    model.set_config(cfg);
+    compare("diag slice", model, ref);
+
+    cfg = ModelConfig();
+    cfg.smooth_surfaces = false;
+    cfg.sel_active = true;
+    cfg.sel_x = uint8_t(model.front().cursor().x);
+    cfg.sel_y = uint8_t(model.front().cursor().y);
+    cfg.sel_z = uint8_t(model.front().cursor().z);
+    model.set_config(cfg);
+    compare("selection", model, ref);
+
+    // Debug-style edits between frames must invalidate the cached columns.
+    for (int z = 0; z < 64; z += 3)
+        model.write_voxel(VoxelModel::addr_of(50, 32, z), 0xB4FFFFDC11223330ull);
+    model.write_voxel(VoxelModel::addr_of(32, 32, 32), 0);
+    compare("edits", model, ref);
+
+    // DDA after legacy frames (the carry registers it ignores are stale), with
+    // the selection still on, then back.
+    const uint64_t legacy_reads = ref.reads, legacy_cycles = ref.cycles;
+    cfg.dda = true;
+    model.set_config(cfg);
+    compare("dda", model, ref);
+    CHECK(ref.reads < legacy_reads && ref.cycles < legacy_cycles,
+          "dda: %llu reads / %llu cycles vs legacy %llu / %llu",
+          (unsigned long long)ref.reads, (unsigned long long)ref.cycles,
+          (unsigned long long)legacy_reads, (unsigned long long)legacy_cycles);
+    cfg = ModelConfig();
+    cfg.dda = true;
+    model.set_config(cfg);
+    compare("dda smooth", model, ref);
+    const ModelCursor& cur = model.front().cursor();
+    CHECK(cur.hit_valid && cur.material_id == ((cur.voxel_data >> 4) & 0xF) << 4,
+          "dda: cursor material is not the hit's own");
+    cfg.diag_slice = true;
+    model.set_config(cfg);
+    compare("diag over dda", model, ref);
+    model.set_config(ModelConfig());
+    compare("legacy after dda", model, ref);
+
+    // Perspective from outside the volume, from inside it, and looking away
+    // from it (no reads at all, so the read word carries through untouched).
+    cfg = ModelConfig();
+    aim(cfg, -24, 32, 28, 0.0f, 0.0f);
+    model.set_config(cfg);
+    compare("perspective", model, ref);
+    CHECK(ref.hits > 0 && ref.reads < legacy_reads, "perspective: %u hits, %llu reads", ref.hits,
+          (unsigned long long)ref.reads);
+    aim(cfg, 90, 70, 40, -2.4f, -0.5f);
+    model.set_config(cfg);
+    compare("perspective pitched", model, ref);
+    aim(cfg, 6, 6, 30, 0.6f, 0.2f);
+    model.set_config(cfg);
+    compare("perspective inside", model, ref);
+    aim(cfg, -24, 32, 28, 3.14159f, 0.0f);
+    model.set_config(cfg);
+    compare("perspective away", model, ref);
+    // Each miss is S_RENDER_PIXEL, setup, S_STEP, S_WRITE, S_NEXT_PIXEL;
+    // all but the first wait out 7 of the 13 divide cycles.
+    CHECK(ref.reads == 0 && ref.hits == 0 && ref.cycles == 1 + 20 + (480ull * 360 - 1) * 14,
+          "perspective away: %llu reads, %llu cycles", (unsigned long long)ref.reads,
+          (unsigned long long)ref.cycles);
+    cfg.dda = true;
+    cfg.diag_slice = true;
+    model.set_config(cfg);
+    compare("diag over perspective", model, ref);
+    model.set_config(ModelConfig());
+    compare("legacy after perspective", model, ref);
+
+    // Ray memo over each orthographic mode; perspective ignores it.
+    const uint64_t full_cycles = ref.cycles;
+    cfg = ModelConfig();
+    cfg.memo = true;
+    model.set_config(cfg);
+    compare("memo", model, ref);
+    CHECK(ref.cycles * 10 < full_cycles, "memo: %llu cycles vs %llu",
+          (unsigned long long)ref.cycles, (unsigned long long)full_cycles);
+    cfg.dda = true;
+    cfg.sel_active = true;
+    cfg.sel_x = 14;
+    cfg.sel_y = 32;
+    cfg.sel_z = 32;
+    model.set_config(cfg);
+    compare("memo dda", model, ref);
+    cfg.diag_slice = true;
+    model.set_config(cfg);
+    compare("memo diag", model, ref);
+    cfg.diag_slice = false;
+    aim(cfg, -24, 32, 28, 0.2f, 0.1f);
+    model.set_config(cfg);
+    compare("memo perspective", model, ref);
+
+    // Empty-space skipping in each mode: same pixels, fewer reads. Then a
+    // brick emptied by edits, and faint words (nonzero, alpha <= 10) that
+    // leave their brick empty.
+    const uint64_t plain_reads = ref.reads;
+    cfg = ModelConfig();
+    cfg.skip_empty = true;
+    model.set_config(cfg);
+    compare("skip", model, ref);
+    CHECK(ref.skips > 0 && ref.reads < legacy_reads, "skip: %u skips, %llu reads", ref.skips,
+          (unsigned long long)ref.reads);
+    cfg.dda = true;
+    model.set_config(cfg);
+    compare("skip dda", model, ref);
+    {
+        // Skipping never changes a pixel.
+        const std::vector<ModelPixel> skipped = ref.out;
+        const uint32_t skipped_hits = ref.hits;
+        cfg.skip_empty = false;
+        model.set_config(cfg);
+        compare("skip off dda", model, ref);
+        const size_t bad = count_pixel_mismatches(skipped, ref.out);
+        CHECK(bad == 0 && skipped_hits == ref.hits, "skip dda: %zu pixels changed", bad);
+        cfg.skip_empty = true;
+    }
+    cfg.memo = true;
+    model.set_config(cfg);
+    compare("skip memo dda", model, ref);
+    cfg.memo = false;
+    cfg.diag_slice = true;
+    model.set_config(cfg);
+    compare("skip diag", model, ref);
+    CHECK(ref.skips == 0, "skip diag: %u skips", ref.skips);
+    cfg.diag_slice = false;
+    aim(cfg, -24, 32, 28, 0.2f, 0.1f);
+    model.set_config(cfg);
+    compare("skip perspective", model, ref);
+    CHECK(ref.reads < plain_reads, "skip perspective: %llu reads vs %llu",
+          (unsigned long long)ref.reads, (unsigned long long)plain_reads);
+    aim(cfg, 6, 6, 30, 0.6f, 0.2f);
+    model.set_config(cfg);
+    compare("skip perspective inside", model, ref);
+    for (int x = 48; x < 56; ++x)
+        for (int y = 24; y < 32; ++y)
+            for (int z = 24; z < 32; ++z)
+                model.write_voxel(VoxelModel::addr_of(x, y, z), (x + z) & 1 ? 0 : 0x800A0000AABBCC10ull);
+    for (int x = 40; x < 48; x += 3)
+        model.write_voxel(VoxelModel::addr_of(x, 33, 30), 0x80FF0000AABBCC10ull);
+    compare("skip perspective edits", model, ref);
+    cfg = ModelConfig();
+    cfg.skip_empty = true;
+    model.set_config(cfg);
+    compare("skip edits", model, ref);
+    cfg.dda = true;
+    model.set_config(cfg);
+    compare("skip dda edits", model, ref);
+
+    // Distance-field jumps over a baked field, alone and with brick skips,
+    // then with the field kept current through edits.
+    std::vector<uint64_t> field(model.front().volume(), model.front().volume() + VoxelModel::kVoxels);
+    distance_field_build(field.data(), 3);
+    CHECK(field_errors(field) == 0, "sdf: %zu wrong distances", field_errors(field));
+    model.load_volume(field.data());
+    cfg = ModelConfig();
+    cfg.dda = true;
+    model.set_config(cfg);
+    compare("sdf off dda", model, ref);
+    const std::vector<ModelPixel> dda_pixels = ref.out;
+    const uint64_t dda_reads = ref.reads, dda_cycles = ref.cycles;
+    cfg.sdf = true;
+    model.set_config(cfg);
+    compare("sdf dda", model, ref);
+    {
+        const size_t bad = count_pixel_mismatches(dda_pixels, ref.out);
+        CHECK(bad == 0, "sdf dda: %zu pixels changed", bad);
+        CHECK(ref.reads < dda_reads && ref.cycles < dda_cycles,
+              "sdf dda: %llu reads / %llu cycles vs %llu / %llu", (unsigned long long)ref.reads,
+              (unsigned long long)ref.cycles, (unsigned long long)dda_reads,
+              (unsigned long long)dda_cycles);
+    }
+    cfg.skip_empty = true;
+    model.set_config(cfg);
+    compare("sdf skip dda", model, ref);
+    cfg.memo = true;
+    model.set_config(cfg);
+    compare("sdf memo dda", model, ref);
+    cfg.memo = false;
+    cfg.dda = false;
+    model.set_config(cfg);
+    compare("sdf march", model, ref);
+    aim(cfg, -24, 32, 28, 0.2f, 0.1f);
+    model.set_config(cfg);
+    compare("sdf skip perspective", model, ref);
+    cfg.skip_empty = false;
+    model.set_config(cfg);
+    compare("sdf perspective", model, ref);
+    aim(cfg, 90, 70, 40, -2.4f, -0.5f);
+    model.set_config(cfg);
+    compare("sdf perspective pitched", model, ref);
+    aim(cfg, 6, 6, 30, 0.6f, 0.2f);
+    model.set_config(cfg);
+    compare("sdf perspective inside", model, ref);
+
+    // Solids dropped into open space and carved out of the sphere.
+    for (int i = 0; i < 6; ++i)
+        model.edit(field, VoxelModel::addr_of(20 + 6 * i, 40, 10 + 7 * i), 0x80FF0000AABBCC50ull);
+    for (int x = 28; x < 36; ++x)
+        model.edit(field, VoxelModel::addr_of(x, 32, 32), 0);
+    model.edit(field, VoxelModel::addr_of(20, 40, 10), 0);
+    {
+        std::vector<uint64_t> rebuilt = field;
+        distance_field_build(rebuilt.data(), 1);
+        CHECK(rebuilt == field, "sdf: incremental field differs from a rebuild");
+        CHECK(field_errors(field) == 0, "sdf edits: %zu wrong distances", field_errors(field));
+        CHECK(std::equal(field.begin(), field.end(), model.front().volume()),
+              "sdf edits: model volume differs from the field");
+    }
+    compare("sdf perspective edits", model, ref);
+    cfg = ModelConfig();
+    cfg.dda = true;
+    cfg.sdf = true;
+    model.set_config(cfg);
+    compare("sdf dda edits", model, ref);
+
+    // Pipelined DDA: the sequential DDA's pixels in under half the cycles,
+    // with skips and jumps, with the memo request ignored, and with the
+    // selection. Perspective keeps the sequential walk, and a march frame
+    // after the pipeline starts from the words it carried.
+    {
+        const std::vector<ModelPixel> seq = ref.out;
+        cfg.pipeline = true;
+        model.set_config(cfg);
+        compare("pipe sdf", model, ref);
+        cfg.sdf = false;
+        model.set_config(cfg);
+        compare("pipe", model, ref);
+        const size_t bad = count_pixel_mismatches(seq, ref.out);
+        CHECK(bad == 0, "pipe: %zu pixels differ from the sequential dda", bad);
+    }
+    {
+        cfg.pipeline = false;
+        model.set_config(cfg);
+        compare("pipe off", model, ref);
+        const uint64_t seq_cycles = ref.cycles;
+        cfg.pipeline = true;
+        model.set_config(cfg);
+        compare("pipe again", model, ref);
+        CHECK(ref.cycles * 2 < seq_cycles, "pipe: %llu cycles vs %llu sequential",
+              (unsigned long long)ref.cycles, (unsigned long long)seq_cycles);
+    }
+    cfg.skip_empty = true;
+    cfg.sdf = true;
+    model.set_config(cfg);
+    compare("pipe skip sdf", model, ref);
+    cfg.memo = true;
+    cfg.smooth_surfaces = false;
+    cfg.sel_active = true;
+    cfg.sel_x = 14;
+    cfg.sel_y = 32;
+    cfg.sel_z = 32;
+    model.set_config(cfg);
+    compare("pipe memo selection", model, ref);
+    model.set_config(ModelConfig());
+    compare("legacy after pipe", model, ref);
+    cfg = ModelConfig();
+    cfg.dda = true;
+    cfg.pipeline = true;
+    aim(cfg, -24, 32, 28, 0.2f, 0.1f);
+    model.set_config(cfg);
+    compare("pipe perspective", model, ref);
+    CHECK(!ref.pipelined, "pipe perspective: pipelined");
+
+    // Lanes: rows interleaved over several cores, each carrying its own
+    // registers from row to row and frame to frame. The odd height leaves
+    // the lanes different row counts.
+    {
+        ModelSet  set = make_odd_fixture();
+        LaneArray lanes(kOddW, kOddH, 3);
+        ModelConfig lcfg;
+        lcfg.lanes = 3;
+        set.set_config(lcfg);
+        compare_lanes("lanes", set, lanes);
+        compare_lanes("lanes again", set, lanes);
+        lcfg.memo = true;
+        set.set_config(lcfg);
+        compare_lanes("lanes memo", set, lanes);
+        lcfg.memo = false;
+        lcfg.dda = true;
+        lcfg.skip_empty = true;
+        set.set_config(lcfg);
+        compare_lanes("lanes dda skip", set, lanes);
+        lcfg.pipeline = true;
+        set.set_config(lcfg);
+        compare_lanes("lanes pipe", set, lanes);
+        aim(lcfg, -20, 30, 24, 0.3f, 0.1f);
+        set.set_config(lcfg);
+        compare_lanes("lanes perspective", set, lanes);
+        lcfg = ModelConfig();
+        lcfg.lanes = 3;
+        lcfg.diag_slice = true;
+        set.set_config(lcfg);
+        compare_lanes("lanes slice", set, lanes);
+    }
+    {
+        cfg = ModelConfig();
+        cfg.dda = true;
+        model.set_config(cfg);
+        compare("one lane dda", model, ref);
+        const uint64_t one_lane = ref.cycles;
+        LaneArray lanes(ref, 4);
+        cfg.lanes = 4;
+        model.set_config(cfg);
+        compare_lanes("world lanes dda", model, lanes);
+        CHECK(lanes.frame.cycles * 3 < one_lane, "lanes: %llu cycles vs %llu on one lane",
+              (unsigned long long)lanes.frame.cycles, (unsigned long long)one_lane);
+        cfg.pipeline = true;
+        cfg.sdf = true;
+        model.set_config(cfg);
+        compare_lanes("world lanes pipe sdf", model, lanes);
+        cfg = ModelConfig();
+        cfg.lanes = 4;
+        model.set_config(cfg);
+        compare_lanes("world lanes", model, lanes);
+    }
+
+    // Tile order: each order visits every cell of the square once, Hilbert
+    // steps only between neighbours, and each order renders as the
+    // transcribed walk does.
+    for (int order = 1; order < 4; ++order)
+        for (int bits = 1; bits <= 5; ++bits) {
+            const uint32_t n = 1u << bits;
+            std::vector<uint8_t> seen(size_t(n) * n, 0);
+            size_t bad = 0, jumps = 0;
+            int px = 0, py = 0;
+            for (uint32_t d = 0; d < n * n; ++d) {
+                int tx, ty;
+                VoxelModel::tile_cell(order, bits, d, tx, ty);
+                bad += tx < 0 || ty < 0 || uint32_t(tx) >= n || uint32_t(ty) >= n ||
+                       seen[size_t(ty) * n + size_t(tx)]++;
+                jumps += d && std::abs(tx - px) + std::abs(ty - py) != 1;
+                px = tx;
+                py = ty;
+            }
+            CHECK(bad == 0, "tile order %d/%d: %zu cells not a permutation", order, bits, bad);
+            CHECK(order != 3 || jumps == 0, "hilbert %d: %zu jumps", bits, jumps);
+        }
+    {
+        ModelSet set = make_odd_fixture();
+        FsmCore  ref(kOddW, kOddH);
+        ModelConfig tcfg;
+        tcfg.dda = true;
+        set.set_config(tcfg);
+        compare("raster dda", set, ref);
+        const std::vector<ModelPixel> raster = set.front().pixels();
+        const uint64_t raster_cycles = set.front().cycles();
+        for (int order : {2, 3}) {
+            const std::string name = order == 2 ? "morton" : "hilbert";
+            tcfg = ModelConfig();
+            tcfg.tile_order = order;
+            set.set_config(tcfg);
+            compare((name + " march").c_str(), set, ref);
+            tcfg.dda = true;
+            set.set_config(tcfg);
+            compare((name + " dda").c_str(), set, ref);
+            for (ModelSet::Tiled& t : set.tiled)
+                CHECK(!t.renderer->stats().fallback && !t.renderer->tile_times().empty(),
+                      "%s dda: %s fell back to the single-thread model", name.c_str(),
+                      t.name.c_str());
+            CHECK(count_pixel_mismatches(set.front().pixels(), raster) == 0,
+                  "%s dda: pixels differ from raster", name.c_str());
+            CHECK(set.front().cycles() == raster_cycles + uint64_t(set.front().tile_cells(kOddH)),
+                  "%s dda: %llu cycles vs %llu raster", name.c_str(),
+                  (unsigned long long)set.front().cycles(), (unsigned long long)raster_cycles);
+            tcfg.memo = true;
+            set.set_config(tcfg);
+            compare((name + " memo ignored").c_str(), set, ref);
+            tcfg.memo = false;
+            tcfg.pipeline = true;
+            tcfg.skip_empty = true;
+            set.set_config(tcfg);
+            compare((name + " pipe").c_str(), set, ref);
+            aim(tcfg, -20, 30, 24, 0.3f, 0.1f);
+            set.set_config(tcfg);
+            compare((name + " perspective").c_str(), set, ref);
+        }
+        LaneArray lanes(kOddW, kOddH, 3);
+        for (int order : {1, 3}) {
+            tcfg = ModelConfig();
+            tcfg.lanes = 3;
+            tcfg.tile_order = order;
+            tcfg.dda = true;
+            set.set_config(tcfg);
+            compare_lanes("lanes tiles dda", set, lanes);
+            tcfg.pipeline = true;
+            set.set_config(tcfg);
+            compare_lanes("lanes tiles pipe", set, lanes);
+            tcfg.pipeline = false;
+            aim(tcfg, -20, 30, 24, 0.3f, 0.1f);
+            set.set_config(tcfg);
+            compare_lanes("lanes tiles perspective", set, lanes);
+        }
+    }
+
+    // Composite: the world_gen sphere is water at alpha 255, so every ray
+    // that meets it ends on its first voxel and pixels stay those of the
+    // plain walk. Then a water pane (alpha 120) and a glass one (alpha 60)
+    // in front of it blend on the way in, at the default threshold, at one
+    // the two panes reach (the glass ends the ray) and at 0 (the water
+    // does), orthographic and perspective, tiled, with the pipeline and
+    // memo requests ignored, and over lanes.
+    {
+        ModelSet set = make_odd_fixture();
+        FsmCore  ref(kOddW, kOddH);
+        ModelConfig ccfg;
+        ccfg.dda = true;
+        set.set_config(ccfg);
+        compare("plain dda", set, ref);
+        const std::vector<ModelPixel> plain = set.front().pixels();
+        ccfg.composite = true;
+        set.set_config(ccfg);
+        compare("composite dda", set, ref);
+        for (ModelSet::Tiled& t : set.tiled)
+            CHECK(t.renderer->stats().fallback &&
+                      std::strcmp(t.renderer->stats().fallback, "composite") == 0,
+                  "composite dda: %s does not report its fallback", t.name.c_str());
+        CHECK(count_pixel_mismatches(set.front().pixels(), plain) == 0,
+              "composite dda: opaque water differs from the plain walk");
+        CHECK(set.front().ets_saved() > 0, "composite dda: no steps saved");
+
+        for (int y = 20; y < 44; ++y)
+            for (int z = 0; z < 64; ++z) {
+                set.write_voxel(VoxelModel::addr_of(54, y, z), 0x400078C82060C050ull);
+                set.write_voxel(VoxelModel::addr_of(50, y, z), 0x20003CC880E0FF20ull);
+            }
+        ccfg.composite = false;
+        set.set_config(ccfg);
+        compare("panes dda", set, ref);
+        ccfg.composite = true;
+        set.set_config(ccfg);
+        compare("panes composite", set, ref);
+        const uint32_t saved_default = set.front().ets_saved();
+        ccfg.alpha_threshold = 128;
+        set.set_config(ccfg);
+        compare("panes composite 128", set, ref);
+        CHECK(set.front().ets_saved() > saved_default, "composite 128: %u steps saved vs %u",
+              set.front().ets_saved(), saved_default);
+        ccfg.alpha_threshold = 0;
+        set.set_config(ccfg);
+        compare("panes composite 0", set, ref);
+        ccfg.alpha_threshold = 243;
+        ccfg.skip_empty = true;
+        ccfg.pipeline = true;
+        ccfg.memo = true;
+        set.set_config(ccfg);
+        compare("panes composite pipe/memo ignored", set, ref);
+        ccfg.tile_order = 3;
+        set.set_config(ccfg);
+        compare("panes composite hilbert", set, ref);
+        ccfg = ModelConfig();
+        ccfg.composite = true;
+        aim(ccfg, 84, 30, 32, 3.1f, 0.05f);
+        set.set_config(ccfg);
+        compare("panes composite perspective", set, ref);
+        ccfg.alpha_threshold = 100;
+        set.set_config(ccfg);
+        compare("panes composite perspective 100", set, ref);
+
+        LaneArray lanes(kOddW, kOddH, 3);
+        ccfg = ModelConfig();
+        ccfg.lanes = 3;
+        ccfg.dda = true;
+        ccfg.composite = true;
+        set.set_config(ccfg);
+        compare_lanes("lanes composite", set, lanes);
+    }
+
+    // Layouts: bijective, RTL bit order, and a volume survives the round trip.
+    for (VoxelLayout l : {VoxelLayout::Xyz, VoxelLayout::Morton, VoxelLayout::Brick}) {
+        std::vector<uint8_t> seen(kLayoutVoxels, 0);
+        size_t bad = 0;
+        for (uint32_t a = 0; a < kLayoutVoxels; ++a) {
+            const uint32_t i = voxel_layout_index(l, a);
+            bad += i >= kLayoutVoxels || seen[i]++ || voxel_layout_xyz(l, i) != a;
+        }
+        CHECK(bad == 0, "layout %s: %zu addresses not a permutation", voxel_layout_name(l), bad);
+        std::vector<uint64_t> stored(kLayoutVoxels), back(kLayoutVoxels);
+        voxel_layout_convert(VoxelLayout::Xyz, l, field.data(), stored.data());
+        voxel_layout_convert(l, VoxelLayout::Xyz, stored.data(), back.data());
+        CHECK(back == field, "layout %s: round trip changed the volume", voxel_layout_name(l));
+    }
+    for (int x = 0; x < 64; x += 9)
+        for (int y = 0; y < 64; y += 7)
+            for (int z = 0; z < 64; z += 5) {
+                const uint32_t a = VoxelModel::addr_of(x, y, z);
+                uint32_t m = 0;
+                for (int b = 0; b < 6; ++b)
+                    m |= uint32_t(((x >> b) & 1) << (3 * b + 2) | ((y >> b) & 1) << (3 * b + 1) |
+                                  ((z >> b) & 1) << (3 * b));
+                CHECK(voxel_layout_index(VoxelLayout::Morton, a) == m, "morton (%d,%d,%d)", x, y, z);
+                const uint32_t brick = uint32_t((x >> 3) << 6 | (y >> 3) << 3 | (z >> 3));
+                const uint32_t local = uint32_t((x & 7) << 6 | (y & 7) << 3 | (z & 7));
+                CHECK(voxel_layout_index(VoxelLayout::Brick, a) == (brick << 9 | local),
+                      "brick (%d,%d,%d)", x, y, z);
+            }
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("voxel model: all checks passed (%zu SIMD level(s))\n", model.models.size());
+    return 0;
+}
@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Compiles and runs the SV benches in this directory with Icarus Verilog:
+# the cache bench, DMA loopback and the HDMI golden CRC. Any $error fails
+# the run. Exits 77 (ctest: skipped) without iverilog.
+
+HERE="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+RTL_DIR="$(cd "${HERE}/../../../rtl" && pwd)"
+IVERILOG="${IVERILOG:-iverilog}"
+VVP="${VVP:-vvp}"
+
+if ! command -v "${IVERILOG}" >/dev/null 2>&1; then
+  echo "[skip] ${IVERILOG} not found"
+  exit 77
+fi
+
+OUT="$(mktemp -d)"
+trap 'rm -rf "${OUT}"' EXIT
+
+run_bench() {
+  local name="$1"
+  shift
+  "${IVERILOG}" -g2012 -I"${RTL_DIR}" -o "${OUT}/${name}.vvp" "${HERE}/${name}.sv" "$@"
+  local status=0
+  "${VVP}" -n "${OUT}/${name}.vvp" >"${OUT}/${name}.log" 2>&1 || status=$?
+  if [ "${status}" -ne 0 ] || grep -q "ERROR" "${OUT}/${name}.log"; then
+    cat "${OUT}/${name}.log"
+    echo "[FAIL] ${name}"
+    return 1
+  fi
+  echo "[ok]   ${name}"
+}
+
+failed=0
+run_bench test_voxel_cache "${RTL_DIR}/voxel_cache.sv" || failed=1
+run_bench test_dma_loopback "${RTL_DIR}"/*.sv || failed=1
+run_bench test_hdmi_crc_golden "${RTL_DIR}"/*.sv || failed=1
+exit "${failed}"
@@ -0,0 +1,55 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Builds sim_voxel for every NUM_LANES x VOXEL_LAYOUT x VOXEL_CACHE variant
+# and checks a few headless frames per render mode against the C++ model
+# (--diff-model). Exits 77 (ctest: skipped) without Verilator.
+# Rebuilds sim/obj_dir and sim/sim_voxel in place.
+
+SIM_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/../.." && pwd)"
+VERILATOR="${VERILATOR:-verilator}"
+FRAMES="${FRAMES:-3}"
+
+if ! command -v "${VERILATOR}" >/dev/null 2>&1; then
+  echo "[skip] ${VERILATOR} not found"
+  exit 77
+fi
+
+MODES=(
+  ""
+  "--skip-empty"
+  "--dda"
+  "--dda --skip-empty"
+  "--dda --sdf"
+  "--dda --pipeline"
+  "--dda --composite"
+  "--dda --tile-order hilbert"
+  "--perspective"
+  "--perspective --memo"
+  "--perspective --composite"
+  "--perspective --tile-order tiles"
+  "--perspective --tile-order morton"
+  "--tile-order hilbert"
+  "--perspective --model-tiles 2"
+)
+
+failed=0
+for lanes in 1 4; do
+  for layout in xyz morton brick; do
+    for cache in 0 1; do
+      knobs="NUM_LANES=${lanes} VOXEL_LAYOUT=${layout} VOXEL_CACHE=${cache}"
+      echo "[build] ${knobs}"
+      make -C "${SIM_DIR}" -s sim_voxel ${knobs} >/dev/null
+      for mode in "${MODES[@]}"; do
+        # shellcheck disable=SC2086
+        if "${SIM_DIR}/sim_voxel" --headless --frames "${FRAMES}" --diff-model ${mode} >/dev/null; then
+          echo "[ok]   ${knobs} ${mode:-(ortho)}"
+        else
+          echo "[FAIL] ${knobs} ${mode:-(ortho)}"
+          failed=1
+        fi
+      done
+    done
+  done
+done
+exit "${failed}"
@@ -133,7 +133,8 @@ module test_dma_loopback;
         .hdmi_line_count(hdmi_line_count),
         .hdmi_pixel_in_line(hdmi_pixel_in_line),
         .irq_out(irq_out),
-        .msi_pulse(msi_pulse)
+        .msi_pulse(msi_pulse),
+        .frame_tick(1'b0)
     );
 
     // Clock
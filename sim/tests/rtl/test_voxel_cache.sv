@@ -0,0 +1,338 @@
+// SV bench for rtl/voxel_cache.sv against a behavioural AXI read slave:
+// hit and miss, a fill shared by ports missing on one line, eviction, a
+// write during a fill and to a cached line, and the miss queue full.
+//   iverilog -g2012 -o cache.vvp sim/tests/rtl/test_voxel_cache.sv rtl/voxel_cache.sv
+//   vvp cache.vvp
+`timescale 1ns/1ps
+
+module test_voxel_cache;
+    localparam integer READ_PORTS = 2;
+    localparam integer SETS       = 4;
+    localparam integer WAYS       = 2;
+    localparam integer LINE_WORDS = 8;
+    localparam integer MISS_DEPTH = 2;
+    // Addresses one line apart share a set every SETS lines.
+    localparam integer SET_STRIDE = SETS * LINE_WORDS;
+
+    reg clk = 0;
+    reg rst_n = 0;
+
+    reg  [READ_PORTS*18-1:0] read_addr = 0;
+    reg  [READ_PORTS-1:0]    read_req  = 0;
+    reg  [READ_PORTS-1:0]    read_en   = 0;
+    wire [READ_PORTS-1:0]    read_hit;
+    wire [READ_PORTS*8-1:0]  read_data;
+    reg  [17:0]              payload_addr = 0;
+    reg                      payload_req  = 0;
+    reg                      payload_en   = 0;
+    wire                     payload_hit;
+    wire [63:0]              payload_data;
+    reg  [17:0]              write_addr = 0;
+    reg                      write_en   = 0;
+    reg  [63:0]              write_data = 0;
+    reg                      clear_stats = 0;
+    wire [31:0]              hits, misses, evictions;
+
+    wire [3:0]  m_axi_arid;
+    wire [20:0] m_axi_araddr;
+    wire [7:0]  m_axi_arlen;
+    wire [2:0]  m_axi_arsize;
+    wire [1:0]  m_axi_arburst;
+    wire        m_axi_arvalid;
+    wire        m_axi_arready;
+    reg  [63:0] m_axi_rdata  = 0;
+    reg         m_axi_rlast  = 0;
+    reg         m_axi_rvalid = 0;
+    wire        m_axi_rready;
+
+    voxel_cache #(
+        .READ_PORTS(READ_PORTS),
+        .SETS(SETS),
+        .WAYS(WAYS),
+        .LINE_WORDS(LINE_WORDS),
+        .MISS_DEPTH(MISS_DEPTH)
+    ) dut (
+        .clk(clk),
+        .rst_n(rst_n),
+        .read_addr(read_addr),
+        .read_req(read_req),
+        .read_en(read_en),
+        .read_hit(read_hit),
+        .read_data(read_data),
+        .payload_addr(payload_addr),
+        .payload_req(payload_req),
+        .payload_en(payload_en),
+        .payload_hit(payload_hit),
+        .payload_data(payload_data),
+        .write_addr(write_addr),
+        .write_en(write_en),
+        .write_data(write_data),
+        .clear_stats(clear_stats),
+        .hits(hits),
+        .misses(misses),
+        .evictions(evictions),
+        .m_axi_arid(m_axi_arid),
+        .m_axi_araddr(m_axi_araddr),
+        .m_axi_arlen(m_axi_arlen),
+        .m_axi_arsize(m_axi_arsize),
+        .m_axi_arburst(m_axi_arburst),
+        .m_axi_arvalid(m_axi_arvalid),
+        .m_axi_arready(m_axi_arready),
+        .m_axi_rid(4'd0),
+        .m_axi_rdata(m_axi_rdata),
+        .m_axi_rresp(2'b00),
+        .m_axi_rlast(m_axi_rlast),
+        .m_axi_rvalid(m_axi_rvalid),
+        .m_axi_rready(m_axi_rready)
+    );
+
+    always #5 clk = ~clk;
+
+    // ------------------------------------------------------------------
+    // Backing volume and AXI read slave: one burst at a time, one beat per
+    // clock. ar_hold keeps a fill waiting on its address.
+    // ------------------------------------------------------------------
+    reg [63:0] mem [0:(1<<18)-1];
+    reg        ar_hold = 0;
+    reg        r_busy  = 0;
+    reg [17:0] r_index;
+    reg [7:0]  r_left;
+    integer    bursts = 0;
+
+    assign m_axi_arready = !ar_hold && !r_busy && !m_axi_rvalid;
+
+    always @(posedge clk) begin
+        if (m_axi_arvalid && m_axi_arready) begin
+            if (m_axi_arlen != LINE_WORDS - 1 || m_axi_arsize != 3'd3 || m_axi_arburst != 2'b01)
+                $error("Bad burst: len=%0d size=%0d burst=%0d", m_axi_arlen, m_axi_arsize, m_axi_arburst);
+            r_busy  <= 1'b1;
+            r_index <= m_axi_araddr[20:3];
+            r_left  <= m_axi_arlen;
+            bursts  <= bursts + 1;
+        end else if (r_busy && (!m_axi_rvalid || m_axi_rready)) begin
+            m_axi_rvalid <= 1'b1;
+            m_axi_rdata  <= mem[r_index];
+            m_axi_rlast  <= r_left == 0;
+            r_index      <= r_index + 1'b1;
+            r_left       <= r_left - 1'b1;
+            if (r_left == 0)
+                r_busy <= 1'b0;
+        end else if (m_axi_rvalid && m_axi_rready) begin
+            m_axi_rvalid <= 1'b0;
+            m_axi_rlast  <= 1'b0;
+        end
+    end
+
+    // Odd words are solid; the low byte gives the material and distance
+    // nibbles, so every trace byte differs from its neighbours'.
+    function automatic [63:0] volume_word;
+        input [17:0] index;
+    begin
+        volume_word = {16'h0000, index[0] ? 8'd200 : 8'd0, 14'd0, index, index[7:0]};
+    end
+    endfunction
+
+    function automatic [7:0] trace_byte;
+        input [63:0] word;
+        reg solid;
+    begin
+        solid      = word != 64'd0 && word[47:40] > 8'd10;
+        trace_byte = {solid, solid && (word[7:4] == 4'd2 || word[7:4] == 4'd5), 2'b00, word[3:0]};
+    end
+    endfunction
+
+    integer i;
+    integer errors = 0;
+
+    task check(input cond, input [8*64-1:0] what);
+    begin
+        if (!cond) begin
+            $error("%0s", what);
+            errors = errors + 1;
+        end
+    end
+    endtask
+
+    task clear_counters;
+    begin
+        clear_stats = 1;
+        @(posedge clk); #1;
+        clear_stats = 0;
+    end
+    endtask
+
+    // Request addr on trace port p until it hits, then take the word.
+    task trace_read(input integer p, input [17:0] addr);
+        integer to;
+    begin
+        read_addr[p*18 +: 18] = addr;
+        read_req[p] = 1;
+        to = 200;
+        #1;
+        while (!read_hit[p] && to > 0) begin
+            @(posedge clk); #1;
+            to = to - 1;
+        end
+        check(read_hit[p], "trace read never hit");
+        read_en[p] = 1;
+        @(posedge clk); #1;
+        read_en[p]  = 0;
+        read_req[p] = 0;
+        check(read_data[p*8 +: 8] == trace_byte(mem[addr]), "trace byte mismatch");
+    end
+    endtask
+
+    task payload_read(input [17:0] addr);
+        integer to;
+    begin
+        payload_addr = addr;
+        payload_req  = 1;
+        to = 200;
+        #1;
+        while (!payload_hit && to > 0) begin
+            @(posedge clk); #1;
+            to = to - 1;
+        end
+        check(payload_hit, "payload read never hit");
+        payload_en = 1;
+        @(posedge clk); #1;
+        payload_en  = 0;
+        payload_req = 0;
+        check(payload_data == mem[addr], "payload word mismatch");
+    end
+    endtask
+
+    task wait_fill_idle;
+        integer to;
+    begin
+        @(posedge clk); #1;
+        to = 200;
+        while ((dut.fill_state != 0 || dut.mq_count != 0) && to > 0) begin
+            @(posedge clk); #1;
+            to = to - 1;
+        end
+        check(to > 0, "fill never finished");
+    end
+    endtask
+
+    task probe(input [17:0] addr, input expect_hit, input [8*64-1:0] what);
+    begin
+        payload_addr = addr;
+        #1;
+        check(payload_hit == expect_hit, what);
+    end
+    endtask
+
+    initial begin
+        $display("Starting voxel cache test...");
+        for (i = 0; i < (1 << 18); i = i + 1)
+            mem[i] = volume_word(i);
+        #20 rst_n = 1;
+        @(posedge clk); #1;
+
+        // Miss, fill, then hits on both planes of the filled line.
+        probe(18'h00010, 1'b0, "cold cache hit");
+        clear_counters;
+        trace_read(0, 18'h00011);
+        check(misses == 1 && bursts == 1, "first read: expected one miss and one burst");
+        trace_read(1, 18'h00013);
+        payload_read(18'h00016);
+        check(bursts == 1, "reads of a filled line went to memory");
+        check(hits == 3, "expected three hits counted");
+
+        // Three ports missing on one line share one fill.
+        clear_counters;
+        bursts = 0;
+        read_addr    = {18'h00041, 18'h00042};
+        read_req     = 2'b11;
+        payload_addr = 18'h00047;
+        payload_req  = 1;
+        wait_fill_idle;
+        check(misses == 1 && bursts == 1, "shared line: expected one miss and one burst");
+        check(read_hit == 2'b11 && payload_hit, "shared line: not every port hits");
+        read_req    = 0;
+        payload_req = 0;
+
+        // A third line in set 0 evicts the round-robin way: the line at 0x40
+        // (first filled) goes, 0x40 + SET_STRIDE stays.
+        clear_counters;
+        trace_read(0, 18'h00040 + SET_STRIDE);
+        check(evictions == 0, "free way counted as eviction");
+        trace_read(0, 18'h00040 + 2 * SET_STRIDE);
+        check(evictions == 1, "expected one eviction");
+        probe(18'h00040, 1'b0, "evicted line still hits");
+        probe(18'h00040 + SET_STRIDE, 1'b1, "other way lost");
+        probe(18'h00040 + 2 * SET_STRIDE, 1'b1, "new line missing");
+
+        // A write to a cached line drops it; a read of the written word in
+        // the same clock returns the new word.
+        write_addr = 18'h00013;
+        write_data = 64'h0000_C800_0000_0025;
+        write_en   = 1;
+        read_addr[17:0] = 18'h00013;
+        read_en[0] = 1;
+        @(posedge clk); #1;
+        mem[18'h00013] = write_data;
+        write_en   = 0;
+        read_en[0] = 0;
+        check(read_data[7:0] == trace_byte(write_data), "write-first trace byte");
+        probe(18'h00010, 1'b0, "written line still cached");
+        trace_read(0, 18'h00013);
+        payload_read(18'h00013);
+
+        // A write to a line while its fill waits on the address channel
+        // spoils the fill; the next request fetches the new word.
+        ar_hold = 1;
+        clear_counters;
+        read_addr[17:0] = 18'h001D9;
+        read_req[0] = 1;
+        repeat (4) @(posedge clk);
+        #1;
+        check(dut.fill_state != 0, "fill did not start");
+        write_addr = 18'h001DD;
+        write_data = 64'h0000_FF00_0000_0051;
+        write_en   = 1;
+        @(posedge clk); #1;
+        mem[18'h001DD] = write_data;
+        write_en   = 0;
+        read_req[0] = 0;
+        ar_hold = 0;
+        wait_fill_idle;
+        probe(18'h001D8, 1'b0, "spoiled fill left the line valid");
+        payload_read(18'h001DD);
+        check(misses == 2, "spoiled line was not fetched again");
+        trace_read(1, 18'h001DD);
+
+        // MISS_DEPTH backpressure: one line filling and MISS_DEPTH queued,
+        // the fourth miss waits for room instead of being pushed or lost.
+        ar_hold = 1;
+        clear_counters;
+        bursts = 0;
+        read_addr[17:0] = 18'h20000;
+        read_req[0] = 1;
+        repeat (3) @(posedge clk);
+        #1;
+        read_addr    = {18'h20010, 18'h20008};
+        read_req     = 2'b11;
+        payload_addr = 18'h20018;
+        payload_req  = 1;
+        repeat (8) @(posedge clk);
+        #1;
+        check(dut.mq_count == MISS_DEPTH, "miss queue not full");
+        check(misses == MISS_DEPTH + 1, "miss pushed into a full queue");
+        check(!payload_hit, "fourth line hit while blocked");
+        ar_hold = 0;
+        wait_fill_idle;
+        check(misses == MISS_DEPTH + 2 && bursts == MISS_DEPTH + 2, "queued lines not all filled");
+        check(read_hit == 2'b11 && payload_hit, "blocked lines do not hit after the queue drained");
+        read_req    = 0;
+        payload_req = 0;
+        probe(18'h20000, 1'b1, "first blocked line lost");
+
+        if (errors == 0)
+            $display("voxel cache test PASSED");
+        else
+            $display("voxel cache test FAILED: %0d errors", errors);
+        $finish;
+    end
+endmodule
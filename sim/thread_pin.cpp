@@ -0,0 +1,98 @@
+// ============================================================================
+// thread_pin.cpp
+// - CPU list parsing and sched_setaffinity-based thread pinning.
+// ============================================================================
+#include "thread_pin.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+bool parse_cpu_list(const std::string& spec, std::vector<int>& out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t end = spec.find(',', pos);
+        if (end == std::string::npos) end = spec.size();
+        std::string item = spec.substr(pos, end - pos);
+        pos = end + 1;
+        if (item.empty()) return false;
+
+        char* rest = nullptr;
+        long lo = std::strtol(item.c_str(), &rest, 10);
+        long hi = lo;
+        if (*rest == '-') {
+            hi = std::strtol(rest + 1, &rest, 10);
+        }
+        if (*rest != '\0' || lo < 0 || hi < lo) return false;
+        for (long c = lo; c <= hi; ++c)
+            out.push_back(int(c));
+    }
+    return !out.empty();
+}
+
+#if defined(__linux__)
+
+std::vector<int> list_thread_ids() {
+    std::vector<int> tids;
+    DIR* d = opendir("/proc/self/task");
+    if (!d) return tids;
+    while (dirent* e = readdir(d)) {
+        if (e->d_name[0] == '.') continue;
+        tids.push_back(std::atoi(e->d_name));
+    }
+    closedir(d);
+    std::sort(tids.begin(), tids.end());
+    return tids;
+}
+
+static bool pin_tid(int tid, int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(tid, sizeof(set), &set) != 0) {
+        std::fprintf(stderr, "Warning: could not pin thread %d to cpu %d\n", tid, cpu);
+        return false;
+    }
+    return true;
+}
+
+int pin_sim_threads(const std::vector<int>& cpus, const std::vector<int>& before) {
+    if (cpus.empty()) return 0;
+
+    const int self = int(syscall(SYS_gettid));
+    int pinned = pin_tid(self, cpus[0]) ? 1 : 0;
+
+    size_t next = 1;
+    for (int tid : list_thread_ids()) {
+        if (tid == self) continue;
+        if (std::find(before.begin(), before.end(), tid) != before.end()) continue;
+        if (next >= cpus.size()) {
+            std::fprintf(stderr, "Warning: more sim threads than pinned cpus; thread %d left floating\n", tid);
+            continue;
+        }
+        if (pin_tid(tid, cpus[next++]))
+            ++pinned;
+    }
+    return pinned;
+}
+
+#else
+
+std::vector<int> list_thread_ids() {
+    return {};
+}
+
+int pin_sim_threads(const std::vector<int>&, const std::vector<int>&) {
+    std::fprintf(stderr, "Warning: thread pinning is only supported on Linux\n");
+    return 0;
+}
+
+#endif
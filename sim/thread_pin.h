@@ -0,0 +1,23 @@
+// ============================================================================
+// thread_pin.h
+// - CPU pinning for the simulation thread and Verilator worker threads.
+// - Linux only (sched_setaffinity on /proc/self/task entries); elsewhere the
+//   calls are no-ops that report failure.
+// ============================================================================
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Parse "0-7", "0,2,4" or "0-3,8-11" into a CPU list. Returns false on
+// malformed input.
+bool parse_cpu_list(const std::string& spec, std::vector<int>& out);
+
+// Thread ids of every thread in this process.
+std::vector<int> list_thread_ids();
+
+// Pin the calling thread to cpus[0] and every thread not in `before`
+// (i.e. threads spawned since the snapshot, such as the Verilator worker
+// pool) to cpus[1], cpus[2], ... in tid order. Returns the number of
+// threads pinned.
+int pin_sim_threads(const std::vector<int>& cpus, const std::vector<int>& before);
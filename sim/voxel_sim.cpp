@@ -0,0 +1,780 @@
+// ============================================================================
+// voxel_sim.cpp
+// - Verilator stepping, pixel drain and frame accounting for the voxel top.
+// ============================================================================
+#include "voxel_sim.h"
+#include "thread_pin.h"
+#include "pixel_ring.h"
+#include "scene/distance_field.h"
+#include "scene/hvx.h"
+#include "scene/voxel_layout.h"
+#include "model/voxel_model.h"
+
+#include <verilated.h>
+#include "Vvoxel_framebuffer_top.h"
+#include "Vvoxel_framebuffer_top___024root.h"
+
+#ifdef HYDRA_SAVABLE
+#include <verilated_save.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static const float FX = 256.0f;  // fixed-point scale
+
+// Written to <snapshot>.meta next to the serialized model so a stale or
+// foreign snapshot can be rejected before Verilator parses it (a layout
+// mismatch inside VerilatedRestore is fatal).
+struct SnapshotHeader {
+    char     magic[8];      // "HYDRASNP"
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved;
+    uint64_t rtl_hash;
+    uint64_t main_time;
+};
+static const char     kSnapshotMagic[8] = {'H','Y','D','R','A','S','N','P'};
+static const uint32_t kSnapshotVersion  = 1;
+
+static uint32_t pixel96_to_argb(uint32_t w0, uint32_t w1, uint32_t w2) {
+    (void)w0; (void)w2;
+    uint8_t r = (w1 >> 24) & 0xFF;
+    uint8_t g = (w1 >> 16) & 0xFF;
+    uint8_t b = (w1 >>  8) & 0xFF;
+    uint8_t a = 0xFF;
+    return (uint32_t(a) << 24) |
+           (uint32_t(r) << 16) |
+           (uint32_t(g) << 8)  |
+            uint32_t(b);
+}
+
+VoxelSim::VoxelSim(int width, int height)
+    : width_(width),
+      height_(height),
+      framebuffer_(size_t(width) * size_t(height), 0) {
+#ifdef HYDRA_DPI_PIXELS
+    argb_scratch_.resize(PixelRing::kCapacity);
+#endif
+    damage_.resize(width, height);
+    damage_.mark_all();
+    threads_before_model_ = list_thread_ids();
+    top_ = new Vvoxel_framebuffer_top;
+    top_->clk   = 0;
+    top_->rst_n = 0;
+    // Default AXI shell inputs (unused in this harness)
+    top_->cam_load        = 0;
+    top_->cam_x_in        = 0;
+    top_->cam_y_in        = 0;
+    top_->cam_z_in        = 0;
+    top_->cam_dir_x_in    = 0;
+    top_->cam_dir_y_in    = 0;
+    top_->cam_dir_z_in    = 0;
+    top_->cam_plane_x_in  = 0;
+    top_->cam_plane_y_in  = 0;
+    top_->flags_load      = 0;
+    top_->flag_smooth_in  = 0;
+    top_->flag_curvature_in = 0;
+    top_->flag_extra_light_in = 0;
+    top_->flag_diag_slice_in  = 0;
+    top_->flag_on_demand_in   = 0;
+    top_->flag_dda_in         = 0;
+    top_->flag_perspective_in = 0;
+    top_->flag_memo_in        = 0;
+    top_->flag_skip_empty_in  = 0;
+    top_->flag_sdf_in         = 0;
+    top_->flag_pipeline_in    = 0;
+    top_->flag_tile_order_in  = 0;
+    top_->flag_composite_in   = 0;
+    top_->alpha_threshold_in  = 243;
+    top_->sel_load        = 0;
+    top_->sel_active_in   = 0;
+    top_->sel_voxel_x_in  = 0;
+    top_->sel_voxel_y_in  = 0;
+    top_->sel_voxel_z_in  = 0;
+    top_->dbg_ext_write_en   = 0;
+    top_->dbg_ext_write_addr = 0;
+    top_->dbg_ext_write_data = 0;
+    top_->start_frame_ext   = 0;
+    top_->soft_reset_ext    = 0;
+    top_->frame_tick        = 0;
+}
+
+VoxelSim::~VoxelSim() {
+    top_->final();
+    delete top_;
+}
+
+void VoxelSim::tick() {
+    top_->clk = 1; top_->eval(); main_time++;
+    top_->clk = 0; top_->eval(); main_time++;
+}
+
+void VoxelSim::reset() {
+    top_->rst_n = 0;
+    for (int i = 0; i < 10; ++i)
+        tick();
+    top_->rst_n = 1;
+    hydra_pixel_ring().clear();
+
+    frame_start_time_  = main_time;
+    frame_start_wall_  = std::chrono::steady_clock::now();
+    pixels_this_frame_ = 0;
+    pixels_changed_    = 0;
+}
+
+bool VoxelSim::world_ready() const {
+    return top_->rootp->voxel_framebuffer_top__DOT__world_ready != 0;
+}
+
+uint64_t VoxelSim::run_until_world_ready(uint64_t max_cycles) {
+    uint64_t cycles = 0;
+    while (!world_ready() && cycles < max_cycles && !Verilated::gotFinish()) {
+        tick();
+        ++cycles;
+    }
+    // Frame accounting starts once the volume is populated.
+    frame_start_time_  = main_time;
+    frame_start_wall_  = std::chrono::steady_clock::now();
+    pixels_this_frame_ = 0;
+    pixels_changed_    = 0;
+    return cycles;
+}
+
+uint64_t VoxelSim::boot(const std::string& snapshot_path, bool* restored) {
+    if (restored) *restored = false;
+    reset();
+
+    if (!scene_path_.empty()) {
+        if (!load_scene(scene_path_))
+            std::fprintf(stderr, "Warning: falling back to voxel_world_gen\n");
+        else
+            return 0;
+    }
+
+    if (!snapshot_path.empty() && load_snapshot(snapshot_path)) {
+        if (restored) *restored = true;
+        return 0;
+    }
+
+    const uint64_t cycles = run_until_world_ready();
+    if (!snapshot_path.empty() && world_ready())
+        save_snapshot(snapshot_path);
+    return cycles;
+}
+
+static const uint32_t kGrid = 64;
+
+#if HYDRA_VOXEL_CACHE
+// The volume lives in vram; voxel_cache holds copies of some lines.
+uint64_t* VoxelSim::volume_words() {
+    auto& mem = top_->rootp->voxel_framebuffer_top__DOT__g_cached__DOT__vram__DOT__mem;
+    static_assert(sizeof(mem.m_storage) == sizeof(uint64_t) * kGrid * kGrid * kGrid,
+                  "unexpected Verilated vram layout");
+    return mem.m_storage;
+}
+
+const uint64_t* VoxelSim::volume_words() const {
+    return top_->rootp->voxel_framebuffer_top__DOT__g_cached__DOT__vram__DOT__mem.m_storage;
+}
+
+// Drop every way of the set the word maps to; the next read refetches it.
+void VoxelSim::sync_word(uint32_t index) {
+    auto& valid = top_->rootp->voxel_framebuffer_top__DOT__g_cached__DOT__cache__DOT__valid;
+    valid[(index / HYDRA_CACHE_LINE_WORDS) % HYDRA_CACHE_SETS] = 0;
+}
+#else
+uint64_t* VoxelSim::volume_words() {
+    auto& vox = top_->rootp->voxel_framebuffer_top__DOT__g_bram__DOT__geom_mem__DOT__vox;
+    static_assert(sizeof(vox.m_storage) == sizeof(uint64_t) * kGrid * kGrid * kGrid,
+                  "unexpected Verilated vox layout");
+    return vox.m_storage;
+}
+
+const uint64_t* VoxelSim::volume_words() const {
+    return top_->rootp->voxel_framebuffer_top__DOT__g_bram__DOT__geom_mem__DOT__vox.m_storage;
+}
+
+// voxel_memory_64 trace plane byte for a word:
+// {solid, translucent, 2'b0, word[3:0]}.
+static uint8_t trace_byte(uint64_t w) {
+    const bool     solid = w != 0 && ((w >> 40) & 0xFF) > 10;
+    const unsigned type  = unsigned(w >> 4) & 0xF;
+    const bool     glass = solid && (type == 2 || type == 5);
+    return uint8_t((solid ? 0x80 : 0) | (glass ? 0x40 : 0) | (w & 0xF));
+}
+
+void VoxelSim::sync_word(uint32_t index) {
+    top_->rootp->voxel_framebuffer_top__DOT__g_bram__DOT__geom_mem__DOT__trace.m_storage[index] =
+        trace_byte(volume_words()[index]);
+}
+#endif
+
+bool VoxelSim::load_scene(const std::string& hvx_path) {
+    HvxFile f;
+    std::string err;
+    if (!f.open(hvx_path, &err)) {
+        std::fprintf(stderr, "Warning: %s\n", err.c_str());
+        return false;
+    }
+    const HvxHeader& h = f.header();
+    if (h.dim_x != kGrid || h.dim_y != kGrid || h.dim_z != kGrid) {
+        std::fprintf(stderr, "Warning: %s is %ux%ux%u, voxel_memory_64 is %ux%ux%u\n",
+                     hvx_path.c_str(), h.dim_x, h.dim_y, h.dim_z, kGrid, kGrid, kGrid);
+        return false;
+    }
+
+    auto* root = top_->rootp;
+    uint64_t* vox = volume_words();
+    // A straight memcpy when the file is already in this build's layout.
+    voxel_layout_convert(VoxelLayout(h.layout), kVoxelLayout, f.words(), vox);
+
+    // voxel_occupancy and the trace plane (or the voxel cache) only learn
+    // the volume from write-port traffic, so rebuild the trace bytes (or
+    // drop the cached lines) and the shadow bits,
+    // brick counts and brick map to match. Occupancy works on {x,y,z}
+    // addresses whatever the RAM layout.
+    auto& solid_bits  = root->voxel_framebuffer_top__DOT__occ__DOT__solid_bits;
+    auto& brick_count = root->voxel_framebuffer_top__DOT__occ__DOT__brick_count;
+    auto& brick_occ   = root->voxel_framebuffer_top__DOT__occ__DOT__brick_occ;
+    for (uint32_t b = 0; b < 512; ++b)
+        brick_count.m_storage[b] = 0;
+    for (uint32_t i = 0; i < 16; ++i)
+        brick_occ.m_storage[i] = 0;
+    for (uint32_t i = 0; i < kGrid * kGrid * kGrid; ++i) {
+        const uint64_t w = vox[i];
+        const uint32_t a = voxel_layout_xyz(kVoxelLayout, i);
+        const bool solid = w != 0 && ((w >> 40) & 0xFF) > 10;
+        sync_word(i);
+        solid_bits.m_storage[a] = solid ? 1 : 0;
+        if (solid) {
+            const uint32_t b = ((a >> 15) << 6) | (((a >> 9) & 7) << 3) | ((a >> 3) & 7);
+            ++brick_count.m_storage[b];
+            brick_occ.m_storage[b >> 5] |= 1u << (b & 31);
+        }
+    }
+
+    // Pretend world_gen already ran: no world_start pulse, frames start on
+    // the next cycle.
+    root->voxel_framebuffer_top__DOT__world_started = 1;
+    root->voxel_framebuffer_top__DOT__world_ready   = 1;
+
+    frame_start_time_  = main_time;
+    frame_start_wall_  = std::chrono::steady_clock::now();
+    pixels_this_frame_ = 0;
+    pixels_changed_    = 0;
+    std::fprintf(stderr, "scene loaded from %s\n", hvx_path.c_str());
+    return true;
+}
+
+bool VoxelSim::dump_scene(const std::string& hvx_path) const {
+    const uint64_t* vox = volume_words();
+    std::string err;
+    if (!hvx_write(hvx_path, kGrid, kGrid, kGrid, vox, &err, uint32_t(kVoxelLayout))) {
+        std::fprintf(stderr, "Warning: %s\n", err.c_str());
+        return false;
+    }
+    return true;
+}
+
+const uint64_t* VoxelSim::volume_xyz() const {
+    const uint64_t* vox = volume_words();
+    if (kVoxelLayout == VoxelLayout::Xyz)
+        return vox;
+    xyz_scratch_.resize(kLayoutVoxels);
+    voxel_layout_convert(kVoxelLayout, VoxelLayout::Xyz, vox, xyz_scratch_.data());
+    return xyz_scratch_.data();
+}
+
+void VoxelSim::sync_model(VoxelModel& model) const {
+    const auto* root = top_->rootp;
+    model.load_volume(volume_xyz());
+
+    ModelConfig cfg;
+    cfg.smooth_surfaces = root->voxel_framebuffer_top__DOT__cfg_smooth_surfaces != 0;
+    cfg.extra_light     = root->voxel_framebuffer_top__DOT__cfg_extra_light != 0;
+    cfg.diag_slice      = root->voxel_framebuffer_top__DOT__cfg_diag_slice != 0;
+    cfg.dda             = root->voxel_framebuffer_top__DOT__cfg_dda != 0;
+    cfg.perspective     = root->voxel_framebuffer_top__DOT__cfg_perspective != 0;
+    cfg.memo            = root->voxel_framebuffer_top__DOT__cfg_memo != 0;
+    cfg.skip_empty      = root->voxel_framebuffer_top__DOT__cfg_skip_empty != 0;
+    cfg.sdf             = root->voxel_framebuffer_top__DOT__cfg_sdf != 0;
+    cfg.pipeline        = root->voxel_framebuffer_top__DOT__cfg_pipeline != 0;
+    cfg.tile_order      = root->voxel_framebuffer_top__DOT__cfg_tile_order & 3;
+    cfg.composite       = root->voxel_framebuffer_top__DOT__cfg_composite != 0;
+    cfg.alpha_threshold = root->voxel_framebuffer_top__DOT__cfg_alpha_threshold;
+    cfg.lanes           = HYDRA_NUM_LANES;
+    cfg.cam_x           = int16_t(root->voxel_framebuffer_top__DOT__cam_x);
+    cfg.cam_y           = int16_t(root->voxel_framebuffer_top__DOT__cam_y);
+    cfg.cam_z           = int16_t(root->voxel_framebuffer_top__DOT__cam_z);
+    cfg.cam_dir_x       = int16_t(root->voxel_framebuffer_top__DOT__cam_dir_x);
+    cfg.cam_dir_y       = int16_t(root->voxel_framebuffer_top__DOT__cam_dir_y);
+    cfg.cam_dir_z       = int16_t(root->voxel_framebuffer_top__DOT__cam_dir_z);
+    cfg.cam_plane_x     = int16_t(root->voxel_framebuffer_top__DOT__cam_plane_x);
+    cfg.cam_plane_y     = int16_t(root->voxel_framebuffer_top__DOT__cam_plane_y);
+    cfg.sel_active      = root->voxel_framebuffer_top__DOT__sel_active != 0;
+    cfg.sel_x           = uint8_t(root->voxel_framebuffer_top__DOT__sel_voxel_x);
+    cfg.sel_y           = uint8_t(root->voxel_framebuffer_top__DOT__sel_voxel_y);
+    cfg.sel_z           = uint8_t(root->voxel_framebuffer_top__DOT__sel_voxel_z);
+    model.set_config(cfg);
+}
+
+void VoxelSim::set_keep_words(bool on) {
+    keep_words_ = on;
+    words_.assign(on ? framebuffer_.size() * 3 : 0, 0);
+}
+
+bool VoxelSim::snapshots_supported() {
+#ifdef HYDRA_SAVABLE
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef HYDRA_SAVABLE
+
+bool VoxelSim::save_snapshot(const std::string& path) const {
+    SnapshotHeader hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, kSnapshotMagic, sizeof(hdr.magic));
+    hdr.version   = kSnapshotVersion;
+    hdr.width     = uint32_t(width_);
+    hdr.height    = uint32_t(height_);
+    hdr.rtl_hash  = HYDRA_RTL_HASH;
+    hdr.main_time = main_time;
+
+    const std::string meta = path + ".meta";
+    std::remove(meta.c_str());
+
+    VerilatedSave os;
+    os.open(path.c_str());
+    if (!os.isOpen()) {
+        std::fprintf(stderr, "Warning: cannot write snapshot %s\n", path.c_str());
+        return false;
+    }
+    os << *top_;
+    os.close();
+
+    // Meta last: a crash mid-save leaves no valid meta, so the snapshot is
+    // regenerated next time.
+    FILE* f = std::fopen(meta.c_str(), "wb");
+    if (!f || std::fwrite(&hdr, sizeof(hdr), 1, f) != 1) {
+        if (f) std::fclose(f);
+        std::fprintf(stderr, "Warning: cannot write %s\n", meta.c_str());
+        return false;
+    }
+    std::fclose(f);
+    std::fprintf(stderr, "snapshot saved to %s\n", path.c_str());
+    return true;
+}
+
+bool VoxelSim::load_snapshot(const std::string& path) {
+    const std::string meta = path + ".meta";
+    FILE* f = std::fopen(meta.c_str(), "rb");
+    if (!f)
+        return false;
+    SnapshotHeader hdr;
+    const bool got_hdr = std::fread(&hdr, sizeof(hdr), 1, f) == 1;
+    std::fclose(f);
+
+    if (!got_hdr ||
+        std::memcmp(hdr.magic, kSnapshotMagic, sizeof(hdr.magic)) != 0 ||
+        hdr.version != kSnapshotVersion) {
+        std::fprintf(stderr, "Warning: %s is not a sim_voxel snapshot, regenerating\n",
+                     path.c_str());
+        return false;
+    }
+    if (hdr.rtl_hash != HYDRA_RTL_HASH) {
+        std::fprintf(stderr,
+            "Warning: snapshot %s is from a different RTL build (%016llx, want %016llx), regenerating\n",
+            path.c_str(), (unsigned long long)hdr.rtl_hash,
+            (unsigned long long)HYDRA_RTL_HASH);
+        return false;
+    }
+    if (hdr.width != uint32_t(width_) || hdr.height != uint32_t(height_)) {
+        std::fprintf(stderr, "Warning: snapshot %s is %ux%u, want %dx%d, regenerating\n",
+                     path.c_str(), hdr.width, hdr.height, width_, height_);
+        return false;
+    }
+
+    VerilatedRestore is;
+    is.open(path.c_str());
+    if (!is.isOpen())
+        return false;
+    is >> *top_;
+    is.close();
+
+    main_time = hdr.main_time;
+    hydra_pixel_ring().clear();
+    frame_start_time_  = main_time;
+    frame_start_wall_  = std::chrono::steady_clock::now();
+    pixels_this_frame_ = 0;
+    pixels_changed_    = 0;
+    std::fprintf(stderr, "snapshot restored from %s\n", path.c_str());
+    return true;
+}
+
+#else
+
+bool VoxelSim::save_snapshot(const std::string& path) const {
+    std::fprintf(stderr, "Warning: this build is not --savable, not writing %s\n",
+                 path.c_str());
+    return false;
+}
+
+bool VoxelSim::load_snapshot(const std::string& path) {
+    std::fprintf(stderr, "Warning: this build is not --savable, ignoring %s\n",
+                 path.c_str());
+    return false;
+}
+
+#endif
+
+void VoxelSim::apply_camera(const CameraPose& cam) {
+    auto* root = top_->rootp;
+    float dx = std::cos(cam.yaw) * std::cos(cam.pitch);
+    float dy = std::sin(cam.yaw) * std::cos(cam.pitch);
+    float dz = std::sin(cam.pitch);
+
+    float px = -dy * 0.66f;
+    float py =  dx * 0.66f;
+
+    root->voxel_framebuffer_top__DOT__cam_x       = int16_t(cam.pos_x * FX);
+    root->voxel_framebuffer_top__DOT__cam_y       = int16_t(cam.pos_y * FX);
+    root->voxel_framebuffer_top__DOT__cam_z       = int16_t(cam.pos_z * FX);
+    root->voxel_framebuffer_top__DOT__cam_dir_x   = int16_t(dx * FX);
+    root->voxel_framebuffer_top__DOT__cam_dir_y   = int16_t(dy * FX);
+    root->voxel_framebuffer_top__DOT__cam_dir_z   = int16_t(dz * FX);
+    root->voxel_framebuffer_top__DOT__cam_plane_x = int16_t(px * FX);
+    root->voxel_framebuffer_top__DOT__cam_plane_y = int16_t(py * FX);
+    // Root pokes bypass cam_load, so mark the scene dirty by hand.
+    root->voxel_framebuffer_top__DOT__scene_dirty = 1;
+}
+
+void VoxelSim::apply_flags(const RenderFlags& flags) {
+    auto* root = top_->rootp;
+    root->voxel_framebuffer_top__DOT__cfg_smooth_surfaces = flags.smooth_surfaces ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_curvature       = flags.curvature       ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_extra_light     = flags.extra_light     ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_diag_slice      = flags.diag_slice      ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_dda             = flags.dda             ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_perspective     = flags.perspective     ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_memo            = flags.memo            ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_skip_empty      = flags.skip_empty      ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_sdf             = flags.sdf             ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_pipeline        = flags.pipeline        ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_tile_order      = flags.tile_order & 3;
+    root->voxel_framebuffer_top__DOT__cfg_composite       = flags.composite       ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__cfg_alpha_threshold = flags.alpha_threshold;
+    root->voxel_framebuffer_top__DOT__scene_dirty         = 1;
+    if (flags.sdf && !distance_field_ && world_ready()) {
+        // Only non-solid words change, so voxel_occupancy is unaffected.
+        uint64_t* vox = volume_words();
+        if (kVoxelLayout == VoxelLayout::Xyz) {
+            distance_field_build(vox);
+        } else {
+            volume_xyz();
+            distance_field_build(xyz_scratch_.data());
+            voxel_layout_convert(VoxelLayout::Xyz, kVoxelLayout, xyz_scratch_.data(), vox);
+        }
+        for (uint32_t i = 0; i < kLayoutVoxels; ++i)
+            sync_word(i);
+        distance_field_ = true;
+    }
+}
+
+void VoxelSim::apply_selection(const SelectionState& sel) {
+    auto* root = top_->rootp;
+    root->voxel_framebuffer_top__DOT__sel_active  = sel.active ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__sel_voxel_x = sel.x;
+    root->voxel_framebuffer_top__DOT__sel_voxel_y = sel.y;
+    root->voxel_framebuffer_top__DOT__sel_voxel_z = sel.z;
+    root->voxel_framebuffer_top__DOT__scene_dirty = 1;
+}
+
+void VoxelSim::set_render_on_demand(bool on) {
+    auto* root = top_->rootp;
+    root->voxel_framebuffer_top__DOT__cfg_render_on_demand = on ? 1 : 0;
+    root->voxel_framebuffer_top__DOT__scene_dirty          = 1;
+}
+
+bool VoxelSim::idle() const {
+    const auto* root = top_->rootp;
+    return root->voxel_framebuffer_top__DOT__cfg_render_on_demand &&
+           world_ready() && !top_->core_busy &&
+           !root->voxel_framebuffer_top__DOT__start &&
+           !root->voxel_framebuffer_top__DOT__scene_dirty;
+}
+
+void VoxelSim::frame_tick() {
+    top_->frame_tick = 1;
+    tick();
+    top_->frame_tick = 0;
+}
+
+uint32_t VoxelSim::skipped_frames() const {
+    return top_->skipped_frames;
+}
+
+void VoxelSim::write_voxel(uint32_t addr, uint64_t data) {
+    auto* root = top_->rootp;
+    if (distance_field_) {
+        // Neighbours are poked directly, payload and trace byte; their
+        // solidity never changes, so the occupancy map doesn't need to see
+        // them. The edited word still goes through the port below.
+        uint64_t* vox = volume_words();
+        std::vector<uint32_t> changed;
+        if (kVoxelLayout == VoxelLayout::Xyz) {
+            vox[addr] = data;
+            distance_field_update(vox, addr, &changed);
+            data = vox[addr];
+            for (uint32_t a : changed)
+                sync_word(a);
+        } else {
+            volume_xyz();
+            xyz_scratch_[addr] = data;
+            distance_field_update(xyz_scratch_.data(), addr, &changed);
+            for (uint32_t a : changed) {
+                const uint32_t i = voxel_layout_index(kVoxelLayout, a);
+                vox[i] = xyz_scratch_[a];
+                sync_word(i);
+            }
+            data = xyz_scratch_[addr];
+        }
+    }
+    // The top clears dbg_write_en every cycle, so this is a one-cycle pulse.
+    root->voxel_framebuffer_top__DOT__dbg_write_addr = addr;
+    root->voxel_framebuffer_top__DOT__dbg_write_data = data;
+    root->voxel_framebuffer_top__DOT__dbg_write_en   = 1;
+}
+
+CursorInfo VoxelSim::cursor() const {
+    auto* root = top_->rootp;
+    CursorInfo c;
+    c.hit_valid   = root->voxel_framebuffer_top__DOT__cursor_hit_valid != 0;
+    c.x           = static_cast<uint8_t>(root->voxel_framebuffer_top__DOT__cursor_voxel_x);
+    c.y           = static_cast<uint8_t>(root->voxel_framebuffer_top__DOT__cursor_voxel_y);
+    c.z           = static_cast<uint8_t>(root->voxel_framebuffer_top__DOT__cursor_voxel_z);
+    c.material_id = static_cast<uint8_t>(root->voxel_framebuffer_top__DOT__cursor_material_id);
+    c.voxel_data  = static_cast<uint64_t>(root->voxel_framebuffer_top__DOT__cursor_voxel_data);
+    return c;
+}
+
+uint32_t VoxelSim::hit_count() const {
+    return top_->rootp->voxel_framebuffer_top__DOT__core_dbg_hit_count;
+}
+
+uint32_t VoxelSim::skip_count() const {
+    return top_->rootp->voxel_framebuffer_top__DOT__core_dbg_skip_count;
+}
+
+int VoxelSim::pin_threads(const std::vector<int>& cpus) {
+    return pin_sim_threads(cpus, threads_before_model_);
+}
+
+bool VoxelSim::got_finish() const {
+    return Verilated::gotFinish();
+}
+
+void VoxelSim::finish_frame(uint64_t end_time) {
+    auto now = std::chrono::steady_clock::now();
+
+    last_frame_.index          = frames_completed_;
+    last_frame_.sim_ticks      = end_time - frame_start_time_;
+    last_frame_.cycles         = last_frame_.sim_ticks / 2;
+    last_frame_.wall_seconds   = std::chrono::duration<double>(now - frame_start_wall_).count();
+    last_frame_.pixels_written = pixels_this_frame_;
+    last_frame_.pixels_changed = pixels_changed_;
+#ifdef HYDRA_DPI_PIXELS
+    {
+        const PixelRing& ring = hydra_pixel_ring();
+        const uint64_t drops = ring.overflows + ring.lost_marks;
+        last_frame_.ring_overflows = drops - ring_drops_seen_;
+        ring_drops_seen_ = drops;
+        if (last_frame_.ring_overflows)
+            std::fprintf(stderr, "frame %llu: pixel ring dropped %llu pixel(s)/frame mark(s); "
+                         "the frame is incomplete\n", (unsigned long long)frames_completed_,
+                         (unsigned long long)last_frame_.ring_overflows);
+    }
+#endif
+    last_frame_.hit_count      = hit_count();
+    last_frame_.skip_count     = skip_count();
+    last_frame_.ets_saved      = top_->rootp->voxel_framebuffer_top__DOT__core_dbg_ets_count;
+    // What FRAME_CYCLES reads once the top latches this frame's length on
+    // the next clock, and CYCLES_PER_PIXEL once its divider settles.
+    const auto* root = top_->rootp;
+    last_frame_.core_cycles = root->voxel_framebuffer_top__DOT__frame_cycle_cnt + 1u;
+    last_frame_.cycles_per_pixel =
+        double(last_frame_.core_cycles) / (double(width_) * height_);
+    for (int k = 0; k < HYDRA_NUM_LANES; ++k) {
+        LaneStats& l = last_frame_.lanes[k];
+        l.active_cycles  = root->voxel_framebuffer_top__DOT__lane_active_cycles[k];
+        l.payload_stalls = root->voxel_framebuffer_top__DOT__lane_payload_stalls[k];
+        l.pixel_stalls   = root->voxel_framebuffer_top__DOT__lane_pixel_stalls[k];
+        l.miss_stalls    = root->voxel_framebuffer_top__DOT__lane_miss_stalls[k];
+    }
+    last_frame_.fetch_reads = root->voxel_framebuffer_top__DOT__fetch_stats__DOT__reads;
+    last_frame_.fetch_reuse = root->voxel_framebuffer_top__DOT__fetch_stats__DOT__reuses;
+#if HYDRA_VOXEL_CACHE
+    last_frame_.cache_hits      = root->voxel_framebuffer_top__DOT__g_cached__DOT__cache__DOT__hits;
+    last_frame_.cache_misses    = root->voxel_framebuffer_top__DOT__g_cached__DOT__cache__DOT__misses;
+    last_frame_.cache_evictions = root->voxel_framebuffer_top__DOT__g_cached__DOT__cache__DOT__evictions;
+#endif
+
+    if (log_frames_) {
+        size_t nonzero = 0;
+        for (uint32_t v : framebuffer_) {
+            if (v != 0) ++nonzero;
+        }
+        uint32_t sample0 = framebuffer_.empty() ? 0 : framebuffer_[0];
+        uint32_t sample_mid = framebuffer_.empty() ? 0 : framebuffer_[framebuffer_.size()/2];
+        std::fprintf(stderr,
+            "frame %llu done, pixels_written=%llu nonzero=%zu sample0=%08x mid=%08x cycles=%llu\n",
+            (unsigned long long)last_frame_.index,
+            (unsigned long long)pixels_this_frame_, nonzero, sample0, sample_mid,
+            (unsigned long long)last_frame_.cycles);
+    }
+
+    ++frames_completed_;
+    frame_start_time_  = end_time;
+    frame_start_wall_  = now;
+    pixels_this_frame_ = 0;
+    pixels_changed_    = 0;
+    damage_.take(damage_rects_);
+}
+
+#ifdef HYDRA_DPI_PIXELS
+
+// Drain everything up to the next frame mark (or the whole ring if no frame
+// finished). Returns true if a frame was completed.
+bool VoxelSim::drain_pixels() {
+    PixelRing& ring = hydra_pixel_ring();
+    const size_t npix = framebuffer_.size();
+
+    uint64_t end = ring.head;
+    uint64_t end_time = 0;
+    const bool frame = ring.frame_pending();
+    if (frame) {
+        const uint32_t m = ring.mark_tail % PixelRing::kMaxMarks;
+        end      = ring.mark_pos[m];
+        end_time = ring.mark_time[m];
+        ++ring.mark_tail;
+    }
+
+    while (ring.tail < end) {
+        const uint32_t start = uint32_t(ring.tail) & PixelRing::kMask;
+        const size_t   len   = size_t(std::min<uint64_t>(end - ring.tail,
+                                                         PixelRing::kCapacity - start));
+        const uint32_t* addr = &ring.addr[start];
+        uint32_t* argb = argb_scratch_.data();
+
+        pixel96_to_argb_batch(&ring.w1[start], argb, len);
+
+        for (size_t i = 0; i < len; ++i) {
+            if (addr[i] < npix)
+                pixels_changed_ += damage_.write(framebuffer_, addr[i], argb[i]);
+        }
+        if (keep_words_) {
+            for (size_t i = 0; i < len; ++i) {
+                if (addr[i] < npix) {
+                    uint32_t* w = &words_[size_t(addr[i]) * 3];
+                    w[0] = ring.w0[start + i];
+                    w[1] = ring.w1[start + i];
+                    w[2] = ring.w2[start + i];
+                }
+            }
+        }
+
+        if (log_frames_) {
+            for (size_t i = 0; i < len && log_pixel_samples_ < 8; ++i, ++log_pixel_samples_) {
+                std::fprintf(stderr, "pix addr=%u w0=%08x w1=%08x w2=%08x argb=%08x\n",
+                             addr[i], ring.w0[start + i], ring.w1[start + i],
+                             ring.w2[start + i], argb[i]);
+            }
+        }
+
+        pixels_this_frame_ += len;
+        ring.tail += len;
+    }
+
+    if (frame)
+        finish_frame(end_time);
+    return frame;
+}
+
+bool VoxelSim::step(int max_cycles) {
+    const PixelRing& ring = hydra_pixel_ring();
+
+    int remaining = max_cycles;
+    while (remaining > 0) {
+        const int n = std::min(remaining, kDrainCycles);
+        int i = 0;
+        for (; i < n; ++i) {
+            top_->clk = 1; top_->eval(); main_time++;
+            top_->clk = 0; top_->eval(); main_time++;
+            if (ring.frame_pending()) {
+                ++i;
+                break;
+            }
+        }
+        remaining -= i;
+
+        if (drain_pixels())
+            return true;
+    }
+    return false;
+}
+
+#else
+
+bool VoxelSim::drain_pixels() {
+    return false;
+}
+
+bool VoxelSim::step(int max_cycles) {
+    const size_t npix = framebuffer_.size();
+
+    for (int i = 0; i < max_cycles; ++i) {
+        top_->clk = 1; top_->eval(); main_time++;
+
+        if (top_->pixel_write_en) {
+            uint32_t addr = top_->pixel_addr;
+            if (addr < npix) {
+                uint32_t w0 = top_->pixel_word0;
+                uint32_t w1 = top_->pixel_word1;
+                uint32_t w2 = top_->pixel_word2;
+                pixels_changed_ += damage_.write(framebuffer_, addr, pixel96_to_argb(w0, w1, w2));
+                if (keep_words_) {
+                    uint32_t* w = &words_[size_t(addr) * 3];
+                    w[0] = w0;
+                    w[1] = w1;
+                    w[2] = w2;
+                }
+
+                if (log_frames_ && log_pixel_samples_ < 8) {
+                    std::fprintf(stderr, "pix addr=%u w0=%08x w1=%08x w2=%08x argb=%08x\n",
+                                 addr, w0, w1, w2,
+                                 pixel96_to_argb(w0, w1, w2));
+                    ++log_pixel_samples_;
+                }
+            }
+            ++pixels_this_frame_;
+        }
+
+        const bool frame_done = top_->frame_done;
+
+        top_->clk = 0; top_->eval(); main_time++;
+
+        if (frame_done) {
+            finish_frame(main_time);
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif
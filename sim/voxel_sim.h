@@ -0,0 +1,281 @@
+// ============================================================================
+// voxel_sim.h
+// - Owns the Verilated voxel_framebuffer_top and steps it in cycle chunks.
+// - Drains pixel writes into an ARGB framebuffer and records per-frame stats.
+// - Shared by the SDL viewer and the headless benchmark mode.
+// ============================================================================
+#pragma once
+
+#include "damage_tracker.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Set by the sim_voxel_mt build (--threads N); 1 for the default build.
+#ifndef HYDRA_SIM_THREADS
+#define HYDRA_SIM_THREADS 1
+#endif
+
+// voxel_framebuffer_top NUM_LANES of this build (make NUM_LANES=n).
+#ifndef HYDRA_NUM_LANES
+#define HYDRA_NUM_LANES 1
+#endif
+
+// voxel_framebuffer_top VOXEL_CACHE of this build and the cache shape
+// (make VOXEL_CACHE=1 CACHE_SETS=s CACHE_LINE=w).
+#ifndef HYDRA_VOXEL_CACHE
+#define HYDRA_VOXEL_CACHE 0
+#endif
+#ifndef HYDRA_CACHE_SETS
+#define HYDRA_CACHE_SETS 64
+#endif
+#ifndef HYDRA_CACHE_LINE_WORDS
+#define HYDRA_CACHE_LINE_WORDS 8
+#endif
+
+// Hash of the RTL sources and Verilator flags, injected by sim/Makefile.
+// Snapshots taken from a different hash are rejected.
+#ifndef HYDRA_RTL_HASH
+#define HYDRA_RTL_HASH 0ULL
+#endif
+
+class Vvoxel_framebuffer_top;
+class VoxelModel;
+
+// Camera axes, z up (voxel y). The default sits outside the volume on -X,
+// level with the spheres, so perspective mode starts on the scene.
+struct CameraPose {
+    float pos_x = -24.0f;
+    float pos_y = 32.0f;
+    float pos_z = 28.0f;
+    float yaw   = 0.0f;
+    float pitch = 0.0f;
+};
+
+struct RenderFlags {
+    bool smooth_surfaces = true;
+    bool curvature       = true;
+    bool extra_light     = false;
+    bool diag_slice      = false;
+    bool dda             = false;   // render_config[2]: 3D-DDA traversal
+    bool perspective     = false;   // render_config[3]: camera rays
+    bool memo            = false;   // render_config[4]: ray memo
+    bool skip_empty      = false;   // render_config[5]: empty-space skipping
+    bool sdf             = false;   // render_config[6]: distance-field jumps
+    bool pipeline        = false;   // render_config[7]: pipelined DDA
+    int  tile_order      = 0;       // render_config[9:8]: raster, tiles, Morton, Hilbert
+    bool composite       = false;   // render_config[10]: alpha compositing
+    uint8_t alpha_threshold = 243;  // render_config[23:16]: composite early-end opacity
+};
+
+struct SelectionState {
+    bool    active = false;
+    uint8_t x = 0;
+    uint8_t y = 0;
+    uint8_t z = 0;
+};
+
+struct CursorInfo {
+    bool     hit_valid   = false;
+    uint8_t  x = 0;
+    uint8_t  y = 0;
+    uint8_t  z = 0;
+    uint8_t  material_id = 0;
+    uint64_t voxel_data  = 0;
+};
+
+// One raycaster lane's share of a frame, in core clocks.
+struct LaneStats {
+    uint64_t active_cycles  = 0;   // busy and not stalled
+    uint64_t payload_stalls = 0;   // lost the shared payload port
+    uint64_t pixel_stalls   = 0;   // pixel hold still full
+    uint64_t miss_stalls    = 0;   // waiting on a voxel cache line fill
+};
+
+struct FrameStats {
+    uint64_t index          = 0;
+    uint64_t sim_ticks      = 0;   // main_time delta (two ticks per clock)
+    uint64_t cycles         = 0;   // rising clock edges
+    double   wall_seconds   = 0.0;
+    uint64_t pixels_written = 0;
+    uint64_t pixels_changed = 0;   // writes that differed from the last frame
+    uint64_t ring_overflows = 0;   // pixels and marks the DPI ring dropped; nonzero = incomplete
+    uint32_t hit_count      = 0;
+    uint32_t skip_count     = 0;   // empty bricks skipped (skip_empty only)
+    uint32_t ets_saved      = 0;   // voxels early ray termination left unread (ETS_SAVED)
+    double   cycles_per_pixel = 0.0;   // core clocks per pixel (CYCLES_PER_PIXEL)
+    uint64_t core_cycles    = 0;   // start to done, as FRAME_CYCLES reads it
+    LaneStats lanes[HYDRA_NUM_LANES];
+    // voxel_cache, as CACHE_HITS / CACHE_MISSES / CACHE_EVICTIONS read
+    uint32_t cache_hits      = 0;
+    uint32_t cache_misses    = 0;
+    uint32_t cache_evictions = 0;
+    // voxel_fetch_stats, as FETCH_READS / FETCH_REUSE read
+    uint32_t fetch_reads     = 0;
+    uint32_t fetch_reuse     = 0;
+
+    // Share of the frame's trace reads whose line was recently read.
+    double fetch_reuse_rate() const {
+        return fetch_reads ? double(fetch_reuse) / double(fetch_reads) : 0.0;
+    }
+
+    // Share of the frame lane k spent working.
+    double lane_utilisation(int k) const {
+        return core_cycles ? double(lanes[k].active_cycles) / double(core_cycles) : 0.0;
+    }
+
+    double mcycles_per_second() const {
+        return wall_seconds > 0.0 ? double(cycles) / wall_seconds / 1e6 : 0.0;
+    }
+};
+
+extern uint64_t main_time;
+
+// Logical voxel address, as the core, world_gen and the debug write port use
+// it. voxel_memory_64 may store the word elsewhere (scene/voxel_layout.h).
+static inline uint32_t voxel_addr_from_xyz(uint8_t x, uint8_t y, uint8_t z) {
+    return (uint32_t(x) << 12) | (uint32_t(y) << 6) | uint32_t(z);
+}
+
+class VoxelSim {
+public:
+    VoxelSim(int width, int height);
+    ~VoxelSim();
+
+    VoxelSim(const VoxelSim&) = delete;
+    VoxelSim& operator=(const VoxelSim&) = delete;
+
+    // Hold reset for a few cycles, then release it.
+    void reset();
+    // Clock the model until voxel_world_gen has populated the volume.
+    // Returns the number of cycles spent.
+    uint64_t run_until_world_ready(uint64_t max_cycles = 4000000);
+    bool world_ready() const;
+
+    // Reset and bring the world up. A scene set with set_scene() is preloaded
+    // and world_gen skipped. Otherwise, with a snapshot path, restore from it
+    // if it matches this build, or run world generation and save it there.
+    // Returns the cycles spent in world generation (0 when loaded/restored).
+    uint64_t boot(const std::string& snapshot_path, bool* restored = nullptr);
+    void set_scene(const std::string& hvx_path) { scene_path_ = hvx_path; }
+
+    // Copy an .hvx volume straight into voxel_memory_64 (vram with
+    // VOXEL_CACHE) and mark the world ready so voxel_world_gen never runs.
+    // Call right after reset(). Files in another layout than the build's
+    // (HYDRA_VOXEL_LAYOUT) are reordered.
+    bool load_scene(const std::string& hvx_path);
+    // Write the current contents of voxel_memory_64 as .hvx, in the build's
+    // layout.
+    bool dump_scene(const std::string& hvx_path) const;
+    // Copy voxel_memory_64 and the core's flag/selection registers into the
+    // C++ model. Call at a frame boundary, after this frame's state is applied.
+    void sync_model(VoxelModel& model) const;
+
+    // Full model state (plus main_time) via Verilator --savable. Only the
+    // single-threaded build is savable; elsewhere these warn and return false.
+    bool save_snapshot(const std::string& path) const;
+    bool load_snapshot(const std::string& path);
+    static bool snapshots_supported();
+
+    void apply_camera(const CameraPose& cam);
+    // The first call with flags.sdf bakes the distance field into
+    // voxel_memory_64 (call after boot()); write_voxel() keeps it current
+    // from then on.
+    void apply_flags(const RenderFlags& flags);
+    void apply_selection(const SelectionState& sel);
+    // One-cycle debug write into voxel_memory_64 (addr = {x,y,z}). With the
+    // distance field baked, data's bits [3:0] are replaced and the
+    // neighbours' distances are fixed up in place.
+    void write_voxel(uint32_t addr, uint64_t data);
+
+    // FLAGS[4]: only start a frame after a camera/flag/selection change or a
+    // voxel write. idle() is true once the last owed frame has finished, so
+    // the caller can stop clocking until the next change.
+    void set_render_on_demand(bool on);
+    bool idle() const;
+    // One display refresh: clocks the model once with frame_tick high. Only
+    // pulses that find idle() count, so call it there (no pixels to drain).
+    void frame_tick();
+    // SKIPPED_FRAMES: frame_tick pulses the RTL held its auto-start back on.
+    uint32_t skipped_frames() const;
+
+    // Clock up to max_cycles. Stops early and returns true on frame_done; the
+    // finished frame is then in framebuffer() and its stats in last_frame().
+    // With HYDRA_DPI_PIXELS the RTL pushes pixels into a ring buffer and the
+    // drain runs every kDrainCycles instead of polling the port per cycle.
+    bool step(int max_cycles);
+
+    static constexpr int kDrainCycles = 1024;
+
+    const std::vector<uint32_t>& framebuffer() const { return framebuffer_; }
+    // Regions of framebuffer() that differ from the previous frame, in
+    // 16x16-tile granularity. The first frame after construction is full.
+    const std::vector<DamageRect>& damage() const { return damage_rects_; }
+    const FrameStats& last_frame() const { return last_frame_; }
+    // Raw 96-bit pixels (w0, w1, w2 per pixel) of the last frames, kept only
+    // after set_keep_words(true).
+    void set_keep_words(bool on);
+    const std::vector<uint32_t>& words() const { return words_; }
+    uint64_t frames_completed() const { return frames_completed_; }
+    CursorInfo cursor() const;
+    uint32_t hit_count() const;
+    uint32_t skip_count() const;
+    bool got_finish() const;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    Vvoxel_framebuffer_top* model() { return top_; }
+
+    // LOG_FRAMES-style stderr tracing of the first pixels and every frame.
+    void set_log_frames(bool on) { log_frames_ = on; }
+
+    // Pin the calling (eval) thread to cpus[0] and the model's worker threads
+    // to the remaining cpus. Call from the thread that steps the model.
+    int pin_threads(const std::vector<int>& cpus);
+    static int model_threads() { return HYDRA_SIM_THREADS; }
+
+private:
+    void tick();
+    void finish_frame(uint64_t end_time);
+    // The Verilated volume in RAM order: geom_mem's payload plane, or vram
+    // in a VOXEL_CACHE build.
+    uint64_t* volume_words();
+    const uint64_t* volume_words() const;
+    // The volume in {x,y,z} order: the Verilated array itself for the
+    // xyz layout, otherwise a reordered copy in xyz_scratch_.
+    const uint64_t* volume_xyz() const;
+    // After poking word index of the volume directly: recompute its trace
+    // plane byte, or drop the voxel cache set it maps to.
+    void sync_word(uint32_t index);
+    bool drain_pixels();
+
+    Vvoxel_framebuffer_top* top_ = nullptr;
+    int width_;
+    int height_;
+    std::vector<uint32_t> framebuffer_;
+    std::vector<uint32_t> argb_scratch_;
+    std::vector<uint32_t> words_;
+    bool                  keep_words_ = false;
+    DamageTracker         damage_;
+    std::vector<DamageRect> damage_rects_;
+
+    FrameStats last_frame_;
+    uint64_t frames_completed_ = 0;
+    uint64_t frame_start_time_ = 0;
+    uint64_t pixels_this_frame_ = 0;
+    uint64_t pixels_changed_ = 0;
+    uint64_t ring_drops_seen_ = 0;   // PixelRing overflows + lost_marks so far
+    std::chrono::steady_clock::time_point frame_start_wall_;
+
+    std::string scene_path_;
+    bool        distance_field_ = false;   // voxel_memory_64 carries the sdf field
+    mutable std::vector<uint64_t> xyz_scratch_;
+
+    bool log_frames_ = false;
+    int  log_pixel_samples_ = 0;
+
+    // Threads that existed before the model spun up its worker pool.
+    std::vector<int> threads_before_model_;
+};